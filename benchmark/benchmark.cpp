@@ -12,9 +12,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
 #include <vector>
 #if defined(_MSC_VER)
 #include <Windows.h>
@@ -28,6 +36,9 @@
 #endif
 
 #include "core/Backend.hpp"
+#ifdef MNN_USE_THREAD_POOL
+#include "backend/cpu/ThreadPool.hpp"
+#endif
 #include <MNN/Interpreter.hpp>
 #include <MNN/MNNDefine.h>
 #include <MNN/Tensor.hpp>
@@ -177,6 +188,230 @@ std::vector<float> doBench(Model& model, int loop, int warmup = 10, int forward
     return costs;
 }
 
+/**
+ Throughput mode: several sessions of one model run at the same time, each session with its own threads.
+ Closed loop: each session runs the next request once the last one finished.
+ Open loop: requests arrive as a Poisson process of given rate and are served by the first idle session,
+ the latency includes the time waiting in queue.
+ */
+struct ThroughputConfig {
+    int sessionNumber = 1;
+    // Requests per second for open loop, 0 means closed loop
+    float arrivalRate = 0.0f;
+};
+
+// Busy time in us of each thread index in thread pool, index 0 is the sum of all callers
+#define MAX_TRACE_THREAD 64
+static std::atomic<int64_t> gThreadBusy[MAX_TRACE_THREAD];
+#ifdef MNN_USE_THREAD_POOL
+static void traceThreadBusy(int threadIndex, int64_t beginUs, int64_t endUs, int workSize) {
+    if (threadIndex < MAX_TRACE_THREAD) {
+        gThreadBusy[threadIndex] += endUs - beginUs;
+    }
+}
+#endif
+
+// Resident and peak resident memory in MB, -1 if unknown
+static void getMemoryUsage(float& rss, float& peak) {
+    rss  = -1.0f;
+    peak = -1.0f;
+#if defined(__linux__)
+    FILE* fp = fopen("/proc/self/status", "rb");
+    if (nullptr == fp) {
+        return;
+    }
+    char buffer[256];
+    while (nullptr != fgets(buffer, sizeof(buffer), fp)) {
+        long value = 0;
+        if (1 == sscanf(buffer, "VmRSS: %ld kB", &value)) {
+            rss = value / 1024.0f;
+        } else if (1 == sscanf(buffer, "VmHWM: %ld kB", &value)) {
+            peak = value / 1024.0f;
+        }
+    }
+    fclose(fp);
+#endif
+}
+
+static float percentile(const std::vector<float>& sorted, float rate) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    auto index = (size_t)ceil(rate * sorted.size());
+    index      = std::max((size_t)1, std::min(index, sorted.size()));
+    return sorted[index - 1];
+}
+
+std::string doThroughput(Model& model, const ThroughputConfig& tc, int loop, int warmup = 10, int forward = MNN_FORWARD_CPU,
+                         int numberThread = 4, int precision = 2, float sparsity = 0.0f, int sparseBlockOC = 1) {
+    auto revertor = std::unique_ptr<Revert>(new Revert(model.model_file.c_str()));
+    revertor->initialize(sparsity, sparseBlockOC);
+    auto modelBuffer      = revertor->getBuffer();
+    const auto bufferSize = revertor->getBufferSize();
+    auto net = std::shared_ptr<MNN::Interpreter>(MNN::Interpreter::createFromBuffer(modelBuffer, bufferSize));
+    revertor.reset();
+    net->setSessionMode(MNN::Interpreter::Session_Release);
+    MNN::ScheduleConfig config;
+    config.numThread = numberThread;
+    config.type      = static_cast<MNNForwardType>(forward);
+    MNN::BackendConfig backendConfig;
+    backendConfig.precision = (MNN::BackendConfig::PrecisionMode)precision;
+    backendConfig.power = MNN::BackendConfig::Power_High;
+    config.backendConfig = &backendConfig;
+
+    const int sessionNumber = std::max(1, tc.sessionNumber);
+    std::vector<MNN::Session*> sessions(sessionNumber);
+    for (int i = 0; i < sessionNumber; ++i) {
+        sessions[i] = net->createSession(config);
+        if (nullptr == sessions[i]) {
+            MNN_ERROR("Create session %d of %s failed\n", i, model.name.c_str());
+            for (int j = 0; j < i; ++j) {
+                net->releaseSession(sessions[j]);
+            }
+            return "";
+        }
+    }
+    net->releaseModel();
+    auto runOnce = [&](MNN::Session* session) {
+        auto input  = net->getSessionInput(session, NULL);
+        auto output = net->getSessionOutput(session, NULL);
+        void* host = input->map(MNN::Tensor::MAP_TENSOR_WRITE,  MNN::Tensor::CAFFE);
+        input->unmap(MNN::Tensor::MAP_TENSOR_WRITE,  MNN::Tensor::CAFFE, host);
+        net->runSession(session);
+        host = output->map(MNN::Tensor::MAP_TENSOR_READ,  MNN::Tensor::CAFFE);
+        output->unmap(MNN::Tensor::MAP_TENSOR_READ,  MNN::Tensor::CAFFE, host);
+    };
+    typedef std::chrono::steady_clock Clock;
+    const int total = loop * sessionNumber;
+    std::vector<float> latency;
+    std::mutex latencyMutex;
+    std::atomic_int issued = {0};
+    std::atomic_int ready  = {0};
+    std::atomic_bool start = {false};
+
+    // Arrival time of open loop requests
+    std::deque<Clock::time_point> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool arrivalEnd = false;
+
+    for (int i = 0; i < MAX_TRACE_THREAD; ++i) {
+        gThreadBusy[i] = 0;
+    }
+    std::vector<std::thread> workers;
+    for (int i = 0; i < sessionNumber; ++i) {
+        workers.emplace_back([&, i]() {
+            auto session = sessions[i];
+            for (int w = 0; w < warmup; ++w) {
+                runOnce(session);
+            }
+            ready++;
+            while (!start) {
+                std::this_thread::yield();
+            }
+            std::vector<float> costs;
+            while (true) {
+                Clock::time_point arrival;
+                if (tc.arrivalRate > 0.0f) {
+                    std::unique_lock<std::mutex> _l(queueMutex);
+                    queueCondition.wait(_l, [&]() { return !queue.empty() || arrivalEnd; });
+                    if (queue.empty()) {
+                        break;
+                    }
+                    arrival = queue.front();
+                    queue.pop_front();
+                } else {
+                    if (issued++ >= total) {
+                        break;
+                    }
+                    arrival = Clock::now();
+                }
+                runOnce(session);
+                costs.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - arrival).count() / 1000.0f);
+            }
+            std::lock_guard<std::mutex> _l(latencyMutex);
+            latency.insert(latency.end(), costs.begin(), costs.end());
+        });
+    }
+    while (ready < sessionNumber) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#ifdef MNN_USE_THREAD_POOL
+    MNN::ThreadPool::setTraceFunction(traceThreadBusy);
+#endif
+    auto timeBegin = Clock::now();
+    start = true;
+    if (tc.arrivalRate > 0.0f) {
+        std::mt19937 engine(0);
+        std::exponential_distribution<double> interval(tc.arrivalRate);
+        auto next = timeBegin;
+        for (int i = 0; i < total; ++i) {
+            std::this_thread::sleep_until(next);
+            {
+                std::lock_guard<std::mutex> _l(queueMutex);
+                queue.emplace_back(next);
+            }
+            queueCondition.notify_one();
+            next += std::chrono::microseconds((int64_t)(interval(engine) * 1000000.0));
+        }
+        {
+            std::lock_guard<std::mutex> _l(queueMutex);
+            arrivalEnd = true;
+        }
+        queueCondition.notify_all();
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    auto wallUs = std::max((int64_t)1, (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - timeBegin).count());
+#ifdef MNN_USE_THREAD_POOL
+    MNN::ThreadPool::setTraceFunction(nullptr);
+#endif
+    float rss, peak;
+    getMemoryUsage(rss, peak);
+    for (auto s : sessions) {
+        net->releaseSession(s);
+    }
+
+    std::sort(latency.begin(), latency.end());
+    float sum = 0.0f;
+    for (auto v : latency) {
+        sum += v;
+    }
+    // Thread pool workers are index 1 to poolSize - 1, the calling threads of all sessions share index 0
+    int poolSize = 1;
+#ifdef MNN_USE_THREAD_POOL
+    poolSize = MNN::ThreadPool::poolSize();
+#endif
+    int poolThread = std::min(poolSize, MAX_TRACE_THREAD);
+    std::string busy;
+    float occupancy = 0.0f;
+    for (int i = 0; i < poolThread; ++i) {
+        float rate = (float)gThreadBusy[i].load() / (float)wallUs;
+        if (i > 0) {
+            occupancy += rate;
+            busy += ", ";
+        }
+        char value[32];
+        snprintf(value, sizeof(value), "%.4f", rate);
+        busy += value;
+    }
+    if (poolThread > 1) {
+        occupancy /= (float)(poolThread - 1);
+    }
+    char result[2048];
+    snprintf(result, sizeof(result),
+             "{\"model\": \"%s\", \"forward\": %d, \"sessions\": %d, \"threads_per_session\": %d, \"thread_pool_size\": %d, \"precision\": %d, "
+             "\"mode\": \"%s\", \"arrival_qps\": %.3f, \"requests\": %d, \"duration_s\": %.4f, \"qps\": %.3f, "
+             "\"latency_ms\": {\"avg\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"p999\": %.4f, \"max\": %.4f}, "
+             "\"rss_mb\": %.2f, \"peak_rss_mb\": %.2f, \"thread_pool_occupancy\": %.4f, \"thread_busy_ratio\": [%s]}",
+             model.name.c_str(), forward, sessionNumber, numberThread, poolSize, precision, tc.arrivalRate > 0.0f ? "open" : "closed",
+             tc.arrivalRate, (int)latency.size(), wallUs / 1000000.0f, latency.size() * 1000000.0f / wallUs,
+             latency.empty() ? 0.0f : sum / latency.size(), percentile(latency, 0.5f), percentile(latency, 0.99f),
+             percentile(latency, 0.999f), latency.empty() ? 0.0f : latency.back(), rss, peak, occupancy, busy.c_str());
+    return result;
+}
+
 void displayStats(const std::string& name, const std::vector<float>& costs) {
     float max = 0, min = FLT_MAX, sum = 0, avg;
     for (auto v : costs) {
@@ -384,8 +619,10 @@ int main(int argc, const char* argv[]) {
     int precision = 2;
     float sparsity = 0.0f;
     int sparseBlockOC = 1;
+    ThroughputConfig throughput;
+    const char* jsonFile = nullptr;
     if (argc <= 2) {
-        std::cout << "Usage: " << argv[0] << " models_folder [loop_count] [warmup] [forwardtype] [numberThread] [precision] [weightSparsity]" << std::endl;
+        std::cout << "Usage: " << argv[0] << " models_folder [loop_count] [warmup] [forwardtype] [numberThread] [precision] [weightSparsity] [sparseBlockOC] [sessionNumber] [arrivalQPS] [jsonFile]" << std::endl;
         return 1;
     }
     if (argc >= 3) {
@@ -413,6 +650,18 @@ int main(int argc, const char* argv[]) {
         sparseBlockOC = atoi(argv[8]);
     }
 
+    if (argc >= 10) {
+        throughput.sessionNumber = atoi(argv[9]);
+    }
+
+    if (argc >= 11) {
+        throughput.arrivalRate = atof(argv[10]);
+    }
+
+    if (argc >= 12) {
+        jsonFile = argv[11];
+    }
+
     std::cout << "Forward type: **" << forwardType(forward) << "** thread=" << numberThread << "** precision=" <<precision << "** sparsity=" <<sparsity << "** sparseBlockOC=" << sparseBlockOC << std::endl;
     std::vector<Model> models = findModelFiles(argv[1]);
 
@@ -421,6 +670,32 @@ int main(int argc, const char* argv[]) {
     /* not called yet */
     // set_cpu_affinity();
 
+    if (argc >= 10) {
+        std::cout << "--------> Throughput... sessions = " << throughput.sessionNumber << ", arrival qps = " << throughput.arrivalRate << std::endl;
+        std::vector<std::string> results;
+        for (auto& m : models) {
+            auto result = doThroughput(m, throughput, loop, warmup, forward, numberThread, precision, sparsity, sparseBlockOC);
+            if (result.empty()) {
+                return 1;
+            }
+            results.emplace_back(result);
+            std::cout << result << std::endl;
+        }
+        if (nullptr != jsonFile) {
+            std::ofstream output(jsonFile);
+            if (!output.is_open()) {
+                std::cout << "open " << jsonFile << " failed" << std::endl;
+                return 1;
+            }
+            output << "[" << std::endl;
+            for (int i = 0; i < results.size(); ++i) {
+                output << results[i] << (i + 1 < results.size() ? "," : "") << std::endl;
+            }
+            output << "]" << std::endl;
+        }
+        return 0;
+    }
+
     for (auto& m : models) {
         std::vector<float> costs = doBench(m, loop, warmup, forward, false, numberThread, precision, sparsity, sparseBlockOC);
         displayStats(m.name, costs);
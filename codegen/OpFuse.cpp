@@ -9,13 +9,15 @@
 #include "OpFuse.hpp"
 #include "geometry/GeometryComputerUtils.hpp"
 #include "PluginModule.hpp"
+#include <map>
 #include <queue>
 #include <unordered_map>
 #include "cpu/CPUAst.hpp"
+#ifdef MNN_CODEGEN_LLVM
 #include "jit/LLVMJit.hpp"
-
-#if !defined(_MSC_VER)
-#include <dlfcn.h>
+#endif
+#ifdef MNN_CODEGEN_C
+#include "cpu/c/SourceCompiler.hpp"
 #endif
 /**
     OpFuse
@@ -64,25 +66,100 @@ static void dumpCmd(const Command* cmd) {
     printf("}\n");
 }
 
+static bool isFloat(const Tensor* t) {
+    return t->getType() == halide_type_of<float>();
+}
+static bool isLegalElemWise(const Command* cmd) {
+    auto op = cmd->op;
+    switch (op->type()) {
+        case OpType_BinaryOp:
+            switch (op->main_as_BinaryOp()->opType()) {
+                case BinaryOpOperation_ADD:
+                case BinaryOpOperation_SUB:
+                case BinaryOpOperation_MUL:
+                case BinaryOpOperation_DIV:
+                case BinaryOpOperation_REALDIV:
+                case BinaryOpOperation_FLOORDIV:
+                case BinaryOpOperation_POW:
+                case BinaryOpOperation_MINIMUM:
+                case BinaryOpOperation_MAXIMUM:
+                    break;
+                default:
+                    return false;
+            }
+            break;
+        case OpType_UnaryOp:
+            switch (op->main_as_UnaryOp()->opType()) {
+                case UnaryOpOperation_ABS:
+                case UnaryOpOperation_FLOOR:
+                case UnaryOpOperation_CEIL:
+                case UnaryOpOperation_SQRT:
+                case UnaryOpOperation_EXP:
+                case UnaryOpOperation_LOG:
+                case UnaryOpOperation_SIN:
+                case UnaryOpOperation_COS:
+                case UnaryOpOperation_ROUND:
+                case UnaryOpOperation_NEG:
+                case UnaryOpOperation_SQUARE:
+                case UnaryOpOperation_RSQRT:
+                case UnaryOpOperation_RECIPROCAL:
+                case UnaryOpOperation_SIGMOID:
+                case UnaryOpOperation_TANH:
+                    break;
+                default:
+                    return false;
+            }
+            break;
+        case OpType_Eltwise: {
+            auto eltwise = op->main_as_Eltwise();
+            if ((nullptr != eltwise->coeff() && eltwise->coeff()->size() > 0)) {
+                return false;
+            }
+            break;
+        }
+        case OpType_ReLU:
+            if (nullptr == op->main_as_Relu()) {
+                return false;
+            }
+            break;
+        case OpType_ReLU6:
+            if (nullptr == op->main_as_Relu6()) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    // The loop run on linear float memory, inputs are the same size as output or scalar
+    auto output = cmd->outputs[0];
+    if (cmd->outputs.size() != 1 || !isFloat(output) || TensorUtils::getDescribe(output)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+        return false;
+    }
+    for (auto input : cmd->inputs) {
+        if (!isFloat(input) || TensorUtils::getDescribe(input)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+            return false;
+        }
+        if (input->elementSize() != 1 && input->elementSize() != output->elementSize()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // is legal fused type
 bool isLegal(const Command* cmd) {
     auto type = cmd->op->type();
-    bool elemWise = type == OpType_BinaryOp
-           || type == OpType_UnaryOp
-           || type == OpType_ReLU
-           || type == OpType_ReLU6
-           || type == OpType_Eltwise;
-    if (elemWise) {
-        return true;
+    if (isElemWise(type)) {
+        return isLegalElemWise(cmd);
     }
 #define fuse_raster
 #ifdef fuse_raster
     if (type == OpType_Raster) {
         auto outputFormat = TensorUtils::getDescribe(cmd->outputs[0])->dimensionFormat;
-        bool legalFormat = outputFormat != MNN_DATA_FORMAT_NC4HW4;
+        bool legalFormat = outputFormat != MNN_DATA_FORMAT_NC4HW4 && isFloat(cmd->outputs[0]);
         if (TensorUtils::getDescribe(cmd->inputs[0])->regions.size() > 1) return false;
         for (auto reg : TensorUtils::getDescribe(cmd->inputs[0])->regions) {
-            legalFormat &= TensorUtils::getDescribe(reg.origin)->dimensionFormat == outputFormat;
+            legalFormat &= TensorUtils::getDescribe(reg.origin)->dimensionFormat == outputFormat && isFloat(reg.origin);
         }
         return legalFormat;
     }
@@ -90,6 +167,19 @@ bool isLegal(const Command* cmd) {
     return false;
 }
 
+// The result of node is only kept in register if it's fused, so it must have only one consumer and not be output
+static bool canBeInlined(Node* node) {
+    if (node->succ.size() != 1) {
+        return false;
+    }
+    for (auto t : node->cmd->outputs) {
+        if (TensorUtils::getDescribe(t)->usage == Tensor::InsideDescribe::OUTPUT) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Node* LCA(Node* x, Node* y) {
     while (x != y) {
         if (!x || !y) {
@@ -128,7 +218,7 @@ std::vector<Node*> fuseNode(Node* root, std::vector<Node*>& edges) {
         fuseSet.insert(fuseSet.begin(), node);
         q.pop();
         for (auto child : node->domainateSucc) {
-            if (isLegal(child->cmd) && allPathLegal(child, root)) {
+            if (isLegal(child->cmd) && canBeInlined(child) && allPathLegal(child, root)) {
                 q.push(child);
             } else {
                 edges.push_back(child);
@@ -138,123 +228,78 @@ std::vector<Node*> fuseNode(Node* root, std::vector<Node*>& edges) {
     return fuseSet;
 }
 
-void codegen(CommandBuffer& cmd, std::vector<std::vector<Node*>>& fuseSets) {
-    // generate Kernel
-    CPUPluginModule plugin("codegen_demo");
-    for (auto compSet : fuseSets) {
-        // printf("set size: %lu \n", compSet.size());
-        InOutTensors tensors = plugin.addFunction(compSet);
-        auto inputs = tensors.first;
-        auto outputs = tensors.second;
-        // build Plugin Op
-        Command cmdPlugin;
-        {
-            std::unique_ptr<OpT> pluginOp(new OpT);
-            pluginOp->type = OpType_Plugin;
-            pluginOp->name = "PluginWrapper";
-            PluginT* plugin_param = new PluginT;
-            plugin_param->type    = "PluginWrapper";
-            plugin_param->attr.resize(1);
-            plugin_param->attr[0].reset(new AttributeT);
-            plugin_param->attr[0]->key = "kernel";
-            plugin_param->attr[0]->i = plugin.getFunctionNum()-1;
-            pluginOp->main.type  = OpParameter_Plugin;
-            pluginOp->main.value = plugin_param;
-            flatbuffers::FlatBufferBuilder builder;
-            auto lastOffset = Op::Pack(builder, pluginOp.get());
-            builder.Finish(lastOffset);
-            cmdPlugin = GeometryComputerUtils::makeCommand(builder, inputs, outputs);
-        }
-        for (int i = 0; i < compSet.size(); i++) {
-            auto cmd = const_cast<Command*>(compSet[i]->cmd);
-            if (i == compSet.size()-1) {
-                cmd->op = cmdPlugin.op;
-                cmd->inputs = cmdPlugin.inputs;
-                cmd->outputs = cmdPlugin.outputs;
-                cmd->buffer = cmdPlugin.buffer;
-            } else {
-                cmd->op = nullptr;
-                cmd->buffer.clear();
-            }
-        }
+// Command of origin -> fused command, nullptr means the command is removed
+using FuseCommandMap = std::map<const Command*, SharedPtr<Command>>;
+
+static SharedPtr<Command> makePluginCommand(const std::string& type, int kernel, const std::string& library,
+                                            const InOutTensors& tensors) {
+    std::unique_ptr<OpT> pluginOp(new OpT);
+    pluginOp->type = OpType_Plugin;
+    pluginOp->name = type;
+    PluginT* plugin_param = new PluginT;
+    plugin_param->type    = type;
+    plugin_param->attr.resize(1);
+    plugin_param->attr[0].reset(new AttributeT);
+    plugin_param->attr[0]->key = "kernel";
+    plugin_param->attr[0]->i = kernel;
+    if (!library.empty()) {
+        std::unique_ptr<AttributeT> attr(new AttributeT);
+        attr->key = "library";
+        attr->s   = library;
+        plugin_param->attr.emplace_back(std::move(attr));
     }
-    // printf("total: %d\n", idx);
-    plugin.codegen();
-    // printf("cmd num: %lu \n", cmd.command.size());
-    for (auto iter = cmd.command.begin(); iter != cmd.command.end();) {
-        if (iter->op == nullptr) {
-            iter = cmd.command.erase(iter);
-        } else {
-            ++iter;
+    pluginOp->main.type  = OpParameter_Plugin;
+    pluginOp->main.value = plugin_param;
+    flatbuffers::FlatBufferBuilder builder;
+    auto lastOffset = Op::Pack(builder, pluginOp.get());
+    builder.Finish(lastOffset);
+    return GeometryComputerUtils::makeCommand(builder, tensors.first, tensors.second);
+}
+
+// The fused command run at the place of the last command in set
+static void replaceFuseSet(const std::vector<Node*>& compSet, SharedPtr<Command> cmdPlugin, FuseCommandMap& replaced) {
+    Node* last = compSet[0];
+    for (auto node : compSet) {
+        replaced[node->cmd] = nullptr;
+        if (node->topoIndex > last->topoIndex) {
+            last = node;
         }
     }
-#if !defined(_MSC_VER)
-    // printf("cmd num: %lu \n", cmd.command.size());
-    dlopen("./libplugin_fuse.so", RTLD_NOW | RTLD_LOCAL);
-#endif
+    replaced[last->cmd] = cmdPlugin;
+}
+
+#ifdef MNN_CODEGEN_C
+// Generate C source for all fused sets, build and load it by system compiler
+static void sourceCodegen(std::vector<std::vector<Node*>>& fuseSets, FuseCommandMap& replaced) {
+    CPUPluginModule plugin("codegen_c");
+    std::vector<InOutTensors> tensors;
+    for (auto& compSet : fuseSets) {
+        tensors.emplace_back(plugin.addFunction(compSet));
+    }
+    auto library = SourceCompiler::get()->load(plugin.sourceCode(), plugin.getFunctionNum());
+    if (library.empty()) {
+        // Can't compile, keep the origin commands
+        return;
+    }
+    for (int i = 0; i < fuseSets.size(); i++) {
+        replaceFuseSet(fuseSets[i], makePluginCommand("CPluginWrapper", i, library, tensors[i]), replaced);
+    }
 }
+#endif
 
-void jit(CommandBuffer& cmd, std::vector<std::vector<Node*>>& fuseSets) {
+#ifdef MNN_CODEGEN_LLVM
+static void jit(std::vector<std::vector<Node*>>& fuseSets, FuseCommandMap& replaced) {
     LLVMJIT* theJit = LLVMJIT::createLLVMJIT();
     CPUPluginModule plugin("jit_demo");
     std::string kernelStr;
-    for (auto compSet : fuseSets) {
-        /*
-        // printf("set size: %lu \n", compSet.size());
-        if (true) {
-            for (auto com : compSet) {
-                // json :
-                // { fusedOps: [ { idx:int, srcOps: [name: string], inputs:[name:string], outputs:[name:string] } ], dynlib:string, jitObj:string, module:string }
-                dumpCmd(com->cmd);
-            }
-        }
-        */
+    for (auto& compSet : fuseSets) {
         kernelStr += "[";
         for (auto com : compSet) {
             kernelStr += com->cmd->op->name()->str();
         }
         kernelStr += "]";
         InOutTensors tensors = plugin.addFunction(compSet);
-        auto inputs = tensors.first;
-        auto outputs = tensors.second;
-        // build Plugin Op
-        Command cmdPlugin;
-        {
-            std::unique_ptr<OpT> pluginOp(new OpT);
-            pluginOp->type = OpType_Plugin;
-            pluginOp->name = "JitPluginWrapper";
-            PluginT* plugin_param = new PluginT;
-            plugin_param->type    = "JitPluginWrapper";
-            plugin_param->attr.resize(1);
-            plugin_param->attr[0].reset(new AttributeT);
-            plugin_param->attr[0]->key = "kernel";
-            plugin_param->attr[0]->i = plugin.getFunctionNum() - 1;
-            pluginOp->main.type  = OpParameter_Plugin;
-            pluginOp->main.value = plugin_param;
-            flatbuffers::FlatBufferBuilder builder;
-            auto lastOffset = Op::Pack(builder, pluginOp.get());
-            builder.Finish(lastOffset);
-            cmdPlugin = GeometryComputerUtils::makeCommand(builder, inputs, outputs);
-        }
-        for (int i = 0; i < compSet.size(); i++) {
-            auto cmd = const_cast<Command*>(compSet[i]->cmd);
-            if (i == compSet.size()-1) {
-                cmd->op = cmdPlugin.op;
-                cmd->inputs = cmdPlugin.inputs;
-                cmd->outputs = cmdPlugin.outputs;
-                cmd->buffer = cmdPlugin.buffer;
-            } else {
-                cmd->op = nullptr;
-                cmd->buffer.clear();
-            }
-        }
-    }
-    for (auto iter = cmd.command.begin(); iter != cmd.command.end();) {
-        if (iter->op == nullptr) {
-            iter = cmd.command.erase(iter);
-        } else {
-            ++iter;
-        }
+        replaceFuseSet(compSet, makePluginCommand("JitPluginWrapper", plugin.getFunctionNum() - 1, "", tensors), replaced);
     }
     size_t id = std::hash<std::string>()(kernelStr);
     std::unique_ptr<LLVMTarget> target(new LLVMTarget("jit-kenerl-" + std::to_string(id)));
@@ -266,8 +311,13 @@ void jit(CommandBuffer& cmd, std::vector<std::vector<Node*>>& fuseSets) {
     theJit->addModule(std::move(m), resourceTracker);
     theJit->compileAllFunction(plugin.getFunctionNum());
 }
+#endif
 
-bool opFuse(CommandBuffer& cmd) {
+bool opFuse(std::vector<Schedule::PipelineInfo>& infos, MNNForwardType type) {
+    // Fused kernels run as plugin op of cpu
+    if (type != MNN_FORWARD_CPU && type != MNN_FORWARD_CPU_EXTENSION) {
+        return false;
+    }
     std::unordered_map<const Tensor*, Node*> outputTensor;
     // build graph
     std::vector<std::unique_ptr<Node>> graph;
@@ -278,27 +328,25 @@ bool opFuse(CommandBuffer& cmd) {
             preNode->succ.push_back(succNode);
         }
     };
-    for (int i = 0; i < cmd.command.size(); i++) {
-        auto& iter = cmd.command[i];
-        if (!iter.buffer.empty()) {
-            iter.op = flatbuffers::GetMutableRoot<Op>((void*)iter.buffer.data());
-        }
-        std::unique_ptr<Node> node(new Node);
-        node->cmd = &iter;
-        node->topoIndex = i;
-        for (auto input : iter.inputs) {
-            if (TensorUtils::getDescribe(input)->memoryType == Tensor::InsideDescribe::MEMORY_VIRTUAL) {
-                for (auto& region : TensorUtils::getDescribe(input)->regions) {
-                    insertEdge(region.origin, node.get());
+    for (auto& info : infos) {
+        for (auto& iter : info.executeBuffer.command) {
+            std::unique_ptr<Node> node(new Node);
+            node->cmd = iter.get();
+            node->topoIndex = (int)graph.size();
+            for (auto input : iter->inputs) {
+                if (TensorUtils::getDescribe(input)->memoryType == Tensor::InsideDescribe::MEMORY_VIRTUAL) {
+                    for (auto& region : TensorUtils::getDescribe(input)->regions) {
+                        insertEdge(region.origin, node.get());
+                    }
+                } else {
+                    insertEdge(input, node.get());
                 }
-            } else {
-                insertEdge(input, node.get());
             }
+            for (auto output : iter->outputs) {
+                outputTensor[output] = node.get();
+            }
+            graph.push_back(std::move(node));
         }
-        for (auto output : iter.outputs) {
-            outputTensor[output] = node.get();
-        }
-        graph.push_back(std::move(node));
     }
     std::queue<Node*> postDominateNodeQueue;
     // build dominate tree
@@ -341,8 +389,31 @@ bool opFuse(CommandBuffer& cmd) {
             postDominateNodeQueue.push(child);
         }
     }
-    jit(cmd, fuseSets);
+    if (fuseSets.empty()) {
+        return true;
+    }
+    FuseCommandMap replaced;
+#ifdef MNN_CODEGEN_LLVM
+    jit(fuseSets, replaced);
+#elif defined(MNN_CODEGEN_C)
+    sourceCodegen(fuseSets, replaced);
+#endif
+    if (replaced.empty()) {
+        return false;
+    }
+    for (auto& info : infos) {
+        auto& commands = info.executeBuffer.command;
+        std::vector<SharedPtr<Command>> fusedCommands;
+        for (auto& iter : commands) {
+            auto fused = replaced.find(iter.get());
+            if (fused == replaced.end()) {
+                fusedCommands.emplace_back(iter);
+            } else if (nullptr != fused->second.get()) {
+                fusedCommands.emplace_back(fused->second);
+            }
+        }
+        commands = std::move(fusedCommands);
+    }
     return true;
 }
 } // namespace MNN
-
@@ -9,6 +9,6 @@
 #include "geometry/GeometryComputerUtils.hpp"
 
 namespace MNN {
-    bool opFuse(CommandBuffer& cmd);
+    // Fuse the commands of all infos after geometry transform, only for cpu backend
+    bool opFuse(std::vector<Schedule::PipelineInfo>& infos, MNNForwardType type);
 } // namespace MNN
-
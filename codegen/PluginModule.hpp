@@ -50,7 +50,13 @@ public:
     InOutTensors addFunction(std::vector<Node*> nodes) override;
     const int getFunctionNum() override { return functions.size(); }
     void codegen() override;
+#ifdef MNN_CODEGEN_LLVM
     void codegen(LLVMTarget* target);
+#endif
+#ifdef MNN_CODEGEN_C
+    // C source of all functions: void kernel_i(float** inputs, float** outputs)
+    std::string sourceCode();
+#endif
 private:
     class CPUPluginFunction;
     std::vector<std::unique_ptr<CPUPluginFunction>> functions;
@@ -145,12 +145,13 @@ private:
                     break;
             }
         }
-        std::unique_ptr<ExprAST> content;
+        // Store all values not consumed in the loop, they are outputs or used by the following raster
+        std::unique_ptr<ListExprAST> content(new ListExprAST);
         for (auto& iter : outMap) {
             auto outputExpr = getExprByTensor(iter.first, false);
             auto output = std::make_unique<SubscriptExprAST>(std::move(outputExpr), "i");
             varShape[iter.first] = iter.first->elementSize();
-            content = std::make_unique<AssignExprAST>(std::move(output), std::move(iter.second));
+            content->push_back(std::make_unique<AssignExprAST>(std::move(output), std::move(iter.second)));
         }
         int size = -1;
         for (auto& iter : varShape) {
@@ -233,11 +234,13 @@ private:
     std::unique_ptr<FunctionAST> function;
 };
 
+#ifdef MNN_CODEGEN_LLVM
 void CPUPluginModule::codegen(LLVMTarget* target) {
     for (int i = 0; i < getFunctionNum(); i++) {
         functions[i]->codegen(target);
     }
 }
+#endif
 
 void CPUPluginModule::codegen() {
     std::ofstream headerFile("./kernel.h");
@@ -250,14 +253,10 @@ void CPUPluginModule::codegen() {
     std::unique_ptr<LLVMTarget> llvm(new LLVMTarget(name));
 #endif
 #ifdef MNN_CODEGEN_C
-    sourceFile << "#include \"math.h\"\n";
-    std::unique_ptr<SourceTarget> source(new CTarget(name));
+    sourceFile << sourceCode();
 #endif
     for (int i = 0; i < getFunctionNum(); i++) {
         headerFile << "void kernel_" + std::to_string(i) + "(float**, float**);\n";
-#ifdef MNN_CODEGEN_C
-        sourceFile << functions[i]->codegen(source.get());
-#endif
 #ifdef MNN_CODEGEN_LLVM
         functions[i]->codegen(llvm.get());
 #endif
@@ -277,6 +276,17 @@ void CPUPluginModule::codegen() {
 #endif
 }
 
+#ifdef MNN_CODEGEN_C
+std::string CPUPluginModule::sourceCode() {
+    std::string source = "#include <math.h>\n";
+    std::unique_ptr<SourceTarget> target(new CTarget(name));
+    for (int i = 0; i < getFunctionNum(); i++) {
+        source += functions[i]->codegen(target.get());
+    }
+    return source;
+}
+#endif
+
 InOutTensors CPUPluginModule::addFunction(std::vector<Node*> nodes) {
     std::unique_ptr<CPUPluginFunction> func(new CPUPluginFunction(nodes, getFunctionNum()));
     auto res = std::make_pair<std::vector<MNN::Tensor*>, std::vector<MNN::Tensor*>>(func->getInputs(), func->getOutputs());
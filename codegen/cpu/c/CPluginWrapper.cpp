@@ -0,0 +1,56 @@
+//
+//  CPluginWrapper.cpp
+//  MNN
+//
+//  Created by MNN on 2023/04/14.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <vector>
+#include "MNN/plugin/PluginKernel.hpp"
+#include "cpu/c/SourceCompiler.hpp"
+
+namespace MNN {
+namespace plugin {
+
+namespace backend {
+// Run kernel of the library built by SourceCompiler, attr library: key of library, kernel: index of kernel
+class CPluginWrapper : public CPUComputeKernel {
+public:
+    bool init(CPUKernelContext* ctx) override;
+    bool compute(CPUKernelContext* ctx) override;
+private:
+    SourceCompiler::Kernel mKernel = nullptr;
+    std::vector<float*> mInputs;
+    std::vector<float*> mOutputs;
+};
+
+bool CPluginWrapper::init(CPUKernelContext* ctx) {
+    if (!ctx->hasAttr("library") || !ctx->hasAttr("kernel")) {
+        return false;
+    }
+    mKernel = SourceCompiler::get()->getKernel(ctx->getAttr("library")->s()->str(), ctx->getAttr("kernel")->i());
+    return nullptr != mKernel;
+}
+
+bool CPluginWrapper::compute(CPUKernelContext* ctx) {
+    if (nullptr == mKernel) {
+        return false;
+    }
+    mInputs.resize(ctx->inputs().size());
+    for (int i = 0; i < mInputs.size(); i++) {
+        mInputs[i] = reinterpret_cast<float*>(ctx->input(i)->buffer().host);
+    }
+    mOutputs.resize(ctx->outputs().size());
+    for (int i = 0; i < mOutputs.size(); i++) {
+        mOutputs[i] = reinterpret_cast<float*>(ctx->output(i)->buffer().host);
+    }
+    mKernel(mInputs.data(), mOutputs.data());
+    return true;
+}
+} // namespace backend
+
+REGISTER_PLUGIN_COMPUTE_KERNEL(CPluginWrapper, backend::CPluginWrapper);
+
+} // namespace plugin
+} // namespace MNN
@@ -0,0 +1,238 @@
+//
+//  SourceCompiler.cpp
+//  MNN
+//
+//  Created by MNN on 2023/04/14.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "cpu/c/SourceCompiler.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fstream>
+#include <sstream>
+#include <MNN/MNNDefine.h>
+#if !defined(_MSC_VER)
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef MNN_CODEGEN_C_COMPILER
+#define MNN_CODEGEN_C_COMPILER "cc"
+#endif
+#ifndef MNN_CODEGEN_C_FLAGS
+#define MNN_CODEGEN_C_FLAGS "-O3 -fPIC -shared -fno-math-errno"
+#endif
+#ifndef MNN_CODEGEN_CACHE_DIR
+#define MNN_CODEGEN_CACHE_DIR ""
+#endif
+
+// SHA-256 of data in hex, used to name and verify the cached libraries
+static std::string _sha256(const std::string& data) {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+    std::string message = data;
+    uint64_t bitLength  = (uint64_t)data.size() * 8;
+    message.push_back((char)0x80);
+    while (message.size() % 64 != 56) {
+        message.push_back((char)0);
+    }
+    for (int i = 7; i >= 0; --i) {
+        message.push_back((char)((bitLength >> (i * 8)) & 0xff));
+    }
+    for (size_t offset = 0; offset < message.size(); offset += 64) {
+        uint32_t w[64];
+        auto block = (const uint8_t*)message.data() + offset;
+        for (int i = 0; i < 16; ++i) {
+            w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) | ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i]    = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t v[8];
+        for (int i = 0; i < 8; ++i) {
+            v[i] = h[i];
+        }
+        for (int i = 0; i < 64; ++i) {
+            auto s1    = rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25);
+            auto ch    = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            auto temp1 = v[7] + s1 + ch + k[i] + w[i];
+            auto s0    = rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22);
+            auto maj   = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            auto temp2 = s0 + maj;
+            for (int j = 7; j > 0; --j) {
+                v[j] = v[j - 1];
+            }
+            v[4] += temp1;
+            v[0] = temp1 + temp2;
+        }
+        for (int i = 0; i < 8; ++i) {
+            h[i] += v[i];
+        }
+    }
+    std::string result;
+    char buffer[9];
+    for (int i = 0; i < 8; ++i) {
+        snprintf(buffer, sizeof(buffer), "%08x", h[i]);
+        result += buffer;
+    }
+    return result;
+}
+
+SourceCompiler* SourceCompiler::get() {
+    static SourceCompiler gCompiler;
+    return &gCompiler;
+}
+
+#if !defined(_MSC_VER)
+static bool _readFile(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+    return !file.bad();
+}
+
+// The file must be owned by current user and can't be written by others
+static bool _isPrivate(const std::string& path, bool directory) {
+    struct stat st;
+    if (0 != lstat(path.c_str(), &st)) {
+        return false;
+    }
+    bool typeValid = directory ? S_ISDIR(st.st_mode) : S_ISREG(st.st_mode);
+    return typeValid && st.st_uid == geteuid() && 0 == (st.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+// Default to a per-user cache directory, only accessible by current user
+static std::string _cacheDirectory() {
+    std::string directory = MNN_CODEGEN_CACHE_DIR;
+    if (directory.empty()) {
+        auto cacheHome = getenv("XDG_CACHE_HOME");
+        auto home      = getenv("HOME");
+        if (nullptr != cacheHome && cacheHome[0] == '/') {
+            directory = std::string(cacheHome) + "/mnn_codegen";
+        } else if (nullptr != home && home[0] == '/') {
+            auto cache = std::string(home) + "/.cache";
+            mkdir(cache.c_str(), 0700);
+            directory = cache + "/mnn_codegen";
+        } else {
+            directory = "/tmp/mnn_codegen_" + std::to_string(geteuid());
+        }
+    }
+    mkdir(directory.c_str(), 0700);
+    if (!_isPrivate(directory, true)) {
+        MNN_ERROR("Codegen cache directory %s must be owned by current user and not writable by others\n", directory.c_str());
+        return "";
+    }
+    return directory;
+}
+
+// The digest file records the digest of source and of the built library, check both before loading the library
+static bool _verifyLibrary(const std::string& libPath, const std::string& digestPath, const std::string& sourceDigest) {
+    if (!_isPrivate(libPath, false) || !_isPrivate(digestPath, false)) {
+        return false;
+    }
+    std::string digests, library;
+    if (!_readFile(digestPath, digests) || !_readFile(libPath, library)) {
+        return false;
+    }
+    return digests == sourceDigest + "\n" + _sha256(library) + "\n";
+}
+#endif
+
+std::string SourceCompiler::load(const std::string& source, int kernelNumber) {
+#if defined(_MSC_VER)
+    return "";
+#else
+    std::string command = std::string(MNN_CODEGEN_C_COMPILER) + " " + MNN_CODEGEN_C_FLAGS;
+    auto sourceDigest   = _sha256(command + "\n" + source);
+    auto key            = sourceDigest.substr(0, 32);
+    std::lock_guard<std::mutex> _l(mLock);
+    if (mLibraries.find(key) != mLibraries.end()) {
+        return key;
+    }
+    auto directory = _cacheDirectory();
+    if (directory.empty()) {
+        return "";
+    }
+    auto prefix     = directory + "/mnn_fuse_" + key;
+    auto libPath    = prefix + ".so";
+    auto digestPath = prefix + ".sha256";
+    if (!_verifyLibrary(libPath, digestPath, sourceDigest)) {
+        // Build in temp files and rename, other processes never see a partial library
+        auto tempPrefix = prefix + "_" + std::to_string(getpid());
+        auto sourcePath = tempPrefix + ".c";
+        auto tempPath   = tempPrefix + ".so";
+        auto tempDigest = tempPrefix + ".sha256";
+        {
+            std::ofstream sourceFile(sourcePath);
+            if (!sourceFile.is_open()) {
+                MNN_ERROR("Can't write fused kernels to %s\n", sourcePath.c_str());
+                return "";
+            }
+            sourceFile << source;
+        }
+        auto compile = command + " \"" + sourcePath + "\" -o \"" + tempPath + "\" -lm";
+        bool success = 0 == system(compile.c_str());
+        remove(sourcePath.c_str());
+        std::string library;
+        if (success) {
+            success = _readFile(tempPath, library);
+        }
+        if (success) {
+            std::ofstream digestFile(tempDigest);
+            digestFile << sourceDigest << "\n" << _sha256(library) << "\n";
+            digestFile.close();
+            success = !digestFile.fail();
+        }
+        success = success && 0 == rename(tempPath.c_str(), libPath.c_str()) && 0 == rename(tempDigest.c_str(), digestPath.c_str());
+        if (!success) {
+            MNN_ERROR("Compile fused kernels failed: %s\n", compile.c_str());
+            remove(tempPath.c_str());
+            remove(tempDigest.c_str());
+            return "";
+        }
+    }
+    auto handle = dlopen(libPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (nullptr == handle) {
+        MNN_ERROR("Can't load fused kernels: %s\n", dlerror());
+        return "";
+    }
+    std::vector<Kernel> kernels(kernelNumber);
+    for (int i = 0; i < kernelNumber; ++i) {
+        kernels[i] = (Kernel)dlsym(handle, ("kernel_" + std::to_string(i)).c_str());
+        if (nullptr == kernels[i]) {
+            MNN_ERROR("Can't find kernel_%d in %s\n", i, libPath.c_str());
+            dlclose(handle);
+            return "";
+        }
+    }
+    mLibraries.insert(std::make_pair(key, std::move(kernels)));
+    return key;
+#endif
+}
+
+SourceCompiler::Kernel SourceCompiler::getKernel(const std::string& key, int index) {
+    std::lock_guard<std::mutex> _l(mLock);
+    auto iter = mLibraries.find(key);
+    if (iter == mLibraries.end() || index < 0 || index >= iter->second.size()) {
+        return nullptr;
+    }
+    return iter->second[index];
+}
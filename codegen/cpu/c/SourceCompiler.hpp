@@ -0,0 +1,38 @@
+//
+//  SourceCompiler.hpp
+//  MNN
+//
+//  Created by MNN on 2023/04/14.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef SourceCompiler_hpp
+#define SourceCompiler_hpp
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ Build the C source of fused kernels by the system compiler and load it without LLVM.
+ The shared library is cached in MNN_CODEGEN_CACHE_DIR (default a per-user directory with mode 0700) and named by
+ the SHA-256 of source and compile command, so the same graph is only compiled once. The digest of source and library
+ is stored beside it and checked before the library is loaded.
+ */
+class SourceCompiler {
+public:
+    typedef void (*Kernel)(float** inputs, float** outputs);
+    static SourceCompiler* get();
+    // Compile (or reuse the cached library) and load kernel_0 ... kernel_{kernelNumber-1},
+    // return the key of library, empty if failed
+    std::string load(const std::string& source, int kernelNumber);
+    Kernel getKernel(const std::string& key, int index);
+private:
+    SourceCompiler() = default;
+    std::mutex mLock;
+    // Libraries are never unloaded, the kernels may be used by any session
+    std::map<std::string, std::vector<Kernel>> mLibraries;
+};
+
+#endif /* SourceCompiler_hpp */
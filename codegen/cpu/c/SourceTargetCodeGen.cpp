@@ -7,8 +7,15 @@
 
 #include "cpu/CPUAst.hpp"
 #include <sstream>
+#include <iomanip>
 
 using namespace AST;
+// float literal, avoid promoting the expression to double which can't be vectorized well
+static std::string floatLiteral(float val) {
+    std::stringstream ss;
+    ss << std::setprecision(9) << std::showpoint << val << "f";
+    return ss.str();
+}
 std::string PrototypeAST::codegen(SourceTarget *target) {
     std::stringstream ss;
     ss << target->getIndent();
@@ -37,6 +44,7 @@ std::string ListExprAST::codegen(SourceTarget* target) {
 }
 
 std::string VarExprAST::codegen(SourceTarget* target) {
+    return "";
 }
 
 std::string ForExprAST::codegen(SourceTarget* target) {
@@ -53,9 +61,11 @@ std::string ForExprAST::codegen(SourceTarget* target) {
 }
 
 std::string IfExprAST::codegen(SourceTarget* target) {
+    return "";
 }
 
 std::string CallExprAST::codegen(SourceTarget* target) {
+    return "";
 }
 
 std::string AssignExprAST::codegen(SourceTarget* target) {
@@ -83,16 +93,16 @@ std::string BinaryExprAST::codegen(SourceTarget *target) {
             ss << "(" << l << " / " << r << ")";
             break;
         case MNN::BinaryOpOperation_FLOORDIV:
-            ss << "floor(" << l << " / " << r << ")";
+            ss << "floorf(" << l << " / " << r << ")";
             break;
         case MNN::BinaryOpOperation_POW:
-            ss << "pow(" << l << ", " << r << ")";
+            ss << "powf(" << l << ", " << r << ")";
             break;
         case MNN::BinaryOpOperation_MINIMUM:
-            ss << "fmin(" << l << ", " << r << ")";
+            ss << "fminf(" << l << ", " << r << ")";
             break;
         case MNN::BinaryOpOperation_MAXIMUM:
-            ss << "fmax(" << l << ", " << r << ")";
+            ss << "fmaxf(" << l << ", " << r << ")";
             break;
         case MNN::BinaryOpOperation_GREATER:
             ss << "(" << l << " > " << r << ")";
@@ -120,11 +130,11 @@ std::string ReluExprAST::codegen(SourceTarget *target) {
     auto x = Operand->codegen(target);
     if (maxVal == 0.f) {
         // slope = minVal
-        // relu(x) = ((x < 0) * slope * x + (x >= 0) * x)
-        ss << "((" << x << " < 0 ) * " << minVal << " * " << x << " + (" << x << " >= 0 ) * " << x << ")";
+        // relu(x) = x < 0 ? slope * x : x
+        ss << "(" << x << " < 0.0f ? " << floatLiteral(minVal) << " * " << x << " : " << x << ")";
     } else {
         // relu6(x) = min(max(x, minv), maxv)
-        ss << "fmin(fmax(" << x << ", " << minVal << "), " << maxVal << ")";
+        ss << "fminf(fmaxf(" << x << ", " << floatLiteral(minVal) << "), " << floatLiteral(maxVal) << ")";
     }
     return ss.str();
 }
@@ -134,31 +144,31 @@ std::string UnaryExprAST::codegen(SourceTarget *target) {
     auto x = Operand->codegen(target);
     switch (Op) {
         case MNN::UnaryOpOperation_ABS:
-            ss << "abs(" << x << ")";
+            ss << "fabsf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_FLOOR:
-            ss << "floor(" << x << ")";
+            ss << "floorf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_CEIL:
-            ss << "ceil(" << x << ")";
+            ss << "ceilf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_SQRT:
-            ss << "sqrt(" << x << ")";
+            ss << "sqrtf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_EXP:
-            ss << "exp(" << x << ")";
+            ss << "expf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_LOG:
-            ss << "log(" << x << ")";
+            ss << "logf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_SIN:
-            ss << "sin(" << x << ")";
+            ss << "sinf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_COS:
-            ss << "cos(" << x << ")";
+            ss << "cosf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_ROUND:
-            ss << "round(" << x << ")";
+            ss << "roundf(" << x << ")";
             break;
         case MNN::UnaryOpOperation_NEG:
             ss << "(-" << x << ")";
@@ -167,16 +177,16 @@ std::string UnaryExprAST::codegen(SourceTarget *target) {
             ss << "(" << x << " * " << x << ")";
             break;
         case MNN::UnaryOpOperation_RSQRT:
-            ss << "(1.f / sqrt(" << x << "))";
+            ss << "(1.f / sqrtf(" << x << "))";
             break;
         case MNN::UnaryOpOperation_RECIPROCAL:
             ss << "(1.f / " << x << ")";
             break;
         case MNN::UnaryOpOperation_SIGMOID:
-            ss << "(1.f / (1.f + exp(-" << x << ")))";
+            ss << "(1.f / (1.f + expf(-" << x << ")))";
             break;
         case MNN::UnaryOpOperation_TANH:
-            ss << "tanh(" << x << ")";
+            ss << "tanhf(" << x << ")";
             break;
         default:
             MNN_ASSERT(false);
@@ -200,8 +210,7 @@ std::string NumberExprAST::codegen(SourceTarget *target) {
     std::stringstream ss;
     switch (mType) {
         case FP32:
-            ss << mVal.f32Val;
-            break;
+            return floatLiteral(mVal.f32Val);
         case FP64:
             ss << mVal.f64Val;
             break;
@@ -212,7 +221,7 @@ std::string NumberExprAST::codegen(SourceTarget *target) {
             ss << mVal.i64Val;
             break;
         default:
-            return nullptr;
+            return "";
     }
     return ss.str();
 }
@@ -18,6 +18,7 @@
 #include <MNN/expr/ExecutorScope.hpp>
 #include "core/Backend.hpp"
 #include "RuntimeAttr.hpp"
+#include <list>
 #include <stack>
 #define DEFAULT_BACKUP_RUNTIME_KEY (std::make_pair(MNN_FORWARD_CPU, 1))
 #ifdef MNN_EXPR_ENABLE_PROFILER
@@ -73,8 +74,22 @@ void Executor::Profiler::addFlops(const std::string& opType, float flops) {
 }
 #endif
 
+// Compiled caches of released graphs, keyed by the signature of graph, reused by the graph with the same signature
+struct Executor::TraceCache {
+    ~TraceCache() {
+        clear();
+    }
+    void clear();
+    std::mutex mutex;
+    // Disabled by default, see Executor::setTraceCacheSize
+    int maxNumber = 0;
+    // Oldest first
+    std::list<std::pair<std::string, ComputeCache*>> parked;
+};
+
 void Executor::setGlobalExecutorConfig(MNNForwardType type, const BackendConfig& config, int numberThread) {
     std::lock_guard<std::mutex> _l(mMutex);
+    mTraceCache->clear();
     mFirstType = std::make_pair(type, numberThread);
     if(type == MNN_FORWARD_AUTO) {
         ScheduleConfig sConfig;
@@ -118,10 +133,27 @@ int Executor::getCurrentRuntimeStatus(RuntimeStatus statusEnum) {
 
 void Executor::gc(GCFlag flag) {
     int level = flag == FULL ? 100 : 0;
+    if (FULL == flag) {
+        mTraceCache->clear();
+    }
     for (auto& iter : mRuntimes) {
         iter.second->onGabageCollect(level);
     }
 }
+void Executor::setTraceCacheSize(int maxNumber) {
+    std::vector<ComputeCache*> evicted;
+    {
+        std::lock_guard<std::mutex> _l(mTraceCache->mutex);
+        mTraceCache->maxNumber = maxNumber;
+        while (mTraceCache->parked.size() > 0 && mTraceCache->parked.size() > maxNumber) {
+            evicted.emplace_back(mTraceCache->parked.front().second);
+            mTraceCache->parked.pop_front();
+        }
+    }
+    for (auto cache : evicted) {
+        delete cache;
+    }
+}
 Executor::Executor(std::shared_ptr<Runtime> backend, MNNForwardType type, int numberThread) {
     mRuntimes.insert(std::make_pair(std::make_pair(type, numberThread), backend));
     mFirstType = std::make_pair(type, numberThread);
@@ -136,6 +168,7 @@ Executor::Executor(std::shared_ptr<Runtime> backend, MNNForwardType type, int nu
         mRuntimes.insert(std::make_pair(DEFAULT_BACKUP_RUNTIME_KEY, backupRt));
     }
     mDebug.reset(new DebugTools);
+    mTraceCache.reset(new TraceCache);
 
 #ifdef MNN_EXPR_ENABLE_PROFILER
     mProfiler.reset(new Profiler);
@@ -260,10 +293,26 @@ void Executor::RuntimeManager::setMode(Interpreter::SessionMode mode) {
         mInside->modes.callBackMode = mode;
     } else if (mode == Interpreter::Session_Resize_Direct || mode == Interpreter::Session_Resize_Defer) {
         mInside->modes.resizeMode = mode;
+    } else if (mode == Interpreter::Session_Memory_Greedy || mode == Interpreter::Session_Memory_Plan) {
+        mInside->modes.memoryMode = mode;
+    } else if (mode == Interpreter::Session_Execute_Serial || mode == Interpreter::Session_Execute_Parallel) {
+        mInside->modes.executeMode = mode;
     }
 }
 void Executor::RuntimeManager::setHint(Interpreter::HintMode mode, int value) {
-    mInside->modes.maxTuningNumber = value;
+    switch (mode) {
+        case Interpreter::MAX_TUNING_NUMBER:
+            mInside->modes.maxTuningNumber = value;
+            break;
+        case Interpreter::KVCACHE_SIZE_LIMIT:
+            mInside->modes.kvcacheSizeLimit = value;
+            break;
+        case Interpreter::CPU_CONV_TUNING:
+            mInside->modes.cpuConvTuning = value;
+            break;
+        default:
+            break;
+    }
 }
 bool Executor::RuntimeManager::getInfo(Interpreter::SessionInfoCode code, void* ptr) {
     // Only support get memory
@@ -349,6 +398,10 @@ BackendConfig* Executor::RuntimeManager::getBnConfig() {
 }
 
 
+void Executor::RuntimeManager::setExternalFile(std::string fileName) {
+    mInside->modes.externalFile = fileName;
+}
+
 void Executor::RuntimeManager::setCache(std::string cacheName) {
     mInside->mCache.reset(new Cache);
     mInside->mCache->cacheFile = cacheName;
@@ -478,6 +531,19 @@ private:
     std::map<const Op*, std::shared_ptr<Execution>> mCacheExes;
     Runtime::CompilerType mCompilerType;
     std::map<Tensor*, std::shared_ptr<Tensor>> mCacheConstTensors;
+
+    // For reused cache, the tensors outside the graph are replaced by holders owned by cache,
+    // the content of source is copied into holder before run
+    struct TraceInput {
+        Tensor* source;
+        std::shared_ptr<Tensor> holder;
+        bool needContent;
+    };
+    std::vector<TraceInput> mTraceInputs;
+    // Signature of the graph compiled into the cache, empty if the cache can't be reused
+    std::string mTraceKey;
+    bool mTraceResized = false;
+    void _syncTraceInputs(bool resize);
 #ifdef MNN_EXPRESS_MEMLEAK_DEBUG
     static int gInstanceCount;
 #endif
@@ -550,6 +616,42 @@ Executor::ComputeCache::~ComputeCache() {
     FUNC_PRINT(gInstanceCount);
 #endif
 }
+void Executor::ComputeCache::_syncTraceInputs(bool resize) {
+    for (auto& input : mTraceInputs) {
+        auto src = input.source;
+        auto dst = input.holder.get();
+        if (nullptr == src) {
+            continue;
+        }
+        if (resize) {
+            bool sameShape = src->getType() == dst->getType() && src->dimensions() == dst->dimensions();
+            for (int i = 0; sameShape && i < src->dimensions(); ++i) {
+                sameShape = src->length(i) == dst->length(i);
+            }
+            if (!sameShape) {
+                Utils::releaseMemoryForHostTensor(dst);
+                TensorUtils::copyShape(src, dst, true);
+                dst->buffer().type = src->getType();
+                if (input.needContent) {
+                    Utils::allocMemoryForHostTensor(dst);
+                }
+            }
+        }
+        if (input.needContent && nullptr != src->host<void>() && nullptr != dst->host<void>()) {
+            ::memcpy(dst->host<void>(), src->host<void>(), dst->size());
+        }
+    }
+}
+void Executor::TraceCache::clear() {
+    std::list<std::pair<std::string, ComputeCache*>> released;
+    {
+        std::lock_guard<std::mutex> _l(mutex);
+        released.swap(parked);
+    }
+    for (auto& iter : released) {
+        delete iter.second;
+    }
+}
 ErrorCode Executor::ComputeCache::compute() {
     std::stack<ComputeCache*> dfsStack;
     std::set<ComputeCache*> visited;
@@ -589,6 +691,7 @@ ErrorCode Executor::ComputeCache::compute() {
         } else {
             visited.insert(cache);
             dfsStack.pop();
+            cache->_syncTraceInputs(false);
             cache->mBackend->onExecuteBegin();
             cache->mBackupBackend->onExecuteBegin();
             for (auto& buffer : cache->mCmdBuffer) {
@@ -622,6 +725,12 @@ ErrorCode Executor::ComputeCache::compute() {
 }
 ErrorCode Executor::ComputeCache::resizeImpl() {
     mShapeDirty = false;
+    if (mTraceResized) {
+        // Shape or content for shape changed, the signature is no longer valid
+        mTraceKey.clear();
+    }
+    mTraceResized = true;
+    _syncTraceInputs(true);
     mCmdBuffer.resize(mUnits.size());
     /** Encoder Begin */
     {
@@ -983,6 +1092,103 @@ static void _collectExecuteUnit(std::vector<std::shared_ptr<Executor::Unit>>& de
     }
 }
 
+// Signature of the graph: ops, output infos and links of units, shape of the tensors outside the graph,
+// and the content of them if it's constant or used to compute shape
+static bool _makeTraceKey(const std::vector<std::shared_ptr<Executor::Unit>>& units, const std::vector<Executor::Unit*>& packedUnits, std::string& key, std::vector<Tensor*>& externals, std::vector<bool>& externalNeedContent) {
+    static const size_t gMaxTraceBytes = 1 << 20;
+    auto appendInt = [&key](int v) {
+        key.append((const char*)&v, sizeof(int));
+    };
+    auto appendShape = [&](halide_type_t type, const INTS& dims) {
+        appendInt(type.code);
+        appendInt(type.bits);
+        appendInt(type.lanes);
+        appendInt((int)dims.size());
+        for (auto d : dims) {
+            appendInt(d);
+        }
+    };
+    std::map<const Executor::Unit*, int> unitIndexes;
+    std::map<const Tensor*, std::pair<int, int>> producers;
+    for (int k = 0; k < units.size(); ++k) {
+        unitIndexes.insert(std::make_pair(units[k].get(), k));
+        for (int j = 0; j < units[k]->outputs.size(); ++j) {
+            producers.insert(std::make_pair(units[k]->outputs[j], std::make_pair(k, j)));
+        }
+    }
+    for (auto unit : packedUnits) {
+        auto iter = unitIndexes.find(unit);
+        if (iter == unitIndexes.end()) {
+            return false;
+        }
+        appendInt(iter->second);
+    }
+    std::map<const Tensor*, int> externalIndexes;
+    size_t copyBytes = 0;
+    for (auto& unit : units) {
+        auto inside = unit->inside.lock();
+        if (nullptr == inside || inside->mInfoDirty || nullptr == unit->opStorage) {
+            return false;
+        }
+        appendInt((int)unit->opStorage->size());
+        key.append((const char*)unit->opStorage->buffer(), unit->opStorage->size());
+        appendInt((int)inside->mOutputInfos.size());
+        for (auto& info : inside->mOutputInfos) {
+            appendInt(info.order);
+            appendShape(info.type, info.dim);
+        }
+        auto& req = inside->mReq;
+        appendInt((int)unit->inputs.size());
+        for (int i = 0; i < unit->inputs.size(); ++i) {
+            auto t = unit->inputs[i];
+            bool needContent = req.contentNeedContent[i];
+            bool shapeNeedContent = req.shapeNeedContent[i];
+            appendInt(needContent);
+            appendInt(shapeNeedContent);
+            auto producer = producers.find(t);
+            if (producer != producers.end()) {
+                appendInt(0);
+                appendInt(producer->second.first);
+                appendInt(producer->second.second);
+                continue;
+            }
+            auto des = TensorUtils::getDescribe(t);
+            if (des->dimensionFormat == MNN_DATA_FORMAT_NC4HW4 || nullptr != des->quantAttr || nullptr != des->tensorArrayAttr || 0 != t->deviceId()) {
+                return false;
+            }
+            int index = 0;
+            auto iter = externalIndexes.find(t);
+            if (iter == externalIndexes.end()) {
+                index = (int)externals.size();
+                externalIndexes.insert(std::make_pair(t, index));
+                externals.emplace_back(t);
+                externalNeedContent.emplace_back(false);
+            } else {
+                index = iter->second;
+            }
+            appendInt(1);
+            appendInt(index);
+            appendInt(des->usage);
+            appendInt(des->dimensionFormat);
+            appendShape(t->getType(), t->shape());
+            if (needContent && !externalNeedContent[index]) {
+                externalNeedContent[index] = true;
+                copyBytes += t->size();
+            }
+            if (des->usage == Tensor::InsideDescribe::CONSTANT || shapeNeedContent) {
+                if (nullptr == t->host<void>()) {
+                    return false;
+                }
+                key.append(t->host<char>(), t->size());
+            }
+        }
+        if (key.size() > gMaxTraceBytes || copyBytes > gMaxTraceBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void Executor::_create(const std::vector<EXPRP>& outputs, std::set<std::shared_ptr<Executor::ComputeCache>>&& inputCaches, std::set<std::shared_ptr<Expr::Inside>>&& inputNode, bool forceCPU) {
     std::vector<EXPRP> packed;
     for (auto expr : outputs) {
@@ -999,6 +1205,102 @@ void Executor::_create(const std::vector<EXPRP>& outputs, std::set<std::shared_p
         return;
     }
     //MNN_PRINT("Create %p begin\n", packed[0].get());
+    std::vector<Unit*> packedUnits;
+    for (auto expr : packed) {
+        MNN_ASSERT(expr->inside()->mUnit != nullptr);
+        packedUnits.emplace_back(expr->inside()->mUnit.get());
+    }
+    std::vector<std::shared_ptr<Unit>> units;
+    for (auto expr : packed) {
+        _collectExecuteUnit(units, expr);
+    }
+    std::string traceKey;
+    std::vector<Tensor*> traceSources;
+    std::vector<bool> traceNeedContent;
+    {
+        bool traceable = forceCPU || MNN_FORWARD_CPU == mFirstType.first;
+        {
+            std::lock_guard<std::mutex> _l(mTraceCache->mutex);
+            traceable = traceable && mTraceCache->maxNumber > 0;
+        }
+        for (auto& c : inputCaches) {
+            if (c->mShapeDirty || MNN_FORWARD_CPU != c->mBackend->type()) {
+                traceable = false;
+                break;
+            }
+        }
+        if (traceable) {
+            traceKey.append((const char*)&forceCPU, sizeof(bool));
+            traceKey.append((const char*)&mFirstType.second, sizeof(int));
+            if (!_makeTraceKey(units, packedUnits, traceKey, traceSources, traceNeedContent)) {
+                traceKey.clear();
+            }
+        }
+    }
+    auto traceCache = std::weak_ptr<TraceCache>(mTraceCache);
+    auto parkCache = [traceCache](ComputeCache* cache) {
+        auto pool = traceCache.lock();
+        if (nullptr == pool || cache->mTraceKey.empty()) {
+            delete cache;
+            return;
+        }
+        // Detach the cache from graph, the inputs may be parked recursively
+        cache->mInputs.clear();
+        cache->mInputInside.clear();
+        for (auto& unit : cache->mUnits) {
+            unit->inside.reset();
+        }
+        for (auto& input : cache->mTraceInputs) {
+            input.source = nullptr;
+        }
+        std::vector<ComputeCache*> evicted;
+        {
+            std::lock_guard<std::mutex> _l(pool->mutex);
+            pool->parked.emplace_back(std::make_pair(cache->mTraceKey, cache));
+            while (pool->parked.size() > pool->maxNumber) {
+                evicted.emplace_back(pool->parked.front().second);
+                pool->parked.pop_front();
+            }
+        }
+        for (auto c : evicted) {
+            delete c;
+        }
+    };
+    if (!traceKey.empty()) {
+        ComputeCache* reuse = nullptr;
+        {
+            std::lock_guard<std::mutex> _l(mTraceCache->mutex);
+            auto& parked = mTraceCache->parked;
+            for (auto iter = parked.rbegin(); iter != parked.rend(); ++iter) {
+                if (iter->first == traceKey) {
+                    reuse = iter->second;
+                    parked.erase(std::next(iter).base());
+                    break;
+                }
+            }
+        }
+        if (nullptr != reuse) {
+            // Same signature, bind the compiled cache to current graph
+            MNN_ASSERT(reuse->mUnits.size() == units.size() && reuse->mTraceInputs.size() == traceSources.size());
+            for (int i = 0; i < units.size(); ++i) {
+                reuse->mUnits[i]->inside = units[i]->inside;
+            }
+            for (int i = 0; i < traceSources.size(); ++i) {
+                reuse->mTraceInputs[i].source = traceSources[i];
+            }
+            reuse->mInputs = std::move(inputCaches);
+            reuse->mInputInside = std::move(inputNode);
+            reuse->mContentDirty = true;
+            std::shared_ptr<ComputeCache> packedCache(reuse, parkCache);
+            int offset = 0;
+            for (int i = 0; i < packed.size(); ++i) {
+                packed[i]->inside()->mCacheOffset = offset;
+                packed[i]->inside()->mCache = packedCache;
+                offset += (int)packedUnits[i]->outputs.size();
+            }
+            return;
+        }
+    }
     std::shared_ptr<Backend> cacheBn;
     std::shared_ptr<Backend> cacheBackupBn;
     BackendConfig defaultConfig;
@@ -1012,21 +1314,49 @@ void Executor::_create(const std::vector<EXPRP>& outputs, std::set<std::shared_p
         cacheBn.reset(mainRuntime->onCreate());
         cacheBackupBn.reset(backupRuntime->onCreate(&defaultConfig));
     }
-    std::shared_ptr<ComputeCache> packedCache(new ComputeCache(cacheBn, cacheBackupBn));
+    std::shared_ptr<ComputeCache> packedCache(new ComputeCache(cacheBn, cacheBackupBn), parkCache);
     packedCache->mCompilerType = mainRuntime->onGetCompilerType();
     packedCache->mInputs = std::move(inputCaches);
     packedCache->mInputInside = std::move(inputNode);
-    for (auto expr : packed) {
-        expr->inside()->mCacheOffset = (int)packedCache->mOutputs.size();
-        MNN_ASSERT(expr->inside()->mUnit != nullptr);
-        auto& originOutputs = expr->inside()->mUnit->outputs;
-        for (auto t : originOutputs) {
+    for (int i = 0; i < packed.size(); ++i) {
+        packed[i]->inside()->mCacheOffset = (int)packedCache->mOutputs.size();
+        for (auto t : packedUnits[i]->outputs) {
             packedCache->mOutputs.emplace_back(t);
             TensorUtils::getDescribe(t)->usage = Tensor::InsideDescribe::OUTPUT;
         }
     }
-    for (auto expr : packed) {
-        _collectExecuteUnit(packedCache->mUnits, expr);
+    packedCache->mUnits = std::move(units);
+    if (!traceKey.empty()) {
+        // Replace the tensors outside by holders, so that the cache can be bound to another graph
+        std::map<Tensor*, Tensor*> holders;
+        for (int i = 0; i < traceSources.size(); ++i) {
+            auto src = traceSources[i];
+            std::shared_ptr<Tensor> holder(new Tensor);
+            TensorUtils::copyShape(src, holder.get(), true);
+            holder->buffer().type = src->getType();
+            auto srcDes = TensorUtils::getDescribe(src);
+            auto des = TensorUtils::getDescribe(holder.get());
+            des->memoryType = Tensor::InsideDescribe::MEMORY_HOST;
+            des->usage = srcDes->usage;
+            if (des->usage != Tensor::InsideDescribe::CONSTANT && des->usage != Tensor::InsideDescribe::TRAINABLE) {
+                des->usage = Tensor::InsideDescribe::INPUT;
+            }
+            des->isMutable = srcDes->isMutable;
+            if (traceNeedContent[i]) {
+                Utils::allocMemoryForHostTensor(holder.get());
+            }
+            holders.insert(std::make_pair(src, holder.get()));
+            packedCache->mTraceInputs.emplace_back(ComputeCache::TraceInput{src, holder, traceNeedContent[i]});
+        }
+        for (auto& unit : packedCache->mUnits) {
+            for (auto& t : unit->inputs) {
+                auto iter = holders.find(t);
+                if (iter != holders.end()) {
+                    t = iter->second;
+                }
+            }
+        }
+        packedCache->mTraceKey = std::move(traceKey);
     }
     for (auto expr : packed) {
         expr->inside()->mCache = packedCache;
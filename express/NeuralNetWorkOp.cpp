@@ -1948,5 +1948,19 @@ VARP _Col2Im(VARP x, VARP outputShape, INTS kernelSize, INTS dilate, INTS pads,
     return (Variable::create(Expr::create(op.get(), {x, outputShape})));
 }
 
+VARP _Attention(VARP query, VARP key, VARP value, VARP mask, float scale, bool kvCache) {
+    std::unique_ptr<MNN::OpT> op(new MNN::OpT);
+    op->type       = MNN::OpType_Attention;
+    op->main.type  = OpParameter_AttentionParam;
+    auto param     = new MNN::AttentionParamT;
+    param->scale   = scale;
+    param->kvCache = kvCache;
+    op->main.value = param;
+    if (nullptr == mask) {
+        return (Variable::create(Expr::create(op.get(), {query, key, value})));
+    }
+    return (Variable::create(Expr::create(op.get(), {query, key, value, mask})));
+}
+
 } // namespace Express
 } // namespace MNN
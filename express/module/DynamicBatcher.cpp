@@ -0,0 +1,263 @@
+//
+//  DynamicBatcher.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/DynamicBatcher.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string.h>
+#include <thread>
+
+namespace MNN {
+namespace Express {
+
+struct Request {
+    // Copy of the inputs' content, so that the request doesn't depend on the caller's executor
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<Variable::Info> infos;
+    int batch = 0;
+    DynamicBatcher::CallBack callback;
+    std::chrono::steady_clock::time_point time;
+};
+typedef std::shared_ptr<Request> RequestPtr;
+
+struct DynamicBatcher::Inside {
+    Config config;
+    std::shared_ptr<Module> origin;
+    std::mutex lock;
+    std::condition_variable condition;
+    std::list<RequestPtr> queue;
+    bool stop = false;
+    std::vector<std::thread> workers;
+};
+
+// Requests can be merged if all inputs are the same except the batch
+static bool _compatible(const Request* a, const Request* b) {
+    if (a->infos.size() != b->infos.size()) {
+        return false;
+    }
+    for (int i = 0; i < a->infos.size(); ++i) {
+        auto& ia = a->infos[i];
+        auto& ib = b->infos[i];
+        if (ia.order != ib.order || ia.type != ib.type || ia.dim.size() != ib.dim.size()) {
+            return false;
+        }
+        for (int j = 1; j < ia.dim.size(); ++j) {
+            if (ia.dim[j] != ib.dim[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static std::vector<RequestPtr> _collect(DynamicBatcher::Inside* inside) {
+    std::vector<RequestPtr> requests;
+    std::unique_lock<std::mutex> _l(inside->lock);
+    inside->condition.wait(_l, [inside]() { return inside->stop || !inside->queue.empty(); });
+    if (inside->queue.empty()) {
+        return requests;
+    }
+    auto first = inside->queue.front();
+    inside->queue.pop_front();
+    requests.emplace_back(first);
+    const int maxBatch = inside->config.maxBatch;
+    auto deadline = first->time + std::chrono::microseconds(inside->config.maxDelayUs);
+    int batch = first->batch;
+    while (batch < maxBatch) {
+        for (auto iter = inside->queue.begin(); iter != inside->queue.end() && batch < maxBatch;) {
+            auto& r = *iter;
+            if (batch + r->batch <= maxBatch && _compatible(first.get(), r.get())) {
+                batch += r->batch;
+                requests.emplace_back(r);
+                iter = inside->queue.erase(iter);
+                continue;
+            }
+            iter++;
+        }
+        // Don't wait when stopping, the remaining requests should finish as soon as possible
+        if (batch >= maxBatch || inside->stop || std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        inside->condition.wait_until(_l, deadline);
+    }
+    return requests;
+}
+
+static std::vector<std::vector<VARP>> _run(Module* module, const std::vector<RequestPtr>& requests) {
+    std::vector<std::vector<VARP>> results(requests.size());
+    auto& first = requests[0]->infos;
+    int batch   = 0;
+    for (auto& r : requests) {
+        batch += r->batch;
+    }
+    std::vector<VARP> inputs(first.size());
+    for (int i = 0; i < first.size(); ++i) {
+        auto dims = first[i].dim;
+        dims[0]   = batch;
+        inputs[i] = _Input(dims, first[i].order, first[i].type);
+        auto ptr  = inputs[i]->writeMap<uint8_t>();
+        if (nullptr == ptr) {
+            MNN_ERROR("DynamicBatcher: Can't alloc input %d for batch %d\n", i, batch);
+            return results;
+        }
+        for (auto& r : requests) {
+            ::memcpy(ptr, r->buffers[i].data(), r->buffers[i].size());
+            ptr += r->buffers[i].size();
+        }
+    }
+    auto outputs = module->onForward(inputs);
+    if (outputs.empty()) {
+        MNN_ERROR("DynamicBatcher: Forward failed for batch %d\n", batch);
+        return results;
+    }
+    for (auto& r : results) {
+        r.resize(outputs.size());
+    }
+    for (int i = 0; i < outputs.size(); ++i) {
+        auto output = outputs[i];
+        auto info   = output->getInfo();
+        if (nullptr != info && info->order == NC4HW4) {
+            output = _Convert(output, NCHW);
+            info   = output->getInfo();
+        }
+        if (nullptr == info || info->dim.empty() || info->dim[0] != batch) {
+            MNN_ERROR("DynamicBatcher: The first dim of output %d isn't batch %d\n", i, batch);
+            return std::vector<std::vector<VARP>>(requests.size());
+        }
+        auto ptr = output->readMap<uint8_t>();
+        if (nullptr == ptr) {
+            MNN_ERROR("DynamicBatcher: Compute output %d failed\n", i);
+            return std::vector<std::vector<VARP>>(requests.size());
+        }
+        const size_t batchBytes = (size_t)info->size / batch * info->type.bytes();
+        auto dims = info->dim;
+        for (int j = 0; j < requests.size(); ++j) {
+            dims[0] = requests[j]->batch;
+            // _Const copy the content, so the result is kept after next forward
+            results[j][i] = _Const(ptr, dims, info->order, info->type);
+            ptr += batchBytes * requests[j]->batch;
+        }
+    }
+    return results;
+}
+
+static void _workerLoop(DynamicBatcher::Inside* inside) {
+    auto& config = inside->config;
+    // Express executor isn't thread safe, each worker runs its own clone under its own executor
+    auto executor = Executor::newExecutor(config.type, config.backendConfig, config.numThread);
+    ExecutorScope scope(executor);
+    std::shared_ptr<Module> module(Module::clone(inside->origin.get()));
+    while (true) {
+        auto requests = _collect(inside);
+        if (requests.empty()) {
+            break;
+        }
+        std::vector<std::vector<VARP>> results(requests.size());
+        if (nullptr != module) {
+            results = _run(module.get(), requests);
+        }
+        for (int i = 0; i < requests.size(); ++i) {
+            requests[i]->callback(std::move(results[i]));
+        }
+    }
+}
+
+DynamicBatcher* DynamicBatcher::create(std::shared_ptr<Module> module, const Config& config) {
+    if (nullptr == module || config.maxBatch <= 0 || config.workerNumber <= 0) {
+        MNN_ERROR("DynamicBatcher: Invalid module or config\n");
+        return nullptr;
+    }
+    std::shared_ptr<Inside> inside(new Inside);
+    inside->config = config;
+    inside->origin = module;
+    for (int i = 0; i < config.workerNumber; ++i) {
+        inside->workers.emplace_back(std::thread(_workerLoop, inside.get()));
+    }
+    return new DynamicBatcher(inside);
+}
+
+void DynamicBatcher::destroy(DynamicBatcher* batcher) {
+    delete batcher;
+}
+
+DynamicBatcher::DynamicBatcher(std::shared_ptr<Inside> inside) {
+    mInside = inside;
+}
+
+DynamicBatcher::~DynamicBatcher() {
+    {
+        std::unique_lock<std::mutex> _l(mInside->lock);
+        mInside->stop = true;
+    }
+    mInside->condition.notify_all();
+    for (auto& t : mInside->workers) {
+        t.join();
+    }
+}
+
+void DynamicBatcher::forward(const std::vector<VARP>& inputs, CallBack callback) {
+    if (inputs.empty()) {
+        MNN_ERROR("DynamicBatcher: Request without input\n");
+        callback({});
+        return;
+    }
+    std::shared_ptr<Request> request(new Request);
+    request->callback = std::move(callback);
+    request->buffers.resize(inputs.size());
+    request->infos.resize(inputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+        auto input = inputs[i];
+        auto info  = nullptr != input ? input->getInfo() : nullptr;
+        if (nullptr != info && info->order == NC4HW4) {
+            input = _Convert(input, NCHW);
+            info  = input->getInfo();
+        }
+        const void* ptr = nullptr;
+        if (nullptr != info && !info->dim.empty() && info->dim[0] > 0) {
+            ptr = input->readMap<void>();
+        }
+        if (nullptr == ptr) {
+            MNN_ERROR("DynamicBatcher: Input %d is invalid, it should be computable and has batch dim\n", i);
+            request->callback({});
+            return;
+        }
+        if (0 == i) {
+            request->batch = info->dim[0];
+        } else if (request->batch != info->dim[0]) {
+            MNN_ERROR("DynamicBatcher: Input %d has batch %d but input 0 has %d\n", i, info->dim[0], request->batch);
+            request->callback({});
+            return;
+        }
+        auto bytes = (size_t)info->size * info->type.bytes();
+        request->buffers[i].resize(bytes);
+        ::memcpy(request->buffers[i].data(), ptr, bytes);
+        request->infos[i] = *info;
+        request->infos[i].syncSize();
+    }
+    request->time = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> _l(mInside->lock);
+        mInside->queue.emplace_back(request);
+    }
+    // Wake both idle workers and the ones waiting for more requests
+    mInside->condition.notify_all();
+}
+
+std::future<std::vector<VARP>> DynamicBatcher::forward(const std::vector<VARP>& inputs) {
+    std::shared_ptr<std::promise<std::vector<VARP>>> promise(new std::promise<std::vector<VARP>>);
+    auto future = promise->get_future();
+    forward(inputs, [promise](std::vector<VARP> outputs) { promise->set_value(std::move(outputs)); });
+    return future;
+}
+
+} // namespace Express
+} // namespace MNN
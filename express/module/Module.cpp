@@ -144,6 +144,51 @@ Module* Module::load(const std::vector<std::string>& inputs, const std::vector<s
     return load(inputs, outputs, buffer, length, nullptr, config);
 }
 
+static bool _hasExternalWeight(const Net* net) {
+    if (nullptr == net->oplists()) {
+        return false;
+    }
+    for (int i = 0; i < net->oplists()->size(); ++i) {
+        auto op = net->oplists()->GetAs<Op>(i);
+        if (op->main_type() == OpParameter_Convolution2D && nullptr != op->main_as_Convolution2D()->external()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static Module* _loadFromFile(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const char* fileName, std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config) {
+    if (!_hasExternalWeight(GetNet(buffer))) {
+        return Module::load(inputs, outputs, buffer, length, rtMgr, config);
+    }
+    if (nullptr != rtMgr && !rtMgr->getInside()->modes.externalFile.empty()) {
+        return Module::load(inputs, outputs, buffer, length, rtMgr, config);
+    }
+    // Default external weight file is placed beside the model by MNNConvert
+    bool userRtMgr = nullptr != rtMgr;
+    if (!userRtMgr) {
+        ScheduleConfig sche_config;
+        if (nullptr != config && nullptr != config->backend) {
+            sche_config.type = config->backend->type;
+            sche_config.backendConfig = config->backend->config;
+        } else {
+            // Same runtime as the default executor's
+            sche_config.numThread = 1;
+        }
+        rtMgr.reset(Executor::RuntimeManager::createRuntimeManager(sche_config));
+        if (nullptr == rtMgr) {
+            return nullptr;
+        }
+    }
+    rtMgr->setExternalFile(std::string(fileName) + ".weight");
+    auto module = Module::load(inputs, outputs, buffer, length, rtMgr, config);
+    if (userRtMgr) {
+        // Modules copy the file name when created, don't pass it to the next model loaded by the user's manager
+        rtMgr->setExternalFile("");
+    }
+    return module;
+}
+
 Module* Module::load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const char* fileName, const std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config) {
     AutoStorage<uint8_t> buffer;
     {
@@ -152,6 +197,10 @@ Module* Module::load(const std::vector<std::string>& inputs, const std::vector<s
             MNN_ERROR("Error for open %s\n", fileName);
             return nullptr;
         }
+        if (nullptr != config && config->useMmap && loader.map()) {
+            // The submodules copy what they need, so the mapping only has to live during load
+            return _loadFromFile(inputs, outputs, loader.mappedData(), loader.size(), fileName, rtMgr, config);
+        }
         loader.read();
         if (!loader.valid()) {
             return nullptr;
@@ -161,7 +210,7 @@ Module* Module::load(const std::vector<std::string>& inputs, const std::vector<s
             return nullptr;
         }
     }
-    return load(inputs, outputs, buffer.get(), buffer.size(), rtMgr, config);
+    return _loadFromFile(inputs, outputs, buffer.get(), buffer.size(), fileName, rtMgr, config);
 }
 class NetModule : public Module {
 public:
@@ -249,6 +298,10 @@ public:
     const Module::Info* info() const {
         return mInfo.get();
     }
+protected:
+    virtual void onClearCache() override {
+        mModule->clearCache();
+    }
 private:
     std::shared_ptr<Module> mModule;
     std::shared_ptr<Module::Info> mInfo;
@@ -233,7 +233,10 @@ std::vector<VARP> PipelineModule::onForward(const std::vector<VARP>& inputs) {
     return outputs;
 }
 void PipelineModule::onClearCache() {
-    // Do nothing
+    // Submodules of loaded net are not registered as children
+    for (auto& iter : mSubModules) {
+        std::get<0>(iter)->clearCache();
+    }
 }
 
 void PipelineModule::_createSubGraph(const MNN::Net* net, std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config* config, std::map<std::string, SubGraph>& subGraphMap) {
@@ -13,6 +13,7 @@
 #include <MNN/expr/ExprCreator.hpp>
 #include "Utils.hpp"
 #include "core/MNNMemoryUtils.h"
+#include "core/FileLoader.hpp"
 #include "RuntimeAttr.hpp"
 #include "core/TensorUtils.hpp"
 
@@ -101,6 +102,7 @@ static std::shared_ptr<BufferStorage> preRearrangeWeights( // NOLINT
                 if (OpParameter_Convolution2D == op_table->main.type) {
                     op_table->main.AsConvolution2D()->bias.clear();
                     op_table->main.AsConvolution2D()->weight.clear();
+                    op_table->main.AsConvolution2D()->external.clear();
                     if (nullptr != op_table->main.AsConvolution2D()->symmetricQuan) {
                         op_table->main.AsConvolution2D()->symmetricQuan->bias.clear();
                         op_table->main.AsConvolution2D()->symmetricQuan->weight.clear();
@@ -192,6 +194,15 @@ StaticModule::StaticModule(const void* buffer, size_t length, const std::vector<
             defaultConfig.flags = 4;
             mBackupResourceBackend.reset(rt.second->onCreate(&defaultConfig));
         }
+        if (!mResource->mModes.externalFile.empty()) {
+            std::shared_ptr<FileLoader> externalFile(new FileLoader(mResource->mModes.externalFile.c_str()));
+            if (externalFile->valid()) {
+                mResourceBackend->setExternalFile(externalFile);
+                mBackupResourceBackend->setExternalFile(externalFile);
+            } else {
+                MNN_ERROR("Can't open external weight file %s\n", mResource->mModes.externalFile.c_str());
+            }
+        }
         net_storage = preRearrangeWeights(GetNet(buffer), exeCache, mResourceBackend.get(), mBackupResourceBackend.get());
         buffer      = net_storage->buffer();
         length      = net_storage->size();
@@ -250,6 +261,11 @@ StaticModule::StaticModule(const void* buffer, size_t length, const std::vector<
     if (!res) {
         return;
     }
+    mResource->mShapeCacheSize = moduleconfig.shapeCacheSize;
+    if (mResource->mShapeCacheSize > 1) {
+        // Sessions in cache keep their own inputs, so switching back to them only needs to copy the inputs
+        mResource->mModes.inputMode = Interpreter::Session_Input_Inside;
+    }
     mResource->mUseContentInputs = scheduleInfo.needInputContentForShape;
     if (mResource->mUseContentInputs) {
         mResource->mModes.inputMode = Interpreter::Session_Input_User;
@@ -259,20 +275,101 @@ StaticModule::StaticModule(const void* buffer, size_t length, const std::vector<
     if (scheduleInfo.validForResize && mResource->mModes.inputMode == Interpreter::Session_Input_Inside) {
         mSession->resize(false);
     }
-    mInputTensors.resize(inputs.size());
-    for (int i = 0; i < inputs.size(); ++i) {
-        mInputTensors[i] = mSession->getInput(inputs[i].c_str());
+    _setSession(mSession);
+}
+
+std::shared_ptr<Session> StaticModule::_createSession(RuntimeInfo&& rt) const {
+    Schedule::ScheduleInfo scheduleInfo;
+    if (nullptr != mResource->mSharedConst) {
+        scheduleInfo.defaultBackend = mResource->mSharedConst->defaultBackend;
+        scheduleInfo.allTensors = mResource->mSharedConst->allTensors;
+    }
+    auto res = Schedule::schedule(scheduleInfo, GetNet(mResource->mNetStorage->buffer()), {mResource->mConfig}, rt);
+    if (!res) {
+        return nullptr;
+    }
+    std::shared_ptr<Session> session(new Session(std::move(scheduleInfo), mResource->mModes, std::move(rt)));
+    session->cloneExecution(mSession->getExecution());
+    if (scheduleInfo.validForResize && mResource->mModes.inputMode == Interpreter::Session_Input_Inside) {
+        session->resize(false);
+    }
+    return session;
+}
+
+void StaticModule::_setSession(std::shared_ptr<Session> session) {
+    mSession = session;
+    mInputTensors.resize(mResource->mInputs.size());
+    for (int i = 0; i < mResource->mInputs.size(); ++i) {
+        mInputTensors[i] = mSession->getInput(mResource->mInputs[i].c_str());
     }
     mOutputTensors.resize(mResource->mOutputFromTensor.size());
     for (int i = 0; i < mResource->mOutputFromTensor.size(); ++i) {
-        mOutputTensors[i] = mSession->getOutput(outputs[mResource->mOutputFromTensor[i]].c_str());
+        mOutputTensors[i] = mSession->getOutput(mResource->mOutputs[mResource->mOutputFromTensor[i]].c_str());
     }
 }
+
+// Use the session resized for the shape of inputs, return true if a new session is created
+bool StaticModule::_switchSession(const std::vector<Express::VARP>& inputs) {
+    std::vector<int> shape;
+    for (auto& input : inputs) {
+        auto info = input->getInfo();
+        if (nullptr == info) {
+            shape.emplace_back(-1);
+            continue;
+        }
+        shape.emplace_back(info->order);
+        shape.emplace_back(info->type.code);
+        shape.emplace_back(info->type.bits);
+        shape.emplace_back((int)info->dim.size());
+        shape.insert(shape.end(), info->dim.begin(), info->dim.end());
+    }
+    if (shape == mCurrentShape) {
+        return false;
+    }
+    if (mCurrentShape.empty()) {
+        mCurrentShape = std::move(shape);
+        return false;
+    }
+    std::shared_ptr<Session> session;
+    bool created = false;
+    for (auto iter = mShapeCache.begin(); iter != mShapeCache.end(); ++iter) {
+        if (iter->shape == shape) {
+            session = iter->session;
+            mShapeCache.erase(iter);
+            break;
+        }
+    }
+    if (nullptr == session) {
+        RuntimeInfo rt = mSession->runtime();
+        session = _createSession(std::move(rt));
+        if (nullptr == session) {
+            // Resize current session instead
+            mCurrentShape = std::move(shape);
+            return false;
+        }
+        created = true;
+    }
+    mShapeCache.push_front({mCurrentShape, mSession});
+    while ((int)mShapeCache.size() >= mResource->mShapeCacheSize) {
+        mShapeCache.pop_back();
+    }
+    mCurrentShape = std::move(shape);
+    _setSession(session);
+    return created;
+}
 StaticModule::~StaticModule() {
     mSession         = nullptr;
     mResourceBackend = nullptr;
     mBackupResourceBackend = nullptr;
 }
+void StaticModule::onClearCache() {
+    if (nullptr != mSession) {
+        mSession->clearExecutionCache();
+    }
+    for (auto& cache : mShapeCache) {
+        cache.session->clearExecutionCache();
+    }
+}
 std::vector<Express::VARP> StaticModule::onForward(const std::vector<Express::VARP>& inputs) {
     AUTOTIME;
     std::vector<Express::VARP> outputs(mResource->mOutputNumbers);
@@ -283,6 +380,10 @@ std::vector<Express::VARP> StaticModule::onForward(const std::vector<Express::VA
         return outputs;
     }
     Variable::compute(inputs);
+    bool newSession = false;
+    if (mResource->mShapeCacheSize > 1 && !mResource->mUseContentInputs) {
+        newSession = _switchSession(inputs);
+    }
 #ifdef MNN_DUMP_MEMORY
     auto rt = Executor::getRuntime();
     auto mem = rt.second->onGetMemoryInMB();
@@ -353,6 +454,10 @@ std::vector<Express::VARP> StaticModule::onForward(const std::vector<Express::VA
             mInputTensors[i]->copyFromHostTensor(inputTensor);
         }
     }
+    if (newSession) {
+        // Share state such as kv cache with the previous session
+        mSession->shareExecutionCache(mShapeCache.front().session.get());
+    }
     ErrorCode code;
     if (mResource->mModes.callBackMode == Interpreter::Session_Debug) {
         auto globalExecutor = ExecutorScope::Current();
@@ -388,30 +493,13 @@ Module* StaticModule::clone(CloneContext* ctx) const {
         return this->cloneBaseTo(ctx, module);
     }
     auto rt             = Express::ExecutorScope::Current()->getRuntime();
-    Schedule::ScheduleInfo scheduleInfo;
-    if (nullptr != mResource->mSharedConst) {
-        scheduleInfo.defaultBackend = mResource->mSharedConst->defaultBackend;
-        scheduleInfo.allTensors = mResource->mSharedConst->allTensors;
-    }
-    auto res = Schedule::schedule(scheduleInfo, GetNet(mResource->mNetStorage->buffer()), {mResource->mConfig}, rt);
-    if (!res) {
+    auto session        = _createSession(std::move(rt));
+    if (nullptr == session) {
         return nullptr;
     }
-    module->mSession.reset(new Session(std::move(scheduleInfo), mResource->mModes, std::move(rt)));
-    module->mSession->cloneExecution(mSession->getExecution());
-    if (scheduleInfo.validForResize && mResource->mModes.inputMode == Interpreter::Session_Input_Inside) {
-        module->mSession->resize(false);
-    }
     module->mResourceBackend = mResourceBackend;
     module->mBackupResourceBackend = mBackupResourceBackend;
-    module->mInputTensors.resize(mResource->mInputs.size());
-    module->mOutputTensors.resize(mResource->mOutputFromTensor.size());
-    for (int i = 0; i < mResource->mInputs.size(); ++i) {
-        module->mInputTensors[i] = module->mSession->getInput(mResource->mInputs[i].c_str());
-    }
-    for (int i = 0; i < mResource->mOutputFromTensor.size(); ++i) {
-        module->mOutputTensors[i] = module->mSession->getOutput(mResource->mOutputs[mResource->mOutputFromTensor[i]].c_str());
-    }
+    module->_setSession(session);
     return this->cloneBaseTo(ctx, module);
 }
 
@@ -9,6 +9,7 @@
 #ifndef StaticModule_hpp
 #define StaticModule_hpp
 
+#include <list>
 #include <MNN/expr/Module.hpp>
 #include "core/Schedule.hpp"
 #include "core/Session.hpp"
@@ -23,10 +24,15 @@ public:
     StaticModule(const void* buffer, size_t length, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::shared_ptr<MNN::Express::Executor::RuntimeManager> rtMgr, const Module::Config& config, bool copyOutput, std::shared_ptr<Schedule::ScheduleInfo> sharedConst);
     virtual ~ StaticModule();
     virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override;
+protected:
+    virtual void onClearCache() override;
 private:
     StaticModule() = default;
 
     Module* clone(CloneContext* ctx) const override;
+    std::shared_ptr<Session> _createSession(RuntimeInfo&& rt) const;
+    void _setSession(std::shared_ptr<Session> session);
+    bool _switchSession(const std::vector<Express::VARP>& inputs);
     struct Resource {
         std::vector<std::string> mInputs;
         std::vector<std::string> mOutputs;
@@ -40,10 +46,19 @@ private:
         ScheduleConfig mConfig;
         std::shared_ptr<Schedule::ScheduleInfo> mSharedConst;
         Session::ModeGroup mModes;
+        int mShapeCacheSize = 0;
+    };
+    // Session resized for other input shapes
+    struct ShapeCache {
+        std::vector<int> shape;
+        std::shared_ptr<Session> session;
     };
     std::shared_ptr<Session> mSession;
     std::vector<Tensor*> mInputTensors;
     std::vector<Tensor*> mOutputTensors;
+    // Input shapes of mSession, and sessions for other shapes, the most recently used first
+    std::vector<int> mCurrentShape;
+    std::list<ShapeCache> mShapeCache;
     std::shared_ptr<Backend> mResourceBackend, mBackupResourceBackend;
     std::shared_ptr<Resource> mResource;
 };
@@ -111,6 +111,14 @@ public:
      * @return created net if success, NULL otherwise.
      */
     static Interpreter* createFromFile(const char* file);
+    /**
+     * @brief create net from file, optionally mapping it into memory instead of reading.
+     * @param file      given file.
+     * @param useMmap   map the file read-only (copy-on-write). The weights are read from the page cache and
+     *                  shared between processes loading the same model. Fallback to normal reading if mmap fails.
+     * @return created net if success, NULL otherwise.
+     */
+    static Interpreter* createFromFile(const char* file, bool useMmap);
     /**
      * @brief create net from buffer.
      * @param buffer    given data buffer.
@@ -151,6 +159,18 @@ public:
         /** Determine the Execution's forward type is determine by user or auto determine */
         Session_Backend_Fix = 8, // Use the backend user set, when not support use default backend
         Session_Backend_Auto = 9, // Auto Determine the Op type by MNN
+
+        /** About dynamic memory, Default Session_Memory_Greedy*/
+        /** Alloc and free memory for tensors in execution order*/
+        Session_Memory_Greedy = 10,
+        /** Record tensors' lifetime and pack them into one block, first resize cost more time to record and plan */
+        Session_Memory_Plan = 11,
+
+        /** About op execution, Default Session_Execute_Serial*/
+        /** Run ops one by one in schedule order*/
+        Session_Execute_Serial = 12,
+        /** Run independent branches of graph at the same time and share the threads between them, only valid for CPU with multi-thread */
+        Session_Execute_Parallel = 13,
     };
     /**
      * @brief The API shoud be called before create session.
@@ -167,6 +187,16 @@ public:
      */
     void setCacheFile(const char* cacheFile, size_t keySize = 128);
 
+    /**
+     * @brief The API shoud be called before create session.
+     * Set the file holding weights which are stored outside the model (MNNConvert --saveExternalData).
+     * The weights are read lazily when creating executions.
+     * For createFromFile, default is the model file name with ".weight" appended.
+     * Only the CPU backend supports external weights, creating session on other backends fails for such model.
+     * @param file      external weight file name
+     */
+    void setExternalFile(const char* file);
+
     /**
      * @brief The API shoud be called after last resize session.
      * If resize session generate new cache info, try to rewrite cache file.
@@ -179,6 +209,10 @@ public:
     enum HintMode {
         // Max Op number for async tuning
         MAX_TUNING_NUMBER = 0,
+        // Max sequence length of key / value cache kept by attention, 0 means no limit
+        KVCACHE_SIZE_LIMIT = 1,
+        // Measure the algorithms of CPU convolution and keep the fastest one in cache file (see setCacheFile), 1: on, 0: off
+        CPU_CONV_TUNING = 2,
     };
     /**
      * @brief The API shoud be called before create session.
@@ -0,0 +1,67 @@
+//
+//  DynamicBatcher.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef MNN_EXPR_DYNAMIC_BATCHER_HPP_
+#define MNN_EXPR_DYNAMIC_BATCHER_HPP_
+
+#include <functional>
+#include <future>
+#include <MNN/expr/Module.hpp>
+
+namespace MNN {
+namespace Express {
+
+/**
+ * Accept requests from many threads, merge them along the batch dimension (the first dim of each input)
+ * and run them with one forward of the module, then split the outputs back to each request.
+ * Each worker thread runs a clone of the module with its own executor.
+ */
+class MNN_PUBLIC DynamicBatcher {
+public:
+    struct Config {
+        // Max batch of one forward, a request larger than it runs alone
+        int maxBatch = 8;
+        // Max time in microseconds the first request of a batch waits for others
+        int maxDelayUs = 1000;
+        // Number of worker threads, each has a clone of the module
+        int workerNumber = 1;
+
+        // Executor of each worker
+        MNNForwardType type = MNN_FORWARD_CPU;
+        int numThread = 1;
+        BackendConfig backendConfig;
+    };
+    typedef std::function<void(std::vector<VARP>)> CallBack;
+
+    /**
+     * @param module : module whose inputs and outputs all have batch as the first dim, it's cloned for workers.
+     * @param config : batching config.
+     */
+    static DynamicBatcher* create(std::shared_ptr<Module> module, const Config& config);
+    static void destroy(DynamicBatcher* batcher);
+    // Wait for all the submitted requests to finish
+    ~DynamicBatcher();
+
+    /**
+     * @brief submit a request, thread safe.
+     * @param inputs : inputs of the request, all the requests should have the same shape except the first dim.
+     * @param callback : called in the worker thread with the outputs, the outputs are empty if forward failed.
+     */
+    void forward(const std::vector<VARP>& inputs, CallBack callback);
+    // Same as above, return the outputs through future
+    std::future<std::vector<VARP>> forward(const std::vector<VARP>& inputs);
+
+    struct Inside;
+private:
+    DynamicBatcher(std::shared_ptr<Inside> inside);
+    std::shared_ptr<Inside> mInside;
+};
+
+} // namespace Express
+} // namespace MNN
+#endif // MNN_EXPR_DYNAMIC_BATCHER_HPP_
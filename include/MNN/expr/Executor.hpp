@@ -52,6 +52,14 @@ public:
         PART
     };
     void gc(GCFlag flag = FULL);
+    /**
+     * @brief set the number of compiled graphs kept after their variables are released. A new graph with the
+     * same ops, attributes, shapes and constants reuses one of them instead of compiling again, 0 means disable.
+     * Only works for graphs computed by CPU. Default is 0, gc(FULL) releases all of them.
+     * Each kept graph holds its backends and the memory planned for its tensors until it is reused,
+     * evicted or released by gc(FULL), so the extra memory is up to maxNumber times the memory of one graph.
+     */
+    void setTraceCacheSize(int maxNumber);
     static std::shared_ptr<Executor> getGlobalExecutor();
 
     static std::shared_ptr<Executor> newExecutor(MNNForwardType type,
@@ -104,6 +112,12 @@ public:
          * Calling Position  : calling after inference done.
          */
         void updateCache();
+
+        /**
+         * @brief set the file holding weights stored outside the model (MNNConvert --saveExternalData).
+         * Calling Position: calling after createRuntimeManager and before load module.
+         */
+        void setExternalFile(std::string fileName);
         std::vector<bool> isBackendSupport(const std::vector<MNNForwardType> type);
         friend class Executor;
         void setMode(Interpreter::SessionMode mode);
@@ -124,6 +138,8 @@ private:
 
     void _visit(EXPRP expr, std::set<std::shared_ptr<Executor::ComputeCache>>& inputCaches, std::set<std::shared_ptr<Expr::Inside>>& inputNode);
     std::map<std::pair<MNNForwardType, int>, std::shared_ptr<Runtime>> mRuntimes;
+    struct TraceCache;
+    std::shared_ptr<TraceCache> mTraceCache;
 
     Executor(std::shared_ptr<Runtime> backend, MNNForwardType type, int numberThread);
     std::mutex mMutex;
@@ -64,7 +64,14 @@ public:
         // The weights will be rearranged in a general way, so the best implementation
         // may not be adopted if `rearrange` is enabled.
         bool rearrange = false;
-        
+
+        // Map the model file instead of reading it when loading from file. Only used by load with fileName.
+        bool useMmap = false;
+
+        // for static mode, max number of input shapes whose resize result is kept. Switching back to a kept shape
+        // doesn't resize again, the least recently used one is dropped. Values less than 2 disable it.
+        int shapeCacheSize = 0;
+
         BackendInfo* backend = nullptr;
     };
     static Module* load(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, const uint8_t* buffer, size_t length, const Config* config = nullptr);
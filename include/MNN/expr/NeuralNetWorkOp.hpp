@@ -165,6 +165,18 @@ MNN_PUBLIC VARP _Raster(const std::vector<VARP>& vars, const std::vector<int>& r
 MNN_PUBLIC VARP _Nms(VARP boxes, VARP scores, int maxDetections, float iouThreshold = -1, float scoreThreshold = -1);
 MNN_PUBLIC VARP _Im2Col(VARP x, INTS kernelSize, INTS dilate, INTS pads, INTS stride);
 MNN_PUBLIC VARP _Col2Im(VARP x, VARP outputShape, INTS kernelSize, INTS dilate, INTS pads, INTS stride);
+/*Compute softmax(query * key^T * scale + mask) * value.
+Args:
+query: [..., L, D], key: [..., S, D], value: [..., S, Dv].
+mask: nullptr or float value added to score, broadcast to [..., L, S].
+scale: 0 means 1 / sqrt(D).
+kvCache: if true, key and value are appended to the ones of previous runs, which are kept by the op
+  until Module::clearCache. The mask only covers the new key, previous key are all visible.
+  Used by Module for incremental decoding, see Interpreter::KVCACHE_SIZE_LIMIT to bound the cache.
+Returns:
+A variable of shape [..., L, Dv].
+*/
+MNN_PUBLIC VARP _Attention(VARP query, VARP key, VARP value, VARP mask = nullptr, float scale = 0.0f, bool kvCache = false);
 
 } // namespace Express
 } // namespace MNN
@@ -132,8 +132,10 @@ typedef struct {
 typedef struct {
     PyObject_HEAD
     Tensor *tensor;
-    // owner: 1: own tensor and data; 2. own tensor and tensor own data.
+    // owner: 1: own tensor and data; 2. own tensor and tensor own data; 3. own tensor and data is owned by base.
     int owner;
+    // the numpy array whose data is used by tensor without copy
+    PyObject *base;
 } PyMNNTensor;
 
 typedef struct {
@@ -347,6 +349,13 @@ static PyObject* PyMNNTensor_getData(PyMNNTensor *self, PyObject *args);
 static PyObject* PyMNNTensor_getHost(PyMNNTensor *self, PyObject *args);
 static PyObject* PyMNNTensor_copyFrom(PyMNNTensor *self, PyObject *args);
 static PyObject* PyMNNTensor_copyToHostTensor(PyMNNTensor *self, PyObject *args);
+#ifdef PYMNN_BUFFER_PROTOCOL
+static int PyMNNTensor_getbuffer(PyMNNTensor *self, Py_buffer *view, int flags);
+static PyBufferProcs PyMNNTensor_as_buffer = {
+    (getbufferproc)PyMNNTensor_getbuffer,     /*bf_getbuffer*/
+    (releasebufferproc)releaseBuffer,         /*bf_releasebuffer*/
+};
+#endif
 
 static PyMethodDef PyMNNTensor_methods[] = {
 #ifdef PYMNN_NUMPY_USABLE
@@ -384,7 +393,11 @@ static PyTypeObject PyMNNTensorType = {
     0,                                        /*tp_str*/
     0,                                        /*tp_getattro*/
     0,                                        /*tp_setattro*/
+#ifdef PYMNN_BUFFER_PROTOCOL
+    &PyMNNTensor_as_buffer,                   /*tp_as_buffer*/
+#else
     0,                                        /*tp_as_buffer*/
+#endif
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /*tp_flags*/
     "MNN Tensor objects",                    /* tp_doc */
     0,                                        /* tp_traverse */
@@ -970,7 +983,9 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBack(PyMNNInterpreter *self,
         return NULL;
     }
 
+    // callbacks are invoked while the GIL is released by runSessionWithCallBack
     TensorCallBack begin = [beginCallback](const std::vector<Tensor*>& tensors, const std::string& name){
+        PyMNNGILGuard guard;
         if (!beginCallback || !PyCallable_Check(beginCallback)) {
             return true;
         }
@@ -998,6 +1013,7 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBack(PyMNNInterpreter *self,
         return ret;
     };
     TensorCallBack end = [endCallback](const std::vector<Tensor*>& tensors, const std::string& name){
+        PyMNNGILGuard guard;
         if (!endCallback || !PyCallable_Check(endCallback)) {
             return true;
         }
@@ -1026,9 +1042,13 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBack(PyMNNInterpreter *self,
     };
 
     ErrorCode r = NO_ERROR;
-    //Py_BEGIN_ALLOW_THREADS
+#ifndef PYMNN_USE_ALINNPYTHON
+    Py_BEGIN_ALLOW_THREADS
+#endif
     r = self->interpreter->runSessionWithCallBack(session->session, begin, end);
-    //Py_END_ALLOW_THREADS
+#ifndef PYMNN_USE_ALINNPYTHON
+    Py_END_ALLOW_THREADS
+#endif
     return PyLong_FromLong(r);
 }
 
@@ -1052,7 +1072,9 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBackInfo(PyMNNInterpreter *s
         return NULL;
     }
 
+    // callbacks are invoked while the GIL is released by runSessionWithCallBackInfo
     TensorCallBackWithInfo begin = [beginCallback](const std::vector<Tensor*>& tensors, const OperatorInfo* info){
+        PyMNNGILGuard guard;
 
         if (!beginCallback || !PyCallable_Check(beginCallback)) {
 
@@ -1105,6 +1127,7 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBackInfo(PyMNNInterpreter *s
         return ret;
     };
     TensorCallBackWithInfo end = [endCallback](const std::vector<Tensor*>& tensors, const OperatorInfo* info){
+        PyMNNGILGuard guard;
         if (!endCallback || !PyCallable_Check(endCallback)) {
             return true;
         }
@@ -1153,9 +1176,13 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBackInfo(PyMNNInterpreter *s
     };
 
     ErrorCode r = NO_ERROR;
-    //Py_BEGIN_ALLOW_THREADS
+#ifndef PYMNN_USE_ALINNPYTHON
+    Py_BEGIN_ALLOW_THREADS
+#endif
     r = self->interpreter->runSessionWithCallBackInfo(session->session, begin, end);
-    //Py_END_ALLOW_THREADS
+#ifndef PYMNN_USE_ALINNPYTHON
+    Py_END_ALLOW_THREADS
+#endif
     return PyLong_FromLong(r);
 }
 
@@ -1468,17 +1495,18 @@ static PyObject* PyMNNTensor_new(struct _typeobject *type, PyObject *args, PyObj
 
 static void PyMNNTensor_dealloc(PyMNNTensor *self) {
     if (self->owner) {
-        if (self->tensor->host<void *>() && self->owner != 2) {
+        if (self->tensor->host<void *>() && self->owner == 1) {
             free(self->tensor->host<void *>());
         }
         delete self->tensor;
     }
+    Py_XDECREF(self->base);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
 static int PyMNNTensor_init(PyMNNTensor *self, PyObject *args, PyObject *kwds) {
     int argc = PyTuple_Size(args);
-    PyObject *shape, *dataType, *data = nullptr, *input_tensor = nullptr, *input_var = nullptr;
+    PyObject *shape, *dataType, *data = nullptr, *input_tensor = nullptr, *input_var = nullptr, *share = nullptr;
     long dimensionType = -1;
     bool parse_res = false;
     switch (argc) {
@@ -1512,6 +1540,10 @@ static int PyMNNTensor_init(PyMNNTensor *self, PyObject *args, PyObject *kwds) {
             parse_res = PyArg_ParseTuple(args, "OOOl", &shape, &dataType, &data, &dimensionType)
                         && isInts(shape) && isVals(data);
             break;
+        case 5:
+            parse_res = PyArg_ParseTuple(args, "OOOlO", &shape, &dataType, &data, &dimensionType, &share)
+                        && isInts(shape) && isVals(data);
+            break;
         default:
             parse_res = false;
     }
@@ -1520,7 +1552,8 @@ static int PyMNNTensor_init(PyMNNTensor *self, PyObject *args, PyObject *kwds) {
                         "\t0. (Var)\n"
                         "\t1. (Tensor/Var, DimensionType)\n"
                         "\t2. ([int], DataType, DimensionType)\n"
-                        "\t3. ([int], DataType, tuple/ndarray, DimensionType)\n");
+                        "\t3. ([int], DataType, tuple/ndarray, DimensionType)\n"
+                        "\t4. ([int], DataType, ndarray, DimensionType, share)\n");
         return -1;
     }
 #ifdef PYMNN_EXPR_API
@@ -1619,6 +1652,29 @@ static int PyMNNTensor_init(PyMNNTensor *self, PyObject *args, PyObject *kwds) {
     }
     DType dtype = htype2dtype(htt);
     int itemsize = getitemsize(dtype);
+#ifdef PYMNN_NUMPY_USABLE
+    // share = True: use the data of numpy array without copy, the array is kept alive by the tensor,
+    // so the change of array after creating is seen by the tensor. Otherwise the data is copied
+    bool shareData = nullptr != share && PyObject_IsTrue(share);
+    if (shareData && inputData == 2 && gNumpyValid && dimensionType != Tensor::CAFFE_C4
+        && PyArray_ISWRITEABLE((PyArrayObject*)data) && isNumpyShareable(data, dtype)) {
+        Tensor *tensor = Tensor::create(vShape
+                                   , htt
+                                   , PyArray_DATA((PyArrayObject*)data)
+                                   , (Tensor::DimensionType)dimensionType
+                                   );
+        if (!tensor) {
+            PyErr_SetString(PyExc_Exception,
+                            "PyMNNTensor_create: Tensor create failed");
+            return -1;
+        }
+        Py_INCREF(data);
+        self->base = data;
+        self->tensor = tensor;
+        self->owner = 3;
+        return 0;
+    }
+#endif
     pData = malloc(dataSize * itemsize);
     if(NULL == pData) {
         PyErr_SetString(PyExc_Exception,"PyMNNTensor_init: malloc failed");
@@ -1692,9 +1748,10 @@ static PyObject* PyMNNTensor_fromNumpy(PyMNNTensor *self, PyObject *args) {
     }
     if (!PyArray_Check(data)) {
         PyErr_SetString(PyExc_Exception,"PyMNNTensor_fromNumpy: input is not a numpy");
+        return NULL;
     }
     if (self->owner){
-        if(self->tensor->size() != PyArray_Size(data)) {
+        if(self->tensor->elementSize() != PyArray_Size(data)) {
             PyErr_SetString(PyExc_Exception,"PyMNNTensor_fromNumpy: tensor/numpy size does not match each other");
             return NULL;
         }
@@ -1707,7 +1764,13 @@ static PyObject* PyMNNTensor_fromNumpy(PyMNNTensor *self, PyObject *args) {
              PyErr_SetString(PyExc_Exception,"PyMNNTensor_fromNumpy: ndarry failed to get buffer data");
              return NULL;
         }
-        memcpy(self->tensor->host<void *>(), tmpBuffer, self->tensor->size() * itemsize);
+        auto dst = self->tensor->host<void *>();
+        if (dst != tmpBuffer) {
+            // data_cont is referenced, so it is safe to copy without GIL
+            Py_BEGIN_ALLOW_THREADS
+            memcpy(dst, tmpBuffer, self->tensor->elementSize() * itemsize);
+            Py_END_ALLOW_THREADS
+        }
         Py_XDECREF(data_cont);
     }
     Py_RETURN_NONE;
@@ -1812,19 +1875,19 @@ static PyObject* PyMNNTensor_getNumpyData(PyMNNTensor *self, PyObject *args) {
         PyObject* obj;
         if (t == *httInt()) {
             auto data = self->tensor->host<int32_t>();
-            obj = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT32, data);
+            obj = toNumpy(npy_dims, NPY_INT32, data, (PyObject*)self);
         } else if (t == *httUint8()) {
             auto data = self->tensor->host<uint8_t>();
-            obj = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_UINT8, data);
+            obj = toNumpy(npy_dims, NPY_UINT8, data, (PyObject*)self);
         } else if (t == *httInt64()) {
             auto data = self->tensor->host<int64_t>();
-            obj = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT64, data);
+            obj = toNumpy(npy_dims, NPY_INT64, data, (PyObject*)self);
         } else if (t == *httFloat()) {
             auto data = self->tensor->host<float>();
-            obj = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_FLOAT, data);
+            obj = toNumpy(npy_dims, NPY_FLOAT, data, (PyObject*)self);
         } else if (t == *httDouble()) {
             auto data = self->tensor->host<double>();
-            obj = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_DOUBLE, data);
+            obj = toNumpy(npy_dims, NPY_DOUBLE, data, (PyObject*)self);
         } else {
             PyErr_SetString(PyExc_Exception, "tensor can not be read as numpy");
             Py_RETURN_NONE;
@@ -1835,6 +1898,18 @@ static PyObject* PyMNNTensor_getNumpyData(PyMNNTensor *self, PyObject *args) {
 }
 #endif
 
+#ifdef PYMNN_BUFFER_PROTOCOL
+static int PyMNNTensor_getbuffer(PyMNNTensor *self, Py_buffer *view, int flags) {
+    if (!self->tensor || self->tensor->getDimensionType() == Tensor::CAFFE_C4) {
+        PyErr_SetString(PyExc_BufferError, "PyMNNTensor_getbuffer: tensor is null or NC4HW4");
+        view->obj = NULL;
+        return -1;
+    }
+    return fillBuffer(view, (PyObject*)self, self->tensor->host<void>(), self->tensor->shape(),
+                      self->tensor->getType(), false, flags);
+}
+#endif
+
 static PyObject* PyMNNTensor_getDimensionType(PyMNNTensor *self, PyObject *args) {
     if (self->tensor) {
         return PyLong_FromLong(self->tensor->getDimensionType());
@@ -1851,9 +1926,13 @@ static PyObject* PyMNNTensor_copyFrom(PyMNNTensor *self, PyObject *args) {
     if (!fromTensor->tensor || !self->tensor) {
         PyErr_SetString(PyExc_Exception,
                         "PyMNNTensor_copyFrom: source or destination tensor is null");
+        return NULL;
     }
 
-    bool r = self->tensor->copyFromHostTensor(fromTensor->tensor);
+    bool r = false;
+    Py_BEGIN_ALLOW_THREADS
+    r = self->tensor->copyFromHostTensor(fromTensor->tensor);
+    Py_END_ALLOW_THREADS
     if (!r) {
         Py_RETURN_FALSE;
     }
@@ -1869,9 +1948,13 @@ static PyObject* PyMNNTensor_copyToHostTensor(PyMNNTensor *self, PyObject *args)
     if (!toTensor->tensor || !self->tensor) {
         PyErr_SetString(PyExc_Exception,
                         "PyMNNTensor_copyTo: source or destination tensor is null");
+        return NULL;
     }
 
-    bool r = self->tensor->copyToHostTensor(toTensor->tensor);
+    bool r = false;
+    Py_BEGIN_ALLOW_THREADS
+    r = self->tensor->copyToHostTensor(toTensor->tensor);
+    Py_END_ALLOW_THREADS
     if (!r) {
         Py_RETURN_FALSE;
     }
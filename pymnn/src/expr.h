@@ -230,6 +230,13 @@ static PyMappingMethods PyMNNVar_as_mapping = {
     PyMNNVar_subscript,     /*mp_subscript*/
     PyMNNVar_ass_subscript, /*mp_ass_subscript*/
 };
+#ifdef PYMNN_BUFFER_PROTOCOL
+static int PyMNNVar_getbuffer(PyMNNVar *self, Py_buffer *view, int flags);
+static PyBufferProcs PyMNNVar_as_buffer = {
+    (getbufferproc)PyMNNVar_getbuffer,  /*bf_getbuffer*/
+    (releasebufferproc)releaseBuffer,   /*bf_releasebuffer*/
+};
+#endif
 PyObject *PyMNNVar_richcompare(PyObject *self, PyObject *other, int op);
 static PyTypeObject PyMNNVarType = {
     PyVarObject_HEAD_INIT(NULL, 0)
@@ -250,7 +257,11 @@ static PyTypeObject PyMNNVarType = {
     PyMNNVar_repr,                            /*tp_str*/
     0,                                        /*tp_getattro*/
     0,                                        /*tp_setattro*/
+#ifdef PYMNN_BUFFER_PROTOCOL
+    &PyMNNVar_as_buffer,                      /*tp_as_buffer*/
+#else
     0,                                        /*tp_as_buffer*/
+#endif
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE
 #if PY_MAJOR_VERSION < 3
     // this flag `tp_as_number` accept arguments of arbitrary object types in py2
@@ -287,6 +298,14 @@ static PyObject* toPyObj(VARP var) {
     *(ret->var) = var;
     return (PyObject*)ret;
 }
+// readMap may compute the graph of var, so release the GIL for other python threads
+static void* readMapWithoutGIL(VARP& var) {
+    const void* ptr = nullptr;
+    Py_BEGIN_ALLOW_THREADS
+    ptr = var->readMap<void>();
+    Py_END_ALLOW_THREADS
+    return const_cast<void*>(ptr);
+}
 static bool isVar(PyObject* var) {
     return isInt(var) || isInts(var) ||
            isFloat(var) || isFloats(var) ||
@@ -711,9 +730,9 @@ static PyObject* PyMNNVar_getndim(PyMNNVar *self, void *closure) {
 
 static PyObject* PyMNNVar_getptr(PyMNNVar *self, void *closure) {
     if (self->var) {
-        const void* ptr = (*(self->var))->readMap<void>();
+        void* ptr = readMapWithoutGIL(*(self->var));
         if(nullptr != ptr) {
-            return PyCapsule_New(const_cast<void*>(ptr), NULL, NULL);
+            return PyCapsule_New(ptr, NULL, NULL);
         }
     }
     PyMNN_ERROR("getptr: unable to get data ptr.");
@@ -838,7 +857,7 @@ static PyObject* PyMNNVar_read(PyMNNVar *self, PyObject *args) {
     auto shape = info->dim;
     int64_t total_length = info->size;
     auto readptr = [self](DType dtype, INTS shape, int64_t total_length) {
-        void *dataPtr = (void *) (*(self->var))->readMap<void>();
+        void *dataPtr = readMapWithoutGIL(*(self->var));
         if (nullptr == dataPtr) {
             PyMNN_ERROR("call to readMap meet a error");
         }
@@ -846,17 +865,19 @@ static PyObject* PyMNNVar_read(PyMNNVar *self, PyObject *args) {
         for(const auto dim : shape) {
             npy_dims.push_back(dim);
         }
+        // the array share memory with var, and keep var alive
+        auto base = (PyObject*)self;
         switch(dtype) {
             case DType_FLOAT:
-                return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_FLOAT, dataPtr);
+                return toNumpy(npy_dims, NPY_FLOAT, dataPtr, base);
             case DType_DOUBLE:
-                return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_DOUBLE, dataPtr);
+                return toNumpy(npy_dims, NPY_DOUBLE, dataPtr, base);
             case DType_INT32:
-                return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT32, dataPtr);
+                return toNumpy(npy_dims, NPY_INT32, dataPtr, base);
             case DType_INT64:
-                return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT64, dataPtr);
+                return toNumpy(npy_dims, NPY_INT64, dataPtr, base);
             case DType_UINT8:
-                return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_UINT8, dataPtr);
+                return toNumpy(npy_dims, NPY_UINT8, dataPtr, base);
             default:
                 PyMNN_ERROR("does not support this dtype");
         }
@@ -866,6 +887,26 @@ static PyObject* PyMNNVar_read(PyMNNVar *self, PyObject *args) {
     return (PyObject*)data;
 }
 #endif
+#ifdef PYMNN_BUFFER_PROTOCOL
+// readonly buffer on the data of var, NC4HW4 var is not supported
+static int PyMNNVar_getbuffer(PyMNNVar *self, Py_buffer *view, int flags) {
+    view->obj = NULL;
+    auto info = self->var ? (*(self->var))->getInfo() : nullptr;
+    if (nullptr == info || NC4HW4 == info->order) {
+        PyErr_SetString(PyExc_BufferError, "getbuffer: unable to get variable info or var is NC4HW4");
+        return -1;
+    }
+    auto shape = info->dim;
+    auto type = info->type;
+    void* dataPtr = readMapWithoutGIL(*(self->var));
+    if (nullptr == dataPtr) {
+        PyErr_SetString(PyExc_BufferError, "getbuffer: call to readMap meet a error");
+        return -1;
+    }
+    (*(self->var))->unMap();
+    return fillBuffer(view, (PyObject*)self, dataPtr, shape, type, true, flags);
+}
+#endif
 static PyObject* PyMNNVar_read_as_tuple(PyMNNVar *self, PyObject *args) {
     auto info = (*(self->var))->getInfo();
     if(nullptr == info) {
@@ -875,7 +916,7 @@ static PyObject* PyMNNVar_read_as_tuple(PyMNNVar *self, PyObject *args) {
     auto shape = info->dim;
     size_t total_length = info->size;
     auto readptr = [self](DType dtype, INTS shape, size_t total_length) {
-        void *dataPtr = (void *) (*(self->var))->readMap<void>();
+        void *dataPtr = readMapWithoutGIL(*(self->var));
         if (nullptr == dataPtr) {
             PyMNN_ERROR("call to readMap meet a error");
         }
@@ -1259,7 +1300,14 @@ static PyObject* PyMNNExpr_const(PyObject *self, PyObject *args, PyObject *kwarg
         bool need_free = false;
         if (PyCapsule_CheckExact(value)) {
             data = PyCapsule_GetPointer(value, NULL);
-        } else {
+        }
+#ifdef PYMNN_NUMPY_USABLE
+        // _Const copy data, so use the memory of numpy array directly
+        else if (PyArray_Check(value) && PyArray_Size(value) == total_length && isNumpyShareable(value, dtype)) {
+            data = PyArray_DATA((PyArrayObject*)value);
+        }
+#endif
+        else {
             data = toPtr(value, dtype, total_length);
             need_free = true;
         }
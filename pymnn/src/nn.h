@@ -126,7 +126,12 @@ static PyObject* PyMNN_Module_forward(PyMNN_Module *self, PyObject *args) {
         (void) MonitorService::GetInstance().EventTrack(self->ptr, timer, status, "PyMNN_Module_forward");
         return toPyObj<VARP, toPyObj>(vars);
 #else
-        return toPyObj<VARP, toPyObj>((*(self->ptr))->onForward(toVars(input)));
+        auto inputs = toVars(input);
+        std::vector<VARP> outputs;
+        Py_BEGIN_ALLOW_THREADS
+        outputs = (*(self->ptr))->onForward(inputs);
+        Py_END_ALLOW_THREADS
+        return toPyObj<VARP, toPyObj>(outputs);
 #endif
     }
     if (isVar(input)) {
@@ -137,7 +142,12 @@ static PyObject* PyMNN_Module_forward(PyMNN_Module *self, PyObject *args) {
         (void) MonitorService::GetInstance().EventTrack(self->ptr, timer, status, "PyMNN_Module_forward");
         return toPyObj(var);
 #else
-        return toPyObj((*(self->ptr))->forward(toVar(input)));
+        auto inputVar = toVar(input);
+        VARP output;
+        Py_BEGIN_ALLOW_THREADS
+        output = (*(self->ptr))->forward(inputVar);
+        Py_END_ALLOW_THREADS
+        return toPyObj(output);
 #endif
     }
     PyMNN_ERROR("PyMNN_Module_forward: args must be Var/[Var].");
@@ -159,7 +169,12 @@ static PyObject* PyMNN_Module_onForward(PyMNN_Module *self, PyObject *args) {
     (void) MonitorService::GetInstance().EventTrack(self->ptr->get(), timer, status, "PyMNN_Module_onForward");
     return toPyObj<VARP, toPyObj>(vars);
 #else
-    return toPyObj<VARP, toPyObj>((*(self->ptr))->onForward(toVars(inputs)));
+    auto vars = toVars(inputs);
+    std::vector<VARP> outputs;
+    Py_BEGIN_ALLOW_THREADS
+    outputs = (*(self->ptr))->onForward(vars);
+    Py_END_ALLOW_THREADS
+    return toPyObj<VARP, toPyObj>(outputs);
 #endif
 }
 
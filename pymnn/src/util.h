@@ -273,7 +273,118 @@ inline int getitemsize(int dtype, int npy_type) {
         return 0;
     }
 }
+// numpy array can be used by MNN directly (no copy) when it is aligned, C-contiguous and has the same dtype
+inline bool isNumpyShareable(PyObject* obj, int dtype) {
+    auto array = (PyArrayObject*)obj;
+    if (!PyArray_IS_C_CONTIGUOUS(array) || !PyArray_ISALIGNED(array) || PyArray_ISBYTESWAPPED(array)) {
+        return false;
+    }
+    int npy_type = PyArray_TYPE(array);
+    switch(dtype) {
+      case DType_FLOAT:
+        return npy_type == NPY_FLOAT;
+      case DType_DOUBLE:
+        return npy_type == NPY_DOUBLE;
+      case DType_INT32:
+        return npy_type == NPY_INT || npy_type == NPY_INT32;
+      case DType_INT64:
+        return npy_type == NPY_INT64;
+      case DType_UINT8:
+        return npy_type == NPY_UINT8;
+      default:
+        return false;
+    }
+}
+// create numpy array on data without copy, the array hold a reference of base to keep data alive
+static PyObject* toNumpy(std::vector<npy_intp>& dims, int npy_type, void* data, PyObject* base) {
+    auto obj = PyArray_SimpleNewFromData(dims.size(), dims.data(), npy_type, data);
+    if (nullptr != obj && nullptr != base) {
+        Py_INCREF(base);
+        // steal the reference of base
+        if (PyArray_SetBaseObject((PyArrayObject*)obj, base) < 0) {
+            Py_DECREF(obj);
+            return nullptr;
+        }
+    }
+    return obj;
+}
 #endif
+#if PY_MAJOR_VERSION >= 3 && !defined(PYMNN_USE_ALINNPYTHON)
+#define PYMNN_BUFFER_PROTOCOL
+// Fill view by C-contiguous data of shape and type, shape and strides are stored in view->internal
+static int fillBuffer(Py_buffer* view, PyObject* obj, void* data, const std::vector<int>& shape,
+                      halide_type_t type, bool readonly, int flags) {
+    view->obj = nullptr;
+    const char* format = nullptr;
+    if (type.code == halide_type_float && type.bits == 32) {
+        format = "f";
+    } else if (type.code == halide_type_float && type.bits == 64) {
+        format = "d";
+    } else if (type.code == halide_type_int && type.bits == 32) {
+        format = "i";
+    } else if (type.code == halide_type_int && type.bits == 64) {
+        format = "q";
+    } else if (type.code == halide_type_int && type.bits == 8) {
+        format = "b";
+    } else if (type.code == halide_type_uint && type.bits == 8) {
+        format = "B";
+    }
+    if (nullptr == format || nullptr == data) {
+        PyErr_SetString(PyExc_BufferError, "data is not on host or type is not supported");
+        return -1;
+    }
+    if (readonly && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "data is readonly");
+        return -1;
+    }
+    int ndim = static_cast<int>(shape.size());
+    // shape: [0, ndim), strides: [ndim, 2 * ndim)
+    auto dims = (Py_ssize_t*)malloc(sizeof(Py_ssize_t) * (2 * ndim + 1));
+    if (nullptr == dims) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    Py_ssize_t itemsize = type.bytes();
+    Py_ssize_t length = itemsize;
+    for (int i = ndim - 1; i >= 0; --i) {
+        dims[i] = shape[i];
+        dims[ndim + i] = length;
+        length *= shape[i];
+    }
+    view->buf = data;
+    view->obj = obj;
+    Py_INCREF(obj);
+    view->len = length;
+    view->readonly = readonly ? 1 : 0;
+    view->itemsize = itemsize;
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char*>(format) : nullptr;
+    view->ndim = ndim;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? dims : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? dims + ndim : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = dims;
+    return 0;
+}
+static void releaseBuffer(PyObject* obj, Py_buffer* view) {
+    free(view->internal);
+    view->internal = nullptr;
+}
+#endif
+// Acquire the GIL in scope, for python callbacks invoked by MNN while the GIL is released.
+// AliNNPython run callbacks with the GIL held, so the guard do nothing
+class PyMNNGILGuard {
+public:
+#ifdef PYMNN_USE_ALINNPYTHON
+    PyMNNGILGuard() {}
+#else
+    PyMNNGILGuard() : mState(PyGILState_Ensure()) {}
+    ~PyMNNGILGuard() {
+        PyGILState_Release(mState);
+    }
+private:
+    PyGILState_STATE mState;
+#endif
+};
 inline int getitemsize(int dtype) {
     switch(dtype) {
       case DType_FLOAT:
@@ -102,6 +102,80 @@ class UnitTest(unittest.TestCase):
         # cv2.imwrite('mnn.jpg', dest)
         # img is like
         self.assertEqual(dest.shape, dest_.shape)
+    # test Tensor created by ndarray copy the data by default
+    def test_tensor_numpy_copy(self):
+        data = np.arange(12, dtype=np.float32).reshape(3, 4)
+        tensor = MNN.Tensor((3, 4), MNN.Halide_Type_Float, data, MNN.Tensor_DimensionType_Caffe)
+        data[0, 0] = 100.0
+        self.assertEqual(tensor.getNumpyData()[0, 0], 0.0)
+    # test Tensor created by ndarray with share = True use the memory of ndarray
+    def test_tensor_numpy_share(self):
+        data = np.arange(12, dtype=np.float32).reshape(3, 4)
+        tensor = MNN.Tensor((3, 4), MNN.Halide_Type_Float, data, MNN.Tensor_DimensionType_Caffe, True)
+        data[0, 0] = 100.0
+        self.assertEqual(tensor.getNumpyData()[0, 0], 100.0)
+        # the tensor keeps the array alive
+        del data
+        self.assertEqual(tensor.getNumpyData()[0, 1], 1.0)
+        # non-contiguous array can't be shared, the data is copied
+        view = np.arange(24, dtype=np.float32).reshape(3, 8)[:, ::2]
+        tensor = MNN.Tensor((3, 4), MNN.Halide_Type_Float, view, MNN.Tensor_DimensionType_Caffe, True)
+        view[0, 0] = 100.0
+        self.assertEqual(tensor.getNumpyData()[0, 0], 0.0)
+    # test buffer protocol of Tensor and Var
+    def test_buffer_protocol(self):
+        if version_info.major < 3:
+            return
+        data = np.arange(12, dtype=np.float32).reshape(3, 4)
+        tensor = MNN.Tensor((3, 4), MNN.Halide_Type_Float, data, MNN.Tensor_DimensionType_Caffe)
+        view = memoryview(tensor)
+        self.assertEqual(view.shape, (3, 4))
+        self.assertEqualArray(np.asarray(view), data)
+        var = expr.const(data, [3, 4])
+        view = memoryview(var)
+        self.assertTrue(view.readonly)
+        self.assertEqualArray(np.asarray(view), data)
+    # test python callbacks run by session which released the GIL
+    def test_session_callback(self):
+        import os, tempfile, threading
+        # build the graph lazily, otherwise the placeholder is computed as const
+        expr.lazy_eval(True)
+        x = expr.placeholder([1, 3, 4, 4], expr.NCHW)
+        x.name = 'x'
+        y = expr.relu(x * expr.scalar(2.0))
+        y.name = 'y'
+        path = os.path.join(tempfile.mkdtemp(), 'callback.mnn')
+        expr.save([y], path)
+        expr.lazy_eval(False)
+        interpreter = MNN.Interpreter(path)
+        data = np.arange(-24, 24, dtype=np.float32).reshape(1, 3, 4, 4)
+        def run(results):
+            session = interpreter.createSession()
+            input = interpreter.getSessionInput(session)
+            input.copyFrom(MNN.Tensor((1, 3, 4, 4), MNN.Halide_Type_Float, data, MNN.Tensor_DimensionType_Caffe))
+            names = []
+            def begin(tensors, name):
+                names.append(name)
+                return True
+            def end(tensors, name):
+                return True
+            interpreter.runSessionWithCallBack(session, begin, end)
+            output = interpreter.getSessionOutput(session)
+            host = MNN.Tensor((1, 3, 4, 4), MNN.Halide_Type_Float, np.zeros((1, 3, 4, 4), dtype=np.float32), MNN.Tensor_DimensionType_Caffe)
+            output.copyToHostTensor(host)
+            results.append((len(names), host.getNumpyData()))
+        results = []
+        threads = [threading.Thread(target=run, args=(results,)) for i in range(2)]
+        for t in threads:
+            t.start()
+        run(results)
+        for t in threads:
+            t.join()
+        os.remove(path)
+        self.assertEqual(len(results), 3)
+        for count, value in results:
+            self.assertTrue(count > 0)
+            self.assertEqualArray(value, np.maximum(data * 2.0, 0.0))
     # test unary
     def test_sign(self):
         self.assertEqualVar(expr.sign(self.x), np.sign(self.x_))
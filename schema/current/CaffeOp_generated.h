@@ -1243,6 +1243,7 @@ struct Convolution2DT : public flatbuffers::NativeTable {
   std::unique_ptr<IDSTQuanT> quanParameter;
   std::unique_ptr<QuantizedFloatParamT> symmetricQuan;
   std::unique_ptr<SparseCommonT> sparseParameter;
+  std::vector<int64_t> external;
   Convolution2DT() {
   }
 };
@@ -1270,6 +1271,9 @@ struct Convolution2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const SparseCommon *sparseParameter() const {
     return GetPointer<const SparseCommon *>(14);
   }
+  const flatbuffers::Vector<int64_t> *external() const {
+    return GetPointer<const flatbuffers::Vector<int64_t> *>(16);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, 4) &&
@@ -1284,6 +1288,8 @@ struct Convolution2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            verifier.VerifyTable(symmetricQuan()) &&
            VerifyOffset(verifier, 14) &&
            verifier.VerifyTable(sparseParameter()) &&
+           VerifyOffset(verifier, 16) &&
+           verifier.VerifyVector(external()) &&
            verifier.EndTable();
   }
   Convolution2DT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -1312,6 +1318,9 @@ struct Convolution2DBuilder {
   void add_sparseParameter(flatbuffers::Offset<SparseCommon> sparseParameter) {
     fbb_.AddOffset(14, sparseParameter);
   }
+  void add_external(flatbuffers::Offset<flatbuffers::Vector<int64_t>> external) {
+    fbb_.AddOffset(16, external);
+  }
   explicit Convolution2DBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1331,8 +1340,10 @@ inline flatbuffers::Offset<Convolution2D> CreateConvolution2D(
     flatbuffers::Offset<flatbuffers::Vector<float>> bias = 0,
     flatbuffers::Offset<IDSTQuan> quanParameter = 0,
     flatbuffers::Offset<QuantizedFloatParam> symmetricQuan = 0,
-    flatbuffers::Offset<SparseCommon> sparseParameter = 0) {
+    flatbuffers::Offset<SparseCommon> sparseParameter = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int64_t>> external = 0) {
   Convolution2DBuilder builder_(_fbb);
+  builder_.add_external(external);
   builder_.add_sparseParameter(sparseParameter);
   builder_.add_symmetricQuan(symmetricQuan);
   builder_.add_quanParameter(quanParameter);
@@ -4392,6 +4403,7 @@ inline void Convolution2D::UnPackTo(Convolution2DT *_o, const flatbuffers::resol
   { auto _e = quanParameter(); if (_e) _o->quanParameter = std::unique_ptr<IDSTQuanT>(_e->UnPack(_resolver)); };
   { auto _e = symmetricQuan(); if (_e) _o->symmetricQuan = std::unique_ptr<QuantizedFloatParamT>(_e->UnPack(_resolver)); };
   { auto _e = sparseParameter(); if (_e) _o->sparseParameter = std::unique_ptr<SparseCommonT>(_e->UnPack(_resolver)); };
+  { auto _e = external(); if (_e) { _o->external.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->external[_i] = _e->Get(_i); } } };
 }
 
 inline flatbuffers::Offset<Convolution2D> Convolution2D::Pack(flatbuffers::FlatBufferBuilder &_fbb, const Convolution2DT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -4408,6 +4420,7 @@ inline flatbuffers::Offset<Convolution2D> CreateConvolution2D(flatbuffers::FlatB
   auto _quanParameter = _o->quanParameter ? CreateIDSTQuan(_fbb, _o->quanParameter.get(), _rehasher) : 0;
   auto _symmetricQuan = _o->symmetricQuan ? CreateQuantizedFloatParam(_fbb, _o->symmetricQuan.get(), _rehasher) : 0;
   auto _sparseParameter = _o->sparseParameter ? CreateSparseCommon(_fbb, _o->sparseParameter.get(), _rehasher) : 0;
+  auto _external = _o->external.size() ? _fbb.CreateVector(_o->external) : 0;
   return MNN::CreateConvolution2D(
       _fbb,
       _common,
@@ -4415,7 +4428,8 @@ inline flatbuffers::Offset<Convolution2D> CreateConvolution2D(flatbuffers::FlatB
       _bias,
       _quanParameter,
       _symmetricQuan,
-      _sparseParameter);
+      _sparseParameter,
+      _external);
 }
 
 inline Convolution3DT *Convolution3D::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
@@ -5842,7 +5856,8 @@ inline const flatbuffers::TypeTable *Convolution2DTypeTable() {
     { flatbuffers::ET_FLOAT, 1, -1 },
     { flatbuffers::ET_SEQUENCE, 0, 1 },
     { flatbuffers::ET_SEQUENCE, 0, 2 },
-    { flatbuffers::ET_SEQUENCE, 0, 3 }
+    { flatbuffers::ET_SEQUENCE, 0, 3 },
+    { flatbuffers::ET_LONG, 1, -1 }
   };
   static const flatbuffers::TypeFunction type_refs[] = {
     Convolution2DCommonTypeTable,
@@ -5856,10 +5871,11 @@ inline const flatbuffers::TypeTable *Convolution2DTypeTable() {
     "bias",
     "quanParameter",
     "symmetricQuan",
-    "sparseParameter"
+    "sparseParameter",
+    "external"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_TABLE, 6, type_codes, type_refs, nullptr, names
+    flatbuffers::ST_TABLE, 7, type_codes, type_refs, nullptr, names
   };
   return &tt;
 }
@@ -132,7 +132,7 @@ void Arm82Backend::onCopyBuffer(const Tensor* srcTensor, const Tensor* dstTensor
         if (srcType == MNN_FORWARD_CPU) {
             MNNCPUCopyBuffer(srcTensor, dstTensor);
         } else {
-            CPUTensorConverter::convert(srcTensor, dstTensor, mCoreFunctions);
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, mCoreFunctions);
         }
         return;
     }
@@ -0,0 +1,403 @@
+//
+//  CPUAttention.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <limits>
+#include "backend/cpu/CPUAttention.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/BufferAllocator.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+
+namespace MNN {
+
+// Length of key / value in one step of streaming softmax
+static const int gSeqUnit = 128;
+
+static inline size_t _alignFloat(size_t size) {
+    return UP_DIV(size, 16) * 16;
+}
+
+CPUAttention::CPUAttention(Backend *backend, float scale, bool kvCache) : Execution(backend), mScale(scale), mKVCache(kvCache) {
+    // Do nothing
+}
+
+void CPUAttention::onClearCache() {
+    if (nullptr != mCache) {
+        mCache->pastLength = 0;
+    }
+}
+
+void CPUAttention::onShareCache(const Execution *src) {
+    auto attention = static_cast<const CPUAttention *>(src);
+    if (mKVCache && nullptr != attention->mCache) {
+        mCache = attention->mCache;
+    }
+}
+
+bool CPUAttention::_allocCache(int units) {
+    const size_t kvStride = mPackedKeyStride + mPackedValueStride;
+    std::shared_ptr<Tensor> packed(Tensor::create<float>({(int)(units * mBatch * kvStride)}));
+    if (nullptr == packed || nullptr == packed->host<float>()) {
+        MNN_ERROR("Attention: alloc kv cache for %d tokens failed\n", units * mSeqUnit);
+        return false;
+    }
+    if (nullptr != mCache->packed) {
+        ::memcpy(packed->host<float>(), mCache->packed->host<float>(), UP_DIV(mCache->pastLength, mSeqUnit) * mBatch * kvStride * sizeof(float));
+    }
+    mCache->packed = packed;
+    mCache->units  = units;
+    return true;
+}
+
+void CPUAttention::_appendCache(const float *key, const float *value) {
+    auto core = static_cast<CPUBackend *>(backend())->functions();
+    const int D = mHeadDim, Dv = mValueDim, newLength = mKeyLength, pastLength = mCache->pastLength;
+    const size_t kvStride = mPackedKeyStride + mPackedValueStride;
+    auto cache = mCache->packed->host<float>();
+    auto tail  = mCache->tail->host<float>();
+    const int threadNumber = ALIMIN(mThreadNumber, mBatch);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int b = (int)tId; b < mBatch; b += threadNumber) {
+            auto tailKey   = tail + (size_t)b * mSeqUnit * (D + Dv);
+            auto tailValue = tailKey + mSeqUnit * D;
+            int pos = pastLength;
+            for (int t = 0; t < newLength;) {
+                // Rows of the unit before offset are kept in tail, repack the whole unit with the new rows
+                int offset = pos % mSeqUnit;
+                int count  = ALIMIN(mSeqUnit - offset, newLength - t);
+                ::memcpy(tailKey + offset * D, key + ((size_t)b * newLength + t) * D, count * D * sizeof(float));
+                ::memcpy(tailValue + offset * Dv, value + ((size_t)b * newLength + t) * Dv, count * Dv * sizeof(float));
+                auto dst = cache + ((size_t)(pos / mSeqUnit) * mBatch + b) * kvStride;
+                core->MNNPackForMatMul_B(dst, tailKey, offset + count, D, true);
+                core->MNNPackForMatMul_B(dst + mPackedKeyStride, tailValue, Dv, offset + count, false);
+                pos += count;
+                t += count;
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+}
+
+ErrorCode CPUAttention::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto core   = static_cast<CPUBackend *>(backend())->functions();
+    auto query  = inputs[0];
+    auto key    = inputs[1];
+    auto value  = inputs[2];
+    const int dims = query->dimensions();
+    mBatch = 1;
+    for (int i = 0; i < dims - 2; ++i) {
+        mBatch *= query->length(i);
+    }
+    mQueryLength  = query->length(dims - 2);
+    mHeadDim      = query->length(dims - 1);
+    mKeyLength    = key->length(dims - 2);
+    mValueDim     = value->length(dims - 1);
+    mRealScale    = mScale != 0.0f ? mScale : 1.0f / sqrtf((float)mHeadDim);
+    mSeqUnit      = mKVCache ? gSeqUnit : ALIMIN(gSeqUnit, mKeyLength);
+    mThreadNumber = static_cast<CPUBackend *>(backend())->threadNumber();
+
+    // Compute mask offset for each batch by broadcast
+    mMaskOffset.clear();
+    if (inputs.size() > 3) {
+        auto mask = inputs[3];
+        const int maskDims = mask->dimensions();
+        mMaskOffset.resize(mBatch);
+        for (int b = 0; b < mBatch; ++b) {
+            int offset = 0, stride = mQueryLength * mKeyLength, index = b;
+            for (int i = dims - 3; i >= 0; --i) {
+                int pos = index % query->length(i);
+                index   = index / query->length(i);
+                int maskIndex = i + maskDims - dims;
+                if (maskIndex < 0) {
+                    break;
+                }
+                int maskLength = mask->length(maskIndex);
+                if (maskLength > 1) {
+                    offset += pos * stride;
+                }
+                stride *= maskLength;
+            }
+            mMaskOffset[b] = offset;
+        }
+    }
+
+    int eP, lP, hP;
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    auto pack  = core->pack;
+    auto hUnit = ALIMAX(hP, pack);
+    auto seqUnitNumber = UP_DIV(mKeyLength, mSeqUnit);
+    mPackedKeyStride   = _alignFloat(UP_DIV(mSeqUnit, hP) * UP_DIV(mHeadDim, lP) * lP * hP);
+    mPackedValueStride = _alignFloat(UP_DIV(mValueDim, hP) * UP_DIV(mSeqUnit, lP) * lP * hP);
+
+    mThreadBufferStride = 0;
+    // packC: C4 layout for query or probability
+    mThreadBufferStride += _alignFloat(ALIMAX(UP_DIV(mHeadDim, pack), UP_DIV(mSeqUnit, pack)) * eP * pack);
+    // query tile and probability tile packed for matmul
+    mThreadBufferStride += _alignFloat(UP_DIV(mHeadDim, lP) * eP * lP);
+    mThreadBufferStride += _alignFloat(UP_DIV(mSeqUnit, lP) * eP * lP);
+    // matmul output
+    mThreadBufferStride += _alignFloat(ALIMAX(UP_DIV(mSeqUnit, hUnit), UP_DIV(mValueDim, hUnit)) * hUnit * eP);
+    // query rows, score rows, output rows and accumulator
+    mThreadBufferStride += _alignFloat(eP * mHeadDim);
+    mThreadBufferStride += _alignFloat(eP * mSeqUnit);
+    mThreadBufferStride += _alignFloat(eP * mValueDim);
+    mThreadBufferStride += _alignFloat(eP * mValueDim);
+    // max, sum and rescale factor for each row
+    mThreadBufferStride += _alignFloat(eP * 3);
+
+    if (mKVCache) {
+        if (nullptr == mCache) {
+            mCache.reset(new KVCache);
+        }
+        std::vector<int> cacheShape = {mBatch, mHeadDim, mValueDim};
+        if (cacheShape != mCache->shape) {
+            if (mCache->pastLength > 0) {
+                MNN_ERROR("Attention: shape of key / value doesn't match the kv cache, clear the cache first\n");
+                return INPUT_DATA_ERROR;
+            }
+            mCache->packed = nullptr;
+            mCache->units  = 0;
+            mCache->tail.reset(Tensor::create<float>({mBatch * mSeqUnit * (mHeadDim + mValueDim)}));
+            if (nullptr == mCache->tail->host<float>()) {
+                mCache->tail = nullptr;
+                return OUT_OF_MEMORY;
+            }
+            mCache->shape = cacheShape;
+        }
+        // Preallocate the whole cache if the limit is known
+        mMaxLength = backend()->getKVCacheLimit();
+        if (mMaxLength > 0 && mCache->units * mSeqUnit < mMaxLength && !_allocCache(UP_DIV(mMaxLength, mSeqUnit))) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    auto bufferAlloc = static_cast<CPUBackend *>(backend())->getBufferAllocator();
+    if (!mKVCache) {
+        mPackedKV = bufferAlloc->alloc(mBatch * seqUnitNumber * (mPackedKeyStride + mPackedValueStride) * sizeof(float));
+        if (nullptr == mPackedKV.first) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    mThreadBuffer = bufferAlloc->alloc(mThreadNumber * mThreadBufferStride * sizeof(float));
+    if (nullptr == mThreadBuffer.first) {
+        return OUT_OF_MEMORY;
+    }
+    if (!mKVCache) {
+        bufferAlloc->free(mPackedKV);
+    }
+    bufferAlloc->free(mThreadBuffer);
+    return NO_ERROR;
+}
+
+ErrorCode CPUAttention::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto core = static_cast<CPUBackend *>(backend())->functions();
+    int eP, lP, hP;
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const auto pack     = core->pack;
+    const auto queryPtr = inputs[0]->host<float>();
+    const auto keyPtr   = inputs[1]->host<float>();
+    const auto valuePtr = inputs[2]->host<float>();
+    const float* maskPtr = mMaskOffset.empty() ? nullptr : inputs[3]->host<float>();
+    auto outputPtr      = outputs[0]->host<float>();
+    const int L = mQueryLength, D = mHeadDim, Dv = mValueDim;
+    // Key before pastLength come from cache and are not masked
+    const int pastLength    = mKVCache ? mCache->pastLength : 0;
+    const int S             = pastLength + mKeyLength;
+    const int seqUnitNumber = UP_DIV(S, mSeqUnit);
+    const int kvStride      = (int)(mPackedKeyStride + mPackedValueStride);
+    auto threadBuffer = (float *)((uint8_t *)mThreadBuffer.first + mThreadBuffer.second);
+    const int threadNumber = mThreadNumber;
+    float* packedKV = nullptr;
+    // Packed unit index is b * batchStep + unit * unitStep
+    int batchStep = seqUnitNumber, unitStep = 1;
+    if (mKVCache) {
+        if (mMaxLength > 0 && S > mMaxLength) {
+            MNN_ERROR("Attention: kv cache length %d exceeds the limit %d\n", S, mMaxLength);
+            return INPUT_DATA_ERROR;
+        }
+        if (seqUnitNumber > mCache->units && !_allocCache(ALIMAX(seqUnitNumber, mCache->units * 2))) {
+            return OUT_OF_MEMORY;
+        }
+        _appendCache(keyPtr, valuePtr);
+        packedKV  = mCache->packed->host<float>();
+        batchStep = 1;
+        unitStep  = mBatch;
+    } else {
+        packedKV = (float *)((uint8_t *)mPackedKV.first + mPackedKV.second);
+        // Pack key as transposed B and value as B for each sequence unit
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            for (int index = (int)tId; index < mBatch * seqUnitNumber; index += threadNumber) {
+                int b = index / seqUnitNumber;
+                int s = (index % seqUnitNumber) * mSeqUnit;
+                int sCount = ALIMIN(mSeqUnit, S - s);
+                auto dst = packedKV + (size_t)index * kvStride;
+                core->MNNPackForMatMul_B(dst, keyPtr + ((size_t)b * S + s) * D, sCount, D, true);
+                core->MNNPackForMatMul_B(dst + mPackedKeyStride, valuePtr + ((size_t)b * S + s) * Dv, Dv, sCount, false);
+            }
+        }
+        MNN_CONCURRENCY_END();
+    }
+
+    const int queryUnitNumber = UP_DIV(L, eP);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto hUnit  = ALIMAX(hP, pack);
+        auto packC  = threadBuffer + tId * mThreadBufferStride;
+        auto qTile  = packC + _alignFloat(ALIMAX(UP_DIV(D, pack), UP_DIV(mSeqUnit, pack)) * eP * pack);
+        auto pTile  = qTile + _alignFloat(UP_DIV(D, lP) * eP * lP);
+        auto matC   = pTile + _alignFloat(UP_DIV(mSeqUnit, lP) * eP * lP);
+        auto qRow   = matC + _alignFloat(ALIMAX(UP_DIV(mSeqUnit, hUnit), UP_DIV(Dv, hUnit)) * hUnit * eP);
+        auto sRow   = qRow + _alignFloat(eP * D);
+        auto oRow   = sRow + _alignFloat(eP * mSeqUnit);
+        auto oAcc   = oRow + _alignFloat(eP * Dv);
+        auto rowMax = oAcc + _alignFloat(eP * Dv);
+        auto rowSum = rowMax + eP;
+        auto rowAlpha = rowSum + eP;
+        const float expOffset[2] = {1.0f, 0.0f};
+        size_t parameters[6];
+        parameters[3] = eP * pack * sizeof(float);
+        parameters[4] = 0;
+        parameters[5] = 0;
+        int32_t info[4];
+        int32_t el[4];
+        info[0] = 1;
+        info[1] = eP;
+        info[3] = 1;
+        el[2]   = 0;
+        el[3]   = 0;
+        for (int index = (int)tId; index < mBatch * queryUnitNumber; index += threadNumber) {
+            int b      = index / queryUnitNumber;
+            int l      = (index % queryUnitNumber) * eP;
+            int eCount = ALIMIN(eP, L - l);
+            info[2] = eCount;
+            el[0]   = eCount;
+            parameters[0] = eCount * sizeof(float);
+
+            // Scale query and pack it: [e, D] -> [D/pack, e, pack] -> tile
+            auto srcQuery = queryPtr + ((size_t)b * L + l) * D;
+            for (int i = 0; i < eCount * D; ++i) {
+                qRow[i] = srcQuery[i] * mRealScale;
+            }
+            int offset[] = {eCount, eP};
+            core->MNNPackCUnitTranspose(packC, qRow, eCount, D, offset);
+            el[1] = D;
+            const float* packCPtr = packC;
+            core->MNNPackC4ForMatMul_A(qTile, &packCPtr, info, el);
+
+            for (int i = 0; i < eCount; ++i) {
+                rowMax[i] = std::numeric_limits<float>::lowest();
+                rowSum[i] = 0.0f;
+            }
+            ::memset(oAcc, 0, eCount * Dv * sizeof(float));
+            for (int su = 0; su < seqUnitNumber; ++su) {
+                int s      = su * mSeqUnit;
+                int sCount = ALIMIN(mSeqUnit, S - s);
+                auto packedKey   = packedKV + ((size_t)b * batchStep + su * unitStep) * kvStride;
+                auto packedValue = packedKey + mPackedKeyStride;
+                int unpackOffset[] = {eP, eCount};
+
+                // score = query * key^T
+                parameters[1] = D;
+                parameters[2] = sCount;
+                if (eCount == eP) {
+                    core->MNNPackedMatMul(matC, qTile, packedKey, parameters, nullptr, nullptr);
+                } else {
+                    core->MNNPackedMatMulRemain(matC, qTile, packedKey, eCount, parameters, nullptr, nullptr);
+                }
+                core->MNNUnpackCUnitTranspose(sRow, matC, eCount, sCount, unpackOffset);
+
+                // Streaming softmax: rescale the previous result if the max value changes
+                for (int i = 0; i < eCount; ++i) {
+                    auto score = sRow + i * sCount;
+                    if (nullptr != maskPtr && s + sCount > pastLength) {
+                        auto mask = maskPtr + mMaskOffset[b] + (size_t)(l + i) * mKeyLength + s - pastLength;
+                        for (int j = ALIMAX(pastLength - s, 0); j < sCount; ++j) {
+                            score[j] += mask[j];
+                        }
+                    }
+                    float maxValue = rowMax[i];
+                    for (int j = 0; j < sCount; ++j) {
+                        maxValue = ALIMAX(maxValue, score[j]);
+                    }
+                    for (int j = 0; j < sCount; ++j) {
+                        score[j] -= maxValue;
+                    }
+                    MNNExp(score, score, expOffset, sCount);
+                    float sumValue = 0.0f;
+                    for (int j = 0; j < sCount; ++j) {
+                        sumValue += score[j];
+                    }
+                    rowAlpha[i] = expf(rowMax[i] - maxValue);
+                    rowSum[i]   = rowSum[i] * rowAlpha[i] + sumValue;
+                    rowMax[i]   = maxValue;
+                }
+
+                // output += probability * value
+                core->MNNPackCUnitTranspose(packC, sRow, eCount, sCount, offset);
+                el[1] = sCount;
+                core->MNNPackC4ForMatMul_A(pTile, &packCPtr, info, el);
+                parameters[1] = sCount;
+                parameters[2] = Dv;
+                if (eCount == eP) {
+                    core->MNNPackedMatMul(matC, pTile, packedValue, parameters, nullptr, nullptr);
+                } else {
+                    core->MNNPackedMatMulRemain(matC, pTile, packedValue, eCount, parameters, nullptr, nullptr);
+                }
+                core->MNNUnpackCUnitTranspose(oRow, matC, eCount, Dv, unpackOffset);
+                for (int i = 0; i < eCount; ++i) {
+                    auto acc   = oAcc + i * Dv;
+                    auto src   = oRow + i * Dv;
+                    auto alpha = rowAlpha[i];
+                    for (int j = 0; j < Dv; ++j) {
+                        acc[j] = acc[j] * alpha + src[j];
+                    }
+                }
+            }
+            for (int i = 0; i < eCount; ++i) {
+                auto dst = outputPtr + ((size_t)b * L + l + i) * Dv;
+                auto acc = oAcc + i * Dv;
+                auto scale = rowSum[i] > 0.0f ? 1.0f / rowSum[i] : 0.0f;
+                for (int j = 0; j < Dv; ++j) {
+                    dst[j] = acc[j] * scale;
+                }
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    if (mKVCache) {
+        mCache->pastLength = S;
+    }
+    return NO_ERROR;
+}
+
+class CPUAttentionCreator : public CPUBackend::Creator {
+public:
+    virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
+                                const MNN::Op *op, Backend *backend) const override {
+        auto core = static_cast<CPUBackend *>(backend)->functions();
+        if (core->bytes != 4) {
+            return nullptr;
+        }
+        for (auto t : inputs) {
+            if (t->getType().code != halide_type_float) {
+                return nullptr;
+            }
+        }
+        float scale  = 0.0f;
+        bool kvCache = false;
+        if (nullptr != op->main_as_AttentionParam()) {
+            scale   = op->main_as_AttentionParam()->scale();
+            kvCache = op->main_as_AttentionParam()->kvCache();
+        }
+        return new CPUAttention(backend, scale, kvCache);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUAttentionCreator, OpType_Attention);
+
+} // namespace MNN
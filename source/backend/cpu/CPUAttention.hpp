@@ -0,0 +1,72 @@
+//
+//  CPUAttention.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUAttention_hpp
+#define CPUAttention_hpp
+
+#include <memory>
+#include <vector>
+#include "core/Execution.hpp"
+
+namespace MNN {
+/**
+ * Fused softmax(query * key^T * scale + mask) * value.
+ * Query is split by eP rows and key / value by mSeqUnit rows, softmax is computed in a streaming way,
+ * so the [L, S] score matrix is never materialized.
+ * In kv cache mode, key / value are packed once into persistent buffers and the new ones are appended to them,
+ * so each execution only computes the new query rows against the whole cache.
+ */
+class CPUAttention : public Execution {
+public:
+    CPUAttention(Backend *backend, float scale, bool kvCache);
+    virtual ~CPUAttention() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual void onClearCache() override;
+    virtual void onShareCache(const Execution *src) override;
+
+private:
+    bool _allocCache(int units);
+    void _appendCache(const float *key, const float *value);
+
+    float mScale;
+    bool mKVCache;
+    float mRealScale = 1.0f;
+    int mBatch = 0;
+    int mQueryLength = 0;
+    int mKeyLength = 0;
+    int mHeadDim = 0;
+    int mValueDim = 0;
+    int mSeqUnit = 0;
+    int mThreadNumber = 1;
+    // Offset of mask for each batch, empty if no mask
+    std::vector<int> mMaskOffset;
+    // Packed key and value for each batch and each sequence unit
+    std::pair<void*, size_t> mPackedKV;
+    size_t mPackedKeyStride = 0;
+    size_t mPackedValueStride = 0;
+    // Key / value kept across executions in kv cache mode
+    struct KVCache {
+        // Packed key / value ordered by [unit, batch], and raw rows of the last unit for repacking
+        std::shared_ptr<Tensor> packed;
+        std::shared_ptr<Tensor> tail;
+        int units = 0;
+        int pastLength = 0;
+        // batch, head dim and value dim
+        std::vector<int> shape;
+    };
+    std::shared_ptr<KVCache> mCache;
+    // Max sequence length of cache, 0 means no limit
+    int mMaxLength = 0;
+    // Temp memory for each thread
+    std::pair<void*, size_t> mThreadBuffer;
+    size_t mThreadBufferStride = 0;
+};
+} // namespace MNN
+
+#endif /* CPUAttention_hpp */
@@ -13,6 +13,7 @@
 #include "core/BufferAllocator.hpp"
 #include "CPUTensorConvert.hpp"
 #include "compute/CommonOptFunction.h"
+#include "compute/ConvolutionTuner.hpp"
 #include "core/TensorUtils.hpp"
 #include "ThreadPool.hpp"
 #include "core/Concurrency.h"
@@ -45,6 +46,8 @@ void registerCPUOps();
 
 CPURuntime::CPURuntime(const Backend::Info& info) {
     mStaticAllocator.reset(new BufferAllocator(BufferAllocator::Allocator::createDefault()));
+    mDynamicPool.reset(new ConcurrentAllocator);
+    mConvTuner.reset(new ConvolutionTuner);
     mThreadNumber = info.numThread;
     mThreadNumber = std::max(1, mThreadNumber);
     mThreadNumber = std::min(mThreadNumber, MAX_THREAD_NUMBER);
@@ -92,8 +95,25 @@ CPURuntime:: ~ CPURuntime() {
 #endif
 }
 float CPURuntime::onGetMemoryInMB() {
-    auto staticMemoryInMB = mStaticAllocator->totalSize() / 1024.0f / 1024.0f;
-    return staticMemoryInMB;
+    size_t totalSize = 0;
+    {
+        std::lock_guard<std::mutex> _l(mStaticLock);
+        totalSize = mStaticAllocator->totalSize();
+    }
+    totalSize += mDynamicPool->totalSize();
+    return totalSize / 1024.0f / 1024.0f;
+}
+
+bool CPURuntime::onSetCache(const void* buffer, size_t size) {
+    if (nullptr == buffer) {
+        // Keep the measured decisions, they are still valid for the runtime
+        return false;
+    }
+    return mConvTuner->load(buffer, size);
+}
+
+std::pair<const void*, size_t> CPURuntime::onGetCache() {
+    return mConvTuner->save();
 }
 
 Backend* CPURuntime::onCreate(const BackendConfig* config) const {
@@ -145,7 +165,11 @@ int CPURuntime::onGetRuntimeStatus(RuntimeStatus statusEnum) const {
 }
 
 void CPURuntime::onGabageCollect(int level) {
-    mStaticAllocator->release(false);
+    {
+        std::lock_guard<std::mutex> _l(mStaticLock);
+        mStaticAllocator->release(false);
+    }
+    mDynamicPool->release();
 }
 std::map<OpType, CPUBackend::Creator*>* CPUBackend::gCreator = nullptr;
 void CPUBackend::initCreatorMap() {
@@ -164,8 +188,7 @@ bool CPUBackend::addCreator(OpType t, Creator* c) {
 
 CPUBackend::CPUBackend(const CPURuntime* runtime, BackendConfig::PrecisionMode precision, MNNForwardType type, size_t flags) : Backend(type) {
     mRuntime = runtime;
-    std::shared_ptr<BufferAllocator::Allocator> defaultAlloc(BufferAllocator::Allocator::createRecurse(runtime->mStaticAllocator.get()));
-    mDynamicAllocator.reset(new BufferAllocator(defaultAlloc));
+    mDynamicAllocator.reset(new BufferAllocator(runtime->mDynamicPool));
     mStaticAllocator = runtime->mStaticAllocator;
     mPrecisionMode = precision;
     mCoreFunctions = MNNGetCoreFunctions();
@@ -177,6 +200,29 @@ CPUBackend::~CPUBackend() {
     delete mCache;
 }
 
+void CPUBackend::onResizeBegin() {
+    mMemoryPlanReady = false;
+    if (mMemoryPlan) {
+        mDynamicAllocator->beginPlan();
+    }
+}
+
+void CPUBackend::onResizeEnd() {
+    if (mMemoryPlan) {
+        mMemoryPlanReady = mDynamicAllocator->endPlan();
+    }
+}
+
+bool CPUBackend::onSetMemoryPlan(bool enable) {
+    mMemoryPlan = enable;
+    return true;
+}
+
+bool CPUBackend::onSetTuning(bool enable) {
+    mConvTuning = enable;
+    return true;
+}
+
 void CPUBackend::onExecuteBegin() const {
 #ifdef MNN_USE_THREAD_POOL
     if (mRuntime->mTaskIndex >= 0 && mRuntime->mPower != BackendConfig::Power_High) {
@@ -198,12 +244,18 @@ void CPUBackend::onExecuteEnd() const {
 }
 class CPUMemObj : public Backend::MemObj {
 public:
-    CPUMemObj(BufferAllocator* allocator, std::pair<void*, int> points, int size) {
+    CPUMemObj(BufferAllocator* allocator, std::pair<void*, int> points, int size, std::mutex* lock = nullptr) {
         mPoint = std::move(points);
         mAllocator = allocator;
         mSize = size;
+        mLock = lock;
     }
     virtual ~ CPUMemObj() {
+        if (nullptr != mLock) {
+            std::lock_guard<std::mutex> _l(*mLock);
+            mAllocator->free(mPoint);
+            return;
+        }
         mAllocator->free(mPoint);
     }
     inline int getSize() const {
@@ -213,6 +265,7 @@ private:
     BufferAllocator* mAllocator;
     std::pair<void*, int> mPoint;
     int mSize;
+    std::mutex* mLock;
 };
 
 Backend::MemObj* CPUBackend::allocBuffer(int size, Tensor* dest, StorageType storageType) {
@@ -238,6 +291,7 @@ Backend::MemObj* CPUBackend::allocBuffer(int size, Tensor* dest, StorageType sto
     std::pair<void*, int> points;
     switch (storageType) {
         case STATIC: {
+            std::lock_guard<std::mutex> _l(mRuntime->mStaticLock);
             points = mStaticAllocator->alloc(size, false);
             break;
         }
@@ -259,7 +313,7 @@ Backend::MemObj* CPUBackend::allocBuffer(int size, Tensor* dest, StorageType sto
     }
     Backend::MemObj* res = nullptr;
     if (storageType == STATIC) {
-        res = new CPUMemObj(mStaticAllocator.get(), points, size);
+        res = new CPUMemObj(mStaticAllocator.get(), points, size, &mRuntime->mStaticLock);
     } else {
         res = new CPUMemObj(mDynamicAllocator.get(), points, size);
     }
@@ -283,7 +337,7 @@ static bool _supportQuant(const Op* op, const std::vector<Tensor*>& inputs, cons
     switch (otype) {
         case OpType_Convolution:
         case OpType_ConvolutionDepthwise:
-            if (op->main_as_Convolution2D() && op->main_as_Convolution2D()->weight() != nullptr) {
+            if (op->main_as_Convolution2D() && (op->main_as_Convolution2D()->weight() != nullptr || op->main_as_Convolution2D()->external() != nullptr)) {
                 return false;
             } else {
                 return true;
@@ -535,7 +589,7 @@ void CPUBackend::onCopyBuffer(const Tensor* srcTensor, const Tensor* dstTensor)
         MNN_ERROR("Input type not match session's tensor\n");
         return;
     }
-    auto code = CPUTensorConverter::convert(srcTensor, dstTensor);
+    auto code = CPUTensorConverter::convert(srcTensor, dstTensor, this);
     if (NO_ERROR != code) {
         MNN_ERROR("Error in CPUBackend::onCopyBuffer:convert\n");
     }
@@ -11,12 +11,15 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include "core/Backend.hpp"
 #include "core/Execution.hpp"
 #include "MNN_generated.h"
 
 namespace MNN {
 class BufferAllocator;
+class ConcurrentAllocator;
+class ConvolutionTuner;
 class CPURuntime : public Runtime {
 public:
     friend class CPUBackend;
@@ -29,8 +32,16 @@ public:
     virtual CompilerType onGetCompilerType() const override {
         return Compiler_Loop;
     }
+    virtual bool onSetCache(const void* buffer, size_t size) override;
+    virtual std::pair<const void*, size_t> onGetCache() override;
 private:
     std::shared_ptr<BufferAllocator> mStaticAllocator;
+    // Guard mStaticAllocator, which is shared by all backends of the runtime
+    mutable std::mutex mStaticLock;
+    // Dynamic memory of all backends is taken from and returned to this pool, so that sessions can share it
+    std::shared_ptr<ConcurrentAllocator> mDynamicPool;
+    // Measured convolution algorithms, shared by all backends of the runtime and kept in cache file
+    std::shared_ptr<ConvolutionTuner> mConvTuner;
     int mThreadNumber;
     int mTaskIndex;
     BackendConfig::MemoryMode mMemory;
@@ -62,6 +73,14 @@ public:
     virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                                 const MNN::Op* op) override;
 
+    virtual void onResizeBegin() override;
+    virtual void onResizeEnd() override;
+    virtual bool onSetMemoryPlan(bool enable) override;
+    virtual bool onMemoryPlanReady() const override {
+        return mMemoryPlanReady;
+    }
+    virtual bool onSetTuning(bool enable) override;
+
     virtual void onExecuteBegin() const override;
     virtual void onExecuteEnd() const override;
 
@@ -103,6 +122,16 @@ public:
     CPUResizeCache* getCache() const {
         return mCache;
     }
+    const CPURuntime* getRuntime() const {
+        return mRuntime;
+    }
+    ConvolutionTuner* getConvTuner() const {
+        return mRuntime->mConvTuner.get();
+    }
+    // Whether measure the algorithms of convolution not found in tuner
+    bool convTuning() const {
+        return mConvTuning;
+    }
 #ifdef MNN_USE_THREAD_POOL
     inline int taskIndex() const {return mRuntime->mTaskIndex;}
 #endif
@@ -121,6 +150,9 @@ private:
     static std::map<OpType, CPUBackend::Creator*>* gCreator;
     std::map<const Tensor*, const Tensor*> mCachedCastTensor;
     CPUResizeCache* mCache;
+    bool mMemoryPlan = false;
+    bool mMemoryPlanReady = false;
+    bool mConvTuning = false;
 };
 
 #define REGISTER_CPU_OP_CREATOR(name, opType)     \
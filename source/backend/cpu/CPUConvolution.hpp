@@ -40,15 +40,26 @@ public:
 };
 class CPUConvolution : public Execution {
 public:
+    // For weight-only quantized mWeight, which is dequantized by the gemm kernel
+    struct ResourceDequantizeInfo {
+        // 32 for float weight, 8 / 4 for int8 / int4 weight
+        int bits = 32;
+        // [2, outputCount aligned]: k and b of each output channel, weight = q * k + b
+        std::shared_ptr<Tensor> mScaleBias;
+    };
     struct Resource {
         std::shared_ptr<Tensor> mWeight;
         std::shared_ptr<Tensor> mBias;
+        ResourceDequantizeInfo dequantize;
         Backend* backend;
         bool copyBiasAlign(const float* bias, int outputCount);
         ~ Resource() {
             if (nullptr != mBias) {
                 backend->onReleaseBuffer(mBias.get(), Backend::STATIC);
             }
+            if (nullptr != dequantize.mScaleBias) {
+                backend->onReleaseBuffer(dequantize.mScaleBias.get(), Backend::STATIC);
+            }
             if (nullptr != mWeight) {
                 backend->onReleaseBuffer(mWeight.get(), Backend::STATIC);
             }
@@ -256,27 +256,23 @@ public:
             return new CPUConvolutionDepthwise::MultiInputFloatExecution(conv, backend);
         }
         const float* originWeight = nullptr;
-        size_t originWeightSize   = 0;
+        int originWeightSize      = 0;
+        const float* bias         = nullptr;
+        int biasSize              = 0;
         std::shared_ptr<ConvolutionCommon::Int8Common> quanCommon;
-        if (nullptr != conv2d->quanParameter()) {
-            quanCommon = ConvolutionCommon::load(conv2d->quanParameter(), true);
-            // Back to float
-            originWeight     = quanCommon->weightFloat.get();
-            originWeightSize = quanCommon->weightFloat.size();
-        }
-        if (nullptr == originWeight) {
-            originWeight     = conv2d->weight()->data();
-            originWeightSize = conv2d->weight()->size();
+        if (!ConvolutionCommon::getConvParameters(&quanCommon, backend, conv2d, &originWeight, &originWeightSize, &bias, &biasSize)) {
+            MNN_ERROR("Load weight failed for ConvolutionDepthwise: %s\n", op->name() ? op->name()->c_str() : "");
+            return nullptr;
         }
         if (inputs.empty()) {
-            return new CPUConvolutionDepthwise::FloatExecution(conv2d->common(), backend, originWeight, originWeightSize, conv2d->bias()->data(), conv2d->bias()->size());
+            return new CPUConvolutionDepthwise::FloatExecution(conv2d->common(), backend, originWeight, originWeightSize, bias, biasSize);
         }
         auto core = static_cast<CPUBackend*>(backend)->functions();
         if (conv->dilateX() == 1 && conv->dilateY() == 1 && conv->strideX() == 1 && conv->strideY() == 1 &&
             conv->kernelX() == 3 && conv->kernelY() == 3 && outputs[0]->width() >= 2 && outputs[0]->height() >= 2 && core->MNNMultiAndDestTransformCommon23 != nullptr) {
-            return new ConvolutionDepthwise3x3(conv, backend, originWeight, originWeightSize, conv2d->bias()->data(), conv2d->bias()->size());
+            return new ConvolutionDepthwise3x3(conv, backend, originWeight, originWeightSize, bias, biasSize);
         }
-        return new CPUConvolutionDepthwise::FloatExecution(conv2d->common(), backend, originWeight, originWeightSize, conv2d->bias()->data(), conv2d->bias()->size());
+        return new CPUConvolutionDepthwise::FloatExecution(conv2d->common(), backend, originWeight, originWeightSize, bias, biasSize);
     }
 };
 
@@ -11,6 +11,7 @@
 #include <string.h>
 #include <mutex>
 #include "core/Macro.h"
+#include "core/Concurrency.h"
 #ifdef MNN_USE_NEON
 #include <arm_neon.h>
 #endif
@@ -294,6 +295,11 @@ ErrorCode CPUImageProcess::onResize(const std::vector<Tensor *> &inputs, const s
         iw = input->width();
         ic = input->channel();
     }
+    auto cpuBn = nullptr != mThreadBackend ? mThreadBackend : static_cast<const CPUBackend*>(backend());
+    mThreadNumber = 1;
+    if (nullptr != cpuBn && !draw) {
+        mThreadNumber = cpuBn->threadNumber();
+    }
     if (draw) {
         blitter = choose(ic * inputs[0]->getType().bytes());
         return NO_ERROR;
@@ -317,11 +323,11 @@ ErrorCode CPUImageProcess::onResize(const std::vector<Tensor *> &inputs, const s
             return INPUT_DATA_ERROR;
         }
         if (backend()) {
-            cacheBuffer.reset(Tensor::createDevice<uint8_t>(std::vector<int>{4 * CACHE_SIZE}));
+            cacheBuffer.reset(Tensor::createDevice<uint8_t>(std::vector<int>{4 * CACHE_SIZE * mThreadNumber}));
             backend()->onAcquireBuffer(cacheBuffer.get(), Backend::DYNAMIC);
             samplerDest = cacheBuffer->host<uint8_t>();
         } else {
-            samplerBuffer.reset(new uint8_t[4 * CACHE_SIZE]);
+            samplerBuffer.reset(new uint8_t[4 * CACHE_SIZE * mThreadNumber]);
             samplerDest = samplerBuffer.get();
         }
     }
@@ -332,117 +338,139 @@ ErrorCode CPUImageProcess::onResize(const std::vector<Tensor *> &inputs, const s
             return INPUT_DATA_ERROR;
         }
         if (backend()) {
-            cacheBufferRGBA.reset(Tensor::createDevice<uint8_t>(std::vector<int>{4 * CACHE_SIZE}));
+            cacheBufferRGBA.reset(Tensor::createDevice<uint8_t>(std::vector<int>{4 * CACHE_SIZE * mThreadNumber}));
             backend()->onAcquireBuffer(cacheBufferRGBA.get(), Backend::DYNAMIC);
             blitDest = cacheBufferRGBA->host<uint8_t>();
         } else {
-            blitBuffer.reset(new uint8_t[4 * CACHE_SIZE]);
+            blitBuffer.reset(new uint8_t[4 * CACHE_SIZE * mThreadNumber]);
             blitDest = blitBuffer.get();
         }
     }
     return NO_ERROR;
 }
 
+void CPUImageProcess::blitTile(const uint8_t* source, uint8_t* dstY, int dy, int xStart, int count, int destBytes,
+                               uint8_t* samplerCache, uint8_t* blitCache) const {
+    auto dstStart = dstY + destBytes * oc * xStart;
+    if (!blitFloat) {
+        blitCache = dstStart;
+    }
+    if (!blitter) {
+        samplerCache = blitCache;
+    }
+
+    // Sample
+    if (!draw) {
+        // Compute position
+        CV::Point points[2];
+        points[0].fX = xStart;
+        points[0].fY = dy;
+
+        points[1].fX = xStart + count;
+        points[1].fY = dy;
+        transform.mapPoints(points, 2);
+        float deltaY = points[1].fY - points[0].fY;
+        float deltaX = points[1].fX - points[0].fX;
+
+        int sta = 0;
+        int end = count;
+
+        // FUNC_PRINT(sta);
+        if (wrap == WrapType_ZERO) {
+            // Clip: Cohen-Sutherland
+            auto clip    = _computeClip(points, iw, ih, transformInvert, xStart, count);
+            sta          = clip.first;
+            end          = clip.second;
+            points[0].fX = sta + xStart;
+            points[0].fY = dy;
+
+            transform.mapPoints(points, 1);
+            if (sta != 0 || end < count) {
+                if (ic > 0) {
+                    if (sta > 0) {
+                        ::memset(samplerCache, paddingValue, ic * sta);
+                    }
+                    if (end < count) {
+                        ::memset(samplerCache + end * ic, paddingValue, (count - end) * ic);
+                    }
+                } else {
+                    // TODO, Only support NV12 / NV21
+                    ::memset(samplerCache, paddingValue, count);
+                    ::memset(samplerCache + count, 128, UP_DIV(count, 2) * 2);
+                }
+            }
+        }
+        points[1].fX = (deltaX) / (float)(count);
+        points[1].fY = (deltaY) / (float)(count);
+
+        sampler(source, samplerCache, points, sta, end - sta, count, iw, ih, mStride);
+    }
+    // Convert format
+    if (blitter) {
+        blitter(samplerCache, blitCache, count);
+    }
+    // Turn float
+    if (blitFloat) {
+        blitFloat(blitCache, (float*)dstStart, mean, normal, count);
+    }
+}
+
 ErrorCode CPUImageProcess::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     if (0 == mStride) {
         mStride = iw * ic;
     }
     auto source = inputs[0]->host<uint8_t>();
-    void* dest = nullptr;
-    CV::Point points[2];
-    auto destBytes = dtype.bytes();
-    int tileCount = UP_DIV(ow, CACHE_SIZE);
-    const int* regions = nullptr;
     if (draw) {
         // change input to output
-        dest = source;
+        auto dest = source;
         oh = inputs[1]->length(0);
         ow = iw;
         oc = ic;
-        destBytes = inputs[0]->getType().bytes();
-        // draw one
-        tileCount = 1;
+        auto destBytes = inputs[0]->getType().bytes();
         // src is color
-        samplerDest = inputs[2]->host<uint8_t>();
-        // get region info ptr
-        regions = inputs[1]->host<int>();
-    } else {
-        dest = outputs[0]->host<void>();
-    }
-    for (int i = 0; i < oh; ++i) {
-        int dy = draw ? regions[3 * i] : i;
-        auto dstY = (uint8_t*)dest + dy * destBytes * ow * oc;
-        for (int tIndex = 0; tIndex < tileCount; ++tIndex) {
-            int xStart    = tIndex * CACHE_SIZE;
-            int count     = std::min(CACHE_SIZE, ow - xStart);
-            if (draw) {
-                xStart = regions[3 * i + 1];
-                count = regions[3 * i + 2] - xStart + 1;
-            }
-            auto dstStart = dstY + destBytes * oc * xStart;
-          
-            if (!blitFloat) {
-                blitDest = dstStart;
-            }
-            if (!blitter) {
-                samplerDest = blitDest;
-            }
-
-            // Sample
-            if (!draw) {
-                // Compute position
-                points[0].fX = xStart;
-                points[0].fY = dy;
-
-                points[1].fX = xStart + count;
-                points[1].fY = dy;
-                transform.mapPoints(points, 2);
-                float deltaY = points[1].fY - points[0].fY;
-                float deltaX = points[1].fX - points[0].fX;
-
-                int sta = 0;
-                int end = count;
-
-                // FUNC_PRINT(sta);
-                if (wrap == WrapType_ZERO) {
-                    // Clip: Cohen-Sutherland
-                    auto clip    = _computeClip(points, iw, ih, transformInvert, xStart, count);
-                    sta          = clip.first;
-                    end          = clip.second;
-                    points[0].fX = sta + xStart;
-                    points[0].fY = dy;
-
-                    transform.mapPoints(points, 1);
-                    if (sta != 0 || end < count) {
-                        if (ic > 0) {
-                            if (sta > 0) {
-                                ::memset(samplerDest, paddingValue, ic * sta);
-                            }
-                            if (end < count) {
-                                ::memset(samplerDest + end * ic, paddingValue, (count - end) * ic);
-                            }
-                        } else {
-                            // TODO, Only support NV12 / NV21
-                            ::memset(samplerDest, paddingValue, count);
-                            ::memset(samplerDest + count, 128, UP_DIV(count, 2) * 2);
-                        }
-                    }
-                }
-                points[1].fX = (deltaX) / (float)(count);
-                points[1].fY = (deltaY) / (float)(count);
-
-                sampler(source, samplerDest, points, sta, end - sta, count, iw, ih, mStride);
-            }
-            // Convert format
-            if (blitter) {
-                blitter(samplerDest, blitDest, count);
-            }
-            // Turn float
-            if (blitFloat) {
-                blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+        auto color = inputs[2]->host<uint8_t>();
+        // get region info ptr, regions may share the same row, so draw them in order
+        auto regions = inputs[1]->host<int>();
+        for (int i = 0; i < oh; ++i) {
+            int dy = regions[3 * i];
+            int xStart = regions[3 * i + 1];
+            int count = regions[3 * i + 2] - xStart + 1;
+            blitTile(source, dest + dy * destBytes * ow * oc, dy, xStart, count, destBytes, color, nullptr);
+        }
+        return NO_ERROR;
+    }
+    auto dest = outputs[0]->host<uint8_t>();
+    auto destBytes = dtype.bytes();
+    int tileCount = UP_DIV(ow, CACHE_SIZE);
+    // Each thread does a block of rows, sample / convert / normalize of one tile stay in its own cache
+    int numberThread = std::max(1, std::min(mThreadNumber, oh));
+    int step = UP_DIV(oh, numberThread);
+    auto function = [&](int tId) {
+        auto samplerCache = nullptr != samplerDest ? samplerDest + 4 * CACHE_SIZE * tId : nullptr;
+        auto blitCache = nullptr != blitDest ? blitDest + 4 * CACHE_SIZE * tId : nullptr;
+        int yEnd = std::min(oh, (tId + 1) * step);
+        for (int dy = tId * step; dy < yEnd; ++dy) {
+            auto dstY = dest + dy * destBytes * ow * oc;
+            for (int tIndex = 0; tIndex < tileCount; ++tIndex) {
+                int xStart = tIndex * CACHE_SIZE;
+                int count  = std::min(CACHE_SIZE, ow - xStart);
+                blitTile(source, dstY, dy, xStart, count, destBytes, samplerCache, blitCache);
             }
         }
+    };
+    if (numberThread <= 1) {
+        function(0);
+        return NO_ERROR;
     }
+#ifdef MNN_USE_THREAD_POOL
+    auto threadBn = nullptr != mThreadBackend ? mThreadBackend : static_cast<const CPUBackend*>(backend());
+    ThreadPool::TASK task = std::make_pair(function, numberThread);
+    ThreadPool::enqueue(std::move(task), threadBn->taskIndex(), threadBn->threadNumber());
+#else
+    for (int tId = 0; tId < numberThread; ++tId) {
+        function(tId);
+    }
+#endif
 
     return NO_ERROR;
 }
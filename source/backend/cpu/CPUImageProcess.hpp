@@ -9,6 +9,7 @@
 #ifndef CPUImageProcess_hpp
 #define CPUImageProcess_hpp
 
+#include <algorithm>
 #include <MNN/ImageProcess.hpp>
 #include "backend/cpu/CPUBackend.hpp"
 #include "compute/CommonOptFunction.h"
@@ -45,6 +46,10 @@ public:
     void setStride(int stride) {
         mStride = stride;
     }
+    // Split rows by the threads of bn when the execution has no backend, nullptr for single thread
+    void setThreadBackend(const CPUBackend* bn) {
+        mThreadBackend = bn;
+    }
     CPUImageProcess(Backend *bn, const ImageProcessParam* process) : Execution(bn) {
         coreFunctions = static_cast<CPUBackend*>(backend())->functions();
         draw = process->draw();
@@ -56,9 +61,17 @@ public:
         sourceFormat = process->sourceFormat();
         destFormat = process->destFormat();
         paddingValue = process->paddingValue();
-        for (int i = 0; i < 4; i++) {
-            mean[i] = process->mean()->Get(i);
-            normal[i] = process->normal()->Get(i);
+        if (nullptr != process->mean()) {
+            int size = std::min((int)process->mean()->size(), 4);
+            for (int i = 0; i < size; i++) {
+                mean[i] = process->mean()->Get(i);
+            }
+        }
+        if (nullptr != process->normal()) {
+            int size = std::min((int)process->normal()->size(), 4);
+            for (int i = 0; i < size; i++) {
+                normal[i] = process->normal()->Get(i);
+            }
         }
         for (int i = 0; i < process->transform()->size(); i++) {
             transform.set(i, process->transform()->Get(i));
@@ -72,6 +85,9 @@ private:
     BLITTER choose(int channelByteSize);
     BLIT_FLOAT choose(ImageFormatType format, int dstBpp = 0);
     SAMPLER choose(ImageFormatType format, FilterType type, bool identity);
+    // Sample, convert and normalize [xStart, xStart + count) of row dy, samplerCache / blitCache hold one tile
+    void blitTile(const uint8_t* source, uint8_t* dstY, int dy, int xStart, int count, int destBytes,
+                  uint8_t* samplerCache, uint8_t* blitCache) const;
 private:
     FilterType filterType;
     WrapType wrap;
@@ -91,6 +107,8 @@ private:
     const CoreFunctions* coreFunctions = nullptr;
     bool draw = false;
     int mStride = 0;
+    const CPUBackend* mThreadBackend = nullptr;
+    int mThreadNumber = 1;
 };
 }; // namespace MNN
 
@@ -0,0 +1,170 @@
+//
+//  CPULSTM.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPULSTM.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "backend/cpu/compute/RNNEngine.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+
+namespace MNN {
+
+CPULSTM::CPULSTM(Backend* backend, bool isRNN) : Execution(backend) {
+    mGateNumber = isRNN ? 1 : 4;
+    // W is [N * hiddenSize, inputSize], use transposeB
+    mMatMul.reset(new CPUMatMul(backend, false, true, true, true));
+}
+
+ErrorCode CPULSTM::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto X                 = inputs[0];
+    auto Y                 = outputs[0];
+    const int seqLength    = X->length(0);
+    const int batchSize    = X->length(1);
+    const int inputSize    = X->length(2);
+    const int hiddenSize   = Y->length(3);
+    const int gateSize     = mGateNumber * hiddenSize;
+    const int hiddenPack   = UP_DIV(hiddenSize, RNNEngine::UNIT) * RNNEngine::UNIT;
+    const int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    mInputGate.reset(Tensor::createDevice<float>({seqLength * batchSize, gateSize}));
+    mPackWeight.reset(Tensor::createDevice<float>({mGateNumber, hiddenPack * hiddenSize}));
+    mHiddenState.reset(Tensor::createDevice<float>({2, batchSize, hiddenSize}));
+    mCell.reset(Tensor::createDevice<float>({batchSize, hiddenSize}));
+    mThreadBuffer.reset(Tensor::createDevice<float>({threadNumber, mGateNumber * hiddenPack}));
+    std::vector<Tensor*> buffers = {mInputGate.get(), mPackWeight.get(), mHiddenState.get(), mCell.get(), mThreadBuffer.get()};
+    for (auto t : buffers) {
+        if (!backend()->onAcquireBuffer(t, Backend::DYNAMIC)) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    std::shared_ptr<Tensor> inputWrap(Tensor::createDevice<float>({seqLength * batchSize, inputSize}));
+    std::shared_ptr<Tensor> weight(Tensor::createDevice<float>({gateSize, inputSize}));
+    std::shared_ptr<Tensor> bias(Tensor::createDevice<float>({gateSize}));
+    auto code = mMatMul->onResize({inputWrap.get(), weight.get(), bias.get()}, {mInputGate.get()});
+    if (NO_ERROR != code) {
+        return code;
+    }
+    for (auto t : buffers) {
+        backend()->onReleaseBuffer(t, Backend::DYNAMIC);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CPULSTM::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto X                 = inputs[0];
+    auto Y                 = outputs[0];
+    const int seqLength    = X->length(0);
+    const int batchSize    = X->length(1);
+    const int inputSize    = X->length(2);
+    const int directions   = Y->length(1);
+    const int hiddenSize   = Y->length(3);
+    const int gateNumber   = mGateNumber;
+    const int gateSize     = gateNumber * hiddenSize;
+    const int stateSize    = batchSize * hiddenSize;
+    const int blocks       = UP_DIV(hiddenSize, RNNEngine::UNIT);
+    const int hiddenPack   = blocks * RNNEngine::UNIT;
+    const int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    const float* initHidden = inputs.size() > 4 ? inputs[4]->host<float>() : nullptr;
+    const float* initCell   = (inputs.size() > 5 && gateNumber > 1) ? inputs[5]->host<float>() : nullptr;
+    float* outputHidden     = outputs.size() > 1 ? outputs[1]->host<float>() : nullptr;
+    float* outputCell       = (outputs.size() > 2 && gateNumber > 1) ? outputs[2]->host<float>() : nullptr;
+    auto inputGatePtr    = mInputGate->host<float>();
+    auto packWeightPtr   = mPackWeight->host<float>();
+    auto cellPtr         = mCell->host<float>();
+    auto threadBufferPtr = mThreadBuffer->host<float>();
+    auto yPtr            = Y->host<float>();
+    for (int d = 0; d < directions; ++d) {
+        auto W = inputs[1]->host<float>() + d * gateSize * inputSize;
+        auto R = inputs[2]->host<float>() + d * gateSize * hiddenSize;
+        auto B = inputs[3]->host<float>() + d * gateSize;
+        mMatMul->execute(X->host<float>(), W, inputGatePtr, B);
+        for (int g = 0; g < gateNumber; ++g) {
+            RNNEngine::packHidden(packWeightPtr + g * hiddenPack * hiddenSize, R + g * hiddenSize * hiddenSize, hiddenSize, hiddenSize, hiddenSize, true);
+        }
+        auto hiddenPtr = mHiddenState->host<float>();
+        if (nullptr != initHidden) {
+            ::memcpy(hiddenPtr, initHidden + d * stateSize, stateSize * sizeof(float));
+        } else {
+            ::memset(hiddenPtr, 0, stateSize * sizeof(float));
+        }
+        if (nullptr != initCell) {
+            ::memcpy(cellPtr, initCell + d * stateSize, stateSize * sizeof(float));
+        } else {
+            ::memset(cellPtr, 0, stateSize * sizeof(float));
+        }
+        for (int s = 0; s < seqLength; ++s) {
+            const int t        = d > 0 ? seqLength - 1 - s : s;
+            const float* hPrev = hiddenPtr + (s % 2) * stateSize;
+            float* hNext       = hiddenPtr + ((s + 1) % 2) * stateSize;
+            float* yDst        = yPtr + (t * directions + d) * stateSize;
+            MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                auto gate = threadBufferPtr + tId * gateNumber * hiddenPack;
+                RNNEngine::divide((int)tId, threadNumber, batchSize, blocks, [&](int b, int blockStart, int blockEnd) {
+                    auto length    = (blockEnd - blockStart) * RNNEngine::UNIT;
+                    auto unit      = blockStart * RNNEngine::UNIT;
+                    auto count     = ALIMIN(hiddenSize, blockEnd * RNNEngine::UNIT) - unit;
+                    auto inputGate = inputGatePtr + (t * batchSize + b) * gateSize + unit;
+                    for (int g = 0; g < gateNumber; ++g) {
+                        auto dst = gate + g * length;
+                        RNNEngine::multiHidden(dst, hPrev + b * hiddenSize, packWeightPtr + g * hiddenPack * hiddenSize, hiddenSize, blockStart, blockEnd);
+                        auto src = inputGate + g * hiddenSize;
+                        for (int i = 0; i < count; ++i) {
+                            dst[i] += src[i];
+                        }
+                    }
+                    auto dst = hNext + b * hiddenSize + unit;
+                    if (1 == gateNumber) {
+                        MNNTanh(dst, gate, count);
+                    } else {
+                        // Gate order is I, O, F, C
+                        auto I = gate;
+                        auto O = gate + length;
+                        auto F = gate + 2 * length;
+                        auto C = gate + 3 * length;
+                        MNNSigmoid(gate, gate, 3 * length);
+                        MNNTanh(C, C, count);
+                        auto cell = cellPtr + b * hiddenSize + unit;
+                        for (int i = 0; i < count; ++i) {
+                            cell[i] = I[i] * C[i] + F[i] * cell[i];
+                        }
+                        MNNTanh(C, cell, count);
+                        for (int i = 0; i < count; ++i) {
+                            dst[i] = O[i] * C[i];
+                        }
+                    }
+                    ::memcpy(yDst + b * hiddenSize + unit, dst, count * sizeof(float));
+                });
+            }
+            MNN_CONCURRENCY_END();
+        }
+        if (nullptr != outputHidden) {
+            ::memcpy(outputHidden + d * stateSize, hiddenPtr + (seqLength % 2) * stateSize, stateSize * sizeof(float));
+        }
+        if (nullptr != outputCell) {
+            ::memcpy(outputCell + d * stateSize, cellPtr, stateSize * sizeof(float));
+        }
+    }
+    return NO_ERROR;
+}
+
+class CPULSTMCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        // Only Onnx's LSTM is computed by execution, others are decomposed by GeometryLSTM
+        if (inputs.size() < 4) {
+            return nullptr;
+        }
+        return new CPULSTM(backend, op->type() == OpType_RNN);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPULSTMCreator, OpType_LSTM);
+REGISTER_CPU_OP_CREATOR(CPULSTMCreator, OpType_RNN);
+
+} // namespace MNN
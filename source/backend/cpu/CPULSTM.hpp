@@ -0,0 +1,39 @@
+//
+//  CPULSTM.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPULSTM_hpp
+#define CPULSTM_hpp
+
+#include "core/Execution.hpp"
+#include "backend/cpu/CPUMatMul.hpp"
+
+namespace MNN {
+// Onnx's LSTM / RNN: X, W, R, B, [initial_h, initial_c] -> Y, Y_h, [Y_c]
+class CPULSTM : public Execution {
+public:
+    CPULSTM(Backend *backend, bool isRNN);
+    virtual ~CPULSTM() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    // RNN has only one gate: Y = tanh(X * W + H * R + B), LSTM has I, O, F, C
+    int mGateNumber;
+    // Input projection of all timesteps: X * W^T + B
+    std::shared_ptr<CPUMatMul> mMatMul;
+    std::shared_ptr<Tensor> mInputGate;
+    // Packed R of each gate
+    std::shared_ptr<Tensor> mPackWeight;
+    // Double buffer of h_t-1 and h_t
+    std::shared_ptr<Tensor> mHiddenState;
+    std::shared_ptr<Tensor> mCell;
+    std::shared_ptr<Tensor> mThreadBuffer;
+};
+} // namespace MNN
+
+#endif /* CPULSTM_hpp */
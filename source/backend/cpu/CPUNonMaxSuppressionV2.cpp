@@ -14,9 +14,12 @@
 
 #include "backend/cpu/CPUNonMaxSuppressionV2.hpp"
 #include <math.h>
-#include <queue>
+#include <algorithm>
+#include <limits>
 #include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
 #include "core/Macro.h"
+#include "math/Vec.hpp"
 
 namespace MNN {
 
@@ -24,86 +27,164 @@ CPUNonMaxSuppressionV2::CPUNonMaxSuppressionV2(Backend* backend, const Op* op) :
     // nothing to do
 }
 
-// Return intersection-over-union overlap between boxes i and j
-static inline float IOU(const float* boxes, int i, int j) {
-    const float yMinI = std::min<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float xMinI = std::min<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float yMaxI = std::max<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float xMaxI = std::max<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float yMinJ = std::min<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float xMinJ = std::min<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float yMaxJ = std::max<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float xMaxJ = std::max<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float areaI = (yMaxI - yMinI) * (xMaxI - xMinI);
-    const float areaJ = (yMaxJ - yMinJ) * (xMaxJ - xMinJ);
-    if (areaI <= 0 || areaJ <= 0)
-        return 0.0;
-    const float intersectionYMin = std::max<float>(yMinI, yMinJ);
-    const float intersectionXMin = std::max<float>(xMinI, xMinJ);
-    const float intersectionYMax = std::min<float>(yMaxI, yMaxJ);
-    const float intersectionXMax = std::min<float>(xMaxI, xMaxJ);
-    const float intersectionArea = std::max<float>(intersectionYMax - intersectionYMin, 0.0) *
-                                   std::max<float>(intersectionXMax - intersectionXMin, 0.0);
-    return intersectionArea / (areaI + areaJ - intersectionArea);
+// Selected boxes in SoA layout, so that one candidate can be checked with several selected boxes at once
+struct NMSSelectedBoxes {
+    std::vector<float> yMin;
+    std::vector<float> xMin;
+    std::vector<float> yMax;
+    std::vector<float> xMax;
+    std::vector<float> area;
+    int size = 0;
+    NMSSelectedBoxes(int number) {
+        yMin.resize(number);
+        xMin.resize(number);
+        yMax.resize(number);
+        xMax.resize(number);
+        area.resize(number);
+    }
+    void push(const float* box) {
+        yMin[size] = box[0];
+        xMin[size] = box[1];
+        yMax[size] = box[2];
+        xMax[size] = box[3];
+        area[size] = box[4];
+        size++;
+    }
+};
+
+// Sort corners and compute area: [ymin, xmin, ymax, xmax, area]
+static inline void _normalizeBox(const float* src, float* dst) {
+    const float yMin = std::min<float>(src[0], src[2]);
+    const float xMin = std::min<float>(src[1], src[3]);
+    const float yMax = std::max<float>(src[0], src[2]);
+    const float xMax = std::max<float>(src[1], src[3]);
+    const float area = (yMax - yMin) * (xMax - xMin);
+    if (area <= 0) {
+        // Empty box has no overlap with any box, make intersection always be zero
+        dst[0] = std::numeric_limits<float>::max();
+        dst[1] = std::numeric_limits<float>::max();
+        dst[2] = std::numeric_limits<float>::lowest();
+        dst[3] = std::numeric_limits<float>::lowest();
+        dst[4] = 0.0f;
+        return;
+    }
+    dst[0] = yMin;
+    dst[1] = xMin;
+    dst[2] = yMax;
+    dst[3] = xMax;
+    dst[4] = area;
 }
 
-void NonMaxSuppressionSingleClasssImpl(const Tensor* decodedBoxes, const float* scores, int maxDetections,
-                                       float iouThreshold, float scoreThreshold, std::vector<int32_t>* selected) {
-    MNN_ASSERT(iouThreshold >= 0.0f && iouThreshold <= 1.0f);
-    MNN_ASSERT(decodedBoxes->dimensions() == 2);
-    const int numBoxes = decodedBoxes->length(0);
-    MNN_ASSERT(decodedBoxes->length(1) == 4)
+// Return true if iou(box, selected[j]) > iouThreshold for any j in [begin, end)
+static bool _isSuppressed(const NMSSelectedBoxes& selected, int begin, int end, const float* box, float iouThreshold) {
+    if (box[4] <= 0.0f) {
+        return false;
+    }
+    using Vec4 = Math::Vec<float, 4>;
+    const Vec4 yMinI(box[0]), xMinI(box[1]), yMaxI(box[2]), xMaxI(box[3]), areaI(box[4]);
+    const Vec4 threshold(iouThreshold), zero(0.0f);
+    float diffs[4];
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        auto height = Vec4::max(Vec4::min(yMaxI, Vec4::load(selected.yMax.data() + j)) - Vec4::max(yMinI, Vec4::load(selected.yMin.data() + j)), zero);
+        auto width  = Vec4::max(Vec4::min(xMaxI, Vec4::load(selected.xMax.data() + j)) - Vec4::max(xMinI, Vec4::load(selected.xMin.data() + j)), zero);
+        auto inter  = height * width;
+        // inter / union > threshold  <=>  inter - union * threshold > 0
+        auto diff   = inter - (areaI + Vec4::load(selected.area.data() + j) - inter) * threshold;
+        Vec4::save(diffs, diff);
+        if (diffs[0] > 0.0f || diffs[1] > 0.0f || diffs[2] > 0.0f || diffs[3] > 0.0f) {
+            return true;
+        }
+    }
+    for (; j < end; ++j) {
+        const float height = std::max<float>(std::min<float>(box[2], selected.yMax[j]) - std::max<float>(box[0], selected.yMin[j]), 0.0f);
+        const float width  = std::max<float>(std::min<float>(box[3], selected.xMax[j]) - std::max<float>(box[1], selected.xMin[j]), 0.0f);
+        const float inter  = height * width;
+        if (inter - (box[4] + selected.area[j] - inter) * iouThreshold > 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
 
+void NonMaxSuppressionSingleClasssImpl(const float* boxes, const float* scores, int numBoxes, int maxDetections,
+                                       float iouThreshold, float scoreThreshold, std::vector<int32_t>* selected,
+                                       const NMSParallelFunction* parallel, int threadNumber) {
+    MNN_ASSERT(iouThreshold >= 0.0f && iouThreshold <= 1.0f);
     const int outputNum = std::min(maxDetections, numBoxes);
-    std::vector<float> scoresData(numBoxes);
-    std::copy_n(scores, numBoxes, scoresData.begin());
-
+    if (outputNum <= 0) {
+        return;
+    }
     struct Candidate {
-        int boxIndex;
         float score;
+        int boxIndex;
     };
-
-    auto cmp = [](const Candidate bsI, const Candidate bsJ) { return bsI.score < bsJ.score; };
-
-    std::priority_queue<Candidate, std::deque<Candidate>, decltype(cmp)> candidatePriorityQueue(cmp);
-
-    for (int i = 0; i < scoresData.size(); ++i) {
-        if (scoresData[i] > scoreThreshold) {
-            candidatePriorityQueue.emplace(Candidate({i, scoresData[i]}));
+    std::vector<Candidate> candidates;
+    candidates.reserve(numBoxes);
+    for (int i = 0; i < numBoxes; ++i) {
+        if (scores[i] > scoreThreshold) {
+            candidates.emplace_back(Candidate({scores[i], i}));
         }
     }
+    auto cmp = [](const Candidate& bsI, const Candidate& bsJ) {
+        return bsI.score > bsJ.score || (bsI.score == bsJ.score && bsI.boxIndex < bsJ.boxIndex);
+    };
 
-    // std::vector<float> selectedScores;
-    Candidate nextCandidate;
-    float iou, originalScore;
-
-    const auto boxesPtr = decodedBoxes->host<float>();
-    while (selected->size() < outputNum && !candidatePriorityQueue.empty()) {
-        nextCandidate = candidatePriorityQueue.top();
-        originalScore = nextCandidate.score;
-        candidatePriorityQueue.pop();
-
-        // Overlapping boxes are likely to have similar scores,
-        // therefore we iterate through the previously selected boxes backwards
-        // in order to see if `next_candidate` should be suppressed.
-        bool shouldSelect = true;
-        for (int j = (int)selected->size() - 1; j >= 0; --j) {
-            iou = IOU(boxesPtr, nextCandidate.boxIndex, selected->at(j));
-            if (iou == 0.0) {
+    NMSSelectedBoxes selectedBoxes(outputNum);
+    std::vector<float> blockBoxes;
+    std::vector<uint8_t> suppressed;
+    const int candidateNum = (int)candidates.size();
+    // Most candidates are dropped after the first block when maxDetections is small, so sort only what is needed
+    int blockSize = std::max(64, outputNum * 2);
+    int blockStart = 0;
+    while (blockStart < candidateNum && selectedBoxes.size < outputNum) {
+        const int blockEnd = std::min(candidateNum, blockStart + blockSize);
+        const int blockNum = blockEnd - blockStart;
+        std::partial_sort(candidates.begin() + blockStart, candidates.begin() + blockEnd, candidates.end(), cmp);
+        blockBoxes.resize(blockNum * 5);
+        suppressed.resize(blockNum);
+        for (int i = 0; i < blockNum; ++i) {
+            _normalizeBox(boxes + 4 * candidates[blockStart + i].boxIndex, blockBoxes.data() + 5 * i);
+        }
+        // Check the block against the boxes selected by previous blocks, candidates are independent here
+        const int selectedBefore = selectedBoxes.size;
+        auto checkFunction = [&](int tId, int taskNumber) {
+            for (int i = tId; i < blockNum; i += taskNumber) {
+                suppressed[i] = _isSuppressed(selectedBoxes, 0, selectedBefore, blockBoxes.data() + 5 * i, iouThreshold) ? 1 : 0;
+            }
+        };
+        const int taskNumber = std::min(threadNumber, blockNum);
+        if (nullptr != parallel && taskNumber > 1 && selectedBefore > 0) {
+            (*parallel)([&](int tId) { checkFunction(tId, taskNumber); }, taskNumber);
+        } else {
+            checkFunction(0, 1);
+        }
+        // Resolve the remaining candidates in score order with the boxes selected in this block
+        for (int i = 0; i < blockNum && selectedBoxes.size < outputNum; ++i) {
+            if (suppressed[i]) {
                 continue;
             }
-            if (iou > iouThreshold) {
-                shouldSelect = false;
+            auto box = blockBoxes.data() + 5 * i;
+            if (_isSuppressed(selectedBoxes, selectedBefore, selectedBoxes.size, box, iouThreshold)) {
+                continue;
             }
+            selectedBoxes.push(box);
+            selected->push_back(candidates[blockStart + i].boxIndex);
         }
-
-        if (shouldSelect) {
-            selected->push_back(nextCandidate.boxIndex);
-            // selectedScores.push_back(nextCandidate.score);
-        }
+        blockStart = blockEnd;
+        blockSize *= 2;
     }
 }
 
+void NonMaxSuppressionSingleClasssImpl(const Tensor* decodedBoxes, const float* scores, int maxDetections,
+                                       float iouThreshold, float scoreThreshold, std::vector<int32_t>* selected) {
+    MNN_ASSERT(decodedBoxes->dimensions() == 2);
+    const int numBoxes = decodedBoxes->length(0);
+    MNN_ASSERT(decodedBoxes->length(1) == 4)
+    NonMaxSuppressionSingleClasssImpl(decodedBoxes->host<float>(), scores, numBoxes, maxDetections, iouThreshold,
+                                      scoreThreshold, selected);
+}
+
 ErrorCode CPUNonMaxSuppressionV2::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
     std::vector<int> selected;
     const int maxDetections    = inputs[2]->host<int32_t>()[0];
@@ -115,7 +196,16 @@ ErrorCode CPUNonMaxSuppressionV2::onExecute(const std::vector<Tensor*>& inputs,
         scoreThreshold = inputs[4]->host<float>()[0];
     }
     const auto scores          = inputs[1]->host<float>();
-    NonMaxSuppressionSingleClasssImpl(inputs[0], scores, maxDetections, iouThreshold, scoreThreshold, &selected);
+    const int numBoxes         = inputs[0]->length(0);
+    const int threadNumber     = static_cast<CPUBackend*>(backend())->threadNumber();
+    NMSParallelFunction parallel = [this](const std::function<void(int)>& function, int number) {
+        MNN_CONCURRENCY_BEGIN(tId, number) {
+            function((int)tId);
+        }
+        MNN_CONCURRENCY_END();
+    };
+    NonMaxSuppressionSingleClasssImpl(inputs[0]->host<float>(), scores, numBoxes, maxDetections, iouThreshold,
+                                      scoreThreshold, &selected, &parallel, threadNumber);
     std::copy_n(selected.begin(), selected.size(), outputs[0]->host<int32_t>());
     for (int i = selected.size(); i < outputs[0]->elementSize(); i++) {
         outputs[0]->host<int32_t>()[i] = -1;
@@ -9,6 +9,7 @@
 #ifndef CPUNonMaxSuppressionV2_hpp
 #define CPUNonMaxSuppressionV2_hpp
 
+#include <functional>
 #include "core/Execution.hpp"
 
 namespace MNN {
@@ -24,6 +25,28 @@ namespace MNN {
  */
 void NonMaxSuppressionSingleClasssImpl(const Tensor* decodedBoxes, const float* scores, int maxDetections, float iouThreshold, float scoreThreshold, std::vector<int>* selected);
 
+/**
+ * @brief run task(tId) for tId in [0, number), the tasks can be executed in parallel
+ */
+typedef std::function<void(const std::function<void(int)>& task, int number)> NMSParallelFunction;
+
+/**
+ * @brief apply non_max_suppression, output the selected boxes index, the result is the same as greedy nms.
+ *        candidates are sorted block by block, and each block is checked against selected boxes in parallel.
+ * @param boxes : float*, length is [numBoxes * 4], where 4 represent [ymin, xmin, ymax, xmax]
+ * @param scores : float*, length is [numBoxes]
+ * @param numBoxes : int
+ * @param maxDetections : int output maxDetections boxes
+ * @param iouThreshold : float
+ * @param scoreThreshold : float
+ * @param selected : std::vector<int32_t>*
+ * @param parallel : used to split the suppression check, nullptr means single thread
+ * @param threadNumber : max number of tasks for parallel
+ */
+MNN_PUBLIC void NonMaxSuppressionSingleClasssImpl(const float* boxes, const float* scores, int numBoxes, int maxDetections,
+                                                  float iouThreshold, float scoreThreshold, std::vector<int32_t>* selected,
+                                                  const NMSParallelFunction* parallel = nullptr, int threadNumber = 1);
+
 
 class CPUNonMaxSuppressionV2 : public Execution {
 public:
@@ -58,6 +58,8 @@ extern void ___CPUQuantizedAvgPoolCreator__OpType_QuantizedAvgPool__();
 extern void ___ConvolutionFactory__OpType_Convolution__();
 extern void ___CPUConvInt8Creator__OpType_ConvInt8__();
 extern void ___CPURNNSequenceGRUCreator__OpType_RNNSequenceGRU__();
+extern void ___CPULSTMCreator__OpType_LSTM__();
+extern void ___CPULSTMCreator__OpType_RNN__();
 extern void ___CPUEltwiseCreator__OpType_Eltwise__();
 extern void ___CPURandomCreator__OpType_RandomUniform__();
 extern void ___CPURandomCreator__OpType_RandomNormal__();
@@ -65,6 +67,7 @@ extern void ___CPUSetDiff1DCreator__OpType_SetDiff1D__();
 extern void ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 extern void ___CPUSvdCreator__OpType_Svd__();
 extern void ___CPULayerNormCreator__OpType_LayerNorm__();
+extern void ___CPUAttentionCreator__OpType_Attention__();
 
 void registerCPUOps() {
 ___CPUCropAndResizeCreator__OpType_CropAndResize__();
@@ -125,6 +128,8 @@ ___CPUQuantizedAvgPoolCreator__OpType_QuantizedAvgPool__();
 ___ConvolutionFactory__OpType_Convolution__();
 ___CPUConvInt8Creator__OpType_ConvInt8__();
 ___CPURNNSequenceGRUCreator__OpType_RNNSequenceGRU__();
+___CPULSTMCreator__OpType_LSTM__();
+___CPULSTMCreator__OpType_RNN__();
 ___CPUEltwiseCreator__OpType_Eltwise__();
 ___CPURandomCreator__OpType_RandomUniform__();
 ___CPURandomCreator__OpType_RandomNormal__();
@@ -132,5 +137,6 @@ ___CPUSetDiff1DCreator__OpType_SetDiff1D__();
 ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 ___CPUSvdCreator__OpType_Svd__();
 ___CPULayerNormCreator__OpType_LayerNorm__();
+___CPUAttentionCreator__OpType_Attention__();
 }
 }
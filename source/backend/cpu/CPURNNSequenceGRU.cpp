@@ -9,121 +9,21 @@
 #include "backend/cpu/CPURNNSequenceGRU.hpp"
 #include <math.h>
 #include "backend/cpu/CPUBackend.hpp"
-#include "backend/cpu/compute/ConvOpt.h"
-#include "math/Matrix.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "backend/cpu/compute/RNNEngine.hpp"
+#include "core/Concurrency.h"
 #include "core/TensorUtils.hpp"
 
 namespace MNN {
 
-static inline float sigmoid(float x) {
-    return 1. / (1. + expf(-x));
-}
-
-static inline void ArrayProduct(float* C, float* A, float* B, const int length) {
-    int numUnit4 = length >> 2;
-    if (numUnit4 > 0) {
-        MNNMatrixProd(C, A, B, numUnit4, 0, 0, 0, 1);
-    }
-    for (int i = numUnit4 << 2; i < length; i++) {
-        C[i] = A[i] * B[i];
-    }
-    return;
-}
-
-static inline void ArrayAdd(float* C, float* A, float* B, const int length) {
-    int numUnit4 = length >> 2;
-    if (numUnit4 > 0) {
-        MNNMatrixAdd(C, A, B, numUnit4, 0, 0, 0, 1);
-    }
-    for (int i = numUnit4 << 2; i < length; i++) {
-        C[i] = A[i] + B[i];
-    }
-    return;
-}
-
-// implement GRU cell function
-// Ref: tensorflow/python/ops/rnn_cell_impl.py
-static void runRNNStep(const float* input, const int inputLength, const bool linearBeforeReset,
-                       std::shared_ptr<Tensor>& hiddenState, const int numUnits, Tensor* gateWeight, Tensor* gateBias,
-                       Tensor* candidateWeight, Tensor* candidateBias, Tensor* recurrentBias,
-                       std::shared_ptr<Tensor>& inputAndState, std::shared_ptr<Tensor>& gate,
-                       std::shared_ptr<Tensor>& resetHt) {
-    // gate is (z_t, r_t)
-    auto inputAndStatePtr = inputAndState->host<float>();
-    auto hiddenStatePtr   = hiddenState->host<float>();
-    ::memcpy(inputAndStatePtr, input, inputLength * sizeof(float));
-    ::memcpy(inputAndStatePtr + inputLength, hiddenStatePtr, numUnits * sizeof(float));
-    inputAndState->setLength(1, inputLength + numUnits);
-    // to be fused
-    // // [x_t, h_t-1] * [W_zr, R_zr]: (1, inputLength + numUnits) X (inputLength + numUnits, 2 * numUnits)
-    Math::Matrix::multi(gate.get(), inputAndState.get(), gateWeight);
-    Math::Matrix::add(gate.get(), gate.get(), gateBias);
-
-    recurrentBias->setLength(1, 2 * numUnits);
-    Math::Matrix::add(gate.get(), gate.get(), recurrentBias);
-    // (1, 2*numUnits)
-    const int gateSize = gate->elementSize();
-    auto gatePtr       = gate->host<float>();
-    for (int i = 0; i < gateSize; ++i) {
-        gatePtr[i] = sigmoid(gatePtr[i]);
-    }
-    // reset gate, // r_t is the second segment
-    auto rtPtr = gatePtr + numUnits;
-
-    if (linearBeforeReset) {
-        // calculate Rt (.) (Ht_1 * Rh + Rbh)
-        auto recurrentHiddenBiasPtr = recurrentBias->host<float>() + 2 * numUnits;
-        auto rhWeightPtr = candidateWeight->host<float>() + inputLength * numUnits;
-        Tensor* rhWeight = Tensor::create({numUnits, numUnits}, candidateWeight->getType(), (void*)(rhWeightPtr), TensorUtils::getDimType(candidateWeight));
-        Math::Matrix::multi(resetHt.get(), hiddenState.get(), rhWeight);
-        ArrayAdd(resetHt->host<float>(), resetHt->host<float>(), recurrentHiddenBiasPtr, numUnits),
-        ArrayProduct(resetHt->host<float>(), rtPtr, resetHt->host<float>(), numUnits);
-
-        // calculate Xt * Wh
-        Tensor* XtWhTensor = Tensor::create({1, numUnits}, inputAndState->getType(), (void*)(inputAndStatePtr + inputLength + numUnits), TensorUtils::getDimType(inputAndState.get()));
-        Tensor* inputTensor = Tensor::create({1, inputLength}, inputAndState->getType(), (void*)(input), TensorUtils::getDimType(inputAndState.get()));
-        candidateWeight->setLength(0, inputLength);
-        Math::Matrix::multi(XtWhTensor, inputTensor, candidateWeight);
-        // sum 3 parts
-        ArrayAdd(resetHt->host<float>(), resetHt->host<float>(), XtWhTensor->host<float>(), numUnits);
-        ArrayAdd(rtPtr, resetHt->host<float>(), candidateBias->host<float>(), numUnits),
-        candidateWeight->setLength(0, inputLength + numUnits);
-
-        // release wrapper
-        delete rhWeight;
-        delete XtWhTensor;
-        delete inputTensor;
-    } else {
-        // r_t: (1, numUnits)
-        auto resetGatePtr = inputAndStatePtr + inputLength;
-        // h_t1(1, numUnits) = r_t(1, numUnits) * h_t-1_(1, numUnits)
-        ArrayProduct(resetGatePtr, rtPtr, hiddenStatePtr, numUnits);
-        // deal with recurrent bias and linear_before_reset parameter
-        auto recurrentBiasAddedPtr = inputAndStatePtr + inputLength + numUnits;
-        auto recurrentHiddenBiasPtr = recurrentBias->host<float>() + 2 * numUnits;
-
-        ArrayAdd(recurrentBiasAddedPtr, recurrentHiddenBiasPtr, candidateBias->host<float>(), numUnits);
-        // [x_t, h_t1](1, inputLength + numUnits) * candidateWeight_(inputLength + numUnits, numUnits)
-        Math::Matrix::multi(resetHt.get(), inputAndState.get(), candidateWeight);
-        // reuse r_t memory as h_t'
-        ArrayAdd(rtPtr, resetHt->host<float>(), recurrentBiasAddedPtr, numUnits);
-    }
-
-    for (int i = 0; i < numUnits; ++i) {
-        hiddenStatePtr[i] =
-            (1 - gatePtr[i]) * tanhf(rtPtr[i]) + gatePtr[i] * hiddenStatePtr[i];
-    }
-
-    inputAndState->setLength(1, inputLength + 2 * numUnits);
-}
-
 CPURNNSequenceGRU::CPURNNSequenceGRU(const Op* op, Backend* backend) : MNN::Execution(backend) {
     auto rnnParam       = op->main_as_RNNParam();
     mKeepAllOutputs     = rnnParam->keepAllOutputs();
     mIsBidirectionalRNN = rnnParam->isBidirectionalRNN();
     mNumUnits           = rnnParam->numUnits();
     mlinearBeforeReset  = rnnParam->linearBeforeReset();
-
+    mGateMatMul.reset(new CPUMatMul(backend, false, false, true, true));
+    mCandidateMatMul.reset(new CPUMatMul(backend, false, false, true, true));
 }
 
 CPURNNSequenceGRU::~CPURNNSequenceGRU() {
@@ -133,121 +33,202 @@ CPURNNSequenceGRU::~CPURNNSequenceGRU() {
 ErrorCode CPURNNSequenceGRU::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
     MNN_ASSERT(1 + 5 * (mIsBidirectionalRNN + 1) <= inputs.size());
     auto input                 = inputs[0];
+    const int seqLength        = input->length(0);
+    const int batchSize        = input->length(1);
     const int inputLastDimSize = input->length(2);
-    mHiddenState.reset(Tensor::createDevice<float>(std::vector<int>{1, mNumUnits}));
-    mInputAndState.reset(Tensor::createDevice<float>(std::vector<int>{1, inputLastDimSize + mNumUnits + mNumUnits}));
-    mGate.reset(Tensor::createDevice<float>(std::vector<int>{1, 2 * mNumUnits}));
-    mResetHt.reset(Tensor::createDevice<float>(std::vector<int>{1, mNumUnits}));
-
-    backend()->onAcquireBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mGate.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mResetHt.get(), Backend::DYNAMIC);
-
-    backend()->onReleaseBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mGate.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mResetHt.get(), Backend::DYNAMIC);
-
+    const int hiddenPack       = UP_DIV(mNumUnits, RNNEngine::UNIT) * RNNEngine::UNIT;
+    const int threadNumber     = static_cast<CPUBackend*>(backend())->threadNumber();
+    mInputGate.reset(Tensor::createDevice<float>({seqLength * batchSize, 2 * mNumUnits}));
+    mInputCandidate.reset(Tensor::createDevice<float>({seqLength * batchSize, mNumUnits}));
+    mBias.reset(Tensor::createDevice<float>({4 * mNumUnits}));
+    mPackWeight.reset(Tensor::createDevice<float>({3, hiddenPack * mNumUnits}));
+    mHiddenState.reset(Tensor::createDevice<float>({2, batchSize, mNumUnits}));
+    mResetHt.reset(Tensor::createDevice<float>({2, batchSize, mNumUnits}));
+    mThreadBuffer.reset(Tensor::createDevice<float>({threadNumber, 3 * hiddenPack}));
+    std::vector<Tensor*> buffers = {mInputGate.get(), mInputCandidate.get(), mBias.get(), mPackWeight.get(),
+                                    mHiddenState.get(), mResetHt.get(), mThreadBuffer.get()};
+    for (auto t : buffers) {
+        if (!backend()->onAcquireBuffer(t, Backend::DYNAMIC)) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    // The weights of input are the first inputLastDimSize lines of gateWeight / candidateWeight
+    std::shared_ptr<Tensor> inputWrap(Tensor::createDevice<float>({seqLength * batchSize, inputLastDimSize}));
+    std::shared_ptr<Tensor> gateWeight(Tensor::createDevice<float>({inputLastDimSize, 2 * mNumUnits}));
+    std::shared_ptr<Tensor> gateBias(Tensor::createDevice<float>({2 * mNumUnits}));
+    std::shared_ptr<Tensor> candidateWeight(Tensor::createDevice<float>({inputLastDimSize, mNumUnits}));
+    std::shared_ptr<Tensor> candidateBias(Tensor::createDevice<float>({mNumUnits}));
+    auto code = mGateMatMul->onResize({inputWrap.get(), gateWeight.get(), gateBias.get()}, {mInputGate.get()});
+    if (NO_ERROR != code) {
+        return code;
+    }
+    code = mCandidateMatMul->onResize({inputWrap.get(), candidateWeight.get(), candidateBias.get()}, {mInputCandidate.get()});
+    if (NO_ERROR != code) {
+        return code;
+    }
+    for (auto t : buffers) {
+        backend()->onReleaseBuffer(t, Backend::DYNAMIC);
+    }
     return NO_ERROR;
 }
 
+// implement GRU cell function
+// Ref: tensorflow/python/ops/rnn_cell_impl.py
 ErrorCode CPURNNSequenceGRU::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-
-    auto inputSize = inputs.size();
-    auto outputSize = outputs.size();
     const int forwardParamNumber = 5;
-    MNN_ASSERT(inputSize >= 1 + forwardParamNumber * (mIsBidirectionalRNN + 1));
-    auto fwGateWeight = inputs[1];
-    auto fwGateBias = inputs[2];
-    auto fwCandidateWeight = inputs[3];
-    auto fwCandidateBias = inputs[4];
-    auto fwRecurrentBias = inputs[5];
-
-    // fwGateWeight->printShape();// mFwGateWeight
-    // fwGateBias->printShape();// mFwGateBias
-    // fwCandidateWeight->printShape();// mFwCandidateWeight
-    // fwCandidateBias->printShape();// mFwCandidateBias
-    // fwRecurrentBias->printShape();// mFwRecurrentBias
-
-    // firstly set the hidden state to zero
-    float* const hiddenStatePtr   = mHiddenState->host<float>();
-    const int hiddenStateDataSize = mHiddenState->size();
-
+    const int directions         = mIsBidirectionalRNN ? 2 : 1;
+    MNN_ASSERT(inputs.size() >= 1 + forwardParamNumber * directions);
     auto input                    = inputs[0];  // shape :(seq_length, batch_size, input_size)
     auto output                   = outputs[0]; // shape :(seq_length, num_directions, batch_size, hidden_size)
-    float* const inputPtr         = input->host<float>();
-    float* const outputPtr        = output->host<float>();
-
-    float* outputYhPtr = mKeepAllOutputs && outputSize > 1 ? outputs[1]->host<float>() : outputs[0]->host<float>();
+    const int seqLength           = input->length(0);
     const int batchSize           = input->length(1);
-    const int SequenceStride      = input->stride(0);
-    const int inputSequenceLength = input->length(0);
     const int inputCodeLength     = input->length(2);
-    // MNN_PRINT("inputSequenceLength:%d, batchSize:%d, inputCodeLength:%d, mNumUnits:%d, hiddenStateDataSize:%d\n", inputSequenceLength, batchSize, inputCodeLength, mNumUnits, hiddenStateDataSize);
-    for (int b = 0; b < batchSize; ++b) { // swap order
-        if (inputSize > 1 + forwardParamNumber * (mIsBidirectionalRNN + 1)) {
-            auto source = inputs[inputSize - 1]->host<uint8_t>() + b * hiddenStateDataSize;
-            ::memcpy(hiddenStatePtr, source, hiddenStateDataSize);
-        } else {
-            ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
-        }
-
-        for (int i = 0; i < inputSequenceLength; ++i) {
-            const int inputOffset = i * SequenceStride + b * inputCodeLength;
-            runRNNStep(inputPtr + inputOffset, inputCodeLength, mlinearBeforeReset, mHiddenState, mNumUnits, fwGateWeight, fwGateBias,
-                       fwCandidateWeight, fwCandidateBias, fwRecurrentBias, mInputAndState, mGate, mResetHt);
+    const int numUnits            = mNumUnits;
+    const bool hasInitialState    = inputs.size() > 1 + forwardParamNumber * directions;
+    const bool linearBeforeReset  = mlinearBeforeReset;
+    const bool keepAllOutputs     = mKeepAllOutputs;
+    float* outputPtr              = output->host<float>();
+    float* outputYhPtr            = nullptr;
+    if (!mKeepAllOutputs) {
+        outputYhPtr = outputs[0]->host<float>();
+    } else if (outputs.size() > 1) {
+        outputYhPtr = outputs[1]->host<float>();
+    }
 
-            if (mKeepAllOutputs) {
-                ::memcpy(outputPtr + i * output->stride(0) + b * mNumUnits, hiddenStatePtr, hiddenStateDataSize);
-            }
+    const int blocks       = UP_DIV(numUnits, RNNEngine::UNIT);
+    const int hiddenPack   = blocks * RNNEngine::UNIT;
+    const int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    const int stateSize    = batchSize * numUnits;
+    auto biasPtr           = mBias->host<float>();
+    auto inputGatePtr      = mInputGate->host<float>();
+    auto inputCandPtr      = mInputCandidate->host<float>();
+    auto threadBufferPtr   = mThreadBuffer->host<float>();
+    auto zPtr              = mResetHt->host<float>();
+    auto resetHtPtr        = zPtr + stateSize;
+    auto rzWeight          = mPackWeight->host<float>();
+    auto rrWeight          = rzWeight + hiddenPack * numUnits;
+    auto rhWeight          = rrWeight + hiddenPack * numUnits;
+    for (int d = 0; d < directions; ++d) {
+        auto gateWeight      = inputs[1 + forwardParamNumber * d]->host<float>();
+        auto gateBias        = inputs[2 + forwardParamNumber * d]->host<float>();
+        auto candidateWeight = inputs[3 + forwardParamNumber * d]->host<float>();
+        auto candidateBias   = inputs[4 + forwardParamNumber * d]->host<float>();
+        auto recurrentBias   = inputs[5 + forwardParamNumber * d]->host<float>();
+        // Gate bias, candidate bias and recurrent bias are all added to the input projection,
+        // except recurrent bias of h when linearBeforeReset, which is multiplied by r_t
+        for (int i = 0; i < 2 * numUnits; ++i) {
+            biasPtr[i] = gateBias[i] + recurrentBias[i];
         }
-        if ((mKeepAllOutputs && outputSize > 1) || !mKeepAllOutputs) {
-            ::memcpy(outputYhPtr, hiddenStatePtr, hiddenStateDataSize);
-            outputYhPtr += mNumUnits;
+        for (int i = 0; i < numUnits; ++i) {
+            auto hiddenBias           = recurrentBias[2 * numUnits + i];
+            biasPtr[2 * numUnits + i] = candidateBias[i] + (linearBeforeReset ? 0.0f : hiddenBias);
+            biasPtr[3 * numUnits + i] = hiddenBias;
         }
-
-    }
-
-    // backward rnn
-    if (mIsBidirectionalRNN) {
-        float* outputYhPtr = mKeepAllOutputs && outputSize > 1 ? outputs[1]->host<float>() : outputs[0]->host<float>();
-        outputYhPtr += batchSize * mNumUnits;
-        // todo: modify the inputOffset
-        MNN_ASSERT(11 <= inputs.size());
-        auto bwGateWeight = inputs[6];
-        auto bwGateBias = inputs[7];
-        auto bwCandidateWeight = inputs[8];
-        auto bwCandidateBias = inputs[9];
-        auto bwRecurrentBias = inputs[10];
-
-        auto outputBw            = outputs[0];
-        float* const outputBwPtr = outputBw->host<float>();
-        for (int b = 0; b < batchSize; ++b) {
-
-            if (inputSize > 1 + forwardParamNumber * 2) {
-                auto source = inputs[inputSize - 1]->host<uint8_t>() + (batchSize + b) * hiddenStateDataSize;
-                ::memcpy(hiddenStatePtr, source, hiddenStateDataSize);
-            } else {
-                ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
-            }
-
-            for (int i = inputSequenceLength - 1; i >= 0; i--) {
-                const int inputOffset = i * SequenceStride + b * inputCodeLength;
-                runRNNStep(inputPtr + inputOffset, inputCodeLength, mlinearBeforeReset, mHiddenState, mNumUnits, bwGateWeight, bwGateBias,
-                           bwCandidateWeight, bwCandidateBias, bwRecurrentBias, mInputAndState, mGate, mResetHt);
-                if (mKeepAllOutputs) {
-                    ::memcpy(outputBwPtr + i * outputBw->stride(0) + (batchSize + b) * mNumUnits,
-                             hiddenStatePtr, hiddenStateDataSize);
+        // x_t * [W_zr, W_h] for all t
+        mGateMatMul->execute(input->host<float>(), gateWeight, inputGatePtr, biasPtr);
+        mCandidateMatMul->execute(input->host<float>(), candidateWeight, inputCandPtr, biasPtr + 2 * numUnits);
+        RNNEngine::packHidden(rzWeight, gateWeight + inputCodeLength * 2 * numUnits, numUnits, numUnits, 2 * numUnits, false);
+        RNNEngine::packHidden(rrWeight, gateWeight + inputCodeLength * 2 * numUnits + numUnits, numUnits, numUnits, 2 * numUnits, false);
+        RNNEngine::packHidden(rhWeight, candidateWeight + inputCodeLength * numUnits, numUnits, numUnits, numUnits, false);
+
+        auto hiddenPtr = mHiddenState->host<float>();
+        if (hasInitialState) {
+            ::memcpy(hiddenPtr, inputs[inputs.size() - 1]->host<float>() + d * stateSize, stateSize * sizeof(float));
+        } else {
+            ::memset(hiddenPtr, 0, stateSize * sizeof(float));
+        }
+        for (int s = 0; s < seqLength; ++s) {
+            const int t        = d > 0 ? seqLength - 1 - s : s;
+            const float* hPrev = hiddenPtr + (s % 2) * stateSize;
+            float* hNext       = hiddenPtr + ((s + 1) % 2) * stateSize;
+            float* yPtr        = outputPtr + (t * directions + d) * stateSize;
+            // z_t = sigmoid(x_t * W_z + h_t-1 * R_z + b_z), r_t likewise, stored as [z, r] of one part
+            auto computeGate = [&](float* gate, int b, int blockStart, int blockEnd) {
+                auto length    = (blockEnd - blockStart) * RNNEngine::UNIT;
+                auto unit      = blockStart * RNNEngine::UNIT;
+                auto count     = ALIMIN(numUnits, blockEnd * RNNEngine::UNIT) - unit;
+                auto inputGate = inputGatePtr + (t * batchSize + b) * 2 * numUnits + unit;
+                RNNEngine::multiHidden(gate, hPrev + b * numUnits, rzWeight, numUnits, blockStart, blockEnd);
+                RNNEngine::multiHidden(gate + length, hPrev + b * numUnits, rrWeight, numUnits, blockStart, blockEnd);
+                for (int i = 0; i < count; ++i) {
+                    gate[i] += inputGate[i];
+                    gate[length + i] += inputGate[numUnits + i];
+                }
+                MNNSigmoid(gate, gate, 2 * length);
+            };
+            // h_t = (1 - z_t) (.) tanh(candidate) + z_t (.) h_t-1
+            auto update = [&](const float* z, float* candidate, int b, int blockStart, int blockEnd) {
+                auto unit  = blockStart * RNNEngine::UNIT;
+                auto count = ALIMIN(numUnits, blockEnd * RNNEngine::UNIT) - unit;
+                MNNTanh(candidate, candidate, count);
+                auto src = hPrev + b * numUnits + unit;
+                auto dst = hNext + b * numUnits + unit;
+                for (int i = 0; i < count; ++i) {
+                    dst[i] = (1.0f - z[i]) * candidate[i] + z[i] * src[i];
+                }
+                if (keepAllOutputs) {
+                    ::memcpy(yPtr + b * numUnits + unit, dst, count * sizeof(float));
+                }
+            };
+            if (linearBeforeReset) {
+                // candidate = x_t * W_h + b_wh + r_t (.) (h_t-1 * R_h + b_rh), every part is independent
+                MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                    auto gate = threadBufferPtr + tId * 3 * hiddenPack;
+                    RNNEngine::divide((int)tId, threadNumber, batchSize, blocks, [&](int b, int blockStart, int blockEnd) {
+                        auto length    = (blockEnd - blockStart) * RNNEngine::UNIT;
+                        auto unit      = blockStart * RNNEngine::UNIT;
+                        auto count     = ALIMIN(numUnits, blockEnd * RNNEngine::UNIT) - unit;
+                        auto candidate = gate + 2 * length;
+                        computeGate(gate, b, blockStart, blockEnd);
+                        RNNEngine::multiHidden(candidate, hPrev + b * numUnits, rhWeight, numUnits, blockStart, blockEnd);
+                        auto inputCand  = inputCandPtr + (t * batchSize + b) * numUnits + unit;
+                        auto hiddenBias = biasPtr + 3 * numUnits + unit;
+                        auto r          = gate + length;
+                        for (int i = 0; i < count; ++i) {
+                            candidate[i] = inputCand[i] + r[i] * (candidate[i] + hiddenBias[i]);
+                        }
+                        update(gate, candidate, b, blockStart, blockEnd);
+                    });
                 }
+                MNN_CONCURRENCY_END();
+                continue;
             }
-            if ((mKeepAllOutputs && outputSize > 1) || !mKeepAllOutputs) {
-                ::memcpy(outputYhPtr, hiddenStatePtr, hiddenStateDataSize);
-                outputYhPtr += mNumUnits;
+            // candidate = x_t * W_h + (r_t (.) h_t-1) * R_h + b_h, needs whole r_t (.) h_t-1 before computing
+            MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                auto gate = threadBufferPtr + tId * 3 * hiddenPack;
+                RNNEngine::divide((int)tId, threadNumber, batchSize, blocks, [&](int b, int blockStart, int blockEnd) {
+                    auto length = (blockEnd - blockStart) * RNNEngine::UNIT;
+                    auto unit   = blockStart * RNNEngine::UNIT;
+                    auto count  = ALIMIN(numUnits, blockEnd * RNNEngine::UNIT) - unit;
+                    computeGate(gate, b, blockStart, blockEnd);
+                    auto offset = b * numUnits + unit;
+                    auto r      = gate + length;
+                    for (int i = 0; i < count; ++i) {
+                        zPtr[offset + i]       = gate[i];
+                        resetHtPtr[offset + i] = r[i] * hPrev[offset + i];
+                    }
+                });
             }
+            MNN_CONCURRENCY_END();
+            MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                auto candidate = threadBufferPtr + tId * 3 * hiddenPack;
+                RNNEngine::divide((int)tId, threadNumber, batchSize, blocks, [&](int b, int blockStart, int blockEnd) {
+                    auto unit  = blockStart * RNNEngine::UNIT;
+                    auto count = ALIMIN(numUnits, blockEnd * RNNEngine::UNIT) - unit;
+                    RNNEngine::multiHidden(candidate, resetHtPtr + b * numUnits, rhWeight, numUnits, blockStart, blockEnd);
+                    auto inputCand = inputCandPtr + (t * batchSize + b) * numUnits + unit;
+                    for (int i = 0; i < count; ++i) {
+                        candidate[i] += inputCand[i];
+                    }
+                    update(zPtr + b * numUnits + unit, candidate, b, blockStart, blockEnd);
+                });
+            }
+            MNN_CONCURRENCY_END();
+        }
+        if (nullptr != outputYhPtr) {
+            ::memcpy(outputYhPtr + d * stateSize, hiddenPtr + (seqLength % 2) * stateSize, stateSize * sizeof(float));
         }
     }
-
     return NO_ERROR;
 }
 
@@ -10,6 +10,7 @@
 #define CPURNNSequenceGRU_hpp
 
 #include "core/Execution.hpp"
+#include "backend/cpu/CPUMatMul.hpp"
 
 namespace MNN {
 
@@ -26,10 +27,20 @@ private:
     bool mlinearBeforeReset;
     int mNumUnits;
 
+    // Input projection of all timesteps: X * W_zr and X * W_h
+    std::shared_ptr<CPUMatMul> mGateMatMul;
+    std::shared_ptr<CPUMatMul> mCandidateMatMul;
+    std::shared_ptr<Tensor> mInputGate;
+    std::shared_ptr<Tensor> mInputCandidate;
+    // Bias of input projection (z, r, h) and recurrent bias of h
+    std::shared_ptr<Tensor> mBias;
+    // Packed R_z, R_r, R_h
+    std::shared_ptr<Tensor> mPackWeight;
+    // Double buffer of h_t-1 and h_t
     std::shared_ptr<Tensor> mHiddenState;
-    std::shared_ptr<Tensor> mInputAndState;
-    std::shared_ptr<Tensor> mGate;
+    // z_t and r_t (.) h_t-1, only used when linearBeforeReset is false
     std::shared_ptr<Tensor> mResetHt;
+    std::shared_ptr<Tensor> mThreadBuffer;
 };
 
 } // namespace MNN
@@ -17,6 +17,7 @@
 #include "CPUUnary.hpp"
 #include "core/BufferAllocator.hpp"
 #include "CPUResizeCache.hpp"
+#include <algorithm>
 
 using Vec4 = MNN::Math::Vec<float, 4>;
 namespace MNN {
@@ -71,26 +72,6 @@ static void getBatchChannelArea(const Tensor* t, int& batch, int& channel, int&
         }
     }
 }
-// Detect if the region is a transpose
-static bool _transpose(const Tensor::InsideDescribe::Region& region) {
-    int srcOne = -1, dstOne = -1;
-    for (int i = 0; i < 3; i++) {
-        if (region.src.stride[i] == 1 && region.size[i] != 1) {
-            if (srcOne >= 0 || region.size[i] < 4) {
-                return false;
-            }
-            srcOne = i;
-        }
-        if (region.dst.stride[i] == 1 && region.size[i] != 1) {
-            if (dstOne >= 0 || region.size[i] < 4) {
-                return false;
-            }
-            dstOne = i;
-        }
-    }
-    return srcOne >= 0 && dstOne >= 0 && srcOne != dstOne;
-}
-
 static int _singleConvert(const Tensor::InsideDescribe::Region& region, const Tensor* dest) {
     auto origin = region.origin;
     auto srcFormat = TensorUtils::getDescribe(origin)->dimensionFormat;
@@ -379,25 +360,6 @@ ErrorCode CPURaster::onResize(const std::vector<Tensor *> &inputs, const std::ve
     }
     return NO_ERROR;
 }
-static void _transpose4Bit(int32_t* dstO, const int32_t* srcO, const Tensor::InsideDescribe::Region& region) {
-    int dims[4], keepDim = -1;
-    for (int i = 0; i < 3; i++) {
-        if (region.src.stride[i] == 1 && region.size[i] != 1) {
-            dims[1] = region.size[i];
-            dims[3] = region.dst.stride[i];
-        }else if (region.dst.stride[i] == 1 && region.size[i] != 1) {
-            dims[0] = region.size[i];
-            dims[2] = region.src.stride[i];
-        } else {
-            keepDim = i;
-        }
-    }
-    for (int z=0; z<region.size[keepDim]; ++z) {
-        auto srcZ = srcO + region.src.stride[keepDim] * z;
-        auto dstZ = dstO + region.dst.stride[keepDim] * z;
-        MNNTranspose32Bit(dstZ, srcZ, dims);
-    }
-}
 typedef void (*BlitProc)(uint8_t* dstO, const uint8_t* srcO, int size, int stride, int ds);
 
 static void _4BitcopyWithStride(uint8_t* dstO, const uint8_t* srcO, int size, int stride, int ds) {
@@ -454,7 +416,6 @@ void CPURaster::executeFaster(const std::vector<Tensor *> &inputs, const std::ve
     auto output = outputs[0];
     auto bytes = CPUBackend::getBytes(backend(), output);
     auto core = static_cast<const CPUBackend*>(backend())->functions();
-    auto threadNum = static_cast<CPUBackend*>(backend())->threadNumber();
     if (mNeedZero) {
         ::memset(output->host<void>(), mZeroPoint, static_cast<CPUBackend*>(backend())->getTensorSize(output) * bytes);
     }
@@ -474,33 +435,30 @@ void CPURaster::executeFaster(const std::vector<Tensor *> &inputs, const std::ve
             C4proc = core->MNNSelectBlitFunction(byteC4);
             break;
     }
-    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
-        for (int u=(int)tId; u<mFastBlit.size(); u+=threadNum) {
-            auto& iter = mFastBlit[u];
-            auto& slice = iter.second;
-            //Offset use byte
-            auto srcPtr = (uint8_t*)iter.first + slice.src.offset * bytes;
-            auto dstPtr = (uint8_t*)mOutputPtr + slice.dst.offset * bytes;
-            if (slice.src.stride[1] == slice.size[2] && slice.dst.stride[1] == slice.size[2] && slice.src.stride[2] == 1) {
-                for (int z=0; z<slice.size[0]; ++z) {
-                    auto srcZ = srcPtr + z * slice.src.stride[0] * byteC4;
-                    auto dstZ = dstPtr + z * slice.dst.stride[0] * byteC4;
-                    ::memcpy(dstZ, srcZ, slice.size[1] * slice.src.stride[1] * byteC4);
-                }
-                continue;
+    // One task per region, so that regions of uneven size are balanced across threads
+    MNN_CONCURRENCY_BEGIN(u, (int)mFastBlit.size()) {
+        auto& iter = mFastBlit[u];
+        auto& slice = iter.second;
+        //Offset use byte
+        auto srcPtr = (uint8_t*)iter.first + slice.src.offset * bytes;
+        auto dstPtr = (uint8_t*)mOutputPtr + slice.dst.offset * bytes;
+        if (slice.src.stride[1] == slice.size[2] && slice.dst.stride[1] == slice.size[2] && slice.src.stride[2] == 1) {
+            for (int z=0; z<slice.size[0]; ++z) {
+                auto srcZ = srcPtr + z * slice.src.stride[0] * byteC4;
+                auto dstZ = dstPtr + z * slice.dst.stride[0] * byteC4;
+                ::memcpy(dstZ, srcZ, slice.size[1] * slice.src.stride[1] * byteC4);
             }
-            if (1 == slice.src.stride[2] && 1 == slice.dst.stride[2]) {
-                for (int z=0; z<slice.size[0]; ++z) {
-                    auto srcZ = srcPtr + z * slice.src.stride[0] * byteC4;
-                    auto dstZ = dstPtr + z * slice.dst.stride[0] * byteC4;
-                    for (int y=0; y<slice.size[1]; ++y) {
-                        auto srcY = srcZ + y * slice.src.stride[1] * byteC4;
-                        auto dstY = dstZ + y * slice.dst.stride[1] * byteC4;
-                        ::memcpy(dstY, srcY, slice.size[2] * byteC4);
-                    }
+        } else if (1 == slice.src.stride[2] && 1 == slice.dst.stride[2]) {
+            for (int z=0; z<slice.size[0]; ++z) {
+                auto srcZ = srcPtr + z * slice.src.stride[0] * byteC4;
+                auto dstZ = dstPtr + z * slice.dst.stride[0] * byteC4;
+                for (int y=0; y<slice.size[1]; ++y) {
+                    auto srcY = srcZ + y * slice.src.stride[1] * byteC4;
+                    auto dstY = dstZ + y * slice.dst.stride[1] * byteC4;
+                    ::memcpy(dstY, srcY, slice.size[2] * byteC4);
                 }
-                continue;
             }
+        } else {
             for (int z=0; z<slice.size[0]; ++z) {
                 auto srcZ = srcPtr + z * slice.src.stride[0] * byteC4;
                 auto dstZ = dstPtr + z * slice.dst.stride[0] * byteC4;
@@ -542,6 +500,116 @@ static void _zero(const Tensor::InsideDescribe::Region& slice, int bytes, uint8_
         }
     }
 }
+#if defined(__GNUC__) || defined(__clang__)
+#define MNN_RASTER_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+#define MNN_RASTER_PREFETCH(ptr)
+#endif
+
+// dst[r * dstR + c] = src[c * srcC + r] for 4 x 4 elements
+template<typename T>
+static inline void _transposeTile(T* dst, const T* src, int srcC, int dstR) {
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            dst[r * dstR + c] = src[c * srcC + r];
+        }
+    }
+}
+template<>
+inline void _transposeTile<float>(float* dst, const float* src, int srcC, int dstR) {
+    auto v0 = Vec4::load(src + 0 * srcC);
+    auto v1 = Vec4::load(src + 1 * srcC);
+    auto v2 = Vec4::load(src + 2 * srcC);
+    auto v3 = Vec4::load(src + 3 * srcC);
+    Vec4::transpose4(v0, v1, v2, v3);
+    Vec4::save(dst + 0 * dstR, v0);
+    Vec4::save(dst + 1 * dstR, v1);
+    Vec4::save(dst + 2 * dstR, v2);
+    Vec4::save(dst + 3 * dstR, v3);
+}
+
+// Copy rows x cols elements: src[r * srcR + c * srcC] -> dst[r * dstR + c * dstC].
+// Walk by blocks of one cache line per side, so the lines of src and dst used by a block stay in L1,
+// use 4 x 4 transposed tiles when src is contiguous in rows and dst in cols
+template<typename T>
+static void _blockCopy(T* dst, const T* src, int rows, int cols, int srcR, int srcC, int dstR, int dstC) {
+    if (1 == srcC && 1 == dstC) {
+        for (int r = 0; r < rows; ++r) {
+            ::memcpy(dst + r * dstR, src + r * srcR, cols * sizeof(T));
+        }
+        return;
+    }
+    const int block = 64 / sizeof(T);
+    bool transpose  = 1 == srcR && 1 == dstC;
+    for (int rb = 0; rb < rows; rb += block) {
+        int re = ALIMIN(rows, rb + block);
+        for (int cb = 0; cb < cols; cb += block) {
+            int ce = ALIMIN(cols, cb + block);
+            if (1 != srcC) {
+                // Each col of next block starts a new line of src
+                for (int c = ce; c < ALIMIN(cols, ce + block); ++c) {
+                    MNN_RASTER_PREFETCH(src + rb * srcR + c * srcC);
+                }
+            }
+            int r = rb;
+            if (transpose) {
+                int ce4 = cb + (ce - cb) / 4 * 4;
+                for (; r + 4 <= re; r += 4) {
+                    auto d = dst + r * dstR;
+                    auto s = src + r;
+                    int c = cb;
+                    for (; c < ce4; c += 4) {
+                        _transposeTile(d + c, s + c * srcC, srcC, dstR);
+                    }
+                    for (; c < ce; ++c) {
+                        for (int i = 0; i < 4; ++i) {
+                            d[i * dstR + c] = s[c * srcC + i];
+                        }
+                    }
+                }
+            }
+            for (; r < re; ++r) {
+                auto d = dst + r * dstR;
+                auto s = src + r * srcR;
+                for (int c = cb; c < ce; ++c) {
+                    d[c * dstC] = s[c * srcC];
+                }
+            }
+        }
+    }
+}
+
+// Copy a region of any strides: the dim with least dst stride is iterated innermost so writes are sequential,
+// the dim with least src stride next to it, then the 2D copy of inner dims is blocked
+template<typename T>
+static void _tiledBlit(T* dst, const T* src, const Tensor::InsideDescribe::Region& slice) {
+    int order[3] = {0, 1, 2};
+    auto less = [&slice](int a, int b, const int* stride, const int* other) {
+        // Dims of size 1 go outside
+        if ((slice.size[a] == 1) != (slice.size[b] == 1)) {
+            return slice.size[b] == 1;
+        }
+        auto sa = std::abs(stride[a]), sb = std::abs(stride[b]);
+        if (sa != sb) {
+            return sa < sb;
+        }
+        return std::abs(other[a]) < std::abs(other[b]);
+    };
+    // order[2]: innermost by dst, order[1]: next by src
+    for (int i = 0; i < 2; ++i) {
+        if (less(order[i], order[2], slice.dst.stride, slice.src.stride)) {
+            std::swap(order[i], order[2]);
+        }
+    }
+    if (less(order[0], order[1], slice.src.stride, slice.dst.stride)) {
+        std::swap(order[0], order[1]);
+    }
+    auto k = order[0], j = order[1], i = order[2];
+    for (int z = 0; z < slice.size[k]; ++z) {
+        _blockCopy(dst + z * slice.dst.stride[k], src + z * slice.src.stride[k], slice.size[j], slice.size[i],
+                   slice.src.stride[j], slice.src.stride[i], slice.dst.stride[j], slice.dst.stride[i]);
+    }
+}
 static void _blit(const Tensor::InsideDescribe::Region& slice, int bytes, const uint8_t* srcPtr, uint8_t* dstPtr, void(*proc)(uint8_t* dstO, const uint8_t* srcO, int size, int stride, int ds)) {
     if (slice.src.stride[1] == slice.size[2] && slice.dst.stride[1] == slice.size[2] && slice.src.stride[2] == 1) {
         for (int z=0; z<slice.size[0]; ++z) {
@@ -551,10 +619,6 @@ static void _blit(const Tensor::InsideDescribe::Region& slice, int bytes, const
         }
         return;
     }
-    if (_transpose(slice) && 4 == bytes) {
-        _transpose4Bit((int32_t*)dstPtr, (const int32_t*)srcPtr, slice);
-        return;
-    }
     if (1 == slice.src.stride[2] && 1 == slice.dst.stride[2]) {
         for (int z=0; z<slice.size[0]; ++z) {
             auto srcZ = srcPtr + z * slice.src.stride[0] * bytes;
@@ -567,6 +631,19 @@ static void _blit(const Tensor::InsideDescribe::Region& slice, int bytes, const
         }
         return;
     }
+    switch (bytes) {
+        case 4:
+            _tiledBlit((float*)dstPtr, (const float*)srcPtr, slice);
+            return;
+        case 2:
+            _tiledBlit((uint16_t*)dstPtr, (const uint16_t*)srcPtr, slice);
+            return;
+        case 1:
+            _tiledBlit(dstPtr, srcPtr, slice);
+            return;
+        default:
+            break;
+    }
     for (int z=0; z<slice.size[0]; ++z) {
         auto srcZ = srcPtr + z * slice.src.stride[0] * bytes;
         auto dstZ = dstPtr + (z) * slice.dst.stride[0] * bytes;
@@ -657,14 +734,12 @@ ErrorCode CPURaster::onExecute(const std::vector<Tensor *> &inputs, const std::v
         tensorConvert(iter.first, iter.second, bytes);
     }
     auto proc = _selectUnitProc(bytes);
-    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
-        for (int u=tId; u<mTempInputCopy.size(); u+=threadNum) {
-            auto& iter = mTempInputCopy[u];
-            auto& slice = *(iter.second);
-            auto srcPtr = (uint8_t*)iter.first + slice.src.offset * bytes;
-            auto dstPtr = (uint8_t*)mOutputPtr + slice.dst.offset * bytes;
-            _blit(slice, bytes, srcPtr, dstPtr, proc);
-        }
+    MNN_CONCURRENCY_BEGIN(u, (int)mTempInputCopy.size()) {
+        auto& iter = mTempInputCopy[u];
+        auto& slice = *(iter.second);
+        auto srcPtr = (uint8_t*)iter.first + slice.src.offset * bytes;
+        auto dstPtr = (uint8_t*)mOutputPtr + slice.dst.offset * bytes;
+        _blit(slice, bytes, srcPtr, dstPtr, proc);
     }
     MNN_CONCURRENCY_END();
     if (nullptr != mTempOutput) {
@@ -12,86 +12,125 @@
 #include "core/TensorUtils.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
 #include "core/Concurrency.h"
+#include "math/Vec.hpp"
+
+using Vec4 = MNN::Math::Vec<float, 4>;
 
 namespace MNN {
 
+// dst[j * dstStride + i] = src[i * srcStride + j], blocked so that both sides stay in cache
 template<typename T>
-void NCHW2NHWC(const T* source, T* dest, int b, int c, int area) {
-    int sourceBatchsize = c * area;
-    int destBatchSize   = sourceBatchsize;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        for (int i = 0; i < area; ++i) {
-            auto srcArea = srcBatch + i;
-            auto dstArea = dstBatch + i * c;
-            for (int ci = 0; ci < c; ++ci) {
-                dstArea[ci] = srcArea[ci * area];
+static void _transpose(T* dst, const T* src, int rows, int cols, int srcStride, int dstStride) {
+    const int block = 16;
+    for (int ib = 0; ib < rows; ib += block) {
+        int ie = ALIMIN(rows, ib + block);
+        for (int jb = 0; jb < cols; jb += block) {
+            int je = ALIMIN(cols, jb + block);
+            for (int i = ib; i < ie; ++i) {
+                for (int j = jb; j < je; ++j) {
+                    dst[j * dstStride + i] = src[i * srcStride + j];
+                }
             }
         }
     }
 }
 
-template<typename T>
-void NHWC2NCHW(const T* source, T* dest, int b, int c, int area) {
-    int sourceBatchsize = c * area;
-    int destBatchSize   = sourceBatchsize;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        for (int i = 0; i < area; ++i) {
-            auto srcArea = srcBatch + i * c;
-            auto dstArea = dstBatch + i;
-            for (int ci = 0; ci < c; ++ci) {
-                dstArea[ci * area] = srcArea[ci];
+template<>
+void _transpose<float>(float* dst, const float* src, int rows, int cols, int srcStride, int dstStride) {
+    const int block = 16;
+    for (int ib = 0; ib < rows; ib += block) {
+        int ie = ALIMIN(rows, ib + block);
+        int i4 = ib + (ie - ib) / 4 * 4;
+        for (int jb = 0; jb < cols; jb += block) {
+            int je = ALIMIN(cols, jb + block);
+            int j4 = jb + (je - jb) / 4 * 4;
+            for (int i = ib; i < i4; i += 4) {
+                for (int j = jb; j < j4; j += 4) {
+                    auto s  = src + i * srcStride + j;
+                    auto v0 = Vec4::load(s);
+                    auto v1 = Vec4::load(s + srcStride);
+                    auto v2 = Vec4::load(s + 2 * srcStride);
+                    auto v3 = Vec4::load(s + 3 * srcStride);
+                    Vec4::transpose4(v0, v1, v2, v3);
+                    auto d = dst + j * dstStride + i;
+                    Vec4::save(d, v0);
+                    Vec4::save(d + dstStride, v1);
+                    Vec4::save(d + 2 * dstStride, v2);
+                    Vec4::save(d + 3 * dstStride, v3);
+                }
+                for (int j = j4; j < je; ++j) {
+                    for (int k = i; k < i + 4; ++k) {
+                        dst[j * dstStride + k] = src[k * srcStride + j];
+                    }
+                }
+            }
+            for (int i = i4; i < ie; ++i) {
+                for (int j = jb; j < je; ++j) {
+                    dst[j * dstStride + i] = src[i * srcStride + j];
+                }
             }
         }
     }
 }
+
+// Divide batch * area to threads, call function(batchIndex, areaStart, areaEnd) for each part of tId
+template<typename F>
+static void _divide(int tId, int numberThread, int batch, int area, F&& function) {
+    int total = batch * area;
+    int step  = UP_DIV(total, numberThread);
+    int start = tId * step;
+    int end   = ALIMIN(total, start + step);
+    while (start < end) {
+        int b      = start / area;
+        int aStart = start - b * area;
+        int aEnd   = ALIMIN(area, aStart + end - start);
+        function(b, aStart, aEnd);
+        start += aEnd - aStart;
+    }
+}
+
+template<typename T>
+static void _swapLayout(const T* source, T* dest, bool fromNCHW, int tId, int numberThread, int b, int c, int area) {
+    _divide(tId, numberThread, b, area, [&](int bi, int aStart, int aEnd) {
+        auto batchOffset = bi * c * area;
+        if (fromNCHW) {
+            // [c, area] -> [area, c]
+            _transpose(dest + batchOffset + aStart * c, source + batchOffset + aStart, c, aEnd - aStart, area, c);
+        } else {
+            // [area, c] -> [c, area]
+            _transpose(dest + batchOffset + aStart, source + batchOffset + aStart * c, aEnd - aStart, c, c, area);
+        }
+    });
+}
 typedef void(*PackProc)(void* dst, const void* src, size_t area, size_t depth, int* areaOffset);
 
 ErrorCode CPUTensorConverter::convert(const void* inputRaw, void* outputRaw, MNN_DATA_FORMAT source, MNN_DATA_FORMAT dest, int batch, int area, int channel, int bitLength, const CoreFunctions* core, int tId, int numberThread) {
     // the case when source and dest data layout are the same
     // This case occurs in BackendTest of BF16 data.
     if(source == dest) {
-        if (tId == 0) {
-            ::memcpy(outputRaw, inputRaw, batch * area * channel * bitLength);
+        size_t total = (size_t)batch * area * channel * bitLength;
+        size_t step  = UP_DIV(total, numberThread);
+        size_t start = ALIMIN(total, tId * step);
+        size_t end   = ALIMIN(total, start + step);
+        if (end > start) {
+            ::memcpy((int8_t*)outputRaw + start, (const int8_t*)inputRaw + start, end - start);
         }
         return NO_ERROR;
     }
-    if (MNN_DATA_FORMAT_NHWC == source && MNN_DATA_FORMAT_NCHW == dest) {
-        if (tId == 0) {
-            switch (bitLength) {
-                case 1:
-                    NHWC2NCHW((int8_t*)inputRaw, (int8_t*)outputRaw, batch, channel, area);
-                    break;
-                case 2:
-                    NHWC2NCHW((int16_t*)inputRaw, (int16_t*)outputRaw, batch, channel, area);
-                    break;
-                case 4:
-                    NHWC2NCHW((float*)inputRaw, (float*)outputRaw, batch, channel, area);
-                    break;
-                default:
-                    break;
-            }
-        }
-        return NO_ERROR;
-    }
-    if (MNN_DATA_FORMAT_NCHW == source && MNN_DATA_FORMAT_NHWC == dest) {
-        if (tId == 0) {
-            switch (bitLength) {
-                case 1:
-                    NCHW2NHWC((int8_t*)inputRaw, (int8_t*)outputRaw, batch, channel, area);
-                    break;
-                case 2:
-                    NCHW2NHWC((int16_t*)inputRaw, (int16_t*)outputRaw, batch, channel, area);
-                    break;
-                case 4:
-                    NCHW2NHWC((float*)inputRaw, (float*)outputRaw, batch, channel, area);
-                    break;
-                default:
-                    break;
-            }
+    if ((MNN_DATA_FORMAT_NHWC == source && MNN_DATA_FORMAT_NCHW == dest) || (MNN_DATA_FORMAT_NCHW == source && MNN_DATA_FORMAT_NHWC == dest)) {
+        bool fromNCHW = MNN_DATA_FORMAT_NCHW == source;
+        switch (bitLength) {
+            case 1:
+                _swapLayout((const int8_t*)inputRaw, (int8_t*)outputRaw, fromNCHW, tId, numberThread, batch, channel, area);
+                break;
+            case 2:
+                _swapLayout((const int16_t*)inputRaw, (int16_t*)outputRaw, fromNCHW, tId, numberThread, batch, channel, area);
+                break;
+            case 4:
+                _swapLayout((const float*)inputRaw, (float*)outputRaw, fromNCHW, tId, numberThread, batch, channel, area);
+                break;
+            default:
+                break;
         }
         return NO_ERROR;
     }
@@ -140,39 +179,16 @@ ErrorCode CPUTensorConverter::convert(const void* inputRaw, void* outputRaw, MNN
             if (nullptr == proc) {
                 return NOT_SUPPORT;
             }
-            if (batch != 1) {
-                // Divide in batch
-                int offset[2] = {
-                    outside * inside,
-                    area
-                };
-                int step = UP_DIV(batch, numberThread);
-                int start = tId * step;
-                int end = std::min(start + step, batch);
-                if (end <= start) {
-                    return NO_ERROR;
-                }
-                for (int v=start; v<end; ++v) {
-                    auto inputStart = (int8_t*)inputRaw + (v * core->pack * bitLength * area);
-                    auto outputStart = (int8_t*)outputRaw + (v * channel * bitLength * area);
-                    proc((float*)outputStart, (const float*)inputStart, area, channel, offset);
-                }
-            } else {
-                // Divide in area
-                int offset[2] = {
-                    area,
-                    area
-                };
-                int step = UP_DIV(area, numberThread);
-                int start = tId * step;
-                int end = std::min(start + step, area);
-                if (end <= start) {
-                    return NO_ERROR;
-                }
-                auto inputStart = (int8_t*)inputRaw + (start * core->pack * bitLength);
-                auto outputStart = (int8_t*)outputRaw + (start * bitLength);
-                proc((float*)outputStart, (const float*)inputStart, end - start, channel, offset);
-            }
+            // NC4HW4 is [UP_DIV(channel, pack), batch, area, pack], divide in batch and area
+            int offset[2] = {
+                batch * area,
+                area
+            };
+            _divide(tId, numberThread, batch, area, [&](int v, int aStart, int aEnd) {
+                auto inputStart = (int8_t*)inputRaw + ((v * area + aStart) * core->pack * bitLength);
+                auto outputStart = (int8_t*)outputRaw + ((v * channel * area + aStart) * bitLength);
+                proc((float*)outputStart, (const float*)inputStart, aEnd - aStart, channel, offset);
+            });
         }
         return NO_ERROR;
     }
@@ -212,39 +228,16 @@ ErrorCode CPUTensorConverter::convert(const void* inputRaw, void* outputRaw, MNN
             if (nullptr == proc) {
                 return NOT_SUPPORT;
             }
-            if (batch != 1) {
-                // Divide in batch
-                int offset[2] = {
-                    area,
-                    outside * inside
-                };
-                int step = UP_DIV(batch, numberThread);
-                int start = tId * step;
-                int end = std::min(start + step, batch);
-                if (end <= start) {
-                    return NO_ERROR;
-                }
-                for (int v=start; v<end; ++v) {
-                    auto outputStart = (int8_t*)outputRaw + (v * core->pack * bitLength * area);
-                    auto inputStart = (int8_t*)inputRaw + (v * channel * bitLength * area);
-                    proc((float*)outputStart, (const float*)inputStart, area, channel, offset);
-                }
-            } else {
-                // Divide in area
-                int offset[2] = {
-                    area,
-                    area
-                };
-                int step = UP_DIV(area, numberThread);
-                int start = tId * step;
-                int end = std::min(start + step, area);
-                if (end <= start) {
-                    return NO_ERROR;
-                }
-                auto outputStart = (int8_t*)outputRaw + (start * core->pack * bitLength);
-                auto inputStart = (int8_t*)inputRaw + (start * bitLength);
-                proc((float*)outputStart, (const float*)inputStart, end - start, channel, offset);
-            }
+            // NC4HW4 is [UP_DIV(channel, pack), batch, area, pack], divide in batch and area
+            int offset[2] = {
+                area,
+                batch * area
+            };
+            _divide(tId, numberThread, batch, area, [&](int v, int aStart, int aEnd) {
+                auto outputStart = (int8_t*)outputRaw + ((v * area + aStart) * core->pack * bitLength);
+                auto inputStart = (int8_t*)inputRaw + ((v * channel * area + aStart) * bitLength);
+                proc((float*)outputStart, (const float*)inputStart, aEnd - aStart, channel, offset);
+            });
         }
         return NO_ERROR;
     }
@@ -298,7 +291,13 @@ ErrorCode CPUTensorConverter::convert(const Tensor* input, const Tensor* output,
             }
             dataSize *= currentDimSize;
         }
-        ::memcpy(ob.host, ib.host, dataSize * bitLength);
+        size_t total = (size_t)dataSize * bitLength;
+        size_t step  = UP_DIV(total, numberThread);
+        size_t start = ALIMIN(total, tId * step);
+        size_t end   = ALIMIN(total, start + step);
+        if (end > start) {
+            ::memcpy(ob.host + start, ib.host + start, end - start);
+        }
         return NO_ERROR;
     }
     if (source == MNN_DATA_FORMAT_UNKNOWN || dest == MNN_DATA_FORMAT_UNKNOWN) {
@@ -315,4 +314,30 @@ ErrorCode CPUTensorConverter::convert(const Tensor* input, const Tensor* output,
     return NO_ERROR;
 }
 
+ErrorCode CPUTensorConverter::convert(const Tensor* input, const Tensor* output, const CPUBackend* bn, const CoreFunctions* core) {
+    // Small tensors are not worth to wake up threads
+    int numberThread = input->elementSize() >= 16384 ? bn->threadNumber() : 1;
+    if (1 == numberThread) {
+        return convert(input, output, core);
+    }
+    std::vector<ErrorCode> codes(numberThread, NO_ERROR);
+    auto function = [&](int tId) {
+        codes[tId] = convert(input, output, core, tId, numberThread);
+    };
+#ifdef MNN_USE_THREAD_POOL
+    ThreadPool::TASK task = std::make_pair(function, numberThread);
+    ThreadPool::enqueue(std::move(task), bn->taskIndex(), bn->threadNumber());
+#else
+    for (int tId = 0; tId < numberThread; ++tId) {
+        function(tId);
+    }
+#endif
+    for (auto code : codes) {
+        if (NO_ERROR != code) {
+            return code;
+        }
+    }
+    return NO_ERROR;
+}
+
 } // namespace MNN
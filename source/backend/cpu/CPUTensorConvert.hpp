@@ -13,11 +13,13 @@
 #include "Tensor_generated.h"
 #include "compute/CommonOptFunction.h"
 namespace MNN {
-
+class CPUBackend;
 class CPUTensorConverter {
 public:
     static std::tuple<int, int, int> splitDimensions(const halide_buffer_t& ib, MNN_DATA_FORMAT source);
     static ErrorCode convert(const Tensor* input, const Tensor* output, const CoreFunctions* core = nullptr, int tId = 0, int numberThread = 1);
+    // Use the threads of bn for large tensor
+    static ErrorCode convert(const Tensor* input, const Tensor* output, const CPUBackend* bn, const CoreFunctions* core = nullptr);
     static ErrorCode convert(const void* inputRaw, void* outputRaw, MNN_DATA_FORMAT inputFormat, MNN_DATA_FORMAT outputFormat, int batch, int area, int channel, int bytes, const CoreFunctions* core, int tId = 0, int numberThread = 1);
 };
 
@@ -8,6 +8,8 @@
 #ifdef MNN_USE_THREAD_POOL
 #include "backend/cpu/ThreadPool.hpp"
 #include <string.h>
+#include <algorithm>
+#include <chrono>
 #include <MNN/MNNDefine.h>
 #ifdef __ANDROID__
 #include <stdint.h>
@@ -17,9 +19,9 @@
 #endif
 //#define MNN_THREAD_LOCK_CPU
 
-#define MNN_THREAD_POOL_MAX_TASKS 2
 namespace MNN {
 ThreadPool* ThreadPool::gInstance = nullptr;
+std::atomic<ThreadPool::TraceFunction> ThreadPool::gTraceFunction = {nullptr};
 static std::mutex gInitMutex;
 int ThreadPool::init(int number) {
     if (1 >= number) {
@@ -36,6 +38,19 @@ int ThreadPool::init(int number) {
     }
     return number;
 }
+int ThreadPool::poolSize() {
+    std::lock_guard<std::mutex> _l(gInitMutex);
+    if (nullptr == gInstance) {
+        return 1;
+    }
+    return gInstance->number();
+}
+void ThreadPool::setTraceFunction(TraceFunction function) {
+    gTraceFunction = function;
+}
+static inline int64_t _traceTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 void ThreadPool::destroy() {
     std::lock_guard<std::mutex> _l(gInitMutex);
     if (nullptr != gInstance) {
@@ -149,17 +164,17 @@ static int setSchedAffinity(const std::vector<int>& cpuIDs) {
 }
 
 #endif // arch
+static inline uint64_t _packRange(int begin, int end) {
+    return ((uint64_t)(uint32_t)end << 32) | (uint64_t)(uint32_t)begin;
+}
+static inline void _unpackRange(uint64_t range, int& begin, int& end) {
+    begin = (int)(uint32_t)(range & 0xffffffffULL);
+    end   = (int)(uint32_t)(range >> 32);
+}
+
 ThreadPool::ThreadPool(int numberThread) {
     mNumberThread = numberThread;
     mActiveCount  = 0;
-    mTaskAvailable.resize(MNN_THREAD_POOL_MAX_TASKS);
-    mTasks.resize(MNN_THREAD_POOL_MAX_TASKS);
-    for (int t = 0; t < mTasks.size(); ++t) {
-        mTaskAvailable[t] = true;
-        for (int i = 0; i < mNumberThread; ++i) {
-            mTasks[t].second.emplace_back(new std::atomic_bool{false});
-        }
-    }
 #ifdef MNN_THREAD_LOCK_CPU
     std::vector<int> sortedCPUIDs = sortCPUIDByMaxFrequency(numberThread);
 #endif
@@ -175,13 +190,31 @@ ThreadPool::ThreadPool(int numberThread) {
 #endif
             while (!mStop) {
                 while (mActiveCount > 0) {
-                    for (int i = 0; i < MNN_THREAD_POOL_MAX_TASKS; ++i) {
-                        if (*mTasks[i].second[threadIndex]) {
-                            mTasks[i].first.first(threadIndex);
-                            { *mTasks[i].second[threadIndex] = false; }
+                    bool worked = false;
+                    if (mJobNumber > 0) {
+                        // Start from different slot for different thread to spread the workers
+                        for (int j = 0; j < SLOT_NUMBER; ++j) {
+                            auto& slot = mSlots[(j + threadIndex) % SLOT_NUMBER];
+                            if (nullptr == slot.job.load()) {
+                                continue;
+                            }
+                            slot.users++;
+                            // Load again after registered as user, the owner won't release the job until users is zero
+                            auto job = slot.job.load();
+                            if (nullptr != job && job->joined < (int)job->ranges.size()) {
+                                int rangeIndex = job->joined++;
+                                if (rangeIndex < (int)job->ranges.size()) {
+                                    while (runOnce(job, rangeIndex, threadIndex)) {
+                                        worked = true;
+                                    }
+                                }
+                            }
+                            slot.users--;
                         }
                     }
-                    std::this_thread::yield();
+                    if (!worked) {
+                        std::this_thread::yield();
+                    }
                 }
                 std::unique_lock<std::mutex> _l(mQueueMutex);
                 mCondition.wait(_l, [this] { return mStop || mActiveCount > 0; });
@@ -199,35 +232,17 @@ ThreadPool::~ThreadPool() {
     for (auto& worker : mWorkers) {
         worker.join();
     }
-    for (auto& task : mTasks) {
-        for (auto c : task.second) {
-            delete c;
-        }
-    }
 }
 
 int ThreadPool::acquireWorkIndex() {
     if (nullptr == gInstance) {
         return -1;
     }
-    std::lock_guard<std::mutex> _l(gInstance->mQueueMutex);
-    for (int i = 0; i < MNN_THREAD_POOL_MAX_TASKS; ++i) {
-        if (gInstance->mTaskAvailable[i]) {
-            gInstance->mTaskAvailable[i] = false;
-            return i;
-        }
-    }
-    return -1;
+    // Work index only identify the user now, tasks of all users are scheduled together
+    return (gInstance->mWorkIndex++) & 0x7fffffff;
 }
 void ThreadPool::releaseWorkIndex(int index) {
-    if (nullptr == gInstance) {
-        return;
-    }
-    if (index < 0 || index >= MNN_THREAD_POOL_MAX_TASKS) {
-        return;
-    }
-    std::lock_guard<std::mutex> _l(gInstance->mQueueMutex);
-    gInstance->mTaskAvailable[index] = true;
+    // Nothing to release
 }
 
 void ThreadPool::active() {
@@ -247,54 +262,143 @@ void ThreadPool::deactive() {
     gInstance->mActiveCount--;
 }
 
-void ThreadPool::enqueue(TASK&& task, int index) {
-    if (1 >= task.second || 0 > index) {
+bool ThreadPool::popFront(Job* job, int rangeIndex, int& begin, int& end) {
+    auto& range = job->ranges[rangeIndex];
+    uint64_t current = range.load();
+    while (true) {
+        int b, e;
+        _unpackRange(current, b, e);
+        if (b >= e) {
+            return false;
+        }
+        int nb = std::min(e, b + job->chunk);
+        if (range.compare_exchange_weak(current, _packRange(nb, e))) {
+            begin = b;
+            end   = nb;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::stealBack(Job* job, int rangeIndex, int& begin, int& end) {
+    auto& range = job->ranges[rangeIndex];
+    uint64_t current = range.load();
+    while (true) {
+        int b, e;
+        _unpackRange(current, b, e);
+        if (b >= e) {
+            return false;
+        }
+        // Steal half of the remain work
+        int ne = e - std::max(1, (e - b) / 2);
+        if (range.compare_exchange_weak(current, _packRange(b, ne))) {
+            begin = ne;
+            end   = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runOnce(Job* job, int rangeIndex, int threadIndex) {
+    int begin = 0, end = 0;
+    auto own  = rangeIndex;
+    if (!popFront(job, own, begin, end)) {
+        bool stolen = false;
+        for (int i = 1; i < job->ranges.size(); ++i) {
+            if (stealBack(job, (own + i) % (int)job->ranges.size(), begin, end)) {
+                stolen = true;
+                break;
+            }
+        }
+        if (!stolen) {
+            return false;
+        }
+        // Put the stolen work back to own range so that it can be stolen again
+        uint64_t empty = job->ranges[own].load();
+        int b, e;
+        _unpackRange(empty, b, e);
+        if (end - begin > job->chunk && b >= e && job->ranges[own].compare_exchange_strong(empty, _packRange(begin, end))) {
+            return true;
+        }
+    }
+    auto trace = gTraceFunction.load();
+    int64_t beginTime = nullptr != trace ? _traceTime() : 0;
+    for (int i = begin; i < end; ++i) {
+        (*job->func)(i);
+    }
+    if (nullptr != trace) {
+        trace(threadIndex, beginTime, _traceTime(), end - begin);
+    }
+    job->remain -= (end - begin);
+    return true;
+}
+
+void ThreadPool::enqueue(TASK&& task, int index, int threadNumber) {
+    if (1 >= task.second || 0 > index || 1 == threadNumber) {
         for (int i = 0; i < task.second; ++i) {
             task.first(i);
         }
         return;
     }
     MNN_ASSERT(nullptr != gInstance);
-    gInstance->enqueueInternal(std::move(task), index);
+    gInstance->enqueueInternal(std::move(task), index, threadNumber);
 }
-void ThreadPool::enqueueInternal(TASK&& task, int index) {
+void ThreadPool::enqueueInternal(TASK&& task, int index, int threadNumber) {
     if (mActiveCount == 0) {
         for (int i = 0; i < task.second; ++i) {
             task.first(i);
         }
         return;
     }
-    int workSize = task.second;
-    if (workSize > mNumberThread) {
-        mTasks[index].first = std::make_pair(
-            [workSize, &task, this](int tId) {
-                for (int v = tId; v < workSize; v += mNumberThread) {
-                    task.first(v);
-                }
-            },
-            mNumberThread);
-        workSize = mNumberThread;
-    } else {
-        mTasks[index].first = std::move(task);
+    Slot* slot = nullptr;
+    for (int i = 0; i < SLOT_NUMBER; ++i) {
+        bool busy = false;
+        if (mSlots[i].busy.compare_exchange_strong(busy, true)) {
+            slot = mSlots + i;
+            break;
+        }
     }
-    {
-        for (int i = 1; i < workSize; ++i) {
-            *mTasks[index].second[i] = true;
+    if (nullptr == slot) {
+        // Too many tasks are running at the same time, the other threads are busy anyway
+        for (int i = 0; i < task.second; ++i) {
+            task.first(i);
         }
+        return;
+    }
+    int workSize = task.second;
+    // Keep the thread budget of caller's runtime, the pool may be larger when it's created by another runtime
+    int number = mNumberThread;
+    if (threadNumber > 0) {
+        number = std::min(number, threadNumber);
+    }
+    number = std::min(number, workSize);
+    Job job(number);
+    job.func   = &task.first;
+    job.remain = workSize;
+    // Several chunks per thread, so that uneven work can be balanced by stealing
+    job.chunk = std::max(1, workSize / (number * 4));
+    for (int i = 0; i < number; ++i) {
+        int begin = (int)((int64_t)workSize * i / number);
+        int end   = (int)((int64_t)workSize * (i + 1) / number);
+        job.ranges[i] = _packRange(begin, end);
     }
-    mTasks[index].first.first(0);
-    bool complete = true;
-    do {
+    slot->job = &job;
+    mJobNumber++;
+    // The caller use range 0 and help until all work is claimed
+    while (runOnce(&job, 0, 0)) {
+        // Do nothing
+    }
+    while (job.remain > 0) {
         std::this_thread::yield();
-        complete = true;
-        for (int i = 1; i < workSize; ++i) {
-            if (*mTasks[index].second[i]) {
-                complete = false;
-                break;
-            }
-        }
-        // FUNC_PRINT(notComplete);
-    } while (!complete);
+    }
+    slot->job = nullptr;
+    mJobNumber--;
+    while (slot->users > 0) {
+        std::this_thread::yield();
+    }
+    slot->busy = false;
 }
 } // namespace MNN
 #endif
@@ -25,7 +25,11 @@ public:
     int number() const {
         return mNumberThread;
     }
-    static void enqueue(TASK&& task, int index);
+    /**
+     Run task with the threads of pool. threadNumber is the thread number of the caller's runtime, the task is
+     run by at most threadNumber threads including the caller, 0 means all threads of pool.
+     */
+    static void enqueue(TASK&& task, int index, int threadNumber = 0);
 
     static void active();
     static void deactive();
@@ -35,24 +39,66 @@ public:
 
     static int init(int number);
     static void destroy();
+    // Thread number of the pool shared by all runtimes, fixed when the pool is created, 1 if there is no pool
+    static int poolSize();
+
+    /**
+     Called after a thread finished a piece of task with thread index, begin and end time in microseconds of
+     steady clock and the work size of the piece, used by profiler to see the balance of threads.
+     */
+    typedef void (*TraceFunction)(int threadIndex, int64_t beginUs, int64_t endUs, int workSize);
+    static void setTraceFunction(TraceFunction function);
 
 private:
-    void enqueueInternal(TASK&& task, int index);
+    /**
+     A task split into one range deque per participant. The owner of a range pops chunks from its front,
+     idle participants steal half of the remaining range from its back. The caller owns range 0, a worker
+     joins as the owner of next range while there is one left, so a job never uses more threads than ranges.
+     Any number of tasks can be scheduled at the same time, so concurrent sessions all get parallelism.
+     */
+    struct Job {
+        Job(int number) : ranges(number) {
+        }
+        const std::function<void(int)>* func = nullptr;
+        int chunk = 1;
+        // begin in low 32 bits and end in high 32 bits
+        std::vector<std::atomic<uint64_t>> ranges;
+        std::atomic_int remain = {0};
+        // Number of ranges taken by caller and workers
+        std::atomic_int joined = {1};
+    };
+    void enqueueInternal(TASK&& task, int index, int threadNumber);
+    static bool popFront(Job* job, int rangeIndex, int& begin, int& end);
+    static bool stealBack(Job* job, int rangeIndex, int& begin, int& end);
+    static bool runOnce(Job* job, int rangeIndex, int threadIndex);
 
     static ThreadPool* gInstance;
+    static std::atomic<TraceFunction> gTraceFunction;
     ThreadPool(int number = 0);
     ~ThreadPool();
 
     std::vector<std::thread> mWorkers;
-    std::vector<bool> mTaskAvailable;
     std::atomic<bool> mStop = {false};
 
-    std::vector<std::pair<TASK, std::vector<std::atomic_bool*>>> mTasks;
+    /**
+     Jobs are published in fixed slots so that workers find them without lock or copy. The owner claims a
+     free slot by busy, and after clearing job waits until no worker uses the slot before releasing it.
+     */
+    struct Slot {
+        std::atomic<Job*> job = {nullptr};
+        std::atomic_int users = {0};
+        std::atomic_bool busy = {false};
+    };
+    static const int SLOT_NUMBER = 16;
+    Slot mSlots[SLOT_NUMBER];
+    std::atomic_int mJobNumber = {0};
+
     std::condition_variable mCondition;
     std::mutex mQueueMutex;
 
     int mNumberThread            = 0;
     std::atomic_int mActiveCount = {0};
+    std::atomic_int mWorkIndex   = {0};
 };
 } // namespace MNN
 #endif
@@ -315,6 +315,68 @@ void MNNPackedMatMulRemain(float* C, const float* A, const float* B, size_t eSiz
     _MNNPackedMatMulRemain(C, A, B, eSize, parameter, postParameters, bias, aStride);
 }
 
+template <int BITS>
+static void _MNNPackedMatMulRemainWeightQuant(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) {
+    auto aStride = parameter[0] / sizeof(float);
+    auto h = parameter[2];
+    auto l = parameter[1];
+    auto cStride = parameter[3] / sizeof(float);
+    auto bExtraStride = parameter[5];
+    auto bStride = bExtraStride + l * 4 * BITS / 8;
+    auto hC4 = UP_DIV(h, 4);
+    float minValue = -std::numeric_limits<float>().max();
+    float maxValue = std::numeric_limits<float>().max();
+    if (nullptr != postParameters) {
+        minValue = postParameters[2];
+        maxValue = postParameters[3];
+    }
+    for (int y=0; y<hC4; ++y) {
+        auto weight = B + y * bStride;
+        auto dstY = C + y * cStride;
+        for (int x=0; x<eSize; ++x) {
+            float summer[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            if (nullptr != bias) {
+                for (int v=0; v<4; ++v) {
+                    summer[v] = bias[4 * y + v];
+                }
+            }
+            for (int z=0; z<l; ++z) {
+                auto aZ = A[x + z * aStride];
+                for (int v=0; v<4; ++v) {
+                    float q;
+                    if (8 == BITS) {
+                        q = (float)((const int8_t*)weight)[4 * z + v];
+                    } else {
+                        q = (float)((weight[2 * z + v / 2] >> (4 * (v % 2))) & 15);
+                    }
+                    summer[v] += (q * k[4 * y + v] + b[4 * y + v]) * aZ;
+                }
+            }
+            for (int v=0; v<4; ++v) {
+                auto dstValue = std::min(summer[v], maxValue);
+                dstValue = std::max(dstValue, minValue);
+                dstY[4 * x + v] = dstValue;
+            }
+        }
+    }
+}
+
+static void MNNPackedMatMul_int8(float* C, const float* A, const int8_t* B, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) {
+    _MNNPackedMatMulRemainWeightQuant<8>(C, A, (const uint8_t*)B, 16, parameter, postParameters, bias, k, b);
+}
+
+static void MNNPackedMatMulRemain_int8(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) {
+    _MNNPackedMatMulRemainWeightQuant<8>(C, A, (const uint8_t*)B, eSize, parameter, postParameters, bias, k, b);
+}
+
+static void MNNPackedMatMul_int4(float* C, const float* A, const uint8_t* B, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) {
+    _MNNPackedMatMulRemainWeightQuant<4>(C, A, B, 16, parameter, postParameters, bias, k, b);
+}
+
+static void MNNPackedMatMulRemain_int4(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) {
+    _MNNPackedMatMulRemainWeightQuant<4>(C, A, B, eSize, parameter, postParameters, bias, k, b);
+}
+
 
 void MNNPackC4ForMatMul_A(float* destOrigin, float const** sourceGroup, const int32_t* info, const int32_t* el) {
     int number = info[0];
@@ -2768,6 +2830,12 @@ void MNNCoreFunctionInit() {
     gCoreFunction->MNNPackForMatMul_B = MNNPackForMatMul_B;
     gCoreFunction->MNNPackedMatMul = MNNPackedMatMul;
     gCoreFunction->MNNPackedMatMulRemain = MNNPackedMatMulRemain;
+#ifndef MNN_USE_NEON
+    gCoreFunction->MNNPackedMatMul_int8 = MNNPackedMatMul_int8;
+    gCoreFunction->MNNPackedMatMulRemain_int8 = MNNPackedMatMulRemain_int8;
+    gCoreFunction->MNNPackedMatMul_int4 = MNNPackedMatMul_int4;
+    gCoreFunction->MNNPackedMatMulRemain_int4 = MNNPackedMatMulRemain_int4;
+#endif
 
     gCoreFunction->MNNGetSparseMatMulPackMode = MNNGetSparseMatMulPackMode;
     gCoreFunction->MNNPackForSparseMatMul_B = MNNPackForSparseMatMul_B; // sparse packing B
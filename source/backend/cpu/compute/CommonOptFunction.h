@@ -178,6 +178,13 @@ struct CoreFunctions {
     void(*MNNPackedMatMulRemain)(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias);
     void(*MNNComputeMatMulForH_1)(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
     void(*MNNComputeMatMulForE_1)(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
+    // B is weight-only quantized and packed as MNNPackForMatMul_B, dequantized in kernel as B * k + b for each h
+    // int8: one weight per byte; int4: two unsigned weights per byte, low 4 bits first
+    // parameters: the same as MNNPackedMatMul, but BStride is in bytes of B. nullptr if not supported
+    void(*MNNPackedMatMul_int8)(float* C, const float* A, const int8_t* B, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) = nullptr;
+    void(*MNNPackedMatMulRemain_int8)(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) = nullptr;
+    void(*MNNPackedMatMul_int4)(float* C, const float* A, const uint8_t* B, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) = nullptr;
+    void(*MNNPackedMatMulRemain_int4)(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b) = nullptr;
 
 
     typedef void(*MNNPackedMatMulKernel)(float* C, const float* A, const float* B, const size_t* parameter, const float* postParameters, const float* bias);
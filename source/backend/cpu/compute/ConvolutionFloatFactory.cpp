@@ -10,8 +10,9 @@
 #include "backend/cpu/CPUConvolutionDepthwise.hpp"
 #include "backend/cpu/compute/ConvOpt.h"
 #include "backend/cpu/compute/Convolution1x1Strassen.hpp"
-#include "backend/cpu/compute/ConvolutionGroup.hpp"
+#include "backend/cpu/compute/ConvolutionGroupTiledExecutor.hpp"
 #include "backend/cpu/compute/ConvolutionIntFactory.hpp"
+#include "backend/cpu/compute/ConvolutionTuner.hpp"
 
 #include "backend/cpu/compute/ConvolutionWinogradBridge.hpp"
 #include "backend/cpu/compute/DenseConvolutionTiledExecutor.hpp"
@@ -24,6 +25,57 @@
 
 namespace MNN {
 
+static Execution* _createByDecision(const ConvolutionTuner::Decision& decision, const Tensor* input, const Tensor* output,
+                                    Backend* backend, const Convolution2D* conv2d, const float* originWeight,
+                                    size_t originWeightSize, const float* bias, size_t biasSize) {
+    auto common = conv2d->common();
+    switch (decision.algorithm) {
+#ifdef MNN_USE_SPARSE_COMPUTE
+        case ConvolutionTuner::SPARSE:
+            return new SparseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize,
+                                                      conv2d->sparseParameter(), bias, biasSize);
+#endif
+        case ConvolutionTuner::STRASSEN_1x1:
+            return new Convolution1x1Strassen(common, backend, originWeight, originWeightSize, bias, biasSize);
+        case ConvolutionTuner::WINOGRAD:
+            return ConvolutionWinogradBridge::createWinogradImpl(common, input, output, backend, originWeight, originWeightSize,
+                                                                 bias, biasSize, decision.config, true);
+        default:
+            break;
+    }
+    auto dense = new DenseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize, bias, biasSize);
+    dense->setPerfConfig(decision.config);
+    return dense;
+}
+
+static std::vector<ConvolutionTuner::Decision> _tuningCandidates(const Tensor* input, const Tensor* output, CPUBackend* backend,
+                                                                 const Convolution2DCommon* common, bool useSparse, bool fastWay) {
+    std::vector<ConvolutionTuner::Decision> candidates;
+    ConvolutionTuner::Decision decision;
+    if (useSparse) {
+        decision.algorithm = ConvolutionTuner::SPARSE;
+        candidates.emplace_back(decision);
+    }
+    if (fastWay) {
+        decision.algorithm = ConvolutionTuner::STRASSEN_1x1;
+        candidates.emplace_back(decision);
+    }
+    auto denseConfig = DenseConvolutionTiledExecutor::bestTileConvolutionConfig(common, input, output, backend->threadNumber(), backend);
+    decision.algorithm = ConvolutionTuner::DENSE;
+    for (int parallelInner = 0; parallelInner < 2; ++parallelInner) {
+        decision.config = WinogradConfig(0, parallelInner > 0, denseConfig.eTile, denseConfig.ePack, denseConfig.hPack, -1);
+        candidates.emplace_back(decision);
+    }
+    if (ConvolutionWinogradBridge::canUseWinograd(common) && backend->memoryMode() != BackendConfig::Memory_Low) {
+        decision.algorithm = ConvolutionTuner::WINOGRAD;
+        for (auto& config : ConvolutionWinogradBridge::candidateConfigs(common, input, output, backend)) {
+            decision.config = config;
+            candidates.emplace_back(decision);
+        }
+    }
+    return candidates;
+}
+
 static Execution* _createUnit(const Tensor* input, const Tensor* output, Backend* backend,
                               const Convolution2D* conv2d, const float* originWeight, size_t originWeightSize,
                               const float* bias, size_t biasSize) {
@@ -31,7 +83,8 @@ static Execution* _createUnit(const Tensor* input, const Tensor* output, Backend
 #ifdef MNN_USE_ONEDNN
     return OneDNN::createConvolution(common, backend, originWeight, originWeightSize, bias, biasSize);
 #endif
-
+    auto cpuBackend = (CPUBackend*)backend;
+    bool useSparse  = false;
 #ifdef MNN_USE_SPARSE_COMPUTE
 
     auto core = static_cast<CPUBackend*>(backend)->functions();
@@ -42,23 +95,52 @@ static Execution* _createUnit(const Tensor* input, const Tensor* output, Backend
     const bool onlySSENotAVX = false;
 #endif
     if (!onlySSENotAVX && bytes == 4 && conv2d->sparseParameter()) {
-        if (SparseConvolutionTiledExecutor::shouldUseSparseConvolution(originWeightSize, conv2d->sparseParameter())) {
-            return new SparseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize,
-                                                      conv2d->sparseParameter(), bias, biasSize);
-        }
+        useSparse = SparseConvolutionTiledExecutor::shouldUseSparseConvolution(originWeightSize, conv2d->sparseParameter());
     }
 
 #endif
     bool fastWay = common->kernelY() == 1 && common->kernelX() == 1
         && output->width() == input->width() && output->height() == input->height()
         && common->strideX() == 1 && common->strideY() == 1;
+
+    // Use the measured algorithm if there is, or measure it in tuning mode
+    auto tuner = cpuBackend->getConvTuner();
+    auto key   = ConvolutionTuner::makeKey(common, input, output, cpuBackend, useSparse);
+    ConvolutionTuner::Decision decision;
+    bool found = tuner->find(key, decision);
+    if (found || cpuBackend->convTuning()) {
+        auto candidates = _tuningCandidates(input, output, cpuBackend, common, useSparse, fastWay);
+        auto creator = [&](const ConvolutionTuner::Decision& d, Backend* bn) {
+            return _createByDecision(d, input, output, bn, conv2d, originWeight, originWeightSize, bias, biasSize);
+        };
+        if (found) {
+            for (auto& c : candidates) {
+                // The cache may come from another version, only use it if it's still a candidate
+                if (ConvolutionTuner::same(c, decision)) {
+                    return creator(decision, backend);
+                }
+            }
+        }
+        if (cpuBackend->convTuning()) {
+            auto index = ConvolutionTuner::measure(candidates, creator, input, output, cpuBackend);
+            if (index >= 0) {
+                tuner->insert(key, candidates[index]);
+                return creator(candidates[index], backend);
+            }
+        }
+    }
+#ifdef MNN_USE_SPARSE_COMPUTE
+    if (useSparse) {
+        return new SparseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize,
+                                                  conv2d->sparseParameter(), bias, biasSize);
+    }
+#endif
     if (fastWay) {
         return new Convolution1x1Strassen(common, backend, originWeight, originWeightSize, bias, biasSize);
     }
     if (!ConvolutionWinogradBridge::canUseWinograd(common)) {
         return new DenseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize, bias, biasSize);
     }
-    auto cpuBackend = (CPUBackend*)backend;
     if (cpuBackend->memoryMode() == BackendConfig::Memory_Low) {
         return new DenseConvolutionTiledExecutor(common, backend, originWeight, originWeightSize, bias, biasSize);
     }
@@ -92,14 +174,45 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
     }
     const float* originWeight = nullptr;
     size_t originWeightSize   = 0;
+    const float* bias         = nullptr;
+    size_t biasSize           = 0;
+    int group                 = conv2d->common()->group();
+    if (conv2d->common()->inputCount() != inputs[0]->channel() && conv2d->common()->inputCount() > 0) {
+        group = inputs[0]->channel()/ conv2d->common()->inputCount();
+    }
+    // In low memory mode, keep weight-only quantized weight as int8 / int4 instead of turning it back to float
+    bool weightQuant = false;
+    if (nullptr != conv2d->quanParameter() && !conv2d->quanParameter()->has_scaleInt() && 1 == group) {
+        weightQuant = static_cast<CPUBackend*>(backend)->memoryMode() == BackendConfig::Memory_Low &&
+                      DenseConvolutionTiledExecutor::supportWeightQuant(backend);
+    }
     std::shared_ptr<ConvolutionCommon::Int8Common> quanCommon;
-    if (nullptr != conv2d->quanParameter()) {
-        quanCommon = ConvolutionCommon::load(conv2d->quanParameter());
+    if (nullptr != conv2d->external()) {
+        quanCommon = ConvolutionCommon::loadExternal(backend, conv2d, false, weightQuant);
+        if (nullptr == quanCommon) {
+            MNN_ERROR("Load external weight failed for Convolution: %s \n", op->name()->c_str());
+            return nullptr;
+        }
+        bias     = quanCommon->bias.get();
+        biasSize = quanCommon->bias.size();
+    } else if (nullptr != conv2d->quanParameter()) {
+        quanCommon = ConvolutionCommon::load(conv2d->quanParameter(), false, weightQuant);
         if (nullptr == quanCommon) {
             MNN_ERROR("Memory not Enough, can't extract IDST Convolution: %s \n", op->name()->c_str());
             return nullptr;
         }
-
+    } else if (nullptr == conv2d->weight() || nullptr == conv2d->bias()) {
+        MNN_ERROR("%s has no weight or bias. The model may be benchmark model, please revert the weight/bias firstly\n", op->name()->c_str());
+        return nullptr;
+    }
+    if (weightQuant && nullptr != quanCommon->weight.get() && nullptr == quanCommon->weightFloat.get()) {
+        if (nullptr == bias) {
+            bias     = conv2d->bias()->data();
+            biasSize = conv2d->bias()->size();
+        }
+        return new DenseConvolutionTiledExecutor(conv2d->common(), backend, quanCommon.get(), bias, biasSize);
+    }
+    if (nullptr != conv2d->quanParameter()) {
         if (quanCommon->weightFloat.get() == nullptr) {
             if (backend->type() != MNN_FORWARD_CPU) {
                 // From BF16
@@ -107,12 +220,15 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
             }
             return ConvolutionIntFactory::create(inputs[0], outputs[0], op, backend, quanCommon.get());
         }
+    }
+    if (nullptr != quanCommon) {
         // Back to float
         originWeight     = quanCommon->weightFloat.get();
         originWeightSize = quanCommon->weightFloat.size();
-    } else if (nullptr == conv2d->weight() || nullptr == conv2d->bias()) {
-        MNN_ERROR("%s has no weight or bias. The model may be benchmark model, please revert the weight/bias firstly\n", op->name()->c_str());
-        return nullptr;
+    }
+    if (nullptr == bias) {
+        bias     = conv2d->bias()->data();
+        biasSize = conv2d->bias()->size();
     }
     auto common = conv2d->common();
     if (nullptr == originWeight) {
@@ -120,29 +236,11 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
         originWeightSize = op->main_as_Convolution2D()->weight()->size();
     }
 
-    int group            = common->group();
-    if (common->inputCount() != inputs[0]->channel() && common->inputCount() > 0) {
-        group = inputs[0]->channel()/ conv2d->common()->inputCount();
-    }
     if (1 == group) {
         return _createUnit(inputs[0], outputs[0], backend, conv2d, originWeight, originWeightSize,
-                           conv2d->bias()->data(), conv2d->bias()->size());
-    }
-    // TODO: Use Geometry to split
-    // Split
-    std::vector<std::shared_ptr<Execution>> subConvolution;
-    auto groupOutputCount = common->outputCount() / group;
-    auto groupWeightSize  = originWeightSize / group;
-    std::shared_ptr<Tensor> emptyInput(Tensor::createDevice<float>(inputs[0]->shape(), Tensor::CAFFE_C4));
-    std::shared_ptr<Tensor> emptyOutput(Tensor::createDevice<float>(outputs[0]->shape(), Tensor::CAFFE_C4));
-    emptyInput->setLength(1, inputs[0]->channel() / group);
-    emptyOutput->setLength(1, outputs[0]->channel() / group);
-    for (int i = 0; i < group; ++i) {
-        auto newConvolution =
-            _createUnit(emptyInput.get(), emptyOutput.get(), backend, conv2d, originWeight + groupWeightSize * i,
-                        groupWeightSize, conv2d->bias()->data() + groupOutputCount * i, groupOutputCount);
-        subConvolution.push_back(std::shared_ptr<Execution>(newConvolution));
-    }
-    return new ConvolutionGroup(backend, subConvolution);
+                           bias, biasSize);
+    }
+    // Compute all groups in one im2col + gemm executor
+    return new ConvolutionGroupTiledExecutor(common, backend, originWeight, originWeightSize, bias, biasSize, group);
 }
 } // namespace MNN
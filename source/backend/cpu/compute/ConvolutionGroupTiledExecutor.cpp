@@ -0,0 +1,353 @@
+//
+//  ConvolutionGroupTiledExecutor.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "ConvolutionGroupTiledExecutor.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+#include "core/BufferAllocator.hpp"
+
+namespace MNN {
+
+ConvolutionGroupTiledExecutor::ConvolutionGroupTiledExecutor(const Convolution2DCommon* common, Backend* b,
+                                                             const float* originWeight, size_t originWeightSize,
+                                                             const float* bias, size_t biasSize, int group)
+    : CPUConvolution(common, b), mGroup(group) {
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    int bytes = core->bytes;
+    int unit  = core->pack;
+    int eP, lP, hP;
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    auto outputCount = (int)biasSize / group;
+    auto kernelSize  = common->kernelX() * common->kernelY();
+    // Don't use common->inputCount for old model common->inputCount is zero
+    auto srcCount    = (int)originWeightSize / group / outputCount / kernelSize;
+    auto lSize       = srcCount * kernelSize;
+    auto groupWeightSize = UP_DIV(outputCount, hP) * UP_DIV(lSize, lP) * hP * lP;
+    auto groupBiasSize   = UP_DIV(outputCount, unit) * unit;
+    mResource.reset(new CPUConvolution::Resource);
+    mResource->backend = b;
+    mResource->mWeight.reset(Tensor::createDevice<uint8_t>({group * groupWeightSize * bytes}));
+    mResource->mBias.reset(Tensor::createDevice<uint8_t>({group * groupBiasSize * bytes}));
+    std::shared_ptr<Tensor> cache(Tensor::createDevice<uint8_t>({(int)originWeightSize * (int)sizeof(float)})); // cache must be float
+    mValid = backend()->onAcquireBuffer(mResource->mWeight.get(), Backend::STATIC);
+    mValid = mValid && backend()->onAcquireBuffer(mResource->mBias.get(), Backend::STATIC);
+    mValid = mValid && backend()->onAcquireBuffer(cache.get(), Backend::STATIC);
+    if (!mValid) {
+        MNN_ERROR("Error for alloc memory for group convolution\n");
+        return;
+    }
+    // Swap k, ic, then pack the weight of each group for matmul
+    int dims[4] = {
+        srcCount,
+        kernelSize,
+        kernelSize,
+        srcCount
+    };
+    auto cacheHost = cache->host<float>();
+    for (int o = 0; o < outputCount * group; ++o) {
+        MNNTranspose32Bit((int32_t*)(cacheHost + o * lSize), (const int32_t*)(originWeight + o * lSize), &dims[0]);
+    }
+    if (bytes < 4) {
+        // Lowp
+        core->MNNFp32ToLowp(cacheHost, (int16_t*)cacheHost, (int)originWeightSize);
+    }
+    auto weightHost = mResource->mWeight->host<uint8_t>();
+    auto biasHost   = mResource->mBias->host<uint8_t>();
+    ::memset(biasHost, 0, group * groupBiasSize * bytes);
+    for (int g = 0; g < group; ++g) {
+        core->MNNPackForMatMul_B((float*)(weightHost + g * groupWeightSize * bytes),
+                                 (const float*)(cache->host<uint8_t>() + g * outputCount * lSize * bytes), outputCount,
+                                 lSize, true);
+        auto biasDst = biasHost + g * groupBiasSize * bytes;
+        if (bytes < 4) {
+            core->MNNFp32ToLowp(bias + g * outputCount, (int16_t*)biasDst, outputCount);
+        } else {
+            ::memcpy(biasDst, bias + g * outputCount, outputCount * bytes);
+        }
+    }
+    backend()->onReleaseBuffer(cache.get(), Backend::STATIC);
+}
+
+ConvolutionGroupTiledExecutor::ConvolutionGroupTiledExecutor(std::shared_ptr<CPUConvolution::Resource> res,
+                                                             const Convolution2DCommon* common, Backend* b, int group)
+    : CPUConvolution(common, b), mResource(res), mGroup(group) {
+    // Do nothing
+}
+
+bool ConvolutionGroupTiledExecutor::onClone(Backend* bn, const Op* op, Execution** dst) {
+    if (!mValid) {
+        return false;
+    }
+    if (nullptr == dst) {
+        return true;
+    }
+    *dst = new ConvolutionGroupTiledExecutor(mResource, op->main_as_Convolution2D()->common(), bn, mGroup);
+    return true;
+}
+
+ErrorCode ConvolutionGroupTiledExecutor::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    CPUConvolution::onResize(inputs, outputs);
+    auto input   = inputs[0];
+    auto output  = outputs[0];
+    auto core    = static_cast<CPUBackend*>(backend())->functions();
+    int bytes    = core->bytes;
+    int unit     = core->pack;
+    auto packA   = core->MNNPackC4ForMatMul_A;
+    int eP, lP, hP;
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    auto matmulUnit    = core->MNNPackedMatMul;
+    auto matmulRemain  = core->MNNPackedMatMulRemain;
+    auto strideX       = mCommon->strideX();
+    auto strideY       = mCommon->strideY();
+    auto dilateX       = mCommon->dilateX();
+    auto dilateY       = mCommon->dilateY();
+    auto padY          = mPadY;
+    auto padX          = mPadX;
+    auto kernel_width  = mCommon->kernelX();
+    auto kernel_height = mCommon->kernelY();
+    auto kernelSize    = kernel_width * kernel_height;
+    auto batch         = output->batch();
+    auto width         = output->width();
+    auto height        = output->height();
+    auto src_width     = input->width();
+    auto src_height    = input->height();
+    int threadNumber   = ((CPUBackend*)backend())->threadNumber();
+    auto group         = mGroup;
+    // Channels of one group
+    auto ic            = input->channel() / group;
+    auto oc            = output->channel() / group;
+    auto icC4          = UP_DIV(ic, unit);
+    auto ocC4          = UP_DIV(oc, unit);
+    auto L             = ic * kernelSize;
+    auto LRoundup      = ROUND_UP(L, lP);
+    auto srcPlane      = src_width * src_height * batch;
+    auto plane         = width * height * batch;
+    auto inputGroupStride  = (size_t)icC4 * srcPlane * unit * bytes;
+    auto outputGroupStride = (size_t)ocC4 * plane * unit * bytes;
+    auto weightGroupStride = (size_t)UP_DIV(oc, hP) * LRoundup * hP * bytes;
+    auto biasGroupStride   = (size_t)ocC4 * unit * bytes;
+
+    // If the channels of one group are aligned to pack, the groups of input / output can be used directly
+    mInputGroup.reset();
+    mInputRaw.reset();
+    mOutputGroup.reset();
+    mOutputRaw.reset();
+    std::vector<Tensor*> temps;
+    if (ic % unit != 0) {
+        mInputGroup.reset(Tensor::createDevice<uint8_t>({(int)(group * inputGroupStride)}));
+        mInputRaw.reset(Tensor::createDevice<uint8_t>({input->channel() * srcPlane * bytes}));
+        temps.emplace_back(mInputGroup.get());
+        temps.emplace_back(mInputRaw.get());
+    }
+    if (oc % unit != 0) {
+        mOutputGroup.reset(Tensor::createDevice<uint8_t>({(int)(group * outputGroupStride)}));
+        mOutputRaw.reset(Tensor::createDevice<uint8_t>({output->channel() * plane * bytes}));
+        temps.emplace_back(mOutputGroup.get());
+        temps.emplace_back(mOutputRaw.get());
+    }
+    mTempBufferTranspose.buffer().type          = halide_type_of<uint8_t>();
+    mTempBufferTranspose.buffer().dimensions    = 2;
+    mTempBufferTranspose.buffer().dim[0].extent = threadNumber;
+    mTempBufferTranspose.buffer().dim[1].extent = LRoundup * eP * bytes;
+    TensorUtils::setLinearLayout(&mTempBufferTranspose);
+    temps.emplace_back(&mTempBufferTranspose);
+    for (auto t : temps) {
+        if (!backend()->onAcquireBuffer(t, Backend::DYNAMIC)) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    auto bufferAlloc = static_cast<CPUBackend*>(backend())->getBufferAllocator();
+    auto maxLine     = UP_DIV(eP, width) + 1;
+    auto indexSize   = kernelSize * maxLine * (4 * sizeof(int32_t) + 2 * sizeof(float*));
+    auto tempPtr     = bufferAlloc->alloc(indexSize * threadNumber);
+    if (nullptr == tempPtr.first) {
+        return OUT_OF_MEMORY;
+    }
+    for (auto t : temps) {
+        backend()->onReleaseBuffer(t, Backend::DYNAMIC);
+    }
+    bufferAlloc->free(tempPtr);
+
+    auto postParameters = getPostParameters();
+    auto weight         = mResource->mWeight.get();
+    auto bias           = mResource->mBias.get();
+    auto inputGroup     = mInputGroup.get();
+    auto outputGroup    = mOutputGroup.get();
+    // Parallel for all tiles of all groups
+    int tileCount      = UP_DIV(plane, eP);
+    int total          = tileCount * group;
+    mFunction.first    = std::min(threadNumber, total);
+    auto threadNumberFirst = mFunction.first;
+    mFunction.second   = [=](int tId) {
+        auto gemmBuffer = mTempBufferTranspose.host<uint8_t>() + mTempBufferTranspose.stride(0) * tId;
+        auto srcPtr     = (float const**)((uint8_t*)tempPtr.first + tempPtr.second + tId * indexSize);
+        auto groupSrc   = srcPtr + kernelSize * maxLine;
+        auto el         = (int32_t*)(groupSrc + kernelSize * maxLine);
+        int32_t info[4];
+        info[1] = srcPlane;
+        info[2] = eP;
+        info[3] = strideX;
+        size_t parameters[6];
+        parameters[0] = eP * bytes;
+        parameters[1] = L;
+        parameters[2] = oc;
+        parameters[3] = plane * unit * bytes;
+        parameters[4] = 0;
+        parameters[5] = 0;
+        auto srcOrigin = nullptr != inputGroup ? inputGroup->host<uint8_t>() : input->host<uint8_t>();
+        auto dstOrigin = nullptr != outputGroup ? outputGroup->host<uint8_t>() : output->host<uint8_t>();
+        auto weightPtr = weight->host<uint8_t>();
+        auto biasPtr   = bias->host<uint8_t>();
+        int lastTile   = -1;
+        int number     = 0;
+        bool needZero  = false;
+        for (int index = tId; index < total; index += threadNumberFirst) {
+            int x      = index / group;
+            int g      = index % group;
+            int start  = x * eP;
+            int remain = plane - start;
+            int xC     = remain > eP ? eP : remain;
+            if (x != lastTile) {
+                // The im2col index is the same for all groups, only compute it when tile changed
+                lastTile      = x;
+                int oyBegin   = start / width;
+                int oxBegin   = start % width;
+                int oyEnd     = (start + xC - 1) / width;
+                int eStart    = 0;
+                remain        = xC;
+                number        = 0;
+                needZero      = false;
+                for (int oyb = oyBegin; oyb <= oyEnd; ++oyb) {
+                    int step    = std::min(width - oxBegin, remain);
+                    int oy      = oyb % height;
+                    int ob      = oyb / height;
+                    int sySta   = oy * strideY - padY;
+                    int kyStart = std::max(0, UP_DIV(-sySta, dilateY));
+                    int kyEnd   = std::min(kernel_height, UP_DIV(src_height - sySta, dilateY));
+                    if (kyEnd - kyStart < kernel_height) {
+                        needZero = true;
+                    }
+                    auto srcStart = srcOrigin + ((ob * src_height + sySta) * src_width) * bytes * unit;
+                    for (int ky = kyStart; ky < kyEnd; ++ky) {
+                        auto lKYOffset = ky * kernel_width * ic;
+                        auto srcKy     = srcStart + ky * dilateY * src_width * bytes * unit;
+                        for (int kx = 0; kx < kernel_width; ++kx) {
+                            /* Compute x range:*/
+                            /* 0 <= (oxBegin + x) * strideX - padX + dilateX * kx < src_width*/
+                            /* 0 <= x <= step*/
+                            int end = std::min(
+                                step, (src_width - oxBegin * strideX - dilateX * kx + padX + strideX - 1) / strideX);
+                            int sta = std::max(0, UP_DIV((padX - oxBegin * strideX - dilateX * kx), strideX));
+                            if (end - sta < step) {
+                                needZero = true;
+                            }
+                            if (end > sta) {
+                                auto lOffset = lKYOffset + (kx * ic);
+                                auto srcKx   = srcKy + ((oxBegin + sta) * strideX + dilateX * kx - padX) * bytes * unit;
+                                srcPtr[number]     = (const float*)srcKx;
+                                el[4 * number + 0] = end - sta;
+                                el[4 * number + 1] = ic;
+                                el[4 * number + 2] = eStart + sta;
+                                el[4 * number + 3] = lOffset;
+                                number++;
+                            }
+                        }
+                    }
+                    oxBegin = 0;
+                    remain -= step;
+                    eStart += step;
+                }
+            }
+            if (needZero || lP != 1) {
+                ::memset(gemmBuffer, 0, mTempBufferTranspose.stride(0));
+            }
+            for (int n = 0; n < number; ++n) {
+                groupSrc[n] = (const float*)((const uint8_t*)srcPtr[n] + g * inputGroupStride);
+            }
+            info[0] = number;
+            if (number > 0) {
+                packA((float*)gemmBuffer, groupSrc, info, el);
+            }
+            auto dst = (float*)(dstOrigin + g * outputGroupStride + start * unit * bytes);
+            auto B   = (const float*)(weightPtr + g * weightGroupStride);
+            auto biasValue = (const float*)(biasPtr + g * biasGroupStride);
+            if (xC == eP) {
+                matmulUnit(dst, (float*)gemmBuffer, B, parameters, postParameters.data(), biasValue);
+            } else {
+                matmulRemain(dst, (float*)gemmBuffer, B, xC, parameters, postParameters.data(), biasValue);
+            }
+        }
+    };
+    return NO_ERROR;
+}
+
+// Move between [UP_DIV(channel, pack), area, pack] and [group, UP_DIV(channel / group, pack), area, pack] by NCHW raw
+void ConvolutionGroupTiledExecutor::regroup(uint8_t* grouped, uint8_t* raw, uint8_t* packed, int area, int channel, bool split) {
+    auto core   = static_cast<CPUBackend*>(backend())->functions();
+    int threadNumber = ((CPUBackend*)backend())->threadNumber();
+    auto group  = mGroup;
+    auto bytes  = core->bytes;
+    auto unit   = core->pack;
+    auto groupChannel = channel / group;
+    auto groupStride  = (size_t)UP_DIV(groupChannel, unit) * area * unit * bytes;
+    int areaOffset[] = {area, area};
+    auto step = UP_DIV(area, threadNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        int sta = (int)tId * step;
+        int end = std::min(sta + step, area);
+        if (end > sta) {
+            if (split) {
+                core->MNNUnpackCUnit((float*)(raw + sta * bytes), (const float*)(packed + sta * unit * bytes), end - sta, channel, areaOffset);
+            } else {
+                for (int g = 0; g < group; ++g) {
+                    core->MNNUnpackCUnit((float*)(raw + ((size_t)g * groupChannel * area + sta) * bytes),
+                                         (const float*)(grouped + g * groupStride + sta * unit * bytes), end - sta, groupChannel, areaOffset);
+                }
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        int sta = (int)tId * step;
+        int end = std::min(sta + step, area);
+        if (end > sta) {
+            if (split) {
+                for (int g = 0; g < group; ++g) {
+                    core->MNNPackCUnit((float*)(grouped + g * groupStride + sta * unit * bytes),
+                                       (const float*)(raw + ((size_t)g * groupChannel * area + sta) * bytes), end - sta, groupChannel, areaOffset);
+                }
+            } else {
+                core->MNNPackCUnit((float*)(packed + sta * unit * bytes), (const float*)(raw + sta * bytes), end - sta, channel, areaOffset);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+}
+
+ErrorCode ConvolutionGroupTiledExecutor::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input  = inputs[0];
+    auto output = outputs[0];
+    if (nullptr != mInputGroup) {
+        regroup(mInputGroup->host<uint8_t>(), mInputRaw->host<uint8_t>(), input->host<uint8_t>(),
+                input->width() * input->height() * input->batch(), input->channel(), true);
+    }
+    MNN_CONCURRENCY_BEGIN(tId, mFunction.first) {
+        mFunction.second((int)tId);
+    }
+    MNN_CONCURRENCY_END();
+    if (nullptr != mOutputGroup) {
+        regroup(mOutputGroup->host<uint8_t>(), mOutputRaw->host<uint8_t>(), output->host<uint8_t>(),
+                output->width() * output->height() * output->batch(), output->channel(), false);
+    }
+    return NO_ERROR;
+}
+
+} // namespace MNN
@@ -0,0 +1,44 @@
+//
+//  ConvolutionGroupTiledExecutor.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ConvolutionGroupTiledExecutor_hpp
+#define ConvolutionGroupTiledExecutor_hpp
+
+#include <functional>
+#include "backend/cpu/CPUConvolution.hpp"
+// Im2Col + GEMM for group convolution, group is a batch dimension of GEMM
+namespace MNN {
+class ConvolutionGroupTiledExecutor : public CPUConvolution {
+public:
+    ConvolutionGroupTiledExecutor(const Convolution2DCommon *common, Backend *b, const float *originWeight,
+                                  size_t originWeightSize, const float *bias, size_t biasSize, int group);
+    ConvolutionGroupTiledExecutor(std::shared_ptr<CPUConvolution::Resource> res, const Convolution2DCommon *common,
+                                  Backend *b, int group);
+    virtual ~ConvolutionGroupTiledExecutor() = default;
+
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual bool onClone(Backend *bn, const Op *op, Execution **dst) override;
+
+private:
+    // Move between [UP_DIV(channel, pack), area, pack] and the grouped layout, split or merge
+    void regroup(uint8_t* grouped, uint8_t* raw, uint8_t* packed, int area, int channel, bool split);
+    std::shared_ptr<CPUConvolution::Resource> mResource;
+    int mGroup;
+    // Input / Output of all groups as [group, UP_DIV(channel / group, pack), plane, pack]
+    // Only needed when channel / group is not aligned to pack
+    std::shared_ptr<Tensor> mInputGroup;
+    std::shared_ptr<Tensor> mInputRaw;
+    std::shared_ptr<Tensor> mOutputGroup;
+    std::shared_ptr<Tensor> mOutputRaw;
+    Tensor mTempBufferTranspose;
+    std::pair<int, std::function<void(int)>> mFunction;
+};
+} // namespace MNN
+
+#endif /* ConvolutionGroupTiledExecutor_hpp */
@@ -25,8 +25,15 @@ Execution *ConvolutionIntFactory::create(const Tensor *input, const Tensor *outp
     if (conv2d->common()->inputCount() != input->channel() && conv2d->common()->inputCount() > 0) {
         group = input->channel()/ conv2d->common()->inputCount();
     }
+    const float* bias = conv2d->bias() ? conv2d->bias()->data() : nullptr;
+    size_t biasSize   = conv2d->bias() ? conv2d->bias()->size() : 0;
+    if (nullptr != common->bias.get()) {
+        // Loaded from external weight file
+        bias     = common->bias.get();
+        biasSize = common->bias.size();
+    }
     if (1 == group) {
-        return createUnit(input, output, op, backend, common, conv2d->bias()->data(), conv2d->bias()->size());
+        return createUnit(input, output, op, backend, common, bias, biasSize);
     }
     MNN_ASSERT(common->weight.get() != nullptr);
 
@@ -43,7 +50,7 @@ Execution *ConvolutionIntFactory::create(const Tensor *input, const Tensor *outp
         ::memcpy(subCommon->weight.get(), common->weight.get() + groupWeightSize * i, groupWeightSize * sizeof(int8_t));
         subConvolution.push_back(
             std::shared_ptr<Execution>(createUnit(input, output, op, backend, subCommon.get(),
-                                                  conv2d->bias()->data() + groupOutputCount * i, groupOutputCount)));
+                                                  bias + groupOutputCount * i, groupOutputCount)));
     }
     return new ConvolutionGroup(backend, subConvolution);
 }
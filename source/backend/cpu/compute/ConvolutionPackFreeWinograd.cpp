@@ -25,6 +25,11 @@
 
 constexpr int FUSE_THRESHHOLD_NUMERATOR = 10;
 constexpr int FUSE_THRESHHOLD_DENOMINATOR = 10;
+// Tile sizes of the pack-free multiply
+constexpr int dynamicHPack = 32;
+constexpr int ePackUnit = 14;
+constexpr int InnerEPackCount = 8;
+constexpr int OuterEPackCount = 2;
 
 using namespace MNN::Math;
 
@@ -69,6 +74,7 @@ bool ConvolutionPackFreeWinograd::onClone(Backend* bn, const Op* op, Execution**
     dstExe->mSourceTransformPack = mSourceTransformPack;
     dstExe->mSourceUnrollTransform = mSourceUnrollTransform;
     dstExe->mConvPerfconfig = mConvPerfconfig;
+    dstExe->mFixedConfig = mFixedConfig;
     dstExe->mDestUnrollTransform = mDestUnrollTransform;
     dstExe->mPostParameters = mPostParameters;
     *dst = dstExe;
@@ -1023,10 +1029,6 @@ WinogradConfig ConvolutionPackFreeWinograd::updateBestWinogradUnit(const Convolu
 
     //In next major version: Would be read from microbenchmark result file.
     constexpr int roofLine = 20;
-    constexpr int dynamicHPack = 32;
-    constexpr int ePackUnit = 14;
-    constexpr int InnerEPackCount = 8;
-    constexpr int OuterEPackCount = 2;
     for (int ePack = ePackUnit; ePack <= ePackUnit; ePack += ePackUnit) {
         int unit2   = UP_DIV(batch * ow * oh, ePack);
         int maxUnit = (int)::sqrtf((float)unit2);
@@ -1141,6 +1143,28 @@ WinogradConfig ConvolutionPackFreeWinograd::updateBestWinogradUnit(const Convolu
     return bestConfig;
 }
 
+std::vector<WinogradConfig> ConvolutionPackFreeWinograd::candidateConfigs(const Convolution2DCommon *common, const Tensor *inputTensor,
+                                          const Tensor *outputTensor, Backend* b) {
+    std::vector<WinogradConfig> configs;
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    auto kernelSize = common->kernelY();
+    std::set<int> supportSu{4, 6, 8};
+    CoreFunctions::WinoUnrollDestTransFunc destTransform[CONVOLUTION_WINOGRAD_MAX_UNIT + 1];
+    for (int u = CONVOLUTION_WINOGRAD_MIN_UNIT; u <= CONVOLUTION_WINOGRAD_MAX_UNIT; ++u) {
+        auto srcUnit = u + kernelSize - 1;
+        if (supportSu.find(srcUnit) == supportSu.end()) {
+            continue;
+        }
+        core->chooseWinoDestUnrollTransform(destTransform, CONVOLUTION_WINOGRAD_MAX_UNIT + 1, srcUnit, u);
+        if (nullptr == destTransform[srcUnit]) {
+            continue;
+        }
+        configs.emplace_back(WinogradConfig(u, false, ePackUnit * OuterEPackCount, ePackUnit, dynamicHPack, -1));
+        configs.emplace_back(WinogradConfig(u, true, ePackUnit * InnerEPackCount, ePackUnit, dynamicHPack, -1));
+    }
+    return configs;
+}
+
 bool ConvolutionPackFreeWinograd::updateWinogradBuffer(const Tensor* input, const Tensor* output) {
 
     auto core = static_cast<CPUBackend*>(backend())->functions();
@@ -1217,12 +1241,14 @@ ErrorCode ConvolutionPackFreeWinograd::onResize(const std::vector<Tensor *> &inp
     auto input   = inputs[0];
     auto output  = outputs[0];
     int threadNumber = std::max(((CPUBackend *)backend())->threadNumber(), 1);
-    WinogradConfig bestConfig = updateBestWinogradUnit(mCommon, input, output, threadNumber, backend());
-    if (bestConfig != mConvPerfconfig) {
-        mConvPerfconfig = bestConfig;
-        updateWinogradBuffer(input, output);
+    if (!mFixedConfig) {
+        WinogradConfig bestConfig = updateBestWinogradUnit(mCommon, input, output, threadNumber, backend());
+        if (bestConfig != mConvPerfconfig) {
+            mConvPerfconfig = bestConfig;
+            updateWinogradBuffer(input, output);
+        }
+        mConvPerfconfig.instructionCosts = bestConfig.instructionCosts;
     }
-    mConvPerfconfig.instructionCosts = bestConfig.instructionCosts;
 
     bool success = backend()->onAcquireBuffer(mTempBuffer.get(), Backend::DYNAMIC);
     success      = success && backend()->onAcquireBuffer(mGemmMidBuffer.get(), Backend::DYNAMIC);
@@ -32,7 +32,11 @@ public:
                                 int threadnumber, Backend* b, const PerfConfig& denseConfig);
     static WinogradConfig updateBestWinogradUnit(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
                                 int threadnumber, Backend* b);
+    static std::vector<WinogradConfig> candidateConfigs(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
+                                Backend* b);
     virtual bool onClone(Backend* bn, const Op* op, Execution** dst) override;
+    // Keep mConvPerfconfig on resize, set when it's decided by ConvolutionTuner
+    bool mFixedConfig = false;
 private:
     ConvolutionPackFreeWinograd(std::shared_ptr<CPUConvolution::Resource> resource, const Convolution2DCommon *convOp, Backend* b) : ConvolutionWinogradImpl(convOp, b) {
         mResource = resource;
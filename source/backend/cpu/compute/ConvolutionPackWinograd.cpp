@@ -509,6 +509,30 @@ WinogradConfig ConvolutionPackWinograd::bestWinogradUnit(const Convolution2DComm
     return wconfig;
 }
 
+std::vector<WinogradConfig> ConvolutionPackWinograd::candidateConfigs(const Convolution2DCommon *common, const Tensor *inputTensor,
+                                          const Tensor *outputTensor, Backend* b) {
+    // Only unit matters, the tile sizes are decided by core functions
+    std::vector<WinogradConfig> configs;
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    auto kernelSize = common->kernelY();
+    std::set<int> supportSu{4, 6, 8};
+    CoreFunctions::WinoUnrollDestTransFunc destTransform[CONVOLUTION_WINOGRAD_MAX_UNIT + 1];
+    for (int u = CONVOLUTION_WINOGRAD_MIN_UNIT; u <= CONVOLUTION_WINOGRAD_MAX_UNIT; ++u) {
+        auto sui = u + kernelSize - 1;
+        if (supportSu.find(sui) == supportSu.end()) {
+            continue;
+        }
+        core->chooseWinoDestUnrollTransform(destTransform, CONVOLUTION_WINOGRAD_MAX_UNIT + 1, sui, u);
+        if (nullptr == destTransform[sui]) {
+            continue;
+        }
+        WinogradConfig config;
+        config.unit = u;
+        configs.emplace_back(config);
+    }
+    return configs;
+}
+
 ErrorCode ConvolutionPackWinograd::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     CPUConvolution::onResize(inputs, outputs);
     // FUNC_PRINT(mA->length(1));
@@ -28,6 +28,8 @@ public:
 
     static WinogradConfig bestWinogradUnit(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
                                 int threadnumber, Backend* b, const PerfConfig& denseConfig);
+    static std::vector<WinogradConfig> candidateConfigs(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
+                                Backend* b);
     virtual bool onClone(Backend* bn, const Op* op, Execution** dst) override;
 private:
     ConvolutionPackWinograd(std::shared_ptr<CPUConvolution::Resource> resource, const Convolution2DCommon *convOp, Backend* b)
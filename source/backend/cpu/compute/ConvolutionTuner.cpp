@@ -0,0 +1,170 @@
+//
+//  ConvolutionTuner.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/24.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/compute/ConvolutionTuner.hpp"
+#include <string.h>
+#include <limits>
+#include <MNN/AutoTime.hpp>
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/ConvolutionCommon.hpp"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+// 'MCVT'
+static const int32_t gCacheMagic   = 0x5456434D;
+static const int32_t gCacheVersion = 1;
+static const int gKeySize          = 21;
+// algorithm, unit, isParallelInner, eTile, ePack, hPack, cost
+static const int gDecisionSize     = 7;
+static const int gMeasureLoop      = 3;
+
+std::vector<int> ConvolutionTuner::makeKey(const Convolution2DCommon* common, const Tensor* input, const Tensor* output,
+                                           const CPUBackend* backend, bool sparse) {
+    auto core = backend->functions();
+    auto pad  = ConvolutionCommon::convolutionPad(input, output, common);
+    std::vector<int> key = {
+        input->batch(), input->channel(), input->height(), input->width(),
+        output->channel(), output->height(), output->width(),
+        common->kernelY(), common->kernelX(), common->strideY(), common->strideX(),
+        common->dilateY(), common->dilateX(), pad.second, pad.first,
+        common->relu() ? 1 : 0, common->relu6() ? 1 : 0,
+        backend->threadNumber(), core->pack, core->bytes, sparse ? 1 : 0
+    };
+    MNN_ASSERT(key.size() == gKeySize);
+    return key;
+}
+
+bool ConvolutionTuner::same(const Decision& a, const Decision& b) {
+    if (a.algorithm != b.algorithm) {
+        return false;
+    }
+    switch (a.algorithm) {
+        case DENSE:
+            return a.config.isParallelInner == b.config.isParallelInner;
+        case WINOGRAD:
+            return a.config.unit == b.config.unit && a.config.isParallelInner == b.config.isParallelInner &&
+                   a.config.eTile == b.config.eTile && a.config.ePack == b.config.ePack && a.config.hPack == b.config.hPack;
+        default:
+            break;
+    }
+    return true;
+}
+
+int ConvolutionTuner::measure(std::vector<Decision>& candidates, const Creator& creator, const Tensor* input,
+                              const Tensor* output, const CPUBackend* backend) {
+    // Measure on another backend, so that the memory planning of the resizing backend isn't disturbed
+    std::shared_ptr<Backend> tempBackend(backend->getRuntime()->onCreate(nullptr));
+    auto cpuBackend = static_cast<CPUBackend*>(tempBackend.get());
+    if (cpuBackend->functions() != backend->functions() || cpuBackend->threadNumber() != backend->threadNumber()) {
+        return -1;
+    }
+    std::shared_ptr<Tensor> tempInput(Tensor::createDevice<float>(input->shape(), Tensor::CAFFE_C4));
+    std::shared_ptr<Tensor> tempOutput(Tensor::createDevice<float>(output->shape(), Tensor::CAFFE_C4));
+    if (!tempBackend->onAcquireBuffer(tempInput.get(), Backend::STATIC) ||
+        !tempBackend->onAcquireBuffer(tempOutput.get(), Backend::STATIC)) {
+        return -1;
+    }
+    ::memset(tempInput->host<void>(), 0, cpuBackend->getTensorSize(tempInput.get(), true));
+    std::vector<Tensor*> inputs  = {tempInput.get()};
+    std::vector<Tensor*> outputs = {tempOutput.get()};
+    int bestIndex  = -1;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int i = 0; i < candidates.size(); ++i) {
+        std::shared_ptr<Execution> execution(creator(candidates[i], tempBackend.get()));
+        if (nullptr == execution || !execution->valid()) {
+            continue;
+        }
+        tempBackend->onResizeBegin();
+        auto code = execution->onResize(inputs, outputs);
+        tempBackend->onResizeEnd();
+        if (NO_ERROR != code) {
+            continue;
+        }
+        tempBackend->onExecuteBegin();
+        // First run for warm up
+        code = execution->onExecute(inputs, outputs);
+        float cost = std::numeric_limits<float>::max();
+        for (int loop = 0; loop < gMeasureLoop && NO_ERROR == code; ++loop) {
+            Timer timer;
+            code = execution->onExecute(inputs, outputs);
+            cost = std::min(cost, (float)timer.durationInUs());
+        }
+        tempBackend->onExecuteEnd();
+        if (NO_ERROR != code) {
+            continue;
+        }
+        candidates[i].cost = cost;
+        if (cost < bestCost) {
+            bestCost  = cost;
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
+
+bool ConvolutionTuner::find(const std::vector<int>& key, Decision& decision) const {
+    std::lock_guard<std::mutex> _l(mLock);
+    auto iter = mDecisions.find(key);
+    if (iter == mDecisions.end()) {
+        return false;
+    }
+    decision = iter->second;
+    return true;
+}
+
+void ConvolutionTuner::insert(const std::vector<int>& key, const Decision& decision) {
+    std::lock_guard<std::mutex> _l(mLock);
+    mDecisions[key] = decision;
+}
+
+bool ConvolutionTuner::load(const void* buffer, size_t size) {
+    auto data = (const int32_t*)buffer;
+    if (size < 4 * sizeof(int32_t) || data[0] != gCacheMagic || data[1] != gCacheVersion || data[3] != gKeySize) {
+        return false;
+    }
+    const size_t count = data[2];
+    if (size != (4 + count * (gKeySize + gDecisionSize)) * sizeof(int32_t)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> _l(mLock);
+    data += 4;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<int> key(data, data + gKeySize);
+        data += gKeySize;
+        Decision decision;
+        decision.algorithm              = data[0];
+        decision.config.unit            = data[1];
+        decision.config.isParallelInner = data[2] > 0;
+        decision.config.eTile           = data[3];
+        decision.config.ePack           = data[4];
+        decision.config.hPack           = data[5];
+        ::memcpy(&decision.cost, data + 6, sizeof(float));
+        data += gDecisionSize;
+        mDecisions[key] = decision;
+    }
+    return true;
+}
+
+std::pair<const void*, size_t> ConvolutionTuner::save() {
+    std::lock_guard<std::mutex> _l(mLock);
+    if (mDecisions.empty()) {
+        return std::make_pair(nullptr, 0);
+    }
+    mBuffer = {gCacheMagic, gCacheVersion, (int32_t)mDecisions.size(), gKeySize};
+    for (auto& iter : mDecisions) {
+        mBuffer.insert(mBuffer.end(), iter.first.begin(), iter.first.end());
+        auto& decision = iter.second;
+        int32_t cost;
+        ::memcpy(&cost, &decision.cost, sizeof(float));
+        mBuffer.insert(mBuffer.end(), {decision.algorithm, decision.config.unit, decision.config.isParallelInner ? 1 : 0,
+                                       decision.config.eTile, decision.config.ePack, decision.config.hPack, cost});
+    }
+    return std::make_pair(mBuffer.data(), mBuffer.size() * sizeof(int32_t));
+}
+
+} // namespace MNN
@@ -0,0 +1,65 @@
+//
+//  ConvolutionTuner.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/24.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ConvolutionTuner_hpp
+#define ConvolutionTuner_hpp
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include "backend/cpu/compute/ConvolutionWinogradImpl.hpp"
+
+namespace MNN {
+/**
+ Measure the candidate algorithms of float convolution on the machine and keep the fastest one for each shape.
+ The decisions are owned by CPURuntime and saved to / loaded from the cache file by onGetCache / onSetCache.
+ */
+class ConvolutionTuner {
+public:
+    enum Algorithm {
+        DENSE = 0,
+        STRASSEN_1x1 = 1,
+        WINOGRAD = 2,
+        SPARSE = 3,
+    };
+    struct Decision {
+        int algorithm = DENSE;
+        // isParallelInner / eTile / ePack / hPack for dense and winograd, unit only for winograd
+        WinogradConfig config;
+        // Measured cost in us
+        float cost = 0.0f;
+    };
+    typedef std::function<Execution*(const Decision& decision, Backend* backend)> Creator;
+
+    static std::vector<int> makeKey(const Convolution2DCommon* common, const Tensor* input, const Tensor* output,
+                                    const CPUBackend* backend, bool sparse);
+    // Whether the two decisions create the same execution
+    static bool same(const Decision& a, const Decision& b);
+    /**
+     * @brief create, resize and run each candidate on a temporary backend of the same runtime.
+     * @return index of the fastest candidate, -1 if none of them works.
+     */
+    static int measure(std::vector<Decision>& candidates, const Creator& creator, const Tensor* input,
+                       const Tensor* output, const CPUBackend* backend);
+
+    bool find(const std::vector<int>& key, Decision& decision) const;
+    void insert(const std::vector<int>& key, const Decision& decision);
+
+    // Return false if the buffer isn't a convolution tuning cache
+    bool load(const void* buffer, size_t size);
+    // Return nullptr if no decision is made
+    std::pair<const void*, size_t> save();
+
+private:
+    mutable std::mutex mLock;
+    std::map<std::vector<int>, Decision> mDecisions;
+    std::vector<int32_t> mBuffer;
+};
+} // namespace MNN
+
+#endif /* ConvolutionTuner_hpp */
@@ -33,6 +33,17 @@ WinogradConfig ConvolutionWinogradBridge::bestWinogradUnit(const Convolution2DCo
 
 }
 
+std::vector<WinogradConfig> ConvolutionWinogradBridge::candidateConfigs(const Convolution2DCommon *common, const Tensor *inputTensor,
+                                                                     const Tensor *outputTensor, Backend* b) {
+#ifdef MNN_USE_SSE
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    if (16 == core->pack) { // avx512
+        return ConvolutionPackFreeWinograd::candidateConfigs(common, inputTensor, outputTensor, b);
+    }
+#endif
+    return ConvolutionPackWinograd::candidateConfigs(common, inputTensor, outputTensor, b);
+}
+
 bool ConvolutionWinogradBridge::canUseWinograd(const Convolution2DCommon *common) {
     return ConvolutionPackWinograd::canUseWinograd(common);
 }
@@ -41,14 +52,16 @@ ConvolutionWinogradImpl *ConvolutionWinogradBridge::createWinogradImpl(const Con
                                                                        const Tensor *input, const Tensor *output,
                                                                        Backend *b, const float *originWeight,
                                                                        size_t originWeightSize, const float *bias,
-                                                                       size_t biasSize, WinogradConfig config) {
+                                                                       size_t biasSize, WinogradConfig config, bool fixedConfig) {
 
 #ifdef MNN_USE_SSE
     auto core = static_cast<CPUBackend*>(b)->functions();
     // Adopt different algorithm for x86 and arm
     if (16 == core->pack) { // avx512
-        return new ConvolutionPackFreeWinograd(common, input, output, b, originWeight, originWeightSize, bias, biasSize,
+        auto winograd = new ConvolutionPackFreeWinograd(common, input, output, b, originWeight, originWeightSize, bias, biasSize,
                                    config);
+        winograd->mFixedConfig = fixedConfig;
+        return winograd;
     } else {
 #endif
 
@@ -22,9 +22,14 @@ public:
     static WinogradConfig bestWinogradUnit(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
         int threadnumber, Backend* b, const PerfConfig& denseConfig);
 
+    // All the configs worth measuring, used by ConvolutionTuner
+    static std::vector<WinogradConfig> candidateConfigs(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output,
+        Backend* b);
+
+    // fixedConfig: keep the config on resize instead of estimating a new one
     static ConvolutionWinogradImpl* createWinogradImpl(const Convolution2DCommon *convOp, const Tensor *input, const Tensor *output, Backend *b,
         const float *originWeight, size_t originWeightSize, const float *bias, size_t biasSize,
-        WinogradConfig config);
+        WinogradConfig config, bool fixedConfig = false);
 };
 
 } // namespace MNN
@@ -23,7 +23,7 @@ public:
     WinogradConfig() : PerfConfig(), unit{0} {
     }
     WinogradConfig(int unit_, bool isParallelInner_, int eTile_, int ePack_, int hPack_, float instructionCosts_)
-        :  PerfConfig(unit_, eTile_, ePack_, hPack_, instructionCosts_), unit{unit_} {
+        :  PerfConfig(isParallelInner_, eTile_, ePack_, hPack_, instructionCosts_), unit{unit_} {
     }
     bool operator!=(const WinogradConfig& other) {
         return unit != other.unit || isParallelInner != other.isParallelInner || ePack != other.ePack || eTile != other.eTile || hPack != other.hPack;
@@ -7,6 +7,7 @@
 //
 
 #include "DenseConvolutionTiledExecutor.hpp"
+#include <cmath>
 #include <MNN/AutoTime.hpp>
 #include "backend/cpu/CPUBackend.hpp"
 #include "CommonOptFunction.h"
@@ -57,8 +58,94 @@ DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(const Convolution2D
     mProxy.reset(new DenseConvolutionTiledImpl(common, b));
 }
 
+bool DenseConvolutionTiledExecutor::supportWeightQuant(Backend* b) {
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    int eP, lP, hP;
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    if (nullptr == core->MNNPackedMatMul_int8 || nullptr == core->MNNPackedMatMul_int4) {
+        return false;
+    }
+    // The kernels dequantize a row of 4 h, int4 weight of an output block should start at whole byte
+    return core->bytes == 4 && lP == 1 && hP == 4 && core->pack % hP == 0;
+}
+
+DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(const Convolution2DCommon* common, Backend* b,
+                                                   const ConvolutionCommon::Int8Common* quanCommon,
+                                                   const float* bias, size_t biasSize)
+    : ConvolutionTiledExecutor(b, bias, biasSize) {
+    auto outputCount = (int)biasSize;
+    int eP, lP, hP;
+    auto core = static_cast<CPUBackend*>(b)->functions();
+    core->MNNGetMatMulPackMode(&eP, &lP, &hP);
+    auto quan        = quanCommon->quan;
+    auto weight      = quanCommon->weight.get();
+    auto weightSize  = (int)quanCommon->weight.size();
+    auto kernelSize  = common->kernelX() * common->kernelY();
+    auto srcCount    = weightSize / outputCount / kernelSize;
+    auto lSize       = srcCount * kernelSize;
+    // Use int4 if all of the weight can be kept in 4 bits
+    int bits = 4;
+    for (int i = 0; i < weightSize; ++i) {
+        if (weight[i] < -8 || weight[i] > 7) {
+            bits = 8;
+            break;
+        }
+    }
+    auto alignOutput = UP_DIV(outputCount, core->pack) * core->pack;
+    auto& dequantize = mResource->dequantize;
+    dequantize.bits = bits;
+    dequantize.mScaleBias.reset(Tensor::createDevice<float>({2, alignOutput}));
+    mResource->mWeight.reset(Tensor::createDevice<uint8_t>({UP_DIV(outputCount, hP) * lSize * hP * bits / 8}));
+    mValid = mValid && backend()->onAcquireBuffer(mResource->mWeight.get(), Backend::STATIC);
+    mValid = mValid && backend()->onAcquireBuffer(dequantize.mScaleBias.get(), Backend::STATIC);
+    if (!mValid) {
+        return;
+    }
+    // The same as ConvolutionCommon::load when it turns weight back to float
+    auto k = dequantize.mScaleBias->host<float>();
+    auto kb = k + alignOutput;
+    ::memset(k, 0, 2 * alignOutput * sizeof(float));
+    bool oldType4 = (quan->type() == 4 && quan->aMin() == 0 && std::abs(quan->quantScale()) < 1e-6);
+    float extraFactor = oldType4 ? 1.0f : quan->quantScale();
+    float clampMin = quan->aMin() == 0 ? -128 : quan->aMin();
+    auto alpha = quanCommon->alpha.get();
+    bool asymmetric = quanCommon->alpha.size() == 2 * outputCount;
+    for (int o = 0; o < outputCount; ++o) {
+        if (asymmetric) {
+            k[o]  = alpha[2 * o + 1] * extraFactor;
+            kb[o] = (alpha[2 * o] - clampMin * alpha[2 * o + 1]) * extraFactor;
+        } else {
+            k[o]  = alpha[o] * extraFactor;
+            kb[o] = 0.0f;
+        }
+        if (4 == bits) {
+            // int4 is stored as q + 8
+            kb[o] -= 8.0f * k[o];
+        }
+    }
+    // Pack as MNNPackForMatMul_B: [oc, ic, k] -> [oc / hP, k * ic, hP]
+    auto dst = mResource->mWeight->host<uint8_t>();
+    ::memset(dst, 0, mResource->mWeight->size());
+    for (int o = 0; o < outputCount; ++o) {
+        for (int c = 0; c < srcCount; ++c) {
+            for (int kk = 0; kk < kernelSize; ++kk) {
+                int q     = weight[(o * srcCount + c) * kernelSize + kk];
+                int index = (o / hP) * lSize * hP + (kk * srcCount + c) * hP + o % hP;
+                if (8 == bits) {
+                    ((int8_t*)dst)[index] = (int8_t)q;
+                } else {
+                    dst[index / 2] |= (uint8_t)((q + 8) << (4 * (index % 2)));
+                }
+            }
+        }
+    }
+    mProxy.reset(new DenseConvolutionTiledImpl(common, b));
+    mProxy->mDequantize = dequantize;
+}
+
 DenseConvolutionTiledExecutor::DenseConvolutionTiledExecutor(std::shared_ptr<CPUConvolution::Resource> res, const Convolution2DCommon* common, Backend* b) : ConvolutionTiledExecutor(res, b) {
     mProxy.reset(new DenseConvolutionTiledImpl(common, b));
+    mProxy->mDequantize = mResource->dequantize;
 }
 
 DenseConvolutionTiledExecutor::~DenseConvolutionTiledExecutor() {
@@ -73,6 +160,7 @@ bool DenseConvolutionTiledExecutor::onClone(Backend* bn, const Op* op, Execution
     }
     auto dense = new DenseConvolutionTiledExecutor(mResource, op->main_as_Convolution2D()->common(), bn);
     dense->mProxy->mConvPerfconfig = mProxy->mConvPerfconfig;
+    dense->mProxy->mFixedConfig = mProxy->mFixedConfig;
     *dst = dense;
     return true;
 }
@@ -339,7 +427,9 @@ ErrorCode DenseConvolutionTiledImpl::onResize(const std::vector<Tensor*>& inputs
     auto plane    = width * height * batch;
     int tileCount = UP_DIV(plane, eP);
     auto oC4           = UP_DIV(outputChannel, unit);
-    mConvPerfconfig = bestTileConvolutionConfig(mCommon, input, output, threadNumber, backend());
+    if (!mFixedConfig) {
+        mConvPerfconfig = bestTileConvolutionConfig(mCommon, input, output, threadNumber, backend());
+    }
 
     auto threadNumberFirst = mConvPerfconfig.isParallelInner ? threadNumber : std::min(threadNumber, tileCount);
     bool success = backend()->onAcquireBuffer(&mTempBufferTranspose, Backend::DYNAMIC);
@@ -359,6 +449,43 @@ ErrorCode DenseConvolutionTiledImpl::onResize(const std::vector<Tensor*>& inputs
     auto postParameters    = getPostParameters();
     mFunction.first        = threadNumberFirst;
 
+    // Compute the output channels from ocIndex, weight may be quantized and dequantized by kernel
+    auto weightBits = mDequantize.bits;
+    const float* dequantK = nullptr;
+    const float* dequantB = nullptr;
+    if (weightBits < 32) {
+        dequantK = mDequantize.mScaleBias->host<float>();
+        dequantB = dequantK + mDequantize.mScaleBias->length(1);
+    }
+    auto matmul = [=](float* C, const float* A, const uint8_t* weightPtr, int ocIndex, int xC, const size_t* parameters,
+                      const float* post, const float* biasValue) {
+        auto weightOffset = (ocIndex / hP) * LRoundup * hP + ocIndex % hP;
+        if (8 == weightBits) {
+            auto B = (const int8_t*)(weightPtr + weightOffset);
+            if (xC == eP) {
+                core->MNNPackedMatMul_int8(C, A, B, parameters, post, biasValue, dequantK + ocIndex, dequantB + ocIndex);
+            } else {
+                core->MNNPackedMatMulRemain_int8(C, A, B, xC, parameters, post, biasValue, dequantK + ocIndex, dequantB + ocIndex);
+            }
+            return;
+        }
+        if (4 == weightBits) {
+            auto B = weightPtr + weightOffset / 2;
+            if (xC == eP) {
+                core->MNNPackedMatMul_int4(C, A, B, parameters, post, biasValue, dequantK + ocIndex, dequantB + ocIndex);
+            } else {
+                core->MNNPackedMatMulRemain_int4(C, A, B, xC, parameters, post, biasValue, dequantK + ocIndex, dequantB + ocIndex);
+            }
+            return;
+        }
+        auto B = (const float*)(weightPtr + weightOffset * bytes);
+        if (xC == eP) {
+            matmulUnit(C, A, B, parameters, post, biasValue);
+        } else {
+            matmulRemain(C, A, B, xC, parameters, post, biasValue);
+        }
+    };
+
     if (mConvPerfconfig.isParallelInner) {
 
         mFunction.second = [=](int placeholder) {
@@ -485,33 +612,17 @@ ErrorCode DenseConvolutionTiledImpl::onResize(const std::vector<Tensor*>& inputs
             timer[0].reset();
 #endif
 
-            if (xC == eP) {
-                MNN_CONCURRENCY_BEGIN(tId, threadNumberFirst) {
-                    size_t paraParameters[PARAMETERSIZE];
-                    memcpy(paraParameters, parameters, PARAMETERSIZE * sizeof(size_t));
-                    for (int t_oc = tId; t_oc < oC4; t_oc += threadNumberFirst) {
-                        auto _dstFloatPtr = (float*)(dstOrigin + (t_oc * plane + start) * unit * bytes);
-                        int ocIndex = t_oc * unit;
-                        auto _weightFloatPtr = (const float*)(weightPtr + ((ocIndex / hP) * LRoundup * hP + ocIndex % hP) * bytes);
-                        paraParameters[2] = std::min(outputChannel - (t_oc * unit), unit);
-                        matmulUnit(_dstFloatPtr, (float*)gemmBuffer, _weightFloatPtr, paraParameters, postParameters.data(), biasPtr + ocIndex);
-                    }
-                }
-                MNN_CONCURRENCY_END();
-            } else {
-                MNN_CONCURRENCY_BEGIN(tId, threadNumberFirst) {
-                    size_t paraParameters[PARAMETERSIZE];
-                    memcpy(paraParameters, parameters, PARAMETERSIZE * sizeof(size_t));
-                    for (int t_oc = tId; t_oc < oC4; t_oc += threadNumberFirst) {
-                        auto _dstFloatPtr = (float*)(dstOrigin + (t_oc * plane + start) * unit * bytes);
-                        int ocIndex = t_oc * unit;
-                        auto _weightFloatPtr = (const float*)(weightPtr + ((ocIndex / hP) * LRoundup * hP + ocIndex % hP) * bytes);
-                        paraParameters[2] = std::min(outputChannel - (t_oc * unit), unit);
-                        matmulRemain(_dstFloatPtr, (float*)gemmBuffer, _weightFloatPtr, xC, paraParameters, postParameters.data(), biasPtr + ocIndex);
-                    }
+            MNN_CONCURRENCY_BEGIN(tId, threadNumberFirst) {
+                size_t paraParameters[PARAMETERSIZE];
+                memcpy(paraParameters, parameters, PARAMETERSIZE * sizeof(size_t));
+                for (int t_oc = tId; t_oc < oC4; t_oc += threadNumberFirst) {
+                    auto _dstFloatPtr = (float*)(dstOrigin + (t_oc * plane + start) * unit * bytes);
+                    int ocIndex = t_oc * unit;
+                    paraParameters[2] = std::min(outputChannel - (t_oc * unit), unit);
+                    matmul(_dstFloatPtr, (float*)gemmBuffer, weightPtr, ocIndex, xC, paraParameters, postParameters.data(), biasPtr + ocIndex);
                 }
-                MNN_CONCURRENCY_END();
             }
+            MNN_CONCURRENCY_END();
 
 #ifdef PROFILE_DETAIL
          macs[0] += 2.0 * xC * L * oC4 * unit / threadNumberFirst;
@@ -544,7 +655,7 @@ ErrorCode DenseConvolutionTiledImpl::onResize(const std::vector<Tensor*>& inputs
             auto srcPtr     = (float const **)((uint8_t *)tempPtr.first + tempPtr.second +
                                            tId * kernelSize * maxLine * (4 * sizeof(int32_t) + sizeof(float *)));
             auto el         = (int32_t *)(srcPtr + kernelSize * maxLine);
-            auto weightPtr = weight->host<float>();
+            auto weightPtr = weight->host<uint8_t>();
             int32_t info[4];
             info[1] = src_width * src_height * batch;
             info[2] = eP;
@@ -637,11 +748,7 @@ ErrorCode DenseConvolutionTiledImpl::onResize(const std::vector<Tensor*>& inputs
                 packATime[tId] += timer[tId].durationInUs();
                 timer[tId].reset();
 #endif
-                if (xC == eP) {
-                    matmulUnit((float*)(dstOrigin + start * unit * bytes), (float*)gemmBuffer, (float*)weightPtr, parameters,postParameters.data(), biasPtr);
-                } else {
-                    matmulRemain((float*)(dstOrigin + start * unit * bytes), (float*)gemmBuffer, (float*)weightPtr, xC, parameters,postParameters.data(), biasPtr);
-                }
+                matmul((float*)(dstOrigin + start * unit * bytes), (float*)gemmBuffer, weightPtr, 0, xC, parameters, postParameters.data(), biasPtr);
 
 #ifdef PROFILE_DETAIL
             macs[tId] += 2.0 * xC * L * oC4 * unit; // bias
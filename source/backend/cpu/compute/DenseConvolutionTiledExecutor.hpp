@@ -28,6 +28,10 @@ public:
     void getPackParameter(int* eP, int* lP, int* hP, const CoreFunctions* core) override;
     static PerfConfig bestTileConvolutionConfig(const Convolution2DCommon *common, const Tensor *inputTensor,
                                           const Tensor *outputTensor, int threadNumber, Backend* b);
+    // Keep mConvPerfconfig on resize, set when it's decided by ConvolutionTuner
+    bool mFixedConfig = false;
+    // The weight is quantized if bits < 32
+    CPUConvolution::ResourceDequantizeInfo mDequantize;
 protected:
 
 };
@@ -36,6 +40,10 @@ public:
     DenseConvolutionTiledExecutor(const Convolution2DCommon *common, Backend *b, const float *originWeight,
                              size_t originWeightSize, const float *bias, size_t biasSize);
 
+    // Keep the weight-only quantized weight as int8 / int4, and dequantize it in gemm kernel
+    DenseConvolutionTiledExecutor(const Convolution2DCommon *common, Backend *b, const ConvolutionCommon::Int8Common* quanCommon,
+                             const float *bias, size_t biasSize);
+
     DenseConvolutionTiledExecutor(std::shared_ptr<CPUConvolution::Resource> res, const Convolution2DCommon *common, Backend* b);
     virtual ~DenseConvolutionTiledExecutor();
 
@@ -48,10 +56,17 @@ public:
     }
     virtual bool onClone(Backend* bn, const Op* op, Execution** dst) override;
     void initWeight(float *dest, const float *source, float* cache, int depth, int outputCount, int kernelSize, const CoreFunctions* function);
+    // Whether the backend has gemm kernels for weight-only quantized weight
+    static bool supportWeightQuant(Backend* b);
     static PerfConfig bestTileConvolutionConfig(const Convolution2DCommon *common, const Tensor *inputTensor,
                                           const Tensor *outputTensor, int threadNumber, Backend* b) {
         return DenseConvolutionTiledImpl::bestTileConvolutionConfig(common, inputTensor, outputTensor, threadNumber, b);
     }
+    // Use the given config instead of estimating it on resize
+    void setPerfConfig(const PerfConfig& config) {
+        mProxy->mConvPerfconfig = config;
+        mProxy->mFixedConfig = true;
+    }
 protected:
     std::shared_ptr<DenseConvolutionTiledImpl> mProxy;
 };
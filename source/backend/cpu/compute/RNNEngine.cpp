@@ -0,0 +1,48 @@
+//
+//  RNNEngine.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/compute/RNNEngine.hpp"
+#include <string.h>
+#include "math/Vec.hpp"
+
+using Vec4 = MNN::Math::Vec<float, 4>;
+namespace MNN {
+
+void RNNEngine::packHidden(float* dst, const float* src, int l, int h, int srcStride, bool transpose) {
+    auto blocks = UP_DIV(h, UNIT);
+    ::memset(dst, 0, blocks * l * UNIT * sizeof(float));
+    for (int y = 0; y < blocks; ++y) {
+        auto dstY = dst + y * l * UNIT;
+        auto count = std::min(UNIT, h - y * UNIT);
+        for (int k = 0; k < l; ++k) {
+            for (int j = 0; j < count; ++j) {
+                auto x = y * UNIT + j;
+                dstY[k * UNIT + j] = transpose ? src[x * srcStride + k] : src[k * srcStride + x];
+            }
+        }
+    }
+}
+
+void RNNEngine::multiHidden(float* dst, const float* src, const float* packed, int l, int blockStart, int blockEnd) {
+    for (int y = blockStart; y < blockEnd; ++y) {
+        auto weight = packed + y * l * UNIT;
+        Vec4 acc0(0.0f);
+        Vec4 acc1(0.0f);
+        int k = 0;
+        for (; k + 1 < l; k += 2) {
+            acc0 = Vec4::fma(acc0, Vec4::load(weight + k * UNIT), Vec4(src[k]));
+            acc1 = Vec4::fma(acc1, Vec4::load(weight + (k + 1) * UNIT), Vec4(src[k + 1]));
+        }
+        if (k < l) {
+            acc0 = Vec4::fma(acc0, Vec4::load(weight + k * UNIT), Vec4(src[k]));
+        }
+        Vec4::save(dst + (y - blockStart) * UNIT, acc0 + acc1);
+    }
+}
+
+} // namespace MNN
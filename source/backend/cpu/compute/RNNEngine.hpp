@@ -0,0 +1,47 @@
+//
+//  RNNEngine.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef RNNEngine_hpp
+#define RNNEngine_hpp
+
+#include <algorithm>
+#include "core/Macro.h"
+
+namespace MNN {
+/* Shared kernels of recurrent executions (GRU / LSTM / RNN):
+ - The input projection of all timesteps is done once by CPUMatMul before the sequence loop
+ - Recurrent weights are packed to [UP_DIV(h, UNIT), l, UNIT] once for all timesteps
+ - Each step is split by (batch, block of UNIT hidden units), a block needs no data from other blocks
+ */
+class RNNEngine {
+public:
+    static constexpr int UNIT = 4;
+    // src is [l, h] with row stride srcStride, or [h, l] if transpose. dst is [UP_DIV(h, UNIT), l, UNIT]
+    static void packHidden(float* dst, const float* src, int l, int h, int srcStride, bool transpose);
+    // dst[0, UNIT * (blockEnd - blockStart)) = src[0, l) * packed[blockStart, blockEnd)
+    static void multiHidden(float* dst, const float* src, const float* packed, int l, int blockStart, int blockEnd);
+
+    // Divide batch * blocks for thread tId, call function(batchIndex, blockStart, blockEnd) for each part
+    template <typename F>
+    static void divide(int tId, int threadNumber, int batch, int blocks, F&& function) {
+        int total = batch * blocks;
+        int step  = UP_DIV(total, threadNumber);
+        int start = tId * step;
+        int end   = std::min(total, start + step);
+        while (start < end) {
+            int b        = start / blocks;
+            int bStart   = start - b * blocks;
+            int bEnd     = std::min(blocks, bStart + end - start);
+            function(b, bStart, bEnd);
+            start += bEnd - bStart;
+        }
+    }
+};
+} // namespace MNN
+
+#endif /* RNNEngine_hpp */
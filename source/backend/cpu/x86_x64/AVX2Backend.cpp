@@ -412,14 +412,14 @@ void AVX2Backend::onCopyBuffer(const Tensor* srcTensor, const Tensor* dstTensor)
     }
     if (srcType == dstType) {
         if(srcType == MNN_FORWARD_CPU_EXTENSION) {
-            CPUTensorConverter::convert(srcTensor, dstTensor, mCoreFunctions);
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, mCoreFunctions);
         } else {
-            CPUTensorConverter::convert(srcTensor, dstTensor, MNNGetCoreFunctions());
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, MNNGetCoreFunctions());
         }
         return;
     }
     if (source != MNN_DATA_FORMAT_NC4HW4 && dest != MNN_DATA_FORMAT_NC4HW4) {
-        CPUTensorConverter::convert(srcTensor, dstTensor, mCoreFunctions);
+        CPUTensorConverter::convert(srcTensor, dstTensor, this, mCoreFunctions);
         return;
     }
     if (source == MNN_DATA_FORMAT_NC4HW4 && dest == MNN_DATA_FORMAT_NC4HW4) {
@@ -456,17 +456,17 @@ void AVX2Backend::onCopyBuffer(const Tensor* srcTensor, const Tensor* dstTensor)
     }
     if (source == MNN_DATA_FORMAT_NC4HW4) {
         if (srcType == MNN_FORWARD_CPU_EXTENSION) {
-            CPUTensorConverter::convert(srcTensor, dstTensor, mCoreFunctions);
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, mCoreFunctions);
         } else {
-            CPUTensorConverter::convert(srcTensor, dstTensor, MNNGetCoreFunctions());
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, MNNGetCoreFunctions());
         }
         return;
     }
     if (dest == MNN_DATA_FORMAT_NC4HW4) {
         if (dstType == MNN_FORWARD_CPU_EXTENSION) {
-            CPUTensorConverter::convert(srcTensor, dstTensor, mCoreFunctions);
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, mCoreFunctions);
         } else {
-            CPUTensorConverter::convert(srcTensor, dstTensor, MNNGetCoreFunctions());
+            CPUTensorConverter::convert(srcTensor, dstTensor, this, MNNGetCoreFunctions());
         }
         return;
     }
@@ -43,6 +43,10 @@ bool AVX2Functions::init(int cpuFlags) {
     coreFunction->MNNPackForMatMul_B    = _AVX_MNNPackForMatMul_B;
     coreFunction->MNNComputeMatMulForE_1 = _AVX_MNNComputeMatMulForE_1;
     coreFunction->MNNComputeMatMulForH_1 = _AVX_MNNComputeMatMulForH_1;
+    coreFunction->MNNPackedMatMul_int8       = _AVX_MNNPackedMatMul_int8;
+    coreFunction->MNNPackedMatMulRemain_int8 = _AVX_MNNPackedMatMulRemain_int8;
+    coreFunction->MNNPackedMatMul_int4       = _AVX_MNNPackedMatMul_int4;
+    coreFunction->MNNPackedMatMulRemain_int4 = _AVX_MNNPackedMatMulRemain_int4;
 
     // For Packed Functions
     coreFunction->pack = 8;
@@ -54,6 +58,10 @@ bool AVX2Functions::init(int cpuFlags) {
         coreFunction->MNNPackedMatMulRemain = _AVX_MNNPackedMatMulRemainFMA;
         coreFunction->MNNComputeMatMulForE_1 = _AVX_MNNComputeMatMulForE_1FMA;
         coreFunction->MNNComputeMatMulForH_1 = _AVX_MNNComputeMatMulForH_1FMA;
+        coreFunction->MNNPackedMatMul_int8       = _AVX_MNNPackedMatMul_int8FMA;
+        coreFunction->MNNPackedMatMulRemain_int8 = _AVX_MNNPackedMatMulRemain_int8FMA;
+        coreFunction->MNNPackedMatMul_int4       = _AVX_MNNPackedMatMul_int4FMA;
+        coreFunction->MNNPackedMatMulRemain_int4 = _AVX_MNNPackedMatMulRemain_int4FMA;
         _AVX_ExtraInitFMA(coreFunction);
     }
     // For ImageProcess Functions
@@ -75,6 +83,11 @@ bool AVX2Functions::init(int cpuFlags) {
         coreFunction->MNNPackC4ForMatMul_A  = _AVX512_MNNPackC8ForMatMul_A;
         coreFunction->MNNPackedMatMul = _AVX512_MNNPackedMatMul;
         coreFunction->MNNPackedMatMulRemain = _AVX512_MNNPackedMatMulRemain;
+        // No weight-only quantized kernel for hP = 8 yet
+        coreFunction->MNNPackedMatMul_int8 = nullptr;
+        coreFunction->MNNPackedMatMulRemain_int8 = nullptr;
+        coreFunction->MNNPackedMatMul_int4 = nullptr;
+        coreFunction->MNNPackedMatMulRemain_int4 = nullptr;
         geP = 48;
         ghP = 8;
         glP = 1;
@@ -53,6 +53,12 @@ void MNNFunctionInit() {
         coreFunction->MNNPackC4ForMatMul_A  = _SSE_MNNPackC4ForMatMul_A;
         coreFunction->MNNPackForMatMul_B    = _SSE_MNNPackForMatMul_B;
     }
+    if (cpuFlags & libyuv::kCpuHasSSE41) {
+        coreFunction->MNNPackedMatMul_int8       = _SSE_MNNPackedMatMul_int8;
+        coreFunction->MNNPackedMatMulRemain_int8 = _SSE_MNNPackedMatMulRemain_int8;
+        coreFunction->MNNPackedMatMul_int4       = _SSE_MNNPackedMatMul_int4;
+        coreFunction->MNNPackedMatMulRemain_int4 = _SSE_MNNPackedMatMulRemain_int4;
+    }
     if (cpuFlags & libyuv::kCpuHasAVX2) {
         MNN::AVX2Functions::init(cpuFlags);
         gFunc.MNNExpC8 = _AVX_MNNExpC8;
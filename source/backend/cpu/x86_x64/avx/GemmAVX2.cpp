@@ -8,6 +8,7 @@
 
 #include "FunctionSummary.hpp"
 #include "GemmCommon.hpp"
+#include <string.h>
 #include "core/Macro.h"
 #define MNNAVXFMA(x, y, z) _mm256_add_ps(_mm256_mul_ps(x, y), z)
 #define MNNSSEFMA(x, y, z) _mm_add_ps(_mm_mul_ps(x, y), z)
@@ -18,6 +19,7 @@
 #define STORE_4(d, x) _mm_storeu_ps(d, x) // The memory is aligned for 4
 #define STORE_8(d, x) _mm256_storeu_ps(d, x)
 #include "GemmFunction.hpp"
+#include "GemmWeightQuant.hpp"
 
 void _AVX_MNNPackedMatMul(float* C, const float* A, const float* B, const size_t* parameter,
                           const float* postParameters, const float* bias) {
@@ -31,6 +33,30 @@ void _AVX_MNNPackedMatMulRemain(float* C, const float* A, const float* B, size_t
     AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
 }
 
+void _AVX_MNNPackedMatMul_int8(float* C, const float* A, const int8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuant_E<8, 3>(C, A, (const uint8_t*)B, MNN_UNIT_E, parameter, k, b);
+    AVX2GemmPostTreat(C, MNN_UNIT_E, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMulRemain_int8(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuantRemain<8>(C, A, (const uint8_t*)B, eSize, parameter, k, b);
+    AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMul_int4(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuant_E<4, 3>(C, A, B, MNN_UNIT_E, parameter, k, b);
+    AVX2GemmPostTreat(C, MNN_UNIT_E, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMulRemain_int4(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuantRemain<4>(C, A, B, eSize, parameter, k, b);
+    AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
+
 void _AVX_MNNComputeMatMulForE_1(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId) {
     auto l = param->l;
     auto h = param->h;
@@ -0,0 +1,208 @@
+//
+//  GemmWeightQuant.hpp
+//  MNN
+//
+//  Created by MNN on 2023/03/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+// Packed matmul with weight-only quantized B: B is packed as [hC4, l, 4] of int8, or int4 (two weights in one byte,
+// low nibble first). Each row of 4 weights is dequantized in register as q * k + b, so float B is never expanded.
+// Need MNNAVXFMA / MNNSSEFMA / BROAD_LOAD / LOAD8 / STORE_4 / STORE_8 defined before include
+
+namespace {
+// Dequantize the 4 weights of one l
+template <int BITS>
+static inline __m128 _dequantWeight4(const uint8_t* w, __m128 k, __m128 b);
+
+template <>
+inline __m128 _dequantWeight4<8>(const uint8_t* w, __m128 k, __m128 b) {
+    int32_t v;
+    ::memcpy(&v, w, sizeof(int32_t));
+    auto q = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(v)));
+    return MNNSSEFMA(q, k, b);
+}
+
+template <>
+inline __m128 _dequantWeight4<4>(const uint8_t* w, __m128 k, __m128 b) {
+    uint16_t v;
+    ::memcpy(&v, w, sizeof(uint16_t));
+    auto q = _mm_srlv_epi32(_mm_set1_epi32(v), _mm_setr_epi32(0, 4, 8, 12));
+    q      = _mm_and_si128(q, _mm_set1_epi32(15));
+    return MNNSSEFMA(_mm_cvtepi32_ps(q), k, b);
+}
+
+// Dequantize the weights of one l from two neighbour hC4 blocks, which make one C8 of output
+template <int BITS>
+static inline __m256 _dequantWeight8(const uint8_t* w0, const uint8_t* w1, __m256 k, __m256 b);
+
+template <>
+inline __m256 _dequantWeight8<8>(const uint8_t* w0, const uint8_t* w1, __m256 k, __m256 b) {
+    int32_t v0, v1;
+    ::memcpy(&v0, w0, sizeof(int32_t));
+    ::memcpy(&v1, w1, sizeof(int32_t));
+    auto q = _mm256_cvtepi8_epi32(_mm_unpacklo_epi32(_mm_cvtsi32_si128(v0), _mm_cvtsi32_si128(v1)));
+    return MNNAVXFMA(_mm256_cvtepi32_ps(q), k, b);
+}
+
+template <>
+inline __m256 _dequantWeight8<4>(const uint8_t* w0, const uint8_t* w1, __m256 k, __m256 b) {
+    uint16_t v0, v1;
+    ::memcpy(&v0, w0, sizeof(uint16_t));
+    ::memcpy(&v1, w1, sizeof(uint16_t));
+    auto q = _mm256_setr_epi32(v0, v0, v0, v0, v1, v1, v1, v1);
+    q      = _mm256_srlv_epi32(q, _mm256_setr_epi32(0, 4, 8, 12, 0, 4, 8, 12));
+    q      = _mm256_and_si256(q, _mm256_set1_epi32(15));
+    return MNNAVXFMA(_mm256_cvtepi32_ps(q), k, b);
+}
+} // namespace
+
+// Vectorize along e: EU x 8 of e for each hC4 block, the same as float kernel. A must be packed with stride >= EU * 8
+template <int BITS, int EU>
+static void _AVX_MNNPackedMatMulWeightQuant_E(float* C, const float* A, const uint8_t* B, size_t eSize,
+                                              const size_t* parameter, const float* k, const float* b) {
+    auto aStride      = parameter[0] / sizeof(float);
+    auto h            = parameter[2];
+    auto l            = parameter[1];
+    auto cStride      = parameter[3] / sizeof(float);
+    auto bExtraStride = parameter[5];
+    auto bStride      = bExtraStride + l * 4 * BITS / 8;
+    auto hC4          = UP_DIV(h, 4);
+    for (int y = 0; y < hC4; ++y) {
+        auto weight = B + y * bStride;
+        auto dst    = C + (y / 2) * cStride + 4 * (y % 2);
+        auto k4     = _mm_loadu_ps(k + 4 * y);
+        auto b4     = _mm_loadu_ps(b + 4 * y);
+        __m256 z[EU][4];
+        for (int u = 0; u < EU; ++u) {
+            for (int j = 0; j < 4; ++j) {
+                z[u][j] = _mm256_setzero_ps();
+            }
+        }
+        for (int sy = 0; sy < l; ++sy) {
+            auto w  = _dequantWeight4<BITS>(weight + sy * 4 * BITS / 8, k4, b4);
+            auto w0 = _mm256_broadcastss_ps(w);
+            auto w1 = _mm256_broadcastss_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 1, 1, 1)));
+            auto w2 = _mm256_broadcastss_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 2, 2)));
+            auto w3 = _mm256_broadcastss_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 3)));
+            auto srcY = A + sy * aStride;
+            for (int u = 0; u < EU; ++u) {
+                auto s  = LOAD8(srcY + 8 * u);
+                z[u][0] = MNNAVXFMA(s, w0, z[u][0]);
+                z[u][1] = MNNAVXFMA(s, w1, z[u][1]);
+                z[u][2] = MNNAVXFMA(s, w2, z[u][2]);
+                z[u][3] = MNNAVXFMA(s, w3, z[u][3]);
+            }
+        }
+        for (int u = 0; u < EU; ++u) {
+            for (int v = 0; v < 2; ++v) {
+                int e = 8 * u + 4 * v;
+                if (e >= eSize) {
+                    break;
+                }
+                auto m0 = _mm256_extractf128_ps(z[u][0], 0);
+                auto m1 = _mm256_extractf128_ps(z[u][1], 0);
+                auto m2 = _mm256_extractf128_ps(z[u][2], 0);
+                auto m3 = _mm256_extractf128_ps(z[u][3], 0);
+                if (v > 0) {
+                    m0 = _mm256_extractf128_ps(z[u][0], 1);
+                    m1 = _mm256_extractf128_ps(z[u][1], 1);
+                    m2 = _mm256_extractf128_ps(z[u][2], 1);
+                    m3 = _mm256_extractf128_ps(z[u][3], 1);
+                }
+                _MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+                STORE_4(dst + 8 * (e + 0), m0);
+                if (e + 1 < eSize) {
+                    STORE_4(dst + 8 * (e + 1), m1);
+                }
+                if (e + 2 < eSize) {
+                    STORE_4(dst + 8 * (e + 2), m2);
+                }
+                if (e + 3 < eSize) {
+                    STORE_4(dst + 8 * (e + 3), m3);
+                }
+            }
+        }
+    }
+}
+
+// Vectorize along h for small e: two hC4 blocks make one C8 of output, so weight is loaded once for all e
+template <int BITS, int E>
+static void _AVX_MNNPackedMatMulWeightQuant_H(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                                              const float* k, const float* b) {
+    auto aStride      = parameter[0] / sizeof(float);
+    auto h            = parameter[2];
+    auto l            = parameter[1];
+    auto cStride      = parameter[3] / sizeof(float);
+    auto bExtraStride = parameter[5];
+    auto lineBytes    = 4 * BITS / 8;
+    auto bStride      = bExtraStride + l * lineBytes;
+    auto hC4          = UP_DIV(h, 4);
+    auto hC8          = hC4 / 2;
+    for (int y = 0; y < hC8; ++y) {
+        auto weight0 = B + (2 * y + 0) * bStride;
+        auto weight1 = B + (2 * y + 1) * bStride;
+        auto k8      = LOAD8(k + 8 * y);
+        auto b8      = LOAD8(b + 8 * y);
+        __m256 z[E];
+        for (int x = 0; x < E; ++x) {
+            z[x] = _mm256_setzero_ps();
+        }
+        for (int sy = 0; sy < l; ++sy) {
+            auto w    = _dequantWeight8<BITS>(weight0 + sy * lineBytes, weight1 + sy * lineBytes, k8, b8);
+            auto srcY = A + sy * aStride;
+            for (int x = 0; x < E; ++x) {
+                z[x] = MNNAVXFMA(BROAD_LOAD(srcY + x), w, z[x]);
+            }
+        }
+        auto dst = C + y * cStride;
+        for (int x = 0; x < E; ++x) {
+            STORE_8(dst + 8 * x, z[x]);
+        }
+    }
+    if (hC4 % 2 > 0) {
+        auto weight = B + (hC4 - 1) * bStride;
+        auto k4     = _mm_loadu_ps(k + 4 * (hC4 - 1));
+        auto b4     = _mm_loadu_ps(b + 4 * (hC4 - 1));
+        __m128 z[E];
+        for (int x = 0; x < E; ++x) {
+            z[x] = _mm_setzero_ps();
+        }
+        for (int sy = 0; sy < l; ++sy) {
+            auto w    = _dequantWeight4<BITS>(weight + sy * lineBytes, k4, b4);
+            auto srcY = A + sy * aStride;
+            for (int x = 0; x < E; ++x) {
+                z[x] = MNNSSEFMA(_mm_broadcast_ss(srcY + x), w, z[x]);
+            }
+        }
+        auto dst = C + hC8 * cStride;
+        for (int x = 0; x < E; ++x) {
+            STORE_4(dst + 8 * x, z[x]);
+        }
+    }
+}
+
+template <int BITS>
+static void _AVX_MNNPackedMatMulWeightQuantRemain(float* C, const float* A, const uint8_t* B, size_t eSize,
+                                                  const size_t* parameter, const float* k, const float* b) {
+    switch (eSize) {
+        case 1:
+            _AVX_MNNPackedMatMulWeightQuant_H<BITS, 1>(C, A, B, parameter, k, b);
+            return;
+        case 2:
+            _AVX_MNNPackedMatMulWeightQuant_H<BITS, 2>(C, A, B, parameter, k, b);
+            return;
+        case 3:
+            _AVX_MNNPackedMatMulWeightQuant_H<BITS, 3>(C, A, B, parameter, k, b);
+            return;
+        default:
+            break;
+    }
+    if (eSize <= 8) {
+        _AVX_MNNPackedMatMulWeightQuant_E<BITS, 1>(C, A, B, eSize, parameter, k, b);
+    } else if (eSize <= 16) {
+        _AVX_MNNPackedMatMulWeightQuant_E<BITS, 2>(C, A, B, eSize, parameter, k, b);
+    } else {
+        _AVX_MNNPackedMatMulWeightQuant_E<BITS, 3>(C, A, B, eSize, parameter, k, b);
+    }
+}
@@ -37,6 +37,12 @@ extern "C" {
 void _AVX_MNNPackedMatMulFMA(float* C, const float* A, const float* B, const size_t* parameter,
                              const float* postParameters, const float* bias);
 void _AVX_MNNPackedMatMulRemainFMA(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias);
+void _AVX_MNNPackedMatMul_int8FMA(float* C, const float* A, const int8_t* B, const size_t* parameter,
+                                  const float* postParameters, const float* bias, const float* k, const float* b);
+void _AVX_MNNPackedMatMulRemain_int8FMA(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b);
+void _AVX_MNNPackedMatMul_int4FMA(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                                  const float* postParameters, const float* bias, const float* k, const float* b);
+void _AVX_MNNPackedMatMulRemain_int4FMA(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter, const float* postParameters, const float* bias, const float* k, const float* b);
 void _AVX_MNNComputeMatMulForE_1FMA(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId);
 void _AVX_MNNPackedMatMulFMA_BF16(float* C, const float* A, const float* B, const size_t* parameter,
                                   const float* postParameters, const float* bias);
@@ -8,6 +8,7 @@
 
 #include "FunctionSummary.hpp"
 #include <math.h>
+#include <string.h>
 #include "../avx/GemmCommon.hpp"
 #include "core/Macro.h"
 #define MNNAVXFMA _mm256_fmadd_ps
@@ -20,6 +21,7 @@
 #define STORE_8(d, x) _mm256_storeu_ps(d, x)
 
 #include "../avx/GemmFunction.hpp"
+#include "../avx/GemmWeightQuant.hpp"
 #ifdef MNN_X86_USE_ASM
 extern "C" {
 void _AVX_MNNGemmFloatUnitMainFMA(float* C, const float* A, const float* B, const size_t* parameter);
@@ -59,6 +61,30 @@ void _AVX_MNNPackedMatMulRemainFMA(float* C, const float* A, const float* B, siz
     AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
 }
 
+void _AVX_MNNPackedMatMul_int8FMA(float* C, const float* A, const int8_t* B, const size_t* parameter,
+                                  const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuant_E<8, 3>(C, A, (const uint8_t*)B, MNN_UNIT_E, parameter, k, b);
+    AVX2GemmPostTreat(C, MNN_UNIT_E, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMulRemain_int8FMA(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter,
+                                        const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuantRemain<8>(C, A, (const uint8_t*)B, eSize, parameter, k, b);
+    AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMul_int4FMA(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                                  const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuant_E<4, 3>(C, A, B, MNN_UNIT_E, parameter, k, b);
+    AVX2GemmPostTreat(C, MNN_UNIT_E, parameter, postParameters, bias);
+}
+
+void _AVX_MNNPackedMatMulRemain_int4FMA(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter,
+                                        const float* postParameters, const float* bias, const float* k, const float* b) {
+    _AVX_MNNPackedMatMulWeightQuantRemain<4>(C, A, B, eSize, parameter, k, b);
+    AVX2GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
+
 void _AVX_MNNComputeMatMulForE_1FMA(const float* A, const float* B, float* C, const float* biasPtr, const MatMulParam* param, size_t tId) {
     auto l = param->l;
     auto h = param->h;
@@ -50,6 +50,14 @@ void _SSE_MNNPackedMatMul(float* C, const float* A, const float* B, const size_t
 void _SSE_MNNPackedMatMulRemain(float* C, const float* A, const float* B, size_t eSize, const size_t* parameter,
                                  const float* postParameters, const float* bias);
 void _SSE_MNNPackC4ForMatMul_A(float* destOrigin, float const** sourceGroup, const int32_t* info, const int32_t* el);
+void _SSE_MNNPackedMatMul_int8(float* C, const float* A, const int8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b);
+void _SSE_MNNPackedMatMulRemain_int8(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b);
+void _SSE_MNNPackedMatMul_int4(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b);
+void _SSE_MNNPackedMatMulRemain_int4(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b);
 void _SSE_MNNConvRunForLineDepthwise(float* dst, const float* src, const float* weight, size_t width, size_t src_w_setup,
                                 size_t fw, size_t fh, size_t dilateX_step, size_t dilateY_step, size_t height,
                                 size_t srcHStep, size_t dstHStep);
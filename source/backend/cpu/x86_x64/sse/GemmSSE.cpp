@@ -8,6 +8,7 @@
 
 #include "FunctionSummary.hpp"
 #include "GemmCommon.hpp"
+#include <string.h>
 #include "core/Macro.h"
 #define MNNSSEFMA(x, y, z) _mm_add_ps(_mm_mul_ps(x, y), z)
 #include "GemmFunction.hpp"
@@ -26,3 +27,98 @@ void _SSE_MNNPackedMatMulRemain(float* C, const float* A, const float* B, size_t
     _SSE_MNNPackednMatMulRemainCommon(C, A, B, eSize, parameter, postParameters, bias);
     _SSE_GemmPostTreat(C, eSize, parameter, postParameters, bias);
 }
+
+// B is weight-only quantized as [hC4, l, 4] of int8 / int4, dequantize each row of 4 weights in register
+template <int BITS>
+static inline __m128 _SSE_DequantWeight4(const uint8_t* w, __m128 k, __m128 b) {
+    __m128i q;
+    if (8 == BITS) {
+        int32_t v;
+        ::memcpy(&v, w, sizeof(int32_t));
+        q = _mm_cvtepi8_epi32(_mm_cvtsi32_si128(v));
+    } else {
+        q = _mm_setr_epi32(w[0] & 15, w[0] >> 4, w[1] & 15, w[1] >> 4);
+    }
+    return MNNSSEFMA(_mm_cvtepi32_ps(q), k, b);
+}
+
+template <int BITS, int EU>
+static void _SSE_MNNPackedMatMulWeightQuant(float* C, const float* A, const uint8_t* B, size_t eSize,
+                                            const size_t* parameter, const float* k, const float* b) {
+    auto aStride      = parameter[0] / sizeof(float);
+    auto h            = parameter[2];
+    auto l            = parameter[1];
+    auto cStride      = parameter[3] / sizeof(float);
+    auto bExtraStride = parameter[5];
+    auto bStride      = bExtraStride + l * 4 * BITS / 8;
+    auto hC4          = UP_DIV(h, 4);
+    for (int y = 0; y < hC4; ++y) {
+        auto weight = B + y * bStride;
+        auto dst    = C + y * cStride;
+        auto k4     = _mm_loadu_ps(k + 4 * y);
+        auto b4     = _mm_loadu_ps(b + 4 * y);
+        __m128 z[EU][4];
+        for (int u = 0; u < EU; ++u) {
+            for (int j = 0; j < 4; ++j) {
+                z[u][j] = _mm_setzero_ps();
+            }
+        }
+        for (int sy = 0; sy < l; ++sy) {
+            auto w  = _SSE_DequantWeight4<BITS>(weight + sy * 4 * BITS / 8, k4, b4);
+            auto w0 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(0, 0, 0, 0));
+            auto w1 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 1, 1, 1));
+            auto w2 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 2, 2));
+            auto w3 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 3));
+            auto srcY = A + sy * aStride;
+            for (int u = 0; u < EU; ++u) {
+                auto s  = _mm_loadu_ps(srcY + 4 * u);
+                z[u][0] = MNNSSEFMA(s, w0, z[u][0]);
+                z[u][1] = MNNSSEFMA(s, w1, z[u][1]);
+                z[u][2] = MNNSSEFMA(s, w2, z[u][2]);
+                z[u][3] = MNNSSEFMA(s, w3, z[u][3]);
+            }
+        }
+        for (int u = 0; u < EU; ++u) {
+            _MM_TRANSPOSE4_PS(z[u][0], z[u][1], z[u][2], z[u][3]);
+            for (int i = 0; i < 4 && 4 * u + i < eSize; ++i) {
+                _mm_storeu_ps(dst + 4 * (4 * u + i), z[u][i]);
+            }
+        }
+    }
+}
+
+template <int BITS>
+static void _SSE_MNNPackedMatMulWeightQuantRemain(float* C, const float* A, const uint8_t* B, size_t eSize,
+                                                  const size_t* parameter, const float* k, const float* b) {
+    if (eSize <= 4) {
+        _SSE_MNNPackedMatMulWeightQuant<BITS, 1>(C, A, B, eSize, parameter, k, b);
+    } else if (eSize <= 8) {
+        _SSE_MNNPackedMatMulWeightQuant<BITS, 2>(C, A, B, eSize, parameter, k, b);
+    } else {
+        _SSE_MNNPackedMatMulWeightQuant<BITS, 3>(C, A, B, eSize, parameter, k, b);
+    }
+}
+
+void _SSE_MNNPackedMatMul_int8(float* C, const float* A, const int8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b) {
+    _SSE_MNNPackedMatMulWeightQuant<8, 3>(C, A, (const uint8_t*)B, 12, parameter, k, b);
+    _SSE_GemmPostTreat(C, 12, parameter, postParameters, bias);
+}
+
+void _SSE_MNNPackedMatMulRemain_int8(float* C, const float* A, const int8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b) {
+    _SSE_MNNPackedMatMulWeightQuantRemain<8>(C, A, (const uint8_t*)B, eSize, parameter, k, b);
+    _SSE_GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
+
+void _SSE_MNNPackedMatMul_int4(float* C, const float* A, const uint8_t* B, const size_t* parameter,
+                               const float* postParameters, const float* bias, const float* k, const float* b) {
+    _SSE_MNNPackedMatMulWeightQuant<4, 3>(C, A, B, 12, parameter, k, b);
+    _SSE_GemmPostTreat(C, 12, parameter, postParameters, bias);
+}
+
+void _SSE_MNNPackedMatMulRemain_int4(float* C, const float* A, const uint8_t* B, size_t eSize, const size_t* parameter,
+                                     const float* postParameters, const float* bias, const float* k, const float* b) {
+    _SSE_MNNPackedMatMulWeightQuantRemain<4>(C, A, B, eSize, parameter, k, b);
+    _SSE_GemmPostTreat(C, eSize, parameter, postParameters, bias);
+}
@@ -20,6 +20,7 @@ namespace MNN {
 
 struct Op;
 class Execution;
+class FileLoader;
 
 class Runtime;
 /** abstract backend */
@@ -110,6 +111,30 @@ public:
         // nothing to do
     }
 
+    /**
+     * @brief set whether plan dynamic memory offline. When enabled, the backend records tensors' lifetime in a resize
+     * and packs them into one block, which is used by the next resize with the same allocation sequence.
+     * @return false if not supported.
+     */
+    virtual bool onSetMemoryPlan(bool enable) {
+        return false;
+    }
+    /**
+     * @brief query whether last resize made a new memory plan, resize again to use it.
+     */
+    virtual bool onMemoryPlanReady() const {
+        return false;
+    }
+
+    /**
+     * @brief set whether measure the candidate algorithms of ops on creating executions, the fastest one is kept in
+     * runtime and saved to cache file.
+     * @return false if not supported.
+     */
+    virtual bool onSetTuning(bool enable) {
+        return false;
+    }
+
     /**
      * @brief callback before executing ops.
      */
@@ -187,8 +212,40 @@ public:
         return 0;
     }
 
+public:
+    /**
+     * @brief set the file that holds weights stored outside the model, see Convolution2D::external.
+     * @param file  opened external weight file, shared by backends of the same session.
+     */
+    void setExternalFile(std::shared_ptr<FileLoader> file) {
+        mExternalFile = file;
+    }
+    /**
+     * @brief get the external weight file.
+     * @return external weight file, nullptr if not set.
+     */
+    FileLoader* getExternalFile() const {
+        return mExternalFile.get();
+    }
+    /**
+     * @brief set the max sequence length of key / value cached by attention, see Interpreter::KVCACHE_SIZE_LIMIT.
+     * @param limit max sequence length, 0 means no limit.
+     */
+    void setKVCacheLimit(int limit) {
+        mKVCacheLimit = limit;
+    }
+    /**
+     * @brief get the max sequence length of key / value cache.
+     * @return max sequence length, 0 means no limit.
+     */
+    int getKVCacheLimit() const {
+        return mKVCacheLimit;
+    }
+
 private:
     const MNNForwardType mType;
+    std::shared_ptr<FileLoader> mExternalFile;
+    int mKVCacheLimit = 0;
 };
 
 /** Each backend belong to a runtime*/
@@ -7,6 +7,8 @@
 //
 
 #include "core/BufferAllocator.hpp"
+#include <algorithm>
+#include <new>
 #include "core/Macro.h"
 
 //#define DUMP_USAGE
@@ -70,12 +72,39 @@ std::pair<void*, size_t> BufferAllocator::alloc(size_t size, bool separate, size
     if (0 == align) {
         align = mAlign;
     }
+    if (PLAN_REPLAY == mPlanState && (!mPlanBroken)) {
+        auto pointer = allocFromPlan(size, align);
+        if (nullptr != pointer.first) {
+            return pointer;
+        }
+    }
+    auto pointer = allocInside(size, separate, align);
+    if (PLAN_RECORD == mPlanState && nullptr != pointer.first) {
+        PlanUnit unit;
+        unit.size   = UP_DIV(size, mAlign) * mAlign;
+        unit.align  = align;
+        unit.begin  = (int)mPlanEvents.size();
+        unit.end    = -1;
+        unit.offset = 0;
+        mPlanUsed[pointer] = (int)mPlanUnits.size();
+        recordPlanEvent(2 * (int)mPlanUnits.size());
+        mPlanUnits.emplace_back(unit);
+    }
+    return pointer;
+}
+
+std::pair<void*, size_t> BufferAllocator::allocInside(size_t size, bool separate, size_t align) {
     std::pair<void*, size_t> pointer;
     // reuse if possible
     if (!separate) {
         if (nullptr != mCurrentFreeList) {
             pointer = getFromFreeList(mCurrentFreeList, size, false, align);
         }
+        for (int i = (int)mBarriers.size() - 1; i >= 0 && nullptr == pointer.first; --i) {
+            if (nullptr != mBarriers[i].outside) {
+                pointer = getFromFreeList(mBarriers[i].outside, size, false, align);
+            }
+        }
         if (nullptr != pointer.first) {
             return pointer;
         }
@@ -139,6 +168,20 @@ void BufferAllocator::returnMemory(FREELIST* listP, SharedPtr<Node> node, bool p
 }
 
 bool BufferAllocator::free(std::pair<void*, size_t> pointer) {
+    if (!mPlanUsed.empty()) {
+        auto planIter = mPlanUsed.find(pointer);
+        if (planIter != mPlanUsed.end()) {
+            auto index = planIter->second;
+            mPlanUsed.erase(planIter);
+            if (PLAN_NONE != mPlanState) {
+                recordPlanEvent(2 * index + 1);
+            }
+            if (PLAN_RECORD != mPlanState) {
+                // Memory in planned block is not put into free list
+                return true;
+            }
+        }
+    }
     // get node
     auto x = mUsedList.find(pointer);
     if (x == mUsedList.end()) {
@@ -162,10 +205,12 @@ bool BufferAllocator::free(std::pair<void*, size_t> pointer) {
 }
 
 void BufferAllocator::release(bool allRelease) {
-    MNN_ASSERT(mGroups.empty());
+    MNN_ASSERT(mBarriers.empty());
     if (allRelease) {
         mUsedList.clear();
         mFreeList.clear();
+        mPlanUsed.clear();
+        mPlanBlock = nullptr;
         mTotalSize = 0;
         return;
     }
@@ -179,27 +224,43 @@ void BufferAllocator::release(bool allRelease) {
 }
 
 void BufferAllocator::barrierBegin() {
-    MNN_ASSERT(mGroups.empty());
+    if (PLAN_NONE != mPlanState) {
+        recordPlanEvent(-1);
+    }
+    Barrier barrier;
+    barrier.outside = mCurrentFreeList;
+    mBarriers.emplace_back(std::move(barrier));
 }
 
 void BufferAllocator::barrierEnd() {
-    for (auto& freeGroup : mGroups) {
+    if (PLAN_NONE != mPlanState) {
+        recordPlanEvent(-2);
+    }
+    MNN_ASSERT(!mBarriers.empty());
+    auto outside = mBarriers.back().outside;
+    for (auto& freeGroup : mBarriers.back().groups) {
         auto freeList = *freeGroup;
         for (auto& iter : freeList) {
-            returnMemory(&mFreeList, iter.second);
+            if (nullptr != outside) {
+                returnMemory(outside, iter.second, false);
+            } else {
+                returnMemory(&mFreeList, iter.second);
+            }
         }
     }
-    mGroups.clear();
+    mBarriers.pop_back();
+    mCurrentFreeList = outside;
 }
 
 void BufferAllocator::beginGroup() {
+    MNN_ASSERT(!mBarriers.empty());
     std::shared_ptr<FREELIST> newFreeList(new FREELIST);
     mCurrentFreeList = newFreeList.get();
-    mGroups.emplace_back(newFreeList);
+    mBarriers.back().groups.emplace_back(newFreeList);
 }
 
 void BufferAllocator::endGroup() {
-    mCurrentFreeList = nullptr;
+    mCurrentFreeList = mBarriers.back().outside;
 }
 
 std::pair<void*, size_t> BufferAllocator::getFromFreeList(FREELIST* list, size_t size, bool permiteSplit, size_t align) {
@@ -255,4 +316,279 @@ std::pair<void*, size_t> BufferAllocator::getFromFreeList(FREELIST* list, size_t
     MNN_ASSERT(pointer.second % align == 0);
     return pointer;
 }
+
+void BufferAllocator::recordPlanEvent(int event) {
+    if (PLAN_RECORD == mPlanState) {
+        mPlanEvents.emplace_back(event);
+        return;
+    }
+    if (mPlanBroken) {
+        return;
+    }
+    if (mPlanEventIndex >= mPlanEvents.size() || mPlanEvents[mPlanEventIndex] != event) {
+        // The sequence is different from the recorded one, stop using planned block
+        mPlanBroken = true;
+        return;
+    }
+    mPlanEventIndex++;
+}
+
+std::pair<void*, size_t> BufferAllocator::allocFromPlan(size_t size, size_t align) {
+    auto index = mPlanAllocIndex;
+    if (index >= mPlanUnits.size()) {
+        mPlanBroken = true;
+        return std::make_pair(nullptr, 0);
+    }
+    auto& unit = mPlanUnits[index];
+    if (unit.size != UP_DIV(size, mAlign) * mAlign || unit.align != align) {
+        mPlanBroken = true;
+        return std::make_pair(nullptr, 0);
+    }
+    recordPlanEvent(2 * (int)index);
+    if (mPlanBroken) {
+        return std::make_pair(nullptr, 0);
+    }
+    mPlanAllocIndex++;
+    auto pointer = mPlanBlock->pointer;
+    pointer.second += unit.offset;
+    mPlanUsed[pointer] = (int)index;
+    return pointer;
+}
+
+void BufferAllocator::computePlan() {
+    // Compute lifetime, memory freed in barrier can only be reused after barrier end, for groups can't share memory
+    std::vector<int> pending;
+    int barrierDepth = 0;
+    for (int i = 0; i < mPlanEvents.size(); ++i) {
+        auto event = mPlanEvents[i];
+        if (-1 == event) {
+            barrierDepth++;
+            continue;
+        }
+        if (-2 == event) {
+            barrierDepth--;
+            if (barrierDepth > 0) {
+                continue;
+            }
+            for (auto index : pending) {
+                mPlanUnits[index].end = i;
+            }
+            pending.clear();
+            continue;
+        }
+        if (event % 2 == 1) {
+            if (barrierDepth > 0) {
+                pending.emplace_back(event / 2);
+            } else {
+                mPlanUnits[event / 2].end = i;
+            }
+        }
+    }
+    for (auto& unit : mPlanUnits) {
+        if (unit.end < 0) {
+            unit.end = (int)mPlanEvents.size();
+        }
+    }
+    // Greedy by size: place larger memory first, each at the smallest gap among the memory living at the same time
+    std::vector<int> order(mPlanUnits.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return mPlanUnits[a].size > mPlanUnits[b].size;
+    });
+    std::vector<int> placed;
+    std::vector<std::pair<size_t, size_t>> conflicts;
+    mPlanSize = 0;
+    for (auto index : order) {
+        auto& unit = mPlanUnits[index];
+        conflicts.clear();
+        for (auto p : placed) {
+            auto& other = mPlanUnits[p];
+            if (other.end < unit.begin || unit.end < other.begin) {
+                continue;
+            }
+            conflicts.emplace_back(std::make_pair(other.offset, other.offset + other.size));
+        }
+        std::sort(conflicts.begin(), conflicts.end());
+        auto align     = ALIMAX(unit.align, mAlign);
+        size_t best    = (size_t)-1;
+        size_t bestGap = (size_t)-1;
+        size_t prevEnd = 0;
+        for (auto& c : conflicts) {
+            auto start = UP_DIV(prevEnd, align) * align;
+            if (c.first >= start + unit.size && c.first - start < bestGap) {
+                best    = start;
+                bestGap = c.first - start;
+            }
+            prevEnd = ALIMAX(prevEnd, c.second);
+        }
+        if ((size_t)-1 == best) {
+            best = UP_DIV(prevEnd, align) * align;
+        }
+        unit.offset = best;
+        placed.emplace_back(index);
+        mPlanSize = ALIMAX(mPlanSize, best + unit.size);
+    }
+}
+
+void BufferAllocator::beginPlan() {
+    mPlanState      = PLAN_NONE;
+    mPlanEventIndex = 0;
+    mPlanAllocIndex = 0;
+    mPlanBroken     = false;
+    if (!mPlanUsed.empty()) {
+        // Memory of last plan is still in use
+        return;
+    }
+    if (nullptr != mPlanBlock.get() && mPlanBlock->size != mPlanSize) {
+        mTotalSize -= mPlanBlock->size;
+        mPlanBlock = nullptr;
+    }
+    if (mPlanSize > 0) {
+        if (nullptr == mPlanBlock.get()) {
+            auto pointer = mAllocator->onAlloc(mPlanSize, mAlign);
+            if (nullptr != pointer.first) {
+                mPlanBlock          = new Node;
+                mPlanBlock->size    = mPlanSize;
+                mPlanBlock->pointer = pointer;
+                mPlanBlock->outside = mAllocator.get();
+                mTotalSize += mPlanSize;
+            }
+        }
+        if (nullptr != mPlanBlock.get()) {
+            mPlanState = PLAN_REPLAY;
+            return;
+        }
+    }
+    mPlanSize = 0;
+    mPlanUnits.clear();
+    mPlanEvents.clear();
+    mPlanState = PLAN_RECORD;
+}
+
+bool BufferAllocator::endPlan() {
+    bool newPlan = false;
+    if (PLAN_RECORD == mPlanState) {
+        computePlan();
+        mPlanUsed.clear();
+        // Only use the plan if it needs less memory than the free list
+        newPlan = (!mPlanUnits.empty()) && mPlanSize <= mTotalSize;
+        if (!newPlan) {
+            mPlanSize = 0;
+        }
+    } else if (PLAN_REPLAY == mPlanState) {
+        if (mPlanBroken || mPlanEventIndex != mPlanEvents.size()) {
+            // The sequence has changed, record again next time
+            mPlanSize = 0;
+        }
+    }
+    if (0 == mPlanSize) {
+        mPlanUnits.clear();
+        mPlanEvents.clear();
+    }
+    mPlanState = PLAN_NONE;
+    return newPlan;
+}
+
+// Blocks smaller than 1 << gBinMinLog use the first bin
+static const int gBinMinLog = 8;
+static const int gBinPerLog = 4;
+static const int gBinNumber = (64 - gBinMinLog) * gBinPerLog + 1;
+// The header of block is put before the memory returned
+static const size_t gBlockHeader = MNN_MEMORY_ALIGN_DEFAULT;
+
+struct ConcurrentAllocator::Block {
+    Block* next = nullptr;
+    size_t size = 0;
+    int bin = 0;
+};
+struct ConcurrentAllocator::Bin {
+    std::mutex lock;
+    Block* head = nullptr;
+};
+
+static int _computeBin(size_t size, size_t& binSize) {
+    size_t minSize = (size_t)1 << gBinMinLog;
+    if (size <= minSize) {
+        binSize = minSize;
+        return 0;
+    }
+    // size in (base, 2 * base]
+    int log = gBinMinLog;
+    while (((size_t)1 << (log + 1)) < size) {
+        log++;
+    }
+    size_t base = (size_t)1 << log;
+    size_t step = base / gBinPerLog;
+    size_t sub  = UP_DIV(size - base, step);
+    binSize     = base + sub * step;
+    return (log - gBinMinLog) * gBinPerLog + (int)sub;
+}
+
+ConcurrentAllocator::ConcurrentAllocator() : mBins(new Bin[gBinNumber]) {
+    mTotalSize  = 0;
+    mCachedSize = 0;
+}
+
+ConcurrentAllocator::~ConcurrentAllocator() {
+    release();
+}
+
+std::pair<void*, size_t> ConcurrentAllocator::onAlloc(size_t size, size_t align) {
+    size_t binSize = 0;
+    auto bin       = _computeBin(size, binSize);
+    // Blocks of larger bins can be used too, at most twice of the size asked
+    for (int i = bin; i < bin + gBinPerLog && i < gBinNumber; ++i) {
+        Block* block = nullptr;
+        {
+            std::lock_guard<std::mutex> _l(mBins[i].lock);
+            block = mBins[i].head;
+            if (nullptr != block) {
+                mBins[i].head = block->next;
+            }
+        }
+        if (nullptr != block) {
+            mCachedSize -= block->size;
+            block->next = nullptr;
+            return std::make_pair((uint8_t*)block + gBlockHeader, 0);
+        }
+    }
+    auto ptr = (uint8_t*)MNNMemoryAllocAlign(binSize + gBlockHeader, MNN_MEMORY_ALIGN_DEFAULT);
+    if (nullptr == ptr) {
+        return std::make_pair(nullptr, 0);
+    }
+    auto block  = new (ptr) Block;
+    block->size = binSize;
+    block->bin  = bin;
+    mTotalSize += binSize;
+    return std::make_pair(ptr + gBlockHeader, 0);
+}
+
+void ConcurrentAllocator::onRelease(std::pair<void*, size_t> ptr) {
+    MNN_ASSERT(ptr.second == 0);
+    auto block = (Block*)((uint8_t*)ptr.first - gBlockHeader);
+    mCachedSize += block->size;
+    std::lock_guard<std::mutex> _l(mBins[block->bin].lock);
+    block->next = mBins[block->bin].head;
+    mBins[block->bin].head = block;
+}
+
+void ConcurrentAllocator::release() {
+    for (int i = 0; i < gBinNumber; ++i) {
+        Block* block = nullptr;
+        {
+            std::lock_guard<std::mutex> _l(mBins[i].lock);
+            block = mBins[i].head;
+            mBins[i].head = nullptr;
+        }
+        while (nullptr != block) {
+            auto next = block->next;
+            mCachedSize -= block->size;
+            mTotalSize -= block->size;
+            MNNMemoryFreeAlign(block);
+            block = next;
+        }
+    }
+}
 } // namespace MNN
@@ -9,8 +9,10 @@
 #ifndef BufferAllocator_hpp
 #define BufferAllocator_hpp
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include "MNNMemoryUtils.h"
 #include "NonCopyable.hpp"
@@ -86,12 +88,30 @@ public:
      begin group / end group means the memory allocated belong to one thread
      different group must use different memory,
      but the origin freelist can be used by every group
+     barrier can be nested in a group, then the free list of outside group can also be used by inner groups
      */
     void barrierBegin();
     void barrierEnd();
     void beginGroup();
     void endGroup();
 
+    /*
+     Offline memory planning.
+     beginPlan / endPlan surround a resize. If there is no plan, the alloc / free sequence is recorded and
+     endPlan computes an offset for every allocation by packing their lifetimes into one block (greedy by size).
+     Next resize with the same sequence takes memory from the planned block, otherwise the plan is dropped
+     and the allocator turns back to the free list.
+     endPlan returns true if a new plan is made by the recorded sequence.
+     */
+    void beginPlan();
+    bool endPlan();
+    /**
+     * @brief query the size of planned block, 0 if no plan.
+     */
+    size_t plannedSize() const {
+        return mPlanSize;
+    }
+
 private:
     class Node : public RefCount {
     public:
@@ -107,15 +127,87 @@ private:
 
     static void returnMemory(FREELIST* list, SharedPtr<Node> node, bool permitMerge = true);
     std::pair<void*, size_t> getFromFreeList(FREELIST* list, size_t size, bool permiteSplit, size_t align);
+    std::pair<void*, size_t> allocInside(size_t size, bool separate, size_t align);
+    std::pair<void*, size_t> allocFromPlan(size_t size, size_t align);
+    void recordPlanEvent(int event);
+    void computePlan();
+
+    enum PlanState {
+        PLAN_NONE = 0,
+        PLAN_RECORD,
+        PLAN_REPLAY,
+    };
+    struct PlanUnit {
+        size_t size;
+        size_t align;
+        // Index of the event alloc / free the memory
+        int begin;
+        int end;
+        size_t offset;
+    };
+    PlanState mPlanState = PLAN_NONE;
+    std::vector<PlanUnit> mPlanUnits;
+    // Alloc event is (2 * index), free event is (2 * index + 1), barrier begin / end are -1 / -2
+    std::vector<int> mPlanEvents;
+    size_t mPlanEventIndex = 0;
+    size_t mPlanAllocIndex = 0;
+    size_t mPlanSize = 0;
+    bool mPlanBroken = false;
+    // Pointers recorded or taken from planned block, map to index of unit
+    std::map<std::pair<void*, size_t>, int> mPlanUsed;
+    SharedPtr<Node> mPlanBlock;
 
     std::map<std::pair<void*, size_t>, SharedPtr<Node>> mUsedList;
     FREELIST mFreeList;
     size_t mTotalSize   = 0;
 
     FREELIST* mCurrentFreeList = nullptr;
-    std::vector<std::shared_ptr<FREELIST>> mGroups;
+    struct Barrier {
+        // Free list in use when barrier begin, nullptr means mFreeList
+        FREELIST* outside = nullptr;
+        std::vector<std::shared_ptr<FREELIST>> groups;
+    };
+    std::vector<Barrier> mBarriers;
     std::shared_ptr<Allocator> mAllocator;
     size_t mAlign;
 };
+
+/**
+ thread-safe allocator shared by the BufferAllocators of different sessions.
+ released blocks are cached in size classes (4 classes per power of two) and reused by any thread,
+ each class is guarded by its own lock so that threads asking for different sizes don't contend.
+ */
+class MNN_PUBLIC ConcurrentAllocator : public BufferAllocator::Allocator {
+public:
+    ConcurrentAllocator();
+    virtual ~ConcurrentAllocator();
+    virtual std::pair<void*, size_t> onAlloc(size_t size, size_t align) override;
+    virtual void onRelease(std::pair<void*, size_t> ptr) override;
+
+    /**
+     * @brief free all cached blocks, blocks in use are not affected.
+     */
+    void release();
+
+    /**
+     * @brief query total size allocated from system, including cached blocks.
+     */
+    size_t totalSize() const {
+        return mTotalSize;
+    }
+    /**
+     * @brief query size of cached blocks.
+     */
+    size_t cachedSize() const {
+        return mCachedSize;
+    }
+
+private:
+    struct Block;
+    struct Bin;
+    std::unique_ptr<Bin[]> mBins;
+    std::atomic<size_t> mTotalSize;
+    std::atomic<size_t> mCachedSize;
+};
 } // namespace MNN
 #endif
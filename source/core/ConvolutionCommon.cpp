@@ -7,6 +7,8 @@
 //
 
 #include "ConvolutionCommon.hpp"
+#include "Backend.hpp"
+#include "FileLoader.hpp"
 #include <math.h>
 #include "half.hpp"
 namespace MNN {
@@ -365,11 +367,11 @@ static int8_t *ReadSparseQuanData_c(unsigned char *&myfile, uint32_t *len, const
     *len = Size;
     return blob;
 }
-std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::load(const IDSTQuan *quan, bool forceFloat, bool forceInt8) {
-    auto result           = std::make_shared<Int8Common>();
+static std::shared_ptr<ConvolutionCommon::Int8Common> _loadQuan(const IDSTQuan *quan, const unsigned char* quanBuffer, size_t quanBufferSize, bool forceFloat, bool forceInt8) {
+    auto result           = std::make_shared<ConvolutionCommon::Int8Common>();
     uint32_t weightLength = 0;
     int8_t *buffer        = nullptr;
-    auto originBuffer     = (unsigned char *)quan->buffer()->data();
+    auto originBuffer     = (unsigned char *)quanBuffer;
     if (1 == quan->type()) {
         buffer = ReadQuanData_c(originBuffer, &weightLength);
     }
@@ -378,9 +380,9 @@ std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::load(const IDS
     }
     // read fp16 data
     if (3 == quan->type()) {
-        weightLength = quan->buffer()->size() / sizeof(half_float::half);
-        std::vector<int8_t> tempHalfWeight(quan->buffer()->size());
-        ::memcpy(tempHalfWeight.data(), quan->buffer()->data(), quan->buffer()->size());
+        weightLength = quanBufferSize / sizeof(half_float::half);
+        std::vector<int8_t> tempHalfWeight(quanBufferSize);
+        ::memcpy(tempHalfWeight.data(), quanBuffer, quanBufferSize);
         auto halfWeight = reinterpret_cast<half_float::half *>(tempHalfWeight.data());
         result->weightFloat.reset(weightLength);
         if (nullptr == result->weightFloat.get()) {
@@ -394,9 +396,9 @@ std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::load(const IDS
 
     // weight int8 only
     if (4 == quan->type()) {
-        weightLength = quan->buffer()->size();
+        weightLength = quanBufferSize;
         result->weight.reset(weightLength);
-        ::memcpy(result->weight.get(), quan->buffer()->data(), weightLength);
+        ::memcpy(result->weight.get(), quanBuffer, weightLength);
     }
 
     if (result->weight.get() == nullptr) {
@@ -463,9 +465,64 @@ std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::load(const IDS
     return result;
 }
 
+std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::load(const IDSTQuan *quan, bool forceFloat, bool forceInt8) {
+    return _loadQuan(quan, (const unsigned char*)quan->buffer()->data(), quan->buffer()->size(), forceFloat, forceInt8);
+}
+
+std::shared_ptr<ConvolutionCommon::Int8Common> ConvolutionCommon::loadExternal(const Backend* backend, const Convolution2D* conv2d, bool forceFloat, bool forceInt8) {
+    auto external = conv2d->external();
+    if (nullptr == external || external->size() < 3) {
+        MNN_ERROR("Invalid external info for convolution\n");
+        return nullptr;
+    }
+    auto file = backend->getExternalFile();
+    if (nullptr == file) {
+        MNN_ERROR("The convolution's weight is stored in external file, but no external file is set\n");
+        return nullptr;
+    }
+    auto offset      = external->Get(0);
+    auto weightBytes = external->Get(1);
+    auto biasBytes   = external->Get(2);
+    std::shared_ptr<Int8Common> result;
+    if (nullptr != conv2d->quanParameter()) {
+        std::vector<unsigned char> quanBuffer(weightBytes);
+        if (!file->read(quanBuffer.data(), offset, weightBytes)) {
+            return nullptr;
+        }
+        result = _loadQuan(conv2d->quanParameter(), quanBuffer.data(), quanBuffer.size(), forceFloat, forceInt8);
+    } else {
+        result = std::make_shared<Int8Common>();
+        result->quan = nullptr;
+        result->weightFloat.reset((int)(weightBytes / sizeof(float)));
+        if (nullptr == result->weightFloat.get()) {
+            MNN_PRINT("Alloc memory error for load external weight\n");
+            return nullptr;
+        }
+        if (!file->read(result->weightFloat.get(), offset, weightBytes)) {
+            return nullptr;
+        }
+    }
+    if (nullptr == result) {
+        return nullptr;
+    }
+    result->bias.reset((int)(biasBytes / sizeof(float)));
+    if (nullptr == result->bias.get()) {
+        MNN_PRINT("Alloc memory error for load external bias\n");
+        return nullptr;
+    }
+    if (!file->read(result->bias.get(), offset + weightBytes, biasBytes)) {
+        return nullptr;
+    }
+    return result;
+}
+
 void ConvolutionCommon::getConvParameters(std::shared_ptr<Int8Common> *quanCommon, const MNN::Convolution2D *conv2d, const float** originWeight, int* originWeightSize) {
     *originWeight = nullptr;
     *originWeightSize = 0;
+    if (nullptr != conv2d->external()) {
+        MNN_ERROR("Convolution with external weight need a backend to load it\n");
+        return;
+    }
     if (nullptr != conv2d->quanParameter()) {
         *quanCommon = load(conv2d->quanParameter(), false);
         *originWeight     = (*quanCommon)->weightFloat.get();
@@ -477,6 +534,39 @@ void ConvolutionCommon::getConvParameters(std::shared_ptr<Int8Common> *quanCommo
     }
 }
 
+bool ConvolutionCommon::getConvParameters(std::shared_ptr<Int8Common> *quanCommon, const Backend* backend, const MNN::Convolution2D *conv2d, const float** originWeight, int* originWeightSize, const float** bias, int* biasSize) {
+    *originWeight     = nullptr;
+    *originWeightSize = 0;
+    *bias             = nullptr;
+    *biasSize         = 0;
+    if (nullptr != conv2d->external()) {
+        *quanCommon = loadExternal(backend, conv2d, true);
+        if (nullptr == *quanCommon) {
+            return false;
+        }
+        *bias     = (*quanCommon)->bias.get();
+        *biasSize = (*quanCommon)->bias.size();
+    } else if (nullptr != conv2d->quanParameter()) {
+        *quanCommon = load(conv2d->quanParameter(), true);
+        if (nullptr == *quanCommon) {
+            return false;
+        }
+    }
+    if (nullptr != *quanCommon) {
+        *originWeight     = (*quanCommon)->weightFloat.get();
+        *originWeightSize = (*quanCommon)->weightFloat.size();
+    }
+    if (nullptr == *originWeight && nullptr != conv2d->weight()) {
+        *originWeight     = conv2d->weight()->data();
+        *originWeightSize = conv2d->weight()->size();
+    }
+    if (nullptr == *bias && nullptr != conv2d->bias()) {
+        *bias     = conv2d->bias()->data();
+        *biasSize = conv2d->bias()->size();
+    }
+    return nullptr != *originWeight && nullptr != *bias;
+}
+
 bool ConvolutionCommon::getConvInt8Parameters(const MNN::Convolution2D* conv2d, std::shared_ptr<Int8Common>& quanCommon,
                                               const int8_t*& weight, int& weightSize, float*& scale, int32_t*& bias,
                                               float inputScale, float outputScale, int inputZeroPoint, int outputZeroPoint) {
@@ -18,10 +18,16 @@ public:
         AutoStorage<int8_t> weight;
         AutoStorage<float> alpha;
         AutoStorage<float> weightFloat;
+        // Only loaded for external weight
+        AutoStorage<float> bias;
         const IDSTQuan* quan;
     };
     static std::shared_ptr<Int8Common> load(const IDSTQuan* quan, bool forceFloat = false, bool forceInt8 = false);
+    // Load weight and bias of conv2d from backend's external file, see Convolution2D::external
+    static std::shared_ptr<Int8Common> loadExternal(const Backend* backend, const Convolution2D* conv2d, bool forceFloat = false, bool forceInt8 = false);
     static void getConvParameters(std::shared_ptr<ConvolutionCommon::Int8Common> *quanCommon, const MNN::Convolution2D *conv2d, const float** originWeight, int* originWeightSize);
+    // Float weight and bias for the conv2d, support external weight
+    static bool getConvParameters(std::shared_ptr<ConvolutionCommon::Int8Common> *quanCommon, const Backend* backend, const MNN::Convolution2D *conv2d, const float** originWeight, int* originWeightSize, const float** bias, int* biasSize);
     static bool getConvInt8Parameters(const MNN::Convolution2D* conv2d, std::shared_ptr<Int8Common>& quanCommon,
                                       const int8_t*& weight, int& weightSize, float*& scale, int32_t*& bias, float inputScale, float outputScale, int inputZeroPoint, int outputZeroPoint);
 
@@ -63,6 +63,22 @@ public:
     virtual bool onClone(Backend* bn, const Op* op, Execution** dst) {
         return false;
     }
+
+    /**
+     * @brief drop the state kept across executions, such as key / value cache of attention.
+     */
+    virtual void onClearCache() {
+        // Do nothing
+    }
+
+    /**
+     * @brief share the state kept across executions with another execution of the same op,
+     * used when one net is resized into several sessions.
+     * @param src   execution of the same op created by the same type of backend
+     */
+    virtual void onShareCache(const Execution* src) {
+        // Do nothing
+    }
 public:
     /**
      * @brief designed for plugin system. not ready yet.
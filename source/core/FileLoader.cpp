@@ -9,6 +9,9 @@
 #include "core/FileLoader.hpp"
 #if defined(_MSC_VER)
 #include "Windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 namespace MNN {
 FileLoader::FileLoader(const char* file) {
@@ -33,6 +36,11 @@ FileLoader::FileLoader(const char* file) {
 }
 
 FileLoader::~FileLoader() {
+#if !defined(_MSC_VER)
+    if (nullptr != mMapped) {
+        munmap(mMapped, mTotalSize);
+    }
+#endif
     if (nullptr != mFile) {
         fclose(mFile);
     }
@@ -73,6 +81,60 @@ bool FileLoader::read() {
     return true;
 }
 
+bool FileLoader::read(void* dst, int64_t offset, int64_t size) {
+    if (nullptr == mFile || offset < 0 || size < 0) {
+        return false;
+    }
+    if (nullptr != mMapped) {
+        if (offset + size > (int64_t)mTotalSize) {
+            return false;
+        }
+        ::memcpy(dst, (const uint8_t*)mMapped + offset, size);
+        return true;
+    }
+    std::lock_guard<std::mutex> _l(mLock);
+#if defined(_MSC_VER)
+    auto code = _fseeki64(mFile, offset, SEEK_SET);
+#else
+    auto code = fseeko(mFile, (off_t)offset, SEEK_SET);
+#endif
+    if (0 != code) {
+        MNN_ERROR("Seek %s to %lld error\n", mFilePath.c_str(), (long long)offset);
+        return false;
+    }
+    auto realSize = fread(dst, 1, size, mFile);
+    if (realSize != (size_t)size) {
+        MNN_ERROR("Read %s error, need %lld but read %lld\n", mFilePath.c_str(), (long long)size, (long long)realSize);
+        return false;
+    }
+    return true;
+}
+
+bool FileLoader::map() {
+#if defined(_MSC_VER)
+    return false;
+#else
+    if (nullptr == mFile || nullptr != mMapped || !mBlocks.empty()) {
+        return false;
+    }
+    auto fd = fileno(mFile);
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size <= 0) {
+        return false;
+    }
+    // Copy-on-write private mapping: clean pages stay shared with the page cache,
+    // while in-place updates (such as updateSessionToModel) never touch the file.
+    auto ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == ptr) {
+        MNN_PRINT("mmap %s failed, fallback to read\n", mFilePath.c_str());
+        return false;
+    }
+    mMapped    = ptr;
+    mTotalSize = (size_t)st.st_size;
+    return true;
+#endif
+}
+
 bool FileLoader::write(const char* filePath, std::pair<const void*, size_t> cacheInfo) {
     FILE* f = fopen(filePath, "wb");
     if (nullptr == f) {
@@ -106,6 +168,10 @@ bool FileLoader::merge(AutoStorage<uint8_t>& buffer) {
         return false;
     }
     auto dst   = buffer.get();
+    if (nullptr != mMapped) {
+        ::memcpy(dst, mMapped, mTotalSize);
+        return true;
+    }
     int offset = 0;
     for (auto iter : mBlocks) {
         ::memcpy(dst + offset, iter.second, iter.first);
@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <mutex>
+#include <string>
 #include "core/AutoStorage.h"
 namespace MNN {
 class MNN_PUBLIC FileLoader {
@@ -17,7 +18,20 @@ public:
     ~FileLoader();
 
     bool read();
-    
+
+    /**
+     * @brief read size bytes from offset of the file into dst, thread-safe.
+     * used for random access to external weight file.
+     */
+    bool read(void* dst, int64_t offset, int64_t size);
+
+    /**
+     * @brief map the whole file read-only instead of reading it into private memory.
+     * pages are shared with the page cache, so processes mapping the same file share one copy.
+     * @return false if mmap is unsupported or fails, the caller should fallback to read() + merge().
+     */
+    bool map();
+
     static bool write(const char* filePath, std::pair<const void*, size_t> cacheInfo);
 
     bool valid() const {
@@ -26,6 +40,10 @@ public:
     inline size_t size() const {
         return mTotalSize;
     }
+    // Only valid after map() succeed
+    inline uint8_t* mappedData() const {
+        return (uint8_t*)mMapped;
+    }
 
     bool merge(AutoStorage<uint8_t>& buffer);
 
@@ -34,6 +52,8 @@ private:
     FILE* mFile                 = nullptr;
     static const int gCacheSize = 4096;
     size_t mTotalSize           = 0;
-    const char* mFilePath       = nullptr;
+    std::string mFilePath;
+    void* mMapped               = nullptr;
+    std::mutex mLock;
 };
 } // namespace MNN
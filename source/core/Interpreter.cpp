@@ -29,6 +29,8 @@ namespace MNN {
 
 struct Content {
     AutoStorage<uint8_t> buffer;
+    // Set when the model is loaded by mmap, buffer is empty in that case
+    std::unique_ptr<FileLoader> mapped;
     const Net* net = nullptr;
     std::vector<std::unique_ptr<Session>> sessions;
     std::map<Tensor*, const Session*> tensorMap;
@@ -43,6 +45,22 @@ struct Content {
     std::map<std::string, std::string> basicLogginData;
     std::map<const Session*, std::tuple<int, int>> sessionInfo;
 #endif
+    uint8_t* modelBuffer() const {
+        if (nullptr != mapped) {
+            return mapped->mappedData();
+        }
+        return buffer.get();
+    }
+    size_t modelSize() const {
+        if (nullptr != mapped) {
+            return mapped->size();
+        }
+        return buffer.size();
+    }
+    void releaseModelBuffer() {
+        mapped.reset();
+        buffer.release();
+    }
 };
 
 const char* getVersion() {
@@ -79,19 +97,63 @@ static Content* loadModelFile(const char* file) {
     auto net     = new Content;
     bool success = loader->merge(net->buffer);
     if (!success) {
+        delete net;
         return nullptr;
     }
     loader.reset();
     return net;
 }
 
+static bool _hasExternalWeight(const Net* net) {
+    for (int i = 0; i < net->oplists()->size(); ++i) {
+        auto op = net->oplists()->GetAs<Op>(i);
+        if (op->main_type() == OpParameter_Convolution2D && nullptr != op->main_as_Convolution2D()->external()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static Content* mapModelFile(const char* file) {
+    if (nullptr == file) {
+        MNN_PRINT("NULL file for create interpreter\n");
+        return nullptr;
+    }
+    std::unique_ptr<FileLoader> loader(new FileLoader(file));
+    if (!loader->valid()) {
+        MNN_PRINT("Create interpreter failed, open %s error\n", file);
+        return nullptr;
+    }
+    if (!loader->map()) {
+        return nullptr;
+    }
+    auto net    = new Content;
+    net->mapped = std::move(loader);
+    return net;
+}
+
 Interpreter* Interpreter::createFromFile(const char* file) {
-    Content* net = loadModelFile(file);
+    return createFromFile(file, false);
+}
+
+Interpreter* Interpreter::createFromFile(const char* file, bool useMmap) {
+    Content* net = nullptr;
+    if (useMmap) {
+        net = mapModelFile(file);
+    }
+    if (nullptr == net) {
+        net = loadModelFile(file);
+    }
     if (nullptr == net) {
         return nullptr;
     }
 
-    return createFromBufferInternal(net, true);
+    auto interpreter = createFromBufferInternal(net, true);
+    if (nullptr != interpreter && _hasExternalWeight(interpreter->mNet->net)) {
+        // Default external weight file is placed beside the model by MNNConvert
+        interpreter->mNet->modes.externalFile = std::string(file) + ".weight";
+    }
+    return interpreter;
 }
 Interpreter* Interpreter::createFromBuffer(const void* buffer, size_t size) {
     if (nullptr == buffer || 0 == size) {
@@ -115,14 +177,14 @@ Interpreter* Interpreter::createFromBufferInternal(Content* net, bool enforceAut
         return nullptr;
     }
 #ifndef MNN_BUILD_MINI
-    flatbuffers::Verifier verify((const uint8_t*)(net->buffer.get()), net->buffer.size());
+    flatbuffers::Verifier verify((const uint8_t*)(net->modelBuffer()), net->modelSize());
     if (false == VerifyNetBuffer(verify)) {
         MNN_PRINT("Invalidate buffer to create interpreter\n");
         delete net;
         return nullptr;
     }
 #endif
-    net->net = GetNet(net->buffer.get());
+    net->net = GetNet(net->modelBuffer());
     if (nullptr == net->net->oplists()) {
         MNN_ERROR("Model has no oplist\n");
         delete net;
@@ -145,6 +207,12 @@ void Interpreter::setSessionHint(HintMode mode, int hint) {
         case MAX_TUNING_NUMBER:
             mNet->modes.maxTuningNumber = hint;
             break;
+        case KVCACHE_SIZE_LIMIT:
+            mNet->modes.kvcacheSizeLimit = hint;
+            break;
+        case CPU_CONV_TUNING:
+            mNet->modes.cpuConvTuning = hint;
+            break;
         default:
             break;
     }
@@ -161,11 +229,15 @@ void Interpreter::setSessionMode(SessionMode mode) {
         mNet->modes.callBackMode = mode;
     } else if (mode == Session_Resize_Direct || mode == Session_Resize_Defer) {
         mNet->modes.resizeMode = mode;
+    } else if (mode == Session_Memory_Greedy || mode == Session_Memory_Plan) {
+        mNet->modes.memoryMode = mode;
+    } else if (mode == Session_Execute_Serial || mode == Session_Execute_Parallel) {
+        mNet->modes.executeMode = mode;
     }
 }
 
 void Interpreter::setCacheFile(const char* cacheFile, size_t keySize) {
-    if (nullptr == cacheFile || nullptr == mNet->buffer.get()) {
+    if (nullptr == cacheFile || nullptr == mNet->modelBuffer()) {
         MNN_ERROR("Empty cacheFile or the interpreter invalid\n");
         return;
     }
@@ -191,6 +263,14 @@ void Interpreter::setCacheFile(const char* cacheFile, size_t keySize) {
     }
 }
 
+void Interpreter::setExternalFile(const char* file) {
+    if (nullptr == file) {
+        mNet->modes.externalFile.clear();
+        return;
+    }
+    mNet->modes.externalFile = file;
+}
+
 ErrorCode Interpreter::updateCacheFile(Session *session, int flag) {
     auto buffer = session->getCache();
 
@@ -237,7 +317,7 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
 }
 
 Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>& configs, const RuntimeInfo& runtime) {
-    if (nullptr == mNet->buffer.get()) {
+    if (nullptr == mNet->modelBuffer()) {
         MNN_ERROR("The model buffer has been released. Can't create session\n");
         return nullptr;
     }
@@ -255,6 +335,15 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
     if (!success) {
         return nullptr;
     }
+    if (_hasExternalWeight(mNet->net)) {
+        // Only the CPU backend loads external weight, other backends read the weight in model directly
+        for (auto& iter : info.pipelineInfo) {
+            if (iter.first.type != MNN_FORWARD_CPU) {
+                MNN_ERROR("The model has external weight, which only support CPU backend, but %d is required\n", iter.first.type);
+                return nullptr;
+            }
+        }
+    }
     RuntimeInfo rt = runtime;
     bool valid  = false;
     if (mNet->cacheBuffer.get() != nullptr) {
@@ -318,7 +407,7 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
         metrics.emplace("Mode", std::to_string(mode));
         metrics.emplace("Cache", std::to_string(cacheMode));
         metrics.emplace("CacheSize", std::to_string((float)(mNet->lastCacheSize / 1024.0f)));
-        metrics.emplace("ModelSize", std::to_string ((float)mNet->buffer.size() / 1024.0f / 1024.0f));
+        metrics.emplace("ModelSize", std::to_string ((float)mNet->modelSize() / 1024.0f / 1024.0f));
         metrics.emplace("Usage", std::to_string((int) mNet->net->usage()));
         metrics.emplace("API", "Interpreter::createMultiPathSession");
         logAsync(metrics);
@@ -440,7 +529,7 @@ void Interpreter::resizeSession(Session* session) {
 
 void Interpreter::resizeSession(Session* session, int needRelloc) {
     std::unique_lock<std::mutex> _l(mNet->lock);
-    if (mNet->buffer.get() == nullptr) {
+    if (mNet->modelBuffer() == nullptr) {
         MNN_ERROR("The model buffer has been released. Can't resize session\n");
         return;
     }
@@ -499,8 +588,8 @@ void Interpreter::releaseModel() {
     for (auto& session : mNet->sessions) {
         session->waitAsyncResize();
     }
-    if (mNet->buffer.get() != nullptr && mNet->net->usage() != Usage_INFERENCE_STATIC) {
-        mNet->buffer.release();
+    if (mNet->modelBuffer() != nullptr && mNet->net->usage() != Usage_INFERENCE_STATIC) {
+        mNet->releaseModelBuffer();
     }
     mNet->cacheBuffer.release();
 }
@@ -551,11 +640,11 @@ const char* Interpreter::uuid() const {
 }
 
 std::pair<const void*, size_t> Interpreter::getModelBuffer() const {
-    return std::make_pair(mNet->buffer.get(), mNet->buffer.size());
+    return std::make_pair(mNet->modelBuffer(), mNet->modelSize());
 }
 ErrorCode Interpreter::updateSessionToModel(Session* session) {
     std::unique_lock<std::mutex> _l(mNet->lock);
-    if (mNet->buffer.get() == nullptr) {
+    if (mNet->modelBuffer() == nullptr) {
         MNN_ERROR("Can't updateSessionToModel because you called releaseModel before\n");
         return INPUT_DATA_ERROR;
     }
@@ -8,12 +8,16 @@
 
 #include "core/Pipeline.hpp"
 #include <string.h>
+#include <algorithm>
+#include <set>
 #include "core/Backend.hpp"
 #include "core/Macro.h"
 #include "core/TensorUtils.hpp"
 #include "core/WrapExecution.hpp"
 #include "geometry/GeometryComputerUtils.hpp"
 #include "shape/SizeComputer.hpp"
+#include "core/BufferAllocator.hpp"
+#include "core/Concurrency.h"
 
 // TODO: Find better way for debug
 //#define MNN_OP_SEPERATE
@@ -295,10 +299,96 @@ ErrorCode Pipeline::encode(bool isStatic, bool supportDebug) {
         }
     }
 #endif
-
+    mStages.clear();
+    if (mParallel && (mBackend->type() == MNN_FORWARD_CPU || mBackend->type() == MNN_FORWARD_CPU_EXTENSION)) {
+        _buildParallelStages();
+    }
     return NO_ERROR;
 }
 
+void Pipeline::_buildParallelStages() {
+    std::vector<Command*> commands;
+    for (auto& info : mInfo) {
+        for (auto& cmdP : info.executeBuffer.command) {
+            commands.emplace_back(cmdP.get());
+        }
+    }
+    // Build DAG, a command depends on the last writer of the tensors it reads and writes,
+    // and the readers since the last write of the tensors it writes
+    std::vector<std::vector<int>> preds(commands.size());
+    std::vector<int> succNumber(commands.size(), 0);
+    std::map<const Tensor*, int> lastWriter;
+    std::map<const Tensor*, std::vector<int>> readers;
+    for (int i = 0; i < commands.size(); ++i) {
+        auto cmd = commands[i];
+        auto& pred = preds[i];
+        auto read = [&](const Tensor* t) {
+            auto writer = lastWriter.find(t);
+            if (writer != lastWriter.end()) {
+                pred.emplace_back(writer->second);
+            }
+            readers[t].emplace_back(i);
+        };
+        for (auto t : cmd->inputs) {
+            auto des = TensorUtils::getDescribe(t);
+            if (cmd->op->type() == OpType_Raster) {
+                // Raster's inputs
+                for (auto& r : des->regions) {
+                    read(r.origin);
+                }
+            } else {
+                read(t);
+            }
+        }
+        for (auto t : cmd->outputs) {
+            auto writer = lastWriter.find(t);
+            if (writer != lastWriter.end()) {
+                pred.emplace_back(writer->second);
+            }
+            auto reader = readers.find(t);
+            if (reader != readers.end()) {
+                for (auto r : reader->second) {
+                    if (r != i) {
+                        pred.emplace_back(r);
+                    }
+                }
+                readers.erase(reader);
+            }
+            lastWriter[t] = i;
+        }
+        std::sort(pred.begin(), pred.end());
+        pred.erase(std::unique(pred.begin(), pred.end()), pred.end());
+        for (auto p : pred) {
+            succNumber[p]++;
+        }
+    }
+    // Linear path of commands merge into one chain, a chain is put in the stage after all stages it depends on
+    std::vector<int> chainIndex(commands.size());
+    std::vector<int> chainStage;
+    std::vector<CommandChain> chains;
+    for (int i = 0; i < commands.size(); ++i) {
+        auto& pred = preds[i];
+        if (pred.size() == 1 && succNumber[pred[0]] == 1) {
+            chainIndex[i] = chainIndex[pred[0]];
+            chains[chainIndex[i]].emplace_back(commands[i]);
+            continue;
+        }
+        int stage = 0;
+        for (auto p : pred) {
+            stage = ALIMAX(stage, chainStage[chainIndex[p]] + 1);
+        }
+        chainIndex[i] = (int)chains.size();
+        chains.emplace_back(CommandChain{commands[i]});
+        chainStage.emplace_back(stage);
+    }
+    for (int i = 0; i < chains.size(); ++i) {
+        if (chainStage[i] >= mStages.size()) {
+            mStages.resize(chainStage[i] + 1);
+        }
+        mStages[chainStage[i]].emplace_back(std::move(chains[i]));
+    }
+}
+
 void Pipeline::_pushTuningTask(std::vector<Schedule::PipelineInfo>&& initInfos) {
     // Dup Tensors for initInfos;
     std::map<Tensor*, std::shared_ptr<Tensor>> holdTensors;
@@ -457,42 +547,6 @@ ErrorCode Pipeline::allocMemory(bool firstMalloc) {
             }
         }
     }
-    int maxLayerUsage = 0;
-    // Compute RefCount
-    for (auto& info : mInfo) {
-        auto& buffer = info.executeBuffer;
-        for (auto& iterP : buffer.command) {
-            auto& iter = *iterP;
-            bool isRaster = iter.op->type() == OpType_Raster;
-            for (auto t : iter.inputs) {
-                auto des = TensorUtils::getDescribe(t);
-                if (isRaster) {
-                    for (auto& r : des->regions) {
-                        TensorUtils::getDescribe(r.origin)->useCount = 0;
-                    }
-                } else {
-                    des->useCount = 0;
-                }
-            }
-        }
-    }
-    for (auto& info : mInfo) {
-        auto& buffer = info.executeBuffer;
-        for (auto& iterP : buffer.command) {
-            auto& iter = *iterP;
-            bool isRaster = iter.op->type() == OpType_Raster;
-            for (auto t : iter.inputs) {
-                auto des = TensorUtils::getDescribe(t);
-                if (isRaster) {
-                    for (auto& r : des->regions) {
-                        TensorUtils::getDescribe(r.origin)->useCount += 1;
-                    }
-                } else {
-                    des->useCount += 1;
-                }
-            }
-        }
-    }
     // Check If we need a lone time for init
     if (mBackend->type() != MNN_FORWARD_CPU && mBackend->type() != MNN_FORWARD_CPU_EXTENSION && mTuneAttr.autoSetOpType) {
         Runtime::OpInfo dstInfo;
@@ -531,134 +585,281 @@ ErrorCode Pipeline::allocMemory(bool firstMalloc) {
             mBackend.reset(mCpuRuntime->onCreate(nullptr));
         }
     }
-    mBackend->onClearBuffer();
-    mBackupBackend->onClearBuffer();
-    // Create Execution and Alloc
-    mBackend->onResizeBegin();
+    auto code = _allocForResize();
+    if (NO_ERROR != code) {
+        return code;
+    }
+    if (mBackend->onMemoryPlanReady()) {
+        // Tensors' lifetime has been recorded, alloc again to use the planned memory
+        for (auto& info : mInfo) {
+            for (auto& c : info.executeBuffer.command) {
+                _releaseBackendMemory(c.get());
+            }
+        }
+        code = _allocForResize();
+    }
+    return code;
+}
+
+void Pipeline::_releaseBackendMemory(Command* command) {
+    // The memory will be cleared by backend, drop separate memory that is not released
+    auto release = [this](Tensor* t) {
+        auto des = TensorUtils::getDescribe(t);
+        if (des->backend != mBackend.get() && des->backend != mBackupBackend.get()) {
+            return;
+        }
+        if (Backend::STATIC != _getTensorStorageType(t, mAllocInput, mOutputStatic)) {
+            des->mem.reset(nullptr);
+        }
+    };
+    bool isRaster = command->op->type() == OpType_Raster;
+    for (auto t : command->inputs) {
+        if (isRaster) {
+            for (auto& r : TensorUtils::getDescribe(t)->regions) {
+                release(r.origin);
+            }
+        } else {
+            release(t);
+        }
+    }
+    for (auto t : command->outputs) {
+        release(t);
+    }
+}
+
+ErrorCode Pipeline::_allocForResize() {
+    // Compute RefCount
     for (auto& info : mInfo) {
         auto& buffer = info.executeBuffer;
         for (auto& iterP : buffer.command) {
             auto& iter = *iterP;
-            // MNN_PRINT("before Resize: %d - %s\n", i, EnumNameOpType(iter.op->type()));
-            // MNN_PRINT("before Resize: %s\n", iter.name.c_str());
-            if (nullptr == iter.executionOrigin) {
-                bool cached    = false;
-                /** Cache origin execution for fast resize*/
-                auto exeIter = mOriginExecution.find(iter.op);
-                if (exeIter != mOriginExecution.end()) {
-                    iter.executionOrigin = exeIter->second.first;
-                    cached         = true;
-                    for (auto t : iter.outputs) {
-                        TensorUtils::getDescribe(t)->type = exeIter->second.second;
+            bool isRaster = iter.op->type() == OpType_Raster;
+            for (auto t : iter.inputs) {
+                auto des = TensorUtils::getDescribe(t);
+                if (isRaster) {
+                    for (auto& r : des->regions) {
+                        TensorUtils::getDescribe(r.origin)->useCount = 0;
                     }
+                } else {
+                    des->useCount = 0;
                 }
-                // Create exe
-                if (nullptr == iter.executionOrigin) {
-                    iter.executionOrigin.reset(mBackend->onCreate(iter.inputs, iter.outputs, iter.op));
-                    if (nullptr == iter.executionOrigin) {
-                        iter.executionOrigin.reset(mBackupBackend->onCreate(iter.inputs, iter.outputs, iter.op));
-                        if (nullptr == iter.executionOrigin) {
-                            MNN_ERROR("Create exection error : %d\n", iter.op->type());
-                            return NOT_SUPPORT;
-                        }
+            }
+        }
+    }
+    for (auto& info : mInfo) {
+        auto& buffer = info.executeBuffer;
+        for (auto& iterP : buffer.command) {
+            auto& iter = *iterP;
+            bool isRaster = iter.op->type() == OpType_Raster;
+            for (auto t : iter.inputs) {
+                auto des = TensorUtils::getDescribe(t);
+                if (isRaster) {
+                    for (auto& r : des->regions) {
+                        TensorUtils::getDescribe(r.origin)->useCount += 1;
                     }
+                } else {
+                    des->useCount += 1;
                 }
-                // invalid means memory alloc failed
-                if (!iter.executionOrigin->valid()) {
-                    iter.executionOrigin = nullptr;
-                    iter.execution = nullptr;
-                    return OUT_OF_MEMORY;
+            }
+        }
+    }
+    mBackend->onClearBuffer();
+    mBackupBackend->onClearBuffer();
+    // Create Execution and Alloc
+    mBackend->onResizeBegin();
+    // In a stage of concurrent chains, tensors not made by the chain may still be read by other chains,
+    // release them after all chains of the stage
+    bool concurrent = false;
+    std::set<const Tensor*> chainOutputs;
+    std::vector<Tensor*> deferRelease;
+    auto releaseInput = [&](Tensor* t) {
+        if (concurrent && chainOutputs.find(t) == chainOutputs.end()) {
+            deferRelease.emplace_back(t);
+            return;
+        }
+        _releaseTensor(t, mAllocInput);
+    };
+    auto resizeCommand = [&](Command& iter) -> ErrorCode {
+        // MNN_PRINT("before Resize: %d - %s\n", i, EnumNameOpType(iter.op->type()));
+        // MNN_PRINT("before Resize: %s\n", iter.name.c_str());
+        if (nullptr == iter.executionOrigin) {
+            bool cached    = false;
+            /** Cache origin execution for fast resize*/
+            auto exeIter = mOriginExecution.find(iter.op);
+            if (exeIter != mOriginExecution.end()) {
+                iter.executionOrigin = exeIter->second.first;
+                cached         = true;
+                for (auto t : iter.outputs) {
+                    TensorUtils::getDescribe(t)->type = exeIter->second.second;
                 }
-                // FIXME: The cached execution may cause wrap error. Fix it in future
-                if ((!cached) && iter.buffer == nullptr && (iter.op->type() != OpType_Raster) && (iter.op->type() != OpType_BinaryOp)) {
-                    if (iter.outputs.size() > 0) {
-                        auto type = TensorUtils::getDescribe(iter.outputs[0])->type;
-                        mOriginExecution.insert(std::make_pair(iter.op, std::make_pair(iter.executionOrigin, type)));
+            }
+            // Create exe
+            if (nullptr == iter.executionOrigin) {
+                iter.executionOrigin.reset(mBackend->onCreate(iter.inputs, iter.outputs, iter.op));
+                if (nullptr == iter.executionOrigin) {
+                    iter.executionOrigin.reset(mBackupBackend->onCreate(iter.inputs, iter.outputs, iter.op));
+                    if (nullptr == iter.executionOrigin) {
+                        MNN_ERROR("Create exection error : %d\n", iter.op->type());
+                        return NOT_SUPPORT;
                     }
                 }
             }
-            auto curBackend = iter.executionOrigin->backend();
-            // Alloc for Tensors
-            bool wrap          = false;
-            if (mAllocInput) {
-                for (auto t : iter.inputs) {
-                    auto des = TensorUtils::getDescribe(t);
-                    if (iter.op->type() == OpType_Raster) {
-                        // Raster's inputs
-                        for (auto& r : des->regions) {
-                            auto allocRes = _allocTensor(r.origin, curBackend, mAllocInput, mOutputStatic);
-                            if (!allocRes) {
-                                return OUT_OF_MEMORY;
-                            }
-                        }
-                    } else {
-                        auto allocRes = _allocTensor(t, curBackend, mAllocInput, mOutputStatic);
-                        if (!allocRes) {
-                            return OUT_OF_MEMORY;
-                        }
-                    }
+            // invalid means memory alloc failed
+            if (!iter.executionOrigin->valid()) {
+                iter.executionOrigin = nullptr;
+                iter.execution = nullptr;
+                return OUT_OF_MEMORY;
+            }
+            // FIXME: The cached execution may cause wrap error. Fix it in future
+            if ((!cached) && iter.buffer == nullptr && (iter.op->type() != OpType_Raster) && (iter.op->type() != OpType_BinaryOp)) {
+                if (iter.outputs.size() > 0) {
+                    auto type = TensorUtils::getDescribe(iter.outputs[0])->type;
+                    mOriginExecution.insert(std::make_pair(iter.op, std::make_pair(iter.executionOrigin, type)));
                 }
             }
-            // Check If need wrap
-            bool isRaster = iter.op->type() == OpType_Raster;
-            for (int v=0; v<iter.inputs.size(); ++v) {
-                auto t = iter.inputs[v];
+        }
+        auto curBackend = iter.executionOrigin->backend();
+        // Alloc for Tensors
+        bool wrap          = false;
+        if (mAllocInput) {
+            for (auto t : iter.inputs) {
                 auto des = TensorUtils::getDescribe(t);
-                if (isRaster) {
+                if (iter.op->type() == OpType_Raster) {
                     // Raster's inputs
                     for (auto& r : des->regions) {
-                        auto origin     = r.origin;
-                        if (WrapExecution::needWrap(origin, curBackend)) {
-                            auto newTensor = WrapExecution::copyConstCache(origin, curBackend, mCacheConstTensors);
-                            if (nullptr != newTensor) {
-                                r.origin = newTensor;
-                            } else {
-                                wrap = true;
-                            }
+                        auto allocRes = _allocTensor(r.origin, curBackend, mAllocInput, mOutputStatic);
+                        if (!allocRes) {
+                            return OUT_OF_MEMORY;
                         }
                     }
                 } else {
-                    if (WrapExecution::needWrap(t, curBackend)) {
-                        auto newTensor = WrapExecution::copyConstCache(t, curBackend, mCacheConstTensors);
+                    auto allocRes = _allocTensor(t, curBackend, mAllocInput, mOutputStatic);
+                    if (!allocRes) {
+                        return OUT_OF_MEMORY;
+                    }
+                }
+            }
+        }
+        // Check If need wrap
+        bool isRaster = iter.op->type() == OpType_Raster;
+        for (int v=0; v<iter.inputs.size(); ++v) {
+            auto t = iter.inputs[v];
+            auto des = TensorUtils::getDescribe(t);
+            if (isRaster) {
+                // Raster's inputs
+                for (auto& r : des->regions) {
+                    auto origin     = r.origin;
+                    if (WrapExecution::needWrap(origin, curBackend)) {
+                        auto newTensor = WrapExecution::copyConstCache(origin, curBackend, mCacheConstTensors);
                         if (nullptr != newTensor) {
-                            iter.inputs[v] = newTensor;
+                            r.origin = newTensor;
                         } else {
                             wrap = true;
                         }
                     }
                 }
-            }
-            {
-                for (auto t : iter.outputs) {
-                    auto res = _allocTensor(t, curBackend, mAllocInput, mOutputStatic);
-                    if (!res) {
-                        return OUT_OF_MEMORY;
+            } else {
+                if (WrapExecution::needWrap(t, curBackend)) {
+                    auto newTensor = WrapExecution::copyConstCache(t, curBackend, mCacheConstTensors);
+                    if (nullptr != newTensor) {
+                        iter.inputs[v] = newTensor;
+                    } else {
+                        wrap = true;
                     }
                 }
             }
-            // Wrap If needed
-            if (wrap) {
-                iter.execution.reset(new WrapExecution(mBackupBackend.get(), iter.executionOrigin));
-            } else {
-                iter.execution = iter.executionOrigin;
+        }
+        {
+            for (auto t : iter.outputs) {
+                auto res = _allocTensor(t, curBackend, mAllocInput, mOutputStatic);
+                if (!res) {
+                    return OUT_OF_MEMORY;
+                }
+                if (concurrent) {
+                    chainOutputs.insert(t);
+                }
             }
+        }
+        // Wrap If needed
+        if (wrap) {
+            iter.execution.reset(new WrapExecution(mBackupBackend.get(), iter.executionOrigin));
+        } else {
+            iter.execution = iter.executionOrigin;
+        }
 
-            auto code = iter.execution->onResize(iter.inputs, iter.outputs);
-            if (NO_ERROR != code && (!iter.info.get())) {
-                MNN_ERROR("Resize error for type = %s, name = %s \n", iter.info->type().c_str(), iter.info->name().c_str());
-                return code;
+        auto code = iter.execution->onResize(iter.inputs, iter.outputs);
+        if (NO_ERROR != code && (!iter.info.get())) {
+            MNN_ERROR("Resize error for type = %s, name = %s \n", iter.info->type().c_str(), iter.info->name().c_str());
+            return code;
+        }
+        // Free mid tensor
+        for (auto t : iter.inputs) {
+            auto des = TensorUtils::getDescribe(t);
+            if (iter.op->type() == OpType_Raster) {
+                // Raster's inputs
+                for (auto& r : des->regions) {
+                    releaseInput(r.origin);
+                }
+            } else {
+                releaseInput(t);
             }
-            // Free mid tensor
-            for (auto t : iter.inputs) {
-                auto des = TensorUtils::getDescribe(t);
-                if (iter.op->type() == OpType_Raster) {
-                    // Raster's inputs
-                    for (auto& r : des->regions) {
-                        _releaseTensor(r.origin, mAllocInput);
+        }
+        return NO_ERROR;
+    };
+    if (mStages.empty()) {
+        for (auto& info : mInfo) {
+            for (auto& iterP : info.executeBuffer.command) {
+                auto code = resizeCommand(*iterP);
+                if (NO_ERROR != code) {
+                    return code;
+                }
+            }
+        }
+    } else {
+        // Memory of different groups never overlap, so the chains can run at the same time
+        std::vector<BufferAllocator*> allocators = {static_cast<CPUBackend*>(mBackend.get())->getBufferAllocator()};
+        if (mBackupBackend != mBackend) {
+            allocators.emplace_back(static_cast<CPUBackend*>(mBackupBackend.get())->getBufferAllocator());
+        }
+        for (auto& stage : mStages) {
+            concurrent = stage.size() > 1;
+            if (concurrent) {
+                for (auto allocator : allocators) {
+                    allocator->barrierBegin();
+                }
+            }
+            ErrorCode code = NO_ERROR;
+            for (int i = 0; i < stage.size() && NO_ERROR == code; ++i) {
+                if (concurrent) {
+                    chainOutputs.clear();
+                    for (auto allocator : allocators) {
+                        allocator->beginGroup();
                     }
-                } else {
+                }
+                for (auto cmd : stage[i]) {
+                    code = resizeCommand(*cmd);
+                    if (NO_ERROR != code) {
+                        break;
+                    }
+                }
+                if (concurrent) {
+                    for (auto allocator : allocators) {
+                        allocator->endGroup();
+                    }
+                }
+            }
+            if (concurrent) {
+                for (auto allocator : allocators) {
+                    allocator->barrierEnd();
+                }
+                for (auto t : deferRelease) {
                     _releaseTensor(t, mAllocInput);
                 }
+                deferRelease.clear();
+                concurrent = false;
+            }
+            if (NO_ERROR != code) {
+                return code;
             }
         }
     }
@@ -673,8 +874,47 @@ ErrorCode Pipeline::allocMemory(bool firstMalloc) {
     return NO_ERROR;
 }
 
+ErrorCode Pipeline::_executeParallel() {
+    for (auto& stage : mStages) {
+        std::vector<ErrorCode> codes(stage.size(), NO_ERROR);
+        auto runChain = [&stage, &codes](int index) {
+            for (auto cmd : stage[index]) {
+                auto code = cmd->execution->onExecute(cmd->inputs, cmd->outputs);
+                if (NO_ERROR != code) {
+                    codes[index] = code;
+                    break;
+                }
+            }
+        };
+#ifdef MNN_USE_THREAD_POOL
+        if (stage.size() > 1) {
+            // The chains and the tasks of their executions share the threads of pool
+            ThreadPool::TASK task = std::make_pair(runChain, (int)stage.size());
+            auto cpuBn = static_cast<CPUBackend*>(mBackend.get());
+            ThreadPool::enqueue(std::move(task), cpuBn->taskIndex(), cpuBn->threadNumber());
+        } else
+#endif
+        {
+            for (int i = 0; i < stage.size(); ++i) {
+                runChain(i);
+            }
+        }
+        for (auto code : codes) {
+            if (NO_ERROR != code) {
+                return code;
+            }
+        }
+    }
+    return NO_ERROR;
+}
+
 ErrorCode Pipeline::execute() {
     mBackend->onExecuteBegin();
+    if (!mStages.empty()) {
+        auto code = _executeParallel();
+        mBackend->onExecuteEnd();
+        return code;
+    }
     for (auto& info : mInfo) {
         auto& buffer = info.executeBuffer;
         for (auto& cmdP : buffer.command) {
@@ -691,33 +931,45 @@ ErrorCode Pipeline::execute() {
 }
 
 ErrorCode Pipeline::executeCallBack(const TensorCallBackWithInfo& before, const TensorCallBackWithInfo& after) {
-    mBackend->onExecuteBegin();
-    for (auto& info : mInfo) {
-        auto& buffer = info.executeBuffer;
-        for (auto& cmdP : buffer.command) {
-            auto& cmd = *cmdP;
-            if (nullptr == cmd.info.get()) {
-                auto code = cmd.execution->onExecute(cmd.inputs, cmd.outputs);
-                if (NO_ERROR != code) {
-                    mBackend->onExecuteEnd();
-                    return code;
-                }
-                continue;
+    // Memory of parallel stages is planned for the order of stages, run in the same order
+    std::vector<Command*> commands;
+    if (mStages.empty()) {
+        for (auto& info : mInfo) {
+            for (auto& cmdP : info.executeBuffer.command) {
+                commands.emplace_back(cmdP.get());
             }
-            auto run   = before(cmd.inputs, cmd.info.get());
-            if (run) {
-                auto code = cmd.execution->onExecute(cmd.inputs, cmd.outputs);
-                if (NO_ERROR != code) {
-                    mBackend->onExecuteEnd();
-                    return code;
-                }
+        }
+    } else {
+        for (auto& stage : mStages) {
+            for (auto& chain : stage) {
+                commands.insert(commands.end(), chain.begin(), chain.end());
+            }
+        }
+    }
+    mBackend->onExecuteBegin();
+    for (auto cmdP : commands) {
+        auto& cmd = *cmdP;
+        if (nullptr == cmd.info.get()) {
+            auto code = cmd.execution->onExecute(cmd.inputs, cmd.outputs);
+            if (NO_ERROR != code) {
+                mBackend->onExecuteEnd();
+                return code;
             }
-            auto stop = !(after(cmd.outputs, cmd.info.get()));
-            if (stop) {
+            continue;
+        }
+        auto run   = before(cmd.inputs, cmd.info.get());
+        if (run) {
+            auto code = cmd.execution->onExecute(cmd.inputs, cmd.outputs);
+            if (NO_ERROR != code) {
                 mBackend->onExecuteEnd();
-                return CALL_BACK_STOP;
+                return code;
             }
         }
+        auto stop = !(after(cmd.outputs, cmd.info.get()));
+        if (stop) {
+            mBackend->onExecuteEnd();
+            return CALL_BACK_STOP;
+        }
     }
     mBackend->onExecuteEnd();
     return NO_ERROR;
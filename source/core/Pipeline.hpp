@@ -59,9 +59,17 @@ public:
     MNNForwardType getMainForwardType() const  {
         return mBackend->type();
     }
+    /** run independent commands at the same time, only valid for cpu backend with thread pool, set before encode */
+    void setParallel(bool parallel) {
+        mParallel = parallel;
+    }
 private:
     void _pushTuningTask(std::vector<Schedule::PipelineInfo>&& initInfos);
     void _recycleDynamicMemory(Command* command);
+    void _releaseBackendMemory(Command* command);
+    ErrorCode _allocForResize();
+    void _buildParallelStages();
+    ErrorCode _executeParallel();
     std::shared_ptr<Backend> mBackend, mBackupBackend, mConstBackend;
     std::vector<Schedule::PipelineInfo> mInfo;
     bool mAllocInput;
@@ -79,6 +87,12 @@ private:
 #endif
     const Runtime* mRuntime;
     const Runtime* mCpuRuntime;
+
+    // Commands in one chain run in order, the chains of one stage don't depend on each other and run concurrently,
+    // stages run one by one. Empty if not parallel
+    typedef std::vector<Command*> CommandChain;
+    std::vector<std::vector<CommandChain>> mStages;
+    bool mParallel = false;
 };
 } // namespace MNN
 
@@ -13,6 +13,7 @@
 #include <set>
 #include "MNN_generated.h"
 #include "core/AutoStorage.h"
+#include "core/FileLoader.hpp"
 #include "core/RuntimeFactory.hpp"
 #include "core/TensorUtils.hpp"
 #include "core/WrapExecution.hpp"
@@ -28,6 +29,14 @@ Session::Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode, RuntimeIn
     }
     mTensors       = std::move(info.allTensors);
     auto defaultBn = std::move(info.defaultBackend);
+    std::shared_ptr<FileLoader> externalFile;
+    if (!mode.externalFile.empty()) {
+        externalFile.reset(new FileLoader(mode.externalFile.c_str()));
+        if (!externalFile->valid()) {
+            MNN_ERROR("Can't open external weight file %s\n", mode.externalFile.c_str());
+            externalFile = nullptr;
+        }
+    }
     for (auto& iter : info.pipelineInfo) {
         auto rt    = mRuntime.first.find(iter.first.type)->second.get();
         auto cpuRuntime = mRuntime.second;
@@ -47,10 +56,21 @@ Session::Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode, RuntimeIn
             defaultConfig.flags = 4;
             second.reset(cpuRuntime->onCreate(&defaultConfig));
         }
+        first->setExternalFile(externalFile);
+        second->setExternalFile(externalFile);
+        first->setKVCacheLimit(mode.kvcacheSizeLimit);
+        second->setKVCacheLimit(mode.kvcacheSizeLimit);
+        if (mode.cpuConvTuning > 0) {
+            first->onSetTuning(true);
+        }
+        if (mode.memoryMode == Interpreter::Session_Memory_Plan) {
+            first->onSetMemoryPlan(true);
+        }
         Pipeline::TuningAttr attr;
         attr.maxTuningNumber = mode.maxTuningNumber;
         attr.autoSetOpType = mode.backendMode == Interpreter::Session_Backend_Auto;
         std::shared_ptr<Pipeline> newPipeline(new Pipeline(std::move(iter.second), first, second, defaultBn, mode.inputMode == Interpreter::Session_Input_Inside, mode.outputMode == Interpreter::Session_Output_User, attr, rt, cpuRuntime.get(), mOriginExecutions));
+        newPipeline->setParallel(mode.executeMode == Interpreter::Session_Execute_Parallel);
         mPipelines.emplace_back(std::move(newPipeline));
     }
     mInputs       = std::move(info.inputTensors);
@@ -123,6 +143,25 @@ void Session::cloneExecution(const CacheExecutionMap& cache) {
     }
 }
 
+void Session::clearExecutionCache() {
+    for (auto& iter : mOriginExecutions) {
+        iter.second.first->onClearCache();
+    }
+}
+
+void Session::shareExecutionCache(const Session* src) {
+    for (auto& iter : mOriginExecutions) {
+        auto srcIter = src->mOriginExecutions.find(iter.first);
+        if (srcIter == src->mOriginExecutions.end() || srcIter->second.first == iter.second.first) {
+            continue;
+        }
+        if (srcIter->second.first->backend()->type() != iter.second.first->backend()->type()) {
+            continue;
+        }
+        iter.second.first->onShareCache(srcIter->second.first.get());
+    }
+}
+
 ErrorCode Session::run() const {
     if (mNeedResize) {
         MNN_ERROR("Can't run session because not resized\n");
@@ -31,7 +31,15 @@ public:
         Interpreter::SessionMode outputMode = Interpreter::Session_Output_Inside;
         Interpreter::SessionMode backendMode = Interpreter::Session_Backend_Fix;
         Interpreter::SessionMode resizeMode = Interpreter::Session_Resize_Direct;
+        Interpreter::SessionMode memoryMode = Interpreter::Session_Memory_Greedy;
+        Interpreter::SessionMode executeMode = Interpreter::Session_Execute_Serial;
         int maxTuningNumber = MNN_DEFAULT_TUNING_NUMBER;
+        // File holding the weights stored outside the model, empty if the model has none
+        std::string externalFile;
+        // Max sequence length of key / value cache, 0 means no limit
+        int kvcacheSizeLimit = 0;
+        // Measure the algorithms of CPU convolution when creating executions
+        int cpuConvTuning = 0;
     };
     Session(Schedule::ScheduleInfo&& info, const ModeGroup& mode,
             RuntimeInfo&& runtime);
@@ -59,6 +67,15 @@ public:
     const CacheExecutionMap& getExecution() {
         return mOriginExecutions;
     }
+    /**
+     * @brief drop the state kept by executions across runs, such as key / value cache.
+     */
+    void clearExecutionCache();
+    /**
+     * @brief let executions share the state kept across runs with the ones of the same op in src.
+     * @param src   session created from the same net.
+     */
+    void shareExecutionCache(const Session* src);
 public:
     /**
      * @brief resize tensors and buffers responding to input changes.
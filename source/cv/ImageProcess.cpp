@@ -178,7 +178,19 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
     if (dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
         bpp = 4;
     }
-    return convert(source, iw, ih, stride, dest->host<void>(), ow, oh, bpp, ow * bpp, dest->getType());
+    // Use the threads of session's cpu backend
+    const CPUBackend* cpuBn = nullptr;
+    if (nullptr != tensorBn && (bnType == MNN_FORWARD_CPU || bnType == MNN_FORWARD_CPU_EXTENSION)) {
+        cpuBn = static_cast<const CPUBackend*>(tensorBn);
+        cpuBn->onExecuteBegin();
+    }
+    mInside->execution->setThreadBackend(cpuBn);
+    auto code = convert(source, iw, ih, stride, dest->host<void>(), ow, oh, bpp, ow * bpp, dest->getType());
+    mInside->execution->setThreadBackend(nullptr);
+    if (nullptr != cpuBn) {
+        cpuBn->onExecuteEnd();
+    }
+    return code;
 }
 
 ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, void* dest, int ow, int oh,
@@ -280,12 +280,7 @@ ErrorCode GeometryComputerUtils::shapeComputeAndGeometryTransform(
     }
 #ifdef MNN_BUILD_CODEGEN
     // fuse op and codegen
-    // TODO: Merge CommandBuffer and then Fuse
-    {
-        for (auto& buf : buffer) {
-            opFuse(buf);
-        }
-    }
+    opFuse(infos, geoContext.forwardType());
 #endif
     return NO_ERROR;
 }
@@ -477,6 +477,15 @@ public:
     virtual bool onCompute(const Op* op, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                            Context& context, CommandBuffer& res) const override {
         if (2 < inputs.size()) {
+            if (context.forwardType() == MNN_FORWARD_CPU) {
+                // CPU computes Onnx 's LSTM / RNN in one execution, see CPULSTM
+                SharedPtr<Command> cmd(new Command);
+                cmd->op      = op;
+                cmd->inputs  = inputs;
+                cmd->outputs = outputs;
+                res.command.emplace_back(std::move(cmd));
+                return true;
+            }
             // Onnx 's LSTM, use origin way
             _ComputeLSTMOnnx(inputs, outputs, context, res, op->main_as_LSTM(), op->type());
             return true;
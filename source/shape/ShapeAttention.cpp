@@ -0,0 +1,79 @@
+//
+//  ShapeAttention.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+
+namespace MNN {
+// inputs: query [..., L, D], key [..., S, D], value [..., S, Dv], mask (optional, broadcast to [..., L, S])
+// output: [..., L, Dv]
+class AttentionSizeComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op *op, const std::vector<Tensor *> &inputs,
+                               const std::vector<Tensor *> &outputs) const override {
+        MNN_ASSERT(inputs.size() >= 3);
+        MNN_ASSERT(1 == outputs.size());
+        auto query = inputs[0], key = inputs[1], value = inputs[2];
+        const int dims = query->dimensions();
+        if (dims < 2 || key->dimensions() != dims || value->dimensions() != dims) {
+            MNN_ERROR("Attention: query, key and value should have the same rank and rank >= 2\n");
+            return false;
+        }
+        for (int i = 0; i < dims - 2; ++i) {
+            if (query->length(i) != key->length(i) || query->length(i) != value->length(i)) {
+                MNN_ERROR("Attention: batch dims of query, key and value don't match\n");
+                return false;
+            }
+        }
+        if (query->length(dims - 1) != key->length(dims - 1) || key->length(dims - 2) != value->length(dims - 2)) {
+            MNN_ERROR("Attention: head dim or sequence length of query, key and value don't match\n");
+            return false;
+        }
+        if (inputs.size() > 3) {
+            auto mask = inputs[3];
+            const int maskDims = mask->dimensions();
+            if (maskDims < 2 || maskDims > dims || mask->length(maskDims - 2) != query->length(dims - 2) ||
+                mask->length(maskDims - 1) != key->length(dims - 2)) {
+                MNN_ERROR("Attention: mask should be [..., query length, key length]\n");
+                return false;
+            }
+            for (int i = 0; i < maskDims - 2; ++i) {
+                auto length = mask->length(i);
+                if (length != 1 && length != query->length(i + dims - maskDims)) {
+                    MNN_ERROR("Attention: mask can't broadcast to query\n");
+                    return false;
+                }
+            }
+        }
+        auto &ob = outputs[0]->buffer();
+        ob.dimensions = dims;
+        for (int i = 0; i < dims - 1; ++i) {
+            ob.dim[i].extent = query->length(i);
+        }
+        ob.dim[dims - 1].extent = value->length(dims - 1);
+        ob.type = query->getType();
+        TensorUtils::getDescribe(outputs[0])->dimensionFormat = TensorUtils::getDescribe(query)->dimensionFormat;
+        return true;
+    }
+
+    virtual float onComputeFlops(const MNN::Op *op, const std::vector<Tensor *> &inputs,
+                                 const std::vector<Tensor *> &outputs) const override {
+        auto query = inputs[0], key = inputs[1], value = inputs[2];
+        const int dims = query->dimensions();
+        float batch = 1.0f;
+        for (int i = 0; i < dims - 2; ++i) {
+            batch *= query->length(i);
+        }
+        float l = query->length(dims - 2), s = key->length(dims - 2);
+        float d = query->length(dims - 1), dv = value->length(dims - 1);
+        return batch * l * s * (d + dv) / FLOPS_M;
+    }
+};
+
+REGISTER_SHAPE(AttentionSizeComputer, OpType_Attention);
+
+} // namespace MNN
@@ -20,6 +20,7 @@ extern void ___QuantizedAvgPoolComputer__OpType_QuantizedAvgPool__();
 extern void ___ArgMaxComputer__OpType_ArgMax__();
 extern void ___ArgMaxComputer__OpType_ArgMin__();
 extern void ___GridSampleSizeComputer__OpType_GridSample__();
+extern void ___AttentionSizeComputer__OpType_Attention__();
 extern void ___DepthToSpaceSizeComputer__OpType_DepthToSpace__();
 extern void ___SliceTfComputer__OpType_SliceTf__();
 extern void ___SelectSizeComputer__OpType_Select__();
@@ -129,6 +130,7 @@ ___QuantizedAvgPoolComputer__OpType_QuantizedAvgPool__();
 ___ArgMaxComputer__OpType_ArgMax__();
 ___ArgMaxComputer__OpType_ArgMin__();
 ___GridSampleSizeComputer__OpType_GridSample__();
+___AttentionSizeComputer__OpType_Attention__();
 ___DepthToSpaceSizeComputer__OpType_DepthToSpace__();
 ___SliceTfComputer__OpType_SliceTf__();
 ___SelectSizeComputer__OpType_Select__();
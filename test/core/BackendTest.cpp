@@ -473,13 +473,9 @@ void nchw_2_NC4HW4_2_nchw_float(std::shared_ptr<Backend> bn) {
 }
 
 template <typename T>
-bool nhwc_2_NC4HW4_2_nhwc_inttype(std::shared_ptr<Backend> bn) {
+bool nhwc_2_NC4HW4_2_nhwc_inttype(std::shared_ptr<Backend> bn, int batch = 1, int channel = 12, int width = 20, int height = 20) {
     // Test NHWC -> NC4HW4 -> NHWC
     MNN_PRINT("\n ========= check nhwc_2_NC4HW4_2_nhwc_inttype result ! ========= \n");
-    int batch   = 1;
-    int channel = 12;
-    int width   = 20;
-    int height  = 20;
     std::shared_ptr<Tensor> hostTensor(
         Tensor::create<T>(std::vector<int>{batch, channel, height, width}, nullptr, Tensor::CAFFE));
     auto elementSize = hostTensor->elementSize();
@@ -534,13 +530,9 @@ bool nhwc_2_NC4HW4_2_nhwc_inttype(std::shared_ptr<Backend> bn) {
     free(temp);
     return true;
 }
-bool nchwTonhwc(std::shared_ptr<Backend> bn) {
+bool nchwTonhwc(std::shared_ptr<Backend> bn, int batch = 2, int channel = 12, int width = 21, int height = 5) {
     // Test NHWC -> NC4HW4 -> NHWC
     MNN_PRINT("\n ========= check nchwTonhwc result ! ========= \n");
-    int batch   = 2;
-    int channel = 12;
-    int width   = 21;
-    int height  = 5;
     std::shared_ptr<Tensor> hostTensor(
         Tensor::create<float>(std::vector<int>{batch, channel, height, width}, nullptr, Tensor::CAFFE));
     auto elementSize = hostTensor->elementSize();
@@ -674,6 +666,11 @@ public:
                 FUNC_PRINT(res);
                 res = res && NCHW_NC4HW4_NCHW(bn, 5, 128, 8, 6);
                 FUNC_PRINT(res);
+                // Large enough to be converted by multi-thread
+                res = res && nchwTonhwc(bn, 2, 37, 61, 45);
+                FUNC_PRINT(res);
+                res = res && NCHW_NC4HW4_NCHW(bn, 2, 64, 80, 35);
+                FUNC_PRINT(res);
                 if (!res) {
                     MNN_ERROR("Error for %d bn\n", i);
                     return false;
@@ -704,6 +701,9 @@ public:
             res = res && nhwc_2_NC4HW4_2_nhwc_inttype<int32_t>(bn);
             res = res && nhwc_2_NC4HW4_2_nhwc_inttype<int16_t>(bn);
             res = res && nhwc_2_NC4HW4_2_nhwc_inttype<int8_t>(bn);
+            // Large enough to be converted by multi-thread
+            res = res && nhwc_2_NC4HW4_2_nhwc_inttype<int16_t>(bn, 1, 40, 96, 72);
+            res = res && nhwc_2_NC4HW4_2_nhwc_inttype<int8_t>(bn, 1, 40, 96, 72);
             if (!res) {
                 MNN_ERROR("Error for Int Copy\n");
                 return false;
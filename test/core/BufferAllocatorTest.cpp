@@ -9,6 +9,9 @@
 #include "MNNTestSuite.h"
 #include "core/BufferAllocator.hpp"
 #include "core/MNNMemoryUtils.h"
+#include <string.h>
+#include <thread>
+#include <vector>
 
 using namespace MNN;
 #ifndef _MSC_VER
@@ -56,4 +59,120 @@ public:
     }
 };
 MNNTestSuiteRegister(BufferAllocatorTest, "core/buffer_allocator");
+
+class BufferAllocatorPlanTest : public MNNTestCase {
+public:
+    virtual ~BufferAllocatorPlanTest() = default;
+    virtual bool run(int precision) {
+        BufferAllocator allocator(BufferAllocator::Allocator::createDefault());
+        std::pair<void*, size_t> a, b, c;
+        auto sequence = [&]() {
+            a = allocator.alloc(1000);
+            b = allocator.alloc(1000);
+            allocator.free(a);
+            allocator.free(b);
+            // Free list can't merge a and b, but planner can put c at the memory of a and b
+            c = allocator.alloc(2000);
+            allocator.free(c);
+        };
+        // record
+        allocator.beginPlan();
+        sequence();
+        auto greedySize = allocator.totalSize();
+        MNNTEST_ASSERT(allocator.endPlan());
+        MNNTEST_ASSERT(allocator.plannedSize() > 0 && allocator.plannedSize() < greedySize);
+
+        // replay
+        allocator.release();
+        allocator.beginPlan();
+        sequence();
+        MNNTEST_ASSERT(!allocator.endPlan());
+        MNNTEST_ASSERT(allocator.totalSize() == allocator.plannedSize());
+        MNNTEST_ASSERT(a.first == c.first && b.first == c.first);
+        MNNTEST_ASSERT(a.second != b.second);
+        MNNTEST_ASSERT(a.second % MNN_MEMORY_ALIGN_DEFAULT == 0 && b.second % MNN_MEMORY_ALIGN_DEFAULT == 0);
+
+        // Different sequence turns back to free list and drops the plan
+        allocator.release();
+        allocator.beginPlan();
+        a = allocator.alloc(3000);
+        b = allocator.alloc(1000);
+        MNNTEST_ASSERT(nullptr != a.first && nullptr != b.first);
+        MNNTEST_ASSERT(a.first != b.first || a.second + 3000 <= b.second || b.second + 1000 <= a.second);
+        allocator.free(a);
+        allocator.free(b);
+        MNNTEST_ASSERT(!allocator.endPlan());
+        MNNTEST_ASSERT(allocator.plannedSize() == 0);
+        return true;
+    }
+};
+MNNTestSuiteRegister(BufferAllocatorPlanTest, "core/buffer_allocator_plan");
+
+class ConcurrentAllocatorTest : public MNNTestCase {
+public:
+    virtual ~ConcurrentAllocatorTest() = default;
+    virtual bool run(int precision) {
+        auto alignment = MNN_MEMORY_ALIGN_DEFAULT;
+        std::shared_ptr<ConcurrentAllocator> pool(new ConcurrentAllocator);
+
+        // size class reuse
+        auto p1 = pool->onAlloc(1000, alignment);
+        MNNTEST_ASSERT((size_t)p1.first % alignment == 0);
+        auto total = pool->totalSize();
+        MNNTEST_ASSERT(total >= 1000 && total <= 1280);
+        pool->onRelease(p1);
+        MNNTEST_ASSERT(pool->cachedSize() == total);
+        auto p2 = pool->onAlloc(900, alignment);
+        MNNTEST_ASSERT(p1 == p2);
+        MNNTEST_ASSERT(pool->totalSize() == total);
+        MNNTEST_ASSERT(pool->cachedSize() == 0);
+        pool->onRelease(p2);
+        pool->release();
+        MNNTEST_ASSERT(pool->totalSize() == 0);
+
+        // Several sessions alloc / free from different threads with the same pool
+        const int threadNumber = 4;
+        std::vector<std::thread> threads;
+        std::vector<int> success(threadNumber, 1);
+        for (int t = 0; t < threadNumber; ++t) {
+            threads.emplace_back([&, t]() {
+                BufferAllocator allocator(pool);
+                for (int loop = 0; loop < 100; ++loop) {
+                    std::vector<std::pair<void*, size_t>> ptrs;
+                    for (int i = 1; i <= 8; ++i) {
+                        size_t size = 1024 * i * (t + 1);
+                        auto ptr = allocator.alloc(size, true);
+                        if (nullptr == ptr.first) {
+                            success[t] = 0;
+                            return;
+                        }
+                        // Each thread writes its own memory, the result should not be broken by others
+                        ::memset((uint8_t*)ptr.first + ptr.second, t, size);
+                        ptrs.emplace_back(ptr);
+                    }
+                    for (auto& ptr : ptrs) {
+                        auto data = (uint8_t*)ptr.first + ptr.second;
+                        if (data[0] != t || data[1023] != t) {
+                            success[t] = 0;
+                        }
+                        allocator.free(ptr);
+                    }
+                    allocator.release();
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (auto s : success) {
+            MNNTEST_ASSERT(s);
+        }
+        // All memory has been returned to pool
+        MNNTEST_ASSERT(pool->cachedSize() == pool->totalSize());
+        pool->release();
+        MNNTEST_ASSERT(pool->totalSize() == 0);
+        return true;
+    }
+};
+MNNTestSuiteRegister(ConcurrentAllocatorTest, "core/concurrent_allocator");
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+//
+//  ConvolutionTuningTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/24.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include <stdio.h>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+using namespace MNN;
+using namespace MNN::Express;
+
+static std::vector<float> _runSession(const uint8_t* buffer, size_t size, const char* cacheFile, int tuning, int& cacheSize) {
+    std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer, size), Interpreter::destroy);
+    net->setCacheFile(cacheFile);
+    net->setSessionHint(Interpreter::CPU_CONV_TUNING, tuning);
+    ScheduleConfig config;
+    config.type = MNN_FORWARD_CPU;
+    auto session = net->createSession(config);
+    auto input   = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> hostInput(new Tensor(input, Tensor::CAFFE));
+    for (int i = 0; i < hostInput->elementSize(); ++i) {
+        hostInput->host<float>()[i] = (float)(i % 19 - 9) / 9.0f;
+    }
+    input->copyFromHostTensor(hostInput.get());
+    net->runSession(session);
+    auto output = net->getSessionOutput(session, nullptr);
+    std::shared_ptr<Tensor> hostOutput(new Tensor(output, Tensor::CAFFE));
+    output->copyToHostTensor(hostOutput.get());
+    net->updateCacheFile(session);
+    FILE* f = fopen(cacheFile, "rb");
+    cacheSize = 0;
+    if (nullptr != f) {
+        fseek(f, 0, SEEK_END);
+        cacheSize = (int)ftell(f);
+        fclose(f);
+    }
+    return std::vector<float>(hostOutput->host<float>(), hostOutput->host<float>() + hostOutput->elementSize());
+}
+
+class ConvolutionTuningTest : public MNNTestCase {
+public:
+    virtual ~ConvolutionTuningTest() = default;
+    virtual bool run(int precision) {
+        // 3x3 can use winograd, 1x1 can use strassen, 5x5 stride 2 only dense
+        auto x = _Input({1, 8, 28, 28}, NCHW, halide_type_of<float>());
+        auto y = _Convert(x, NC4HW4);
+        std::vector<std::tuple<int, int, int, int>> convs = {{8, 16, 3, 1}, {16, 16, 1, 1}, {16, 8, 5, 2}};
+        for (auto& c : convs) {
+            int ic = std::get<0>(c), oc = std::get<1>(c), k = std::get<2>(c), s = std::get<3>(c);
+            std::vector<float> weight(oc * ic * k * k), bias(oc);
+            for (int i = 0; i < weight.size(); ++i) {
+                weight[i] = (float)(i % 13 - 6) / 13.0f;
+            }
+            for (int i = 0; i < bias.size(); ++i) {
+                bias[i] = (float)i / oc;
+            }
+            y = _Conv(std::move(weight), std::move(bias), y, {ic, oc}, {k, k}, SAME, {s, s}, {1, 1}, 1);
+        }
+        y = _Convert(y, NCHW);
+        std::unique_ptr<NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        flatbuffers::FlatBufferBuilder builder(1024);
+        builder.Finish(Net::Pack(builder, net.get()));
+
+        const char* cacheFile = ".convolution_tuning.cache";
+        ::remove(cacheFile);
+        int cacheSize = 0;
+        auto expect = _runSession(builder.GetBufferPointer(), builder.GetSize(), cacheFile, 0, cacheSize);
+        if (cacheSize != 0) {
+            MNN_ERROR("Cache shouldn't be written without tuning\n");
+            return false;
+        }
+        // Measure and write decisions, then load them without measuring
+        for (int tuning = 1; tuning >= 0; --tuning) {
+            auto result = _runSession(builder.GetBufferPointer(), builder.GetSize(), cacheFile, tuning, cacheSize);
+            if (cacheSize <= 0) {
+                MNN_ERROR("Tuning cache isn't written\n");
+                return false;
+            }
+            if (result.size() != expect.size()) {
+                return false;
+            }
+            // Different algorithms, such as winograd with large unit, don't give bitwise equal results
+            float maxValue = 1.0f;
+            for (auto v : expect) {
+                maxValue = fmaxf(maxValue, fabsf(v));
+            }
+            for (int i = 0; i < expect.size(); ++i) {
+                if (fabsf(result[i] - expect[i]) > 1e-2f * maxValue) {
+                    MNN_ERROR("ConvolutionTuningTest mismatch at %d: %f - %f, tuning = %d\n", i, result[i], expect[i], tuning);
+                    ::remove(cacheFile);
+                    return false;
+                }
+            }
+        }
+        ::remove(cacheFile);
+        return true;
+    }
+};
+MNNTestSuiteRegister(ConvolutionTuningTest, "core/convolution_tuning");
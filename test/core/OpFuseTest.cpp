@@ -0,0 +1,99 @@
+//
+//  OpFuseTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/04/14.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifdef MNN_CODEGEN_C
+#include <math.h>
+#include <map>
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+// Elementwise chain with an output in middle, the chain must be replaced by fused plugin ops and give the same result
+class OpFuseTest : public MNNTestCase {
+public:
+    virtual ~OpFuseTest() = default;
+    virtual bool run(int precision) {
+        // Abs, Sqrt, Mul, Add, Sigmoid, Square, Mul, Neg, Tanh, Max
+        const int elementwiseNumber = 10;
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        {
+            auto x = _Input({2, 3, 16, 16}, NCHW, halide_type_of<float>());
+            x->setName("x");
+            auto a = _Sqrt(_Abs(x)) * x + _Scalar<float>(0.5f);
+            a->setName("a");
+            auto b = _Maximum(_Sigmoid(a) * _Square(x), _Tanh(_Negative(x)));
+            b->setName("b");
+            std::unique_ptr<NetT> net(new NetT);
+            Variable::save({a, b}, net.get());
+            // a is consumed by b, name it as output to keep it
+            net->outputName = {"a", "b"};
+            auto len = Net::Pack(builderOutput, net.get());
+            builderOutput.Finish(len);
+        }
+        std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(builderOutput.GetBufferPointer(), builderOutput.GetSize()), Interpreter::destroy);
+        net->setSessionMode(Interpreter::Session_Debug);
+        ScheduleConfig config;
+        auto session = net->createSession(config);
+        auto input   = net->getSessionInput(session, "x");
+        std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        auto size = inputHost->elementSize();
+        auto ptr  = inputHost->host<float>();
+        std::vector<float> a(size), b(size);
+        for (int i = 0; i < size; ++i) {
+            auto v = (float)(i % 31 - 15) / 8.0f;
+            ptr[i] = v;
+            a[i]   = sqrtf(fabsf(v)) * v + 0.5f;
+            b[i]   = fmaxf(1.0f / (1.0f + expf(-a[i])) * v * v, tanhf(-v));
+        }
+        input->copyFromHostTensor(inputHost.get());
+        std::map<std::string, int> commandNumber;
+        MNN::TensorCallBackWithInfo before = [&](const std::vector<Tensor*>& tensors, const OperatorInfo* info) {
+            commandNumber[info->type()]++;
+            return true;
+        };
+        MNN::TensorCallBackWithInfo after = [](const std::vector<Tensor*>& tensors, const OperatorInfo* info) {
+            return true;
+        };
+        if (NO_ERROR != net->runSessionWithCallBackInfo(session, before, after)) {
+            MNN_ERROR("Run fused session failed\n");
+            return false;
+        }
+        int totalNumber = 0;
+        for (auto& iter : commandNumber) {
+            totalNumber += iter.second;
+        }
+        if (commandNumber["Plugin"] == 0 || totalNumber >= elementwiseNumber) {
+            MNN_ERROR("Elementwise chain is not fused, %d plugin in %d commands\n", commandNumber["Plugin"], totalNumber);
+            return false;
+        }
+        float error = (precision <= BackendConfig::Precision_High ? 1 : 100) * 0.0005f;
+        auto check = [&](const char* name, const std::vector<float>& expect) {
+            auto output = net->getSessionOutput(session, name);
+            std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+            output->copyToHostTensor(outputHost.get());
+            return checkVector(outputHost->host<float>(), expect.data(), size, error);
+        };
+        if (!check("a", a)) {
+            MNN_ERROR("Fused middle output error\n");
+            return false;
+        }
+        if (!check("b", b)) {
+            MNN_ERROR("Fused output error\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(OpFuseTest, "core/op_fuse");
+#endif
@@ -0,0 +1,96 @@
+//
+//  ParallelExecuteTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/04/16.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+// Inception like net, four branches from one input, the result must be the same as serial execution
+class ParallelExecuteTest : public MNNTestCase {
+public:
+    virtual ~ParallelExecuteTest() = default;
+    virtual bool run(int precision) {
+        const int ic = 16, oc = 16, size = 28;
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        {
+            auto conv = [&](VARP x, int kernel, int seed) {
+                std::vector<float> weight(oc * x->getInfo()->dim[1] * kernel * kernel), bias(oc);
+                for (int i = 0; i < weight.size(); ++i) {
+                    weight[i] = (float)((i * seed) % 19 - 9) / 90.0f;
+                }
+                for (int i = 0; i < oc; ++i) {
+                    bias[i] = (float)(i % 5) / 10.0f;
+                }
+                return _Conv(std::move(weight), std::move(bias), x, {x->getInfo()->dim[1], oc}, {kernel, kernel}, SAME);
+            };
+            auto x = _Input({1, ic, size, size}, NC4HW4, halide_type_of<float>());
+            x->setName("x");
+            auto b0 = _Relu(conv(x, 1, 3));
+            auto b1 = _Relu6(conv(_Relu(conv(x, 1, 5)), 3, 7));
+            auto b2 = _Sigmoid(conv(_Relu(conv(x, 1, 11)), 5, 13));
+            auto b3 = conv(_MaxPool(x, {3, 3}, {1, 1}, SAME), 1, 17);
+            auto y  = _Concat({b0, b1, b2, b3}, 1);
+            auto z  = _Tanh(conv(y, 1, 23)) + b0;
+            z->setName("z");
+            std::unique_ptr<NetT> net(new NetT);
+            Variable::save({z}, net.get());
+            auto len = Net::Pack(builderOutput, net.get());
+            builderOutput.Finish(len);
+        }
+        std::shared_ptr<Interpreter> interp(Interpreter::createFromBuffer(builderOutput.GetBufferPointer(), builderOutput.GetSize()), Interpreter::destroy);
+        std::vector<float> expect;
+        for (auto mode : {Interpreter::Session_Execute_Serial, Interpreter::Session_Execute_Parallel}) {
+            interp->setSessionMode(mode);
+            ScheduleConfig config;
+            config.numThread = 4;
+            auto session = interp->createSession(config);
+            // Run twice to check the memory of branches are not overlapped in resize again
+            for (int t = 0; t < 2; ++t) {
+                if (t > 0) {
+                    interp->resizeSession(session, 1);
+                }
+                auto input = interp->getSessionInput(session, nullptr);
+                std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+                auto ptr = inputHost->host<float>();
+                for (int i = 0; i < inputHost->elementSize(); ++i) {
+                    ptr[i] = (float)(i % 23 - 11) / 11.0f;
+                }
+                input->copyFromHostTensor(inputHost.get());
+                if (NO_ERROR != interp->runSession(session)) {
+                    MNN_ERROR("Run session failed for mode %d\n", mode);
+                    return false;
+                }
+                auto output = interp->getSessionOutput(session, "z");
+                std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+                output->copyToHostTensor(outputHost.get());
+                auto outPtr  = outputHost->host<float>();
+                auto outSize = outputHost->elementSize();
+                if (expect.empty()) {
+                    expect.assign(outPtr, outPtr + outSize);
+                    continue;
+                }
+                float error = precision <= BackendConfig::Precision_High ? 1e-4f : 1e-2f;
+                for (int i = 0; i < outSize; ++i) {
+                    if (fabsf(outPtr[i] - expect[i]) > error) {
+                        MNN_ERROR("Parallel execute error at %d: %f, correct=%f\n", i, outPtr[i], expect[i]);
+                        return false;
+                    }
+                }
+            }
+            interp->releaseSession(session);
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ParallelExecuteTest, "core/parallel_execute");
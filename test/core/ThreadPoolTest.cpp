@@ -8,6 +8,11 @@
 
 #ifdef MNN_USE_THREAD_POOL
 #include <MNN/MNNDefine.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
 #include "MNNTestSuite.h"
 #include "backend/cpu/ThreadPool.hpp"
 
@@ -38,7 +43,73 @@ public:
             t.join();
         }
         MNN::ThreadPool::destroy();
-        return true;
+
+        // More concurrent users than threads, every user should get valid work index and all work done once
+        MNN::ThreadPool::init(4);
+        std::atomic<bool> valid(true);
+        threads.clear();
+        for (int i = 0; i < 8; ++i) {
+            threads.emplace_back([i, &valid]() {
+                auto workIndex = ThreadPool::acquireWorkIndex();
+                if (workIndex < 0) {
+                    valid = false;
+                }
+                ThreadPool::active();
+                for (int loop = 0; loop < 10; ++loop) {
+                    const int size = 97 + 13 * i;
+                    std::vector<std::atomic_int> counts(size);
+                    for (auto& c : counts) {
+                        c = 0;
+                    }
+                    auto func = [&counts](int index) {
+                        // Uneven work
+                        if (index % 7 == 0) {
+                            std::this_thread::yield();
+                        }
+                        counts[index]++;
+                    };
+                    ThreadPool::enqueue(std::make_pair(std::move(func), size), workIndex);
+                    for (auto& c : counts) {
+                        if (c != 1) {
+                            valid = false;
+                        }
+                    }
+                }
+                ThreadPool::deactive();
+                ThreadPool::releaseWorkIndex(workIndex);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        MNN::ThreadPool::destroy();
+        if (!valid) {
+            MNN_ERROR("ThreadPool concurrent enqueue error\n");
+            return false;
+        }
+
+        // A job must not use more threads than the thread number of caller, even if the pool is larger
+        MNN::ThreadPool::init(4);
+        {
+            auto workIndex = ThreadPool::acquireWorkIndex();
+            ThreadPool::active();
+            std::mutex idMutex;
+            std::set<std::thread::id> ids;
+            auto func = [&idMutex, &ids](int index) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                std::lock_guard<std::mutex> _l(idMutex);
+                ids.insert(std::this_thread::get_id());
+            };
+            ThreadPool::enqueue(std::make_pair(std::move(func), 200), workIndex, 2);
+            ThreadPool::deactive();
+            ThreadPool::releaseWorkIndex(workIndex);
+            if (ids.size() > 2) {
+                MNN_ERROR("ThreadPool job uses %d threads, more than 2\n", (int)ids.size());
+                valid = false;
+            }
+        }
+        MNN::ThreadPool::destroy();
+        return valid;
     }
 };
 
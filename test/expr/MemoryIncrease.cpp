@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include <MNN/Interpreter.hpp>
 #include <MNN/expr/ExprCreator.hpp>
 #include <thread>
@@ -205,3 +206,79 @@ public:
     }
 };
 MNNTestSuiteRegister(MidOutputTest, "expr/MidOutputTest");
+
+class MemoryPlanTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 8, 32, 32}, NC4HW4);
+        auto makeConv = [](VARP x, int ic, int oc, int kernel, int seed) {
+            std::vector<float> weight(ic * oc * kernel * kernel);
+            std::vector<float> bias(oc);
+            for (int i = 0; i < weight.size(); ++i) {
+                weight[i] = (float)((i * seed) % 17 - 8) / 64.0f;
+            }
+            for (int i = 0; i < oc; ++i) {
+                bias[i] = (float)(i % 5) / 10.0f;
+            }
+            return _Conv(std::move(weight), std::move(bias), x, {ic, oc}, {kernel, kernel}, SAME);
+        };
+        auto y0 = makeConv(x, 8, 16, 3, 3);
+        auto y1 = makeConv(x, 8, 16, 1, 5);
+        auto y2 = _Relu(makeConv(y0, 16, 16, 3, 7));
+        auto y = _Concat({y1, y2, _Relu6(y0)}, 1);
+        y = makeConv(y, 48, 8, 3, 11);
+        y = _Convert(y, NCHW);
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        auto len = MNN::Net::Pack(builderOutput, net.get());
+        builderOutput.Finish(len);
+        std::shared_ptr<Interpreter> interp(Interpreter::createFromBuffer(builderOutput.GetBufferPointer(), builderOutput.GetSize()));
+        ScheduleConfig config;
+        config.type = MNN_FORWARD_CPU;
+        auto greedySession = interp->createSession(config);
+        interp->setSessionMode(Interpreter::Session_Memory_Plan);
+        auto planSession = interp->createSession(config);
+        auto compute = [&](Session* session, int size, std::vector<float>& result) {
+            auto input = interp->getSessionInput(session, nullptr);
+            interp->resizeTensor(input, {1, 8, size, size});
+            interp->resizeSession(session);
+            std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+            auto inputPtr = inputHost->host<float>();
+            for (int i = 0; i < inputHost->elementSize(); ++i) {
+                inputPtr[i] = (float)(i % 23) / 23.0f;
+            }
+            input->copyFromHostTensor(inputHost.get());
+            interp->runSession(session);
+            auto output = interp->getSessionOutput(session, nullptr);
+            std::shared_ptr<Tensor> outputHost(new Tensor(output, output->getDimensionType()));
+            output->copyToHostTensor(outputHost.get());
+            result.resize(outputHost->elementSize());
+            ::memcpy(result.data(), outputHost->host<float>(), result.size() * sizeof(float));
+        };
+        // The second resize of same shape uses the planned memory
+        std::vector<int> sizes = {32, 32, 17, 32};
+        for (auto size : sizes) {
+            std::vector<float> greedyResult, planResult;
+            compute(greedySession, size, greedyResult);
+            compute(planSession, size, planResult);
+            if (greedyResult.size() != planResult.size()) {
+                MNN_ERROR("Memory plan output size error\n");
+                return false;
+            }
+            for (int i = 0; i < greedyResult.size(); ++i) {
+                auto diff = fabsf(greedyResult[i] - planResult[i]);
+                if (diff > 0.001f) {
+                    MNN_ERROR("Memory plan result error for size %d: %f - %f\n", size, greedyResult[i], planResult[i]);
+                    return false;
+                }
+            }
+        }
+        float greedyMemory = 0.0f, planMemory = 0.0f;
+        interp->getSessionInfo(greedySession, Interpreter::MEMORY, &greedyMemory);
+        interp->getSessionInfo(planSession, Interpreter::MEMORY, &planMemory);
+        MNN_PRINT("Memory greedy: %f mb, plan: %f mb\n", greedyMemory, planMemory);
+        return true;
+    }
+};
+MNNTestSuiteRegister(MemoryPlanTest, "expr/MemoryPlanTest");
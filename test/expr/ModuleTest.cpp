@@ -7,7 +7,10 @@
 //
 
 #include <MNN/expr/Module.hpp>
+#include <MNN/expr/DynamicBatcher.hpp>
 #include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include <fstream>
 #include <thread>
 #include "MNNTestSuite.h"
 #include "core/Backend.hpp"
@@ -263,3 +266,511 @@ public:
     }
 };
 MNNTestSuiteRegister(SessionTest, "expr/SessionTest");
+
+class MmapLoadTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 3, 32, 32}, NCHW, halide_type_of<float>());
+        x->setName("Input");
+        std::vector<float> weight(8 * 3 * 3 * 3), bias(8);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 7 - 3) / 7.0f;
+        }
+        for (int i = 0; i < bias.size(); ++i) {
+            bias[i] = (float)i / 8.0f;
+        }
+        auto y = _Conv(std::move(weight), std::move(bias), x, {3, 8}, {3, 3}, SAME, {1, 1}, {1, 1}, 1);
+        y      = _Relu(y);
+        y->setName("Prob");
+        const char* fileName = "_mmap_load_test.mnn";
+        Variable::save({y}, fileName);
+        x = nullptr;
+        y = nullptr;
+        auto check = [](const std::vector<float>& a, const std::vector<float>& b) {
+            if (a.size() != b.size() || a.empty()) {
+                return false;
+            }
+            for (int i = 0; i < a.size(); ++i) {
+                if (fabsf(a[i] - b[i]) > 1e-5f) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::vector<float> results[2];
+        for (int useMmap = 0; useMmap < 2; ++useMmap) {
+            std::shared_ptr<Interpreter> net(Interpreter::createFromFile(fileName, useMmap == 1), Interpreter::destroy);
+            if (nullptr == net.get()) {
+                MNN_ERROR("Create interpreter failed, mmap = %d\n", useMmap);
+                return false;
+            }
+            ScheduleConfig config;
+            config.numThread = 1;
+            auto session = net->createSession(config);
+            net->releaseModel();
+            auto input = net->getSessionInput(session, nullptr);
+            for (int i = 0; i < input->elementSize(); ++i) {
+                input->host<float>()[i] = (float)(i % 17) / 17.0f;
+            }
+            net->runSession(session);
+            auto output = net->getSessionOutput(session, nullptr);
+            std::shared_ptr<Tensor> hostOutput(new Tensor(output, output->getDimensionType()));
+            output->copyToHostTensor(hostOutput.get());
+            results[useMmap].assign(hostOutput->host<float>(), hostOutput->host<float>() + hostOutput->elementSize());
+        }
+        if (!check(results[0], results[1])) {
+            MNN_ERROR("Interpreter mmap load result mismatch\n");
+            return false;
+        }
+        Module::Config mconfig;
+        mconfig.useMmap = true;
+        std::shared_ptr<Module> module(Module::load({"Input"}, {"Prob"}, fileName, &mconfig), Module::destroy);
+        if (nullptr == module.get()) {
+            MNN_ERROR("Module mmap load failed\n");
+            return false;
+        }
+        auto input = _Input({1, 3, 32, 32}, NCHW, halide_type_of<float>());
+        auto inputPtr = input->writeMap<float>();
+        for (int i = 0; i < 3 * 32 * 32; ++i) {
+            inputPtr[i] = (float)(i % 17) / 17.0f;
+        }
+        auto outputs = module->onForward({input});
+        if (outputs.size() != 1) {
+            return false;
+        }
+        auto output = _Convert(outputs[0], NCHW);
+        auto outputPtr = output->readMap<float>();
+        std::vector<float> moduleResult(outputPtr, outputPtr + output->getInfo()->size);
+        if (!check(results[0], moduleResult)) {
+            MNN_ERROR("Module mmap load result mismatch\n");
+            return false;
+        }
+        remove(fileName);
+        return true;
+    }
+};
+MNNTestSuiteRegister(MmapLoadTest, "expr/MmapLoadTest");
+
+class ExternalWeightTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 4, 16, 16}, NCHW, halide_type_of<float>());
+        x->setName("Input");
+        std::vector<float> weight(8 * 4 * 3 * 3), bias(8), dwWeight(8 * 3 * 3), dwBias(8);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 11 - 5) / 11.0f;
+        }
+        for (int i = 0; i < dwWeight.size(); ++i) {
+            dwWeight[i] = (float)(i % 5 - 2) / 5.0f;
+        }
+        for (int i = 0; i < bias.size(); ++i) {
+            bias[i]   = (float)i / 8.0f;
+            dwBias[i] = -(float)i / 8.0f;
+        }
+        auto y = _Conv(std::move(weight), std::move(bias), x, {4, 8}, {3, 3}, SAME, {1, 1}, {1, 1}, 1);
+        y      = _Conv(std::move(dwWeight), std::move(dwBias), y, {8, 8}, {3, 3}, SAME, {1, 1}, {1, 1}, 8);
+        y->setName("Prob");
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        x = nullptr;
+        y = nullptr;
+        auto pack = [](const MNN::NetT* netT) {
+            flatbuffers::FlatBufferBuilder builder(1024);
+            builder.Finish(MNN::Net::Pack(builder, netT));
+            return std::vector<uint8_t>(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+        };
+        auto run = [](Interpreter* interp) {
+            std::vector<float> result;
+            ScheduleConfig config;
+            config.numThread = 1;
+            auto session = interp->createSession(config);
+            auto input   = interp->getSessionInput(session, nullptr);
+            for (int i = 0; i < input->elementSize(); ++i) {
+                input->host<float>()[i] = (float)(i % 13) / 13.0f;
+            }
+            if (NO_ERROR != interp->runSession(session)) {
+                return result;
+            }
+            auto output = interp->getSessionOutput(session, nullptr);
+            std::shared_ptr<Tensor> hostOutput(new Tensor(output, output->getDimensionType()));
+            output->copyToHostTensor(hostOutput.get());
+            result.assign(hostOutput->host<float>(), hostOutput->host<float>() + hostOutput->elementSize());
+            return result;
+        };
+        auto inlineBuffer = pack(net.get());
+        std::shared_ptr<Interpreter> inlineNet(Interpreter::createFromBuffer(inlineBuffer.data(), inlineBuffer.size()), Interpreter::destroy);
+        auto expect = run(inlineNet.get());
+        if (expect.empty()) {
+            return false;
+        }
+        // Move convolution weights to external file, just as MNNConvert --saveExternalData
+        const char* modelName = "_external_weight_test.mnn";
+        std::string weightName = std::string(modelName) + ".weight";
+        {
+            std::ofstream output(weightName.c_str(), std::ofstream::binary);
+            int64_t offset = 0;
+            for (auto& op : net->oplists) {
+                if (op->type != OpType_Convolution && op->type != OpType_ConvolutionDepthwise) {
+                    continue;
+                }
+                auto conv = op->main.AsConvolution2D();
+                int64_t weightBytes = conv->weight.size() * sizeof(float);
+                int64_t biasBytes   = conv->bias.size() * sizeof(float);
+                output.write((const char*)conv->weight.data(), weightBytes);
+                output.write((const char*)conv->bias.data(), biasBytes);
+                conv->external = {offset, weightBytes, biasBytes};
+                offset += weightBytes + biasBytes;
+                conv->weight.clear();
+                conv->bias.clear();
+            }
+        }
+        {
+            auto externalBuffer = pack(net.get());
+            std::ofstream output(modelName, std::ofstream::binary);
+            output.write((const char*)externalBuffer.data(), externalBuffer.size());
+        }
+        std::shared_ptr<Interpreter> externalNet(Interpreter::createFromFile(modelName), Interpreter::destroy);
+        auto result = run(externalNet.get());
+        // Module::load also defaults to the weight file beside the model
+        std::vector<float> moduleResult;
+        {
+            std::shared_ptr<Module> module(Module::load({"Input"}, {"Prob"}, modelName), Module::destroy);
+            if (nullptr != module) {
+                auto input = _Input({1, 4, 16, 16}, NCHW, halide_type_of<float>());
+                auto inputPtr = input->writeMap<float>();
+                for (int i = 0; i < input->getInfo()->size; ++i) {
+                    inputPtr[i] = (float)(i % 13) / 13.0f;
+                }
+                auto output = _Convert(module->onForward({input})[0], NCHW);
+                auto outputPtr = output->readMap<float>();
+                if (nullptr != outputPtr) {
+                    moduleResult.assign(outputPtr, outputPtr + output->getInfo()->size);
+                }
+            }
+        }
+        remove(modelName);
+        remove(weightName.c_str());
+        if (result.size() != expect.size() || moduleResult.size() != expect.size()) {
+            MNN_ERROR("External weight model output size mismatch\n");
+            return false;
+        }
+        for (int i = 0; i < result.size(); ++i) {
+            if (fabsf(result[i] - expect[i]) > 1e-4f || fabsf(moduleResult[i] - expect[i]) > 1e-4f) {
+                MNN_ERROR("External weight model result mismatch at %d: %f, %f - %f\n", i, result[i], moduleResult[i], expect[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ExternalWeightTest, "expr/ExternalWeightTest");
+
+class KVCacheTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        const int heads = 2, dim = 16, valueDim = 8, totalLength = 140;
+        auto q    = _Input({1, heads, 1, dim}, NCHW, halide_type_of<float>());
+        auto k    = _Input({1, heads, 1, dim}, NCHW, halide_type_of<float>());
+        auto v    = _Input({1, heads, 1, valueDim}, NCHW, halide_type_of<float>());
+        auto mask = _Input({1, 1, 1, 1}, NCHW, halide_type_of<float>());
+        q->setName("q");
+        k->setName("k");
+        v->setName("v");
+        mask->setName("mask");
+        auto o = _Attention(q, k, v, mask, 0.0f, true);
+        o->setName("o");
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({o}, net.get());
+        q = nullptr;
+        k = nullptr;
+        v = nullptr;
+        mask = nullptr;
+        o = nullptr;
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        builderOutput.Finish(MNN::Net::Pack(builderOutput, net.get()));
+
+        // Token data of each head: [heads, totalLength, dim]
+        std::vector<float> queryData(heads * totalLength * dim), keyData(heads * totalLength * dim), valueData(heads * totalLength * valueDim);
+        for (int i = 0; i < queryData.size(); ++i) {
+            queryData[i] = sinf(i * 0.37f);
+            keyData[i]   = cosf(i * 0.21f);
+        }
+        for (int i = 0; i < valueData.size(); ++i) {
+            valueData[i] = sinf(i * 0.13f + 1.0f);
+        }
+        // Causal attention of query at pos over key [0, pos]
+        auto reference = [&](int h, int pos, float* dst) {
+            std::vector<float> score(pos + 1);
+            float maxValue = -1e30f;
+            for (int s = 0; s <= pos; ++s) {
+                float sum = 0.0f;
+                for (int d = 0; d < dim; ++d) {
+                    sum += queryData[(h * totalLength + pos) * dim + d] * keyData[(h * totalLength + s) * dim + d];
+                }
+                score[s] = sum / sqrtf((float)dim);
+                maxValue = fmaxf(maxValue, score[s]);
+            }
+            float sumValue = 0.0f;
+            for (int s = 0; s <= pos; ++s) {
+                score[s] = expf(score[s] - maxValue);
+                sumValue += score[s];
+            }
+            for (int d = 0; d < valueDim; ++d) {
+                dst[d] = 0.0f;
+                for (int s = 0; s <= pos; ++s) {
+                    dst[d] += score[s] / sumValue * valueData[(h * totalLength + s) * valueDim + d];
+                }
+            }
+        };
+        // Feed tokens [start, start + length) and check output
+        auto step = [&](Module* module, int start, int length) {
+            auto query = _Input({1, heads, length, dim}, NCHW, halide_type_of<float>());
+            auto key   = _Input({1, heads, length, dim}, NCHW, halide_type_of<float>());
+            auto value = _Input({1, heads, length, valueDim}, NCHW, halide_type_of<float>());
+            auto causal = _Input({1, 1, length, length}, NCHW, halide_type_of<float>());
+            auto queryPtr = query->writeMap<float>();
+            auto keyPtr   = key->writeMap<float>();
+            auto valuePtr = value->writeMap<float>();
+            for (int h = 0; h < heads; ++h) {
+                ::memcpy(queryPtr + h * length * dim, queryData.data() + (h * totalLength + start) * dim, length * dim * sizeof(float));
+                ::memcpy(keyPtr + h * length * dim, keyData.data() + (h * totalLength + start) * dim, length * dim * sizeof(float));
+                ::memcpy(valuePtr + h * length * valueDim, valueData.data() + (h * totalLength + start) * valueDim, length * valueDim * sizeof(float));
+            }
+            auto maskPtr = causal->writeMap<float>();
+            for (int i = 0; i < length; ++i) {
+                for (int j = 0; j < length; ++j) {
+                    maskPtr[i * length + j] = j > i ? -10000.0f : 0.0f;
+                }
+            }
+            auto outputs = module->onForward({query, key, value, causal});
+            if (outputs.size() != 1) {
+                return false;
+            }
+            auto outputPtr = outputs[0]->readMap<float>();
+            std::vector<float> expect(valueDim);
+            for (int h = 0; h < heads; ++h) {
+                for (int i = 0; i < length; ++i) {
+                    reference(h, start + i, expect.data());
+                    for (int d = 0; d < valueDim; ++d) {
+                        auto result = outputPtr[(h * length + i) * valueDim + d];
+                        if (fabsf(result - expect[d]) > 1e-3f) {
+                            MNN_ERROR("KVCacheTest mismatch at token %d: %f - %f\n", start + i, result, expect[d]);
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        };
+        // limit and shapeCacheSize
+        std::vector<std::pair<int, int>> configs = {{0, 0}, {totalLength, 0}, {0, 2}};
+        for (auto& c : configs) {
+            int limit = c.first;
+            MNN::ScheduleConfig sconfig;
+            sconfig.numThread = 2;
+            std::shared_ptr<Executor::RuntimeManager> rtMgr(Executor::RuntimeManager::createRuntimeManager(sconfig), Executor::RuntimeManager::destroy);
+            rtMgr->setHint(Interpreter::KVCACHE_SIZE_LIMIT, limit);
+            // The kv cache should be shared by the sessions for prefill and decode
+            Module::Config mconfig;
+            mconfig.shapeCacheSize = c.second;
+            std::shared_ptr<Module> module(Module::load({"q", "k", "v", "mask"}, {"o"}, builderOutput.GetBufferPointer(), builderOutput.GetSize(), rtMgr, &mconfig), Module::destroy);
+            // Prefill then decode one token each step, cross the boundary of cache unit
+            if (!step(module.get(), 0, 125)) {
+                return false;
+            }
+            for (int pos = 125; pos < totalLength; ++pos) {
+                if (!step(module.get(), pos, 1)) {
+                    MNN_ERROR("KVCacheTest decode failed at %d, limit = %d\n", pos, limit);
+                    return false;
+                }
+            }
+            if (limit > 0) {
+                MNN_PRINT("Expect kv cache exceed error:\n");
+                if (step(module.get(), totalLength - 1, 1)) {
+                    return false;
+                }
+            }
+            // Start a new sequence
+            module->clearCache();
+            if (!step(module.get(), 0, 3) || !step(module.get(), 3, 1)) {
+                MNN_ERROR("KVCacheTest failed after clear cache, limit = %d\n", limit);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(KVCacheTest, "expr/KVCacheTest");
+
+class ShapeCacheTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 3, 16, 16}, NCHW, halide_type_of<float>());
+        x->setName("Input");
+        std::vector<float> weight(8 * 3 * 3 * 3), bias(8);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 9 - 4) / 9.0f;
+        }
+        for (int i = 0; i < bias.size(); ++i) {
+            bias[i] = (float)i / 8.0f;
+        }
+        auto y = _Conv(std::move(weight), std::move(bias), x, {3, 8}, {3, 3}, SAME, {2, 2}, {1, 1}, 1);
+        y      = _Relu(y);
+        y      = _Convert(y, NCHW);
+        y->setName("Prob");
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        x = nullptr;
+        y = nullptr;
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        builderOutput.Finish(MNN::Net::Pack(builderOutput, net.get()));
+        Module::Config config;
+        std::shared_ptr<Module> expectModule(Module::load({"Input"}, {"Prob"}, builderOutput.GetBufferPointer(), builderOutput.GetSize(), &config), Module::destroy);
+        config.shapeCacheSize = 2;
+        std::shared_ptr<Module> module(Module::load({"Input"}, {"Prob"}, builderOutput.GetBufferPointer(), builderOutput.GetSize(), &config), Module::destroy);
+        // Switch between shapes, the third one evicts the least recently used one
+        std::vector<std::pair<int, int>> shapes = {{16, 16}, {24, 20}, {16, 16}, {24, 20}, {8, 8}, {16, 16}, {8, 8}};
+        for (int n = 0; n < shapes.size(); ++n) {
+            auto h = shapes[n].first, w = shapes[n].second;
+            auto input = _Input({1, 3, h, w}, NCHW, halide_type_of<float>());
+            auto inputPtr = input->writeMap<float>();
+            for (int i = 0; i < 3 * h * w; ++i) {
+                inputPtr[i] = (float)((i + n) % 13) / 13.0f;
+            }
+            auto expect = expectModule->onForward({input});
+            auto result = module->onForward({input});
+            if (expect.size() != 1 || result.size() != 1) {
+                return false;
+            }
+            auto size = expect[0]->getInfo()->size;
+            if (result[0]->getInfo()->size != size) {
+                MNN_ERROR("ShapeCacheTest output size mismatch for %d x %d\n", h, w);
+                return false;
+            }
+            auto expectPtr = expect[0]->readMap<float>();
+            auto resultPtr = result[0]->readMap<float>();
+            for (int i = 0; i < size; ++i) {
+                if (fabsf(expectPtr[i] - resultPtr[i]) > 1e-5f) {
+                    MNN_ERROR("ShapeCacheTest mismatch for %d x %d at %d: %f - %f\n", h, w, i, resultPtr[i], expectPtr[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ShapeCacheTest, "expr/ShapeCacheTest");
+
+class DynamicBatcherTest : public MNNTestCase {
+public:
+    virtual bool run(int precision) {
+        auto x = _Input({1, 3, 8, 8}, NCHW, halide_type_of<float>());
+        x->setName("Input");
+        std::vector<float> weight(4 * 3 * 3 * 3), bias(4);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 7 - 3) / 7.0f;
+        }
+        for (int i = 0; i < bias.size(); ++i) {
+            bias[i] = (float)i / 4.0f;
+        }
+        auto y = _Conv(std::move(weight), std::move(bias), x, {3, 4}, {3, 3}, SAME, {1, 1}, {1, 1}, 1);
+        y      = _Relu(y);
+        y->setName("Prob");
+        std::unique_ptr<MNN::NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        x = nullptr;
+        y = nullptr;
+        flatbuffers::FlatBufferBuilder builderOutput(1024);
+        builderOutput.Finish(MNN::Net::Pack(builderOutput, net.get()));
+        std::shared_ptr<Module> module(Module::load({"Input"}, {"Prob"}, builderOutput.GetBufferPointer(), builderOutput.GetSize()), Module::destroy);
+
+        // Batch of each request, the last one is larger than maxBatch and runs alone
+        const std::vector<int> batches = {1, 2, 1, 3, 1, 1, 2, 6};
+        const int clientNumber = 4;
+        const int inputSize = 3 * 8 * 8;
+        auto makeInput = [&](int client, int index) {
+            auto input = _Input({batches[index], 3, 8, 8}, NCHW, halide_type_of<float>());
+            auto ptr = input->writeMap<float>();
+            for (int i = 0; i < batches[index] * inputSize; ++i) {
+                ptr[i] = (float)((i * 3 + client * 5 + index) % 17) / 17.0f;
+            }
+            return input;
+        };
+        std::vector<std::vector<std::vector<float>>> expects(clientNumber);
+        for (int c = 0; c < clientNumber; ++c) {
+            for (int n = 0; n < batches.size(); ++n) {
+                auto output = _Convert(module->onForward({makeInput(c, n)})[0], NCHW);
+                auto info = output->getInfo();
+                auto ptr = output->readMap<float>();
+                expects[c].emplace_back(std::vector<float>(ptr, ptr + info->size));
+            }
+        }
+        DynamicBatcher::Config config;
+        config.maxBatch = 4;
+        config.maxDelayUs = 2000;
+        config.workerNumber = 2;
+        std::shared_ptr<DynamicBatcher> batcher(DynamicBatcher::create(module, config), DynamicBatcher::destroy);
+        if (nullptr == batcher) {
+            return false;
+        }
+        auto check = [&](const std::vector<VARP>& outputs, int client, int index) {
+            if (outputs.size() != 1) {
+                return false;
+            }
+            auto info = outputs[0]->getInfo();
+            auto& expect = expects[client][index];
+            if (nullptr == info || info->dim[0] != batches[index] || info->size != expect.size()) {
+                return false;
+            }
+            auto ptr = _Convert(outputs[0], NCHW)->readMap<float>();
+            for (int i = 0; i < expect.size(); ++i) {
+                if (fabsf(ptr[i] - expect[i]) > 1e-5f) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::vector<int> success(clientNumber, 0);
+        std::vector<std::thread> clients;
+        for (int c = 0; c < clientNumber; ++c) {
+            clients.emplace_back([&, c]() {
+                auto exe = Executor::newExecutor(MNN_FORWARD_CPU, BackendConfig(), 1);
+                ExecutorScope scope(exe);
+                std::vector<std::future<std::vector<VARP>>> futures;
+                for (int n = 0; n < batches.size(); ++n) {
+                    futures.emplace_back(batcher->forward({makeInput(c, n)}));
+                }
+                int count = 0;
+                for (int n = 0; n < batches.size(); ++n) {
+                    if (check(futures[n].get(), c, n)) {
+                        count++;
+                    }
+                }
+                success[c] = count;
+            });
+        }
+        for (auto& t : clients) {
+            t.join();
+        }
+        for (int c = 0; c < clientNumber; ++c) {
+            if (success[c] != batches.size()) {
+                MNN_ERROR("DynamicBatcherTest client %d: %d / %d requests correct\n", c, success[c], (int)batches.size());
+                return false;
+            }
+        }
+        // Requests with different shape can't be merged, but still work
+        bool callbackResult = false;
+        auto input = _Input({1, 3, 6, 6}, NCHW, halide_type_of<float>());
+        ::memset(input->writeMap<float>(), 0, 3 * 6 * 6 * sizeof(float));
+        batcher->forward({input}, [&callbackResult](std::vector<VARP> outputs) {
+            callbackResult = outputs.size() == 1 && outputs[0]->getInfo()->dim == std::vector<int>({1, 4, 6, 6});
+        });
+        batcher.reset();
+        if (!callbackResult) {
+            MNN_ERROR("DynamicBatcherTest callback failed\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(DynamicBatcherTest, "expr/DynamicBatcherTest");
@@ -0,0 +1,161 @@
+//
+//  TraceCacheTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/04/17.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Executor.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+#include "Utils.hpp"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+// y = relu(x * w + b, slope), w and b are constant
+static VARP _buildGraph(VARP x, const std::vector<float>& w, int ic, int oc, float slope = 0.0f) {
+    std::vector<float> bias(oc);
+    for (int i = 0; i < oc; ++i) {
+        bias[i] = (float)(i % 3) / 4.0f;
+    }
+    auto weight = _Const(w.data(), {ic, oc}, NCHW);
+    return _Relu(_MatMul(x, weight) + _Const(bias.data(), {oc}, NCHW), slope);
+}
+
+// The backend of compiled cache, the same object means the cache is reused
+static std::shared_ptr<Backend> _cacheBackend(VARP y) {
+    auto cache = y->expr().first->inside()->mCache;
+    if (nullptr == cache) {
+        return nullptr;
+    }
+    return Executor::getBackends(cache.get()).first;
+}
+
+// The same graph is built repeatedly with different input, the compiled cache of released graph is reused
+class TraceCacheTest : public MNNTestCase {
+public:
+    virtual ~TraceCacheTest() = default;
+    virtual bool run(int precision) {
+        auto executor = ExecutorScope::Current();
+        executor->setTraceCacheSize(8);
+        bool res = _run();
+        executor->setTraceCacheSize(0);
+        executor->gc(Executor::FULL);
+        return res;
+    }
+
+private:
+    bool _run() {
+        const int ic = 16, oc = 8;
+        std::vector<float> w(ic * oc);
+        for (int i = 0; i < w.size(); ++i) {
+            w[i] = (float)(i % 7 - 3) / 8.0f;
+        }
+        auto check = [&](VARP y, VARP x, int batch, const std::vector<float>& weight, int index, float slope = 0.0f) {
+            auto xPtr = x->readMap<float>();
+            auto yPtr = y->readMap<float>();
+            if (nullptr == yPtr) {
+                MNN_ERROR("Trace cache compute failed at %d\n", index);
+                return false;
+            }
+            for (int b = 0; b < batch; ++b) {
+                for (int o = 0; o < oc; ++o) {
+                    float sum = (float)(o % 3) / 4.0f;
+                    for (int i = 0; i < ic; ++i) {
+                        sum += xPtr[b * ic + i] * weight[i * oc + o];
+                    }
+                    sum = sum > 0.0f ? sum : sum * slope;
+                    if (fabsf(yPtr[b * oc + o] - sum) > 0.01f) {
+                        MNN_ERROR("Trace cache error at %d: %f, correct=%f\n", index, yPtr[b * oc + o], sum);
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+        auto makeInput = [&](int batch, int seed) {
+            auto x   = _Input({batch, ic}, NCHW);
+            auto ptr = x->writeMap<float>();
+            for (int i = 0; i < batch * ic; ++i) {
+                ptr[i] = (float)((i * seed) % 11 - 5) / 5.0f;
+            }
+            return x;
+        };
+        // Hold the backend of first graph, so that a new backend can't have the same address
+        std::shared_ptr<Backend> firstBackend;
+        for (int t = 0; t < 6; ++t) {
+            // Batch changed in the middle, and the released graph of the old batch is reused after it
+            int batch = (t == 3) ? 6 : 4;
+            auto x    = makeInput(batch, t + 3);
+            auto y    = _buildGraph(x, w, ic, oc);
+            if (!check(y, x, batch, w, t)) {
+                return false;
+            }
+            auto backend = _cacheBackend(y);
+            if (nullptr == backend) {
+                MNN_ERROR("Trace cache has no compiled cache at %d\n", t);
+                return false;
+            }
+            if (0 == t) {
+                firstBackend = backend;
+            } else if (3 != t && backend != firstBackend) {
+                MNN_ERROR("Trace cache is not reused at %d\n", t);
+                return false;
+            }
+        }
+        {
+            // Different constant can't reuse the cache
+            auto w2 = w;
+            w2[0] += 1.0f;
+            auto x = makeInput(4, 7);
+            auto y = _buildGraph(x, w2, ic, oc);
+            if (!check(y, x, 4, w2, 6)) {
+                return false;
+            }
+            if (_cacheBackend(y) == firstBackend) {
+                MNN_ERROR("Trace cache is reused by graph with different constant\n");
+                return false;
+            }
+        }
+        {
+            // Different attribute of op can't reuse the cache
+            auto x = makeInput(4, 7);
+            auto y = _buildGraph(x, w, ic, oc, 0.25f);
+            if (!check(y, x, 4, w, 7, 0.25f)) {
+                return false;
+            }
+            if (_cacheBackend(y) == firstBackend) {
+                MNN_ERROR("Trace cache is reused by graph with different attribute\n");
+                return false;
+            }
+        }
+        {
+            // Two alive graphs of the same structure, and the input changed after compute
+            auto x0 = makeInput(4, 5);
+            auto x1 = makeInput(4, 9);
+            auto y0 = _buildGraph(x0, w, ic, oc);
+            auto y1 = _buildGraph(x1, w, ic, oc);
+            if (!check(y0, x0, 4, w, 8) || !check(y1, x1, 4, w, 9)) {
+                return false;
+            }
+            if (_cacheBackend(y0) == _cacheBackend(y1)) {
+                MNN_ERROR("Trace cache is shared by two alive graphs\n");
+                return false;
+            }
+            auto ptr = x0->writeMap<float>();
+            for (int i = 0; i < 4 * ic; ++i) {
+                ptr[i] = (float)(i % 5) / 5.0f;
+            }
+            if (!check(y0, x0, 4, w, 10) || !check(y1, x1, 4, w, 11)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(TraceCacheTest, "expr/TraceCache");
@@ -0,0 +1,80 @@
+//
+//  OptimizerTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/04/12.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Module.hpp>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+#include "../tools/train/source/optimizer/SGD.hpp"
+#include "../tools/train/source/optimizer/ADAM.hpp"
+
+using namespace MNN;
+using namespace MNN::Express;
+using namespace MNN::Train;
+
+// loss = sum(w * x), so grad of w is x
+class OptimizerTest : public MNNTestCase {
+public:
+    virtual ~OptimizerTest() = default;
+    virtual bool run(int precision) {
+        // Large enough to be updated by multi-thread
+        const int size      = 40000;
+        const int stepCount = 3;
+        const float lr = 0.1f, momentum = 0.9f, momentum2 = 0.99f, weightDecay = 0.01f, eps = 1e-8f;
+        std::vector<float> w(size), x(size);
+        for (int i = 0; i < size; ++i) {
+            w[i] = (float)(i % 17 - 8) / 10.0f;
+            x[i] = (float)(i % 13 - 6) / 10.0f;
+        }
+        for (int isAdam = 0; isAdam < 2; ++isAdam) {
+            auto weight = _TrainableParam(w.data(), {size}, NCHW);
+            std::shared_ptr<Module> module(Module::createEmpty({weight}));
+            std::shared_ptr<ParameterOptimizer> opt;
+            if (isAdam) {
+                opt.reset(ParameterOptimizer::createADAM(module, lr, momentum, momentum2, weightDecay, eps, ParameterOptimizer::L2));
+            } else {
+                opt.reset(ParameterOptimizer::createSGD(module, lr, momentum, weightDecay, ParameterOptimizer::L1L2));
+            }
+            std::vector<float> expect = w, m(size, 0.0f), v(size, 0.0f);
+            for (int s = 1; s <= stepCount; ++s) {
+                auto input = _Const(x.data(), {size}, NCHW);
+                auto loss  = _ReduceSum(weight * input, {});
+                if (!opt->step(loss)) {
+                    MNN_ERROR("Optimizer step failed\n");
+                    return false;
+                }
+                for (int i = 0; i < size; ++i) {
+                    auto p = expect[i];
+                    if (isAdam) {
+                        auto g     = x[i] + weightDecay * p;
+                        m[i]       = momentum * m[i] + (1.0f - momentum) * g;
+                        v[i]       = momentum2 * v[i] + (1.0f - momentum2) * g * g;
+                        auto scale = lr * sqrtf(1.0f - powf(momentum2, s)) / (1.0f - powf(momentum, s));
+                        expect[i]  = p - scale * m[i] / (sqrtf(v[i]) + eps);
+                    } else {
+                        auto sign = p > 0.0f ? 1.0f : (p < 0.0f ? -1.0f : 0.0f);
+                        auto g    = x[i] + weightDecay * (sign + p);
+                        m[i]      = lr * g + momentum * m[i];
+                        expect[i] = p - m[i];
+                    }
+                }
+            }
+            auto ptr = weight->readMap<float>();
+            for (int i = 0; i < size; ++i) {
+                if (fabsf(ptr[i] - expect[i]) > 1e-4f) {
+                    MNN_ERROR("%s error at %d: %f, correct=%f\n", isAdam ? "ADAM" : "SGD", i, ptr[i], expect[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(OptimizerTest, "grad/optimizer");
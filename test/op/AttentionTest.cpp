@@ -0,0 +1,122 @@
+//
+//  AttentionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <math.h>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static std::vector<float> _referenceAttention(const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+                                              const float* mask, int maskBatch, int batch, int L, int S, int D, int Dv, float scale) {
+    std::vector<float> output(batch * L * Dv, 0.0f);
+    std::vector<float> score(S);
+    for (int b = 0; b < batch; ++b) {
+        for (int l = 0; l < L; ++l) {
+            float maxValue = -1e30f;
+            for (int s = 0; s < S; ++s) {
+                float sum = 0.0f;
+                for (int d = 0; d < D; ++d) {
+                    sum += q[(b * L + l) * D + d] * k[(b * S + s) * D + d];
+                }
+                score[s] = sum * scale;
+                if (nullptr != mask) {
+                    score[s] += mask[((b % maskBatch) * L + l) * S + s];
+                }
+                maxValue = fmaxf(maxValue, score[s]);
+            }
+            float sumValue = 0.0f;
+            for (int s = 0; s < S; ++s) {
+                score[s] = expf(score[s] - maxValue);
+                sumValue += score[s];
+            }
+            for (int s = 0; s < S; ++s) {
+                for (int d = 0; d < Dv; ++d) {
+                    output[(b * L + l) * Dv + d] += score[s] / sumValue * v[(b * S + s) * Dv + d];
+                }
+            }
+        }
+    }
+    return output;
+}
+
+class AttentionTest : public MNNTestCase {
+public:
+    virtual ~AttentionTest() = default;
+    bool test(int batch, int heads, int L, int S, int D, int Dv, bool useMask, float scale) {
+        const int number = batch * heads;
+        std::vector<float> q(number * L * D), k(number * S * D), v(number * S * Dv), mask;
+        for (int i = 0; i < q.size(); ++i) {
+            q[i] = (float)((i * 7) % 23 - 11) / 11.0f;
+        }
+        for (int i = 0; i < k.size(); ++i) {
+            k[i] = (float)((i * 5) % 19 - 9) / 9.0f;
+        }
+        for (int i = 0; i < v.size(); ++i) {
+            v[i] = (float)((i * 3) % 17 - 8) / 8.0f;
+        }
+        VARP maskVar;
+        if (useMask) {
+            // Causal mask for each batch, broadcast to heads
+            mask.resize(batch * L * S);
+            for (int b = 0; b < batch; ++b) {
+                for (int l = 0; l < L; ++l) {
+                    for (int s = 0; s < S; ++s) {
+                        mask[(b * L + l) * S + s] = (s > l + S - L + b) ? -10000.0f : 0.0f;
+                    }
+                }
+            }
+            maskVar = _Const(mask.data(), {batch, 1, L, S}, NCHW);
+        }
+        float realScale = scale != 0.0f ? scale : 1.0f / sqrtf((float)D);
+        // mask batch index is b / heads in reference
+        std::vector<float> expected;
+        {
+            std::vector<float> expandMask;
+            if (useMask) {
+                expandMask.resize(number * L * S);
+                for (int n = 0; n < number; ++n) {
+                    ::memcpy(expandMask.data() + n * L * S, mask.data() + (n / heads) * L * S, L * S * sizeof(float));
+                }
+            }
+            expected = _referenceAttention(q, k, v, useMask ? expandMask.data() : nullptr, number, number, L, S, D, Dv, realScale);
+        }
+        auto query = _Const(q.data(), {batch, heads, L, D}, NCHW);
+        auto key   = _Const(k.data(), {batch, heads, S, D}, NCHW);
+        auto value = _Const(v.data(), {batch, heads, S, Dv}, NCHW);
+        auto output = _Attention(query, key, value, maskVar, scale);
+        auto info = output->getInfo();
+        if (nullptr == info || info->dim != std::vector<int>({batch, heads, L, Dv})) {
+            MNN_ERROR("AttentionTest shape error for L=%d, S=%d\n", L, S);
+            return false;
+        }
+        auto ptr = output->readMap<float>();
+        if (!checkVectorByRelativeError<float>(ptr, expected.data(), (int)expected.size(), 0.01f)) {
+            MNN_ERROR("AttentionTest failed for L=%d, S=%d, D=%d, mask=%d\n", L, S, D, useMask);
+            return false;
+        }
+        return true;
+    }
+    virtual bool run(int precision) {
+        // Single query, sequence shorter than one unit
+        if (!test(1, 2, 1, 7, 16, 16, false, 0.0f)) {
+            return false;
+        }
+        // Query not aligned to tile, key cross several units
+        if (!test(2, 3, 37, 300, 20, 12, true, 0.0f)) {
+            return false;
+        }
+        if (!test(1, 1, 64, 129, 32, 32, false, 0.25f)) {
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(AttentionTest, "op/attention");
@@ -19,6 +19,7 @@
 #include "core/TensorUtils.hpp"
 #include "common/MemoryFormater.h"
 #include "common/CommonCompute.hpp"
+#include "cpp/IDSTEncoder.hpp"
 
 #define TEST_RANDOM_SEED 100
 
@@ -737,6 +738,22 @@ protected:
         bool succ = ConvolutionCommonTest().test(
             type, device_name, "GroupConv2D", 2, 8, 16, 1, 1, PadMode_CAFFE,
             0, 0, 1, 1, 1, 1, 2, precision, MNN::SparseAlgo_RANDOM, 1, false);
+        if (!succ) {
+            return false;
+        }
+        // Channels of one group may be not aligned to pack: batch, ic, oc, size, kernel, stride, pad, group
+        std::vector<std::vector<int>> cases = {
+            {1, 12, 18, 7, 3, 1, 1, 3}, {2, 30, 20, 9, 3, 2, 1, 10}, {1, 64, 64, 6, 3, 1, 1, 32}, {1, 6, 10, 5, 1, 1, 0, 2}
+        };
+        for (auto& c : cases) {
+            succ = ConvolutionCommonTest().test(type, device_name, "GroupConv2D", c[0], c[1], c[2], c[3], c[3], PadMode_CAFFE,
+                                                c[6], c[6], c[4], c[4], c[5], 1, c[7], precision, MNN::SparseAlgo_RANDOM, 1, false);
+            if (!succ) {
+                MNN_PRINT("convolution group b=%d, ic=%d, oc=%d, is=%d, k=%d, s=%d, p=%d, g=%d\n", c[0], c[1], c[2], c[3], c[4],
+                          c[5], c[6], c[7]);
+                return false;
+            }
+        }
         return succ;
         for (int b = 1; b <= 2; b++) {
             for (int g = 2; g <= 4; g *= 2) {
@@ -781,8 +798,119 @@ public:
     }
 };
 
+// Weight-only quantized convolution keeps int8 / int4 weight in low memory mode, compare it with the float weight one
+class WeightQuantConvolutionTest : public MNNTestCase {
+public:
+    virtual ~WeightQuantConvolutionTest() = default;
+    static std::vector<float> _run(const uint8_t* buffer, size_t size, const std::vector<float>& input, BackendConfig::MemoryMode memory, int thread) {
+        std::shared_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer, size), Interpreter::destroy);
+        ScheduleConfig config;
+        config.type      = MNN_FORWARD_CPU;
+        config.numThread = thread;
+        BackendConfig backendConfig;
+        backendConfig.memory = memory;
+        config.backendConfig = &backendConfig;
+        auto session = net->createSession(config);
+        auto inputTensor = net->getSessionInput(session, nullptr);
+        std::shared_ptr<Tensor> hostInput(new Tensor(inputTensor, Tensor::CAFFE));
+        ::memcpy(hostInput->host<float>(), input.data(), input.size() * sizeof(float));
+        inputTensor->copyFromHostTensor(hostInput.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::shared_ptr<Tensor> hostOutput(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(hostOutput.get());
+        return std::vector<float>(hostOutput->host<float>(), hostOutput->host<float>() + hostOutput->elementSize());
+    }
+    static bool _test(int batch, int ic, int oc, int kernel, int size, int maxValue, bool asymmetric) {
+        int kernelSize = ic * kernel * kernel;
+        std::vector<int8_t> quantWeight(oc * kernelSize);
+        std::vector<float> weight(oc * kernelSize), scale(asymmetric ? 2 * oc : oc), bias(oc);
+        for (int o = 0; o < oc; ++o) {
+            float alpha = 0.1f / maxValue * (o % 5 + 1);
+            float minValue = -0.5f + 0.01f * o;
+            if (asymmetric) {
+                scale[2 * o]     = minValue;
+                scale[2 * o + 1] = alpha;
+            } else {
+                scale[o] = alpha;
+            }
+            bias[o] = 0.1f * (o % 3 - 1);
+            for (int i = o * kernelSize; i < (o + 1) * kernelSize; ++i) {
+                quantWeight[i] = (int8_t)((i * 7 + i / 5) % (2 * maxValue + 1) - maxValue);
+                // Asymmetric weight is (q + 128) * alpha + min
+                weight[i] = asymmetric ? (quantWeight[i] + 128) * alpha + minValue : quantWeight[i] * alpha;
+            }
+        }
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = OpType_Convolution;
+        op->main.type  = OpParameter_Convolution2D;
+        auto conv      = new Convolution2DT;
+        op->main.value = conv;
+        conv->common.reset(new Convolution2DCommonT);
+        conv->common->kernelX     = kernel;
+        conv->common->kernelY     = kernel;
+        conv->common->padX        = kernel / 2;
+        conv->common->padY        = kernel / 2;
+        conv->common->inputCount  = ic;
+        conv->common->outputCount = oc;
+        conv->common->relu        = asymmetric;
+        conv->bias                = bias;
+        conv->quanParameter = IDSTEncoder::encode(weight, scale, kernelSize, oc, asymmetric, quantWeight.data(), -128);
+        auto x = _Input({batch, ic, size, size}, NCHW, halide_type_of<float>());
+        auto y = Variable::create(Expr::create(op.get(), {_Convert(x, NC4HW4)}));
+        y      = _Convert(y, NCHW);
+        std::unique_ptr<NetT> net(new NetT);
+        Variable::save({y}, net.get());
+        flatbuffers::FlatBufferBuilder builder(1024);
+        builder.Finish(Net::Pack(builder, net.get()));
+
+        std::vector<float> input(batch * ic * size * size);
+        for (int i = 0; i < input.size(); ++i) {
+            input[i] = (float)(i % 23 - 11) / 11.0f;
+        }
+        auto expect = _run(builder.GetBufferPointer(), builder.GetSize(), input, BackendConfig::Memory_Normal, 1);
+        float maxAbs = 1.0f;
+        for (auto v : expect) {
+            maxAbs = fmaxf(maxAbs, fabsf(v));
+        }
+        for (int thread = 1; thread <= 2; ++thread) {
+            auto result = _run(builder.GetBufferPointer(), builder.GetSize(), input, BackendConfig::Memory_Low, thread);
+            if (result.size() != expect.size()) {
+                return false;
+            }
+            for (int i = 0; i < expect.size(); ++i) {
+                if (fabsf(result[i] - expect[i]) > 1e-3f * maxAbs) {
+                    MNN_ERROR("Weight quant convolution mismatch at %d: %f - %f\n", i, result[i], expect[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    virtual bool run(int precision) {
+        // batch, ic, oc, kernel, size
+        std::vector<std::vector<int>> cases = {
+            {1, 64, 36, 1, 1}, {2, 32, 20, 1, 1}, {3, 40, 12, 1, 1}, {1, 16, 12, 3, 13}, {1, 7, 10, 3, 6}, {2, 9, 17, 1, 5}
+        };
+        for (auto& c : cases) {
+            // int4 and int8 weight
+            for (int maxValue : {7, 127}) {
+                for (int asymmetric = 0; asymmetric < 2; ++asymmetric) {
+                    if (!_test(c[0], c[1], c[2], c[3], c[4], maxValue, asymmetric > 0)) {
+                        MNN_ERROR("Weight quant convolution failed: batch=%d, ic=%d, oc=%d, kernel=%d, size=%d, maxValue=%d, asymmetric=%d\n",
+                                  c[0], c[1], c[2], c[3], c[4], maxValue, asymmetric);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
 MNNTestSuiteRegister(ConvolutionTestOnCPU, "op/convolution/conv2d");
 MNNTestSuiteRegister(ConvolutionSpeedTestOnCPU, "speed/convolution/conv2d");
 MNNTestSuiteRegister(SparseConvolutionTestOnCPU, "op/convolution/sparse_conv2d");
 MNNTestSuiteRegister(DepthwiseConvolutionTestOnCPU, "op/convolution/depthwise_conv");
 MNNTestSuiteRegister(GroupConvolutionTestOnCPU, "op/convolution/conv_group");
+MNNTestSuiteRegister(WeightQuantConvolutionTest, "op/convolution/weight_quant");
@@ -0,0 +1,143 @@
+//
+//  LSTMTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+// Onnx's LSTM / RNN, gate order of LSTM is I, O, F, C
+static void _refLSTM(bool isRNN, int T, int B, int I, int H, int D, const float* X, const float* W, const float* R,
+                     const float* bias, const float* initH, const float* initC, float* Y, float* Yh, float* Yc) {
+    const int N = isRNN ? 1 : 4;
+    std::vector<float> h(B * H), c(B * H), gate(N * H);
+    for (int d = 0; d < D; ++d) {
+        for (int i = 0; i < B * H; ++i) {
+            h[i] = nullptr != initH ? initH[d * B * H + i] : 0.0f;
+            c[i] = nullptr != initC ? initC[d * B * H + i] : 0.0f;
+        }
+        for (int s = 0; s < T; ++s) {
+            int t = d > 0 ? T - 1 - s : s;
+            std::vector<float> newH(B * H);
+            for (int b = 0; b < B; ++b) {
+                for (int j = 0; j < N * H; ++j) {
+                    double sum = bias[d * N * H + j];
+                    for (int k = 0; k < I; ++k) {
+                        sum += X[(t * B + b) * I + k] * W[(d * N * H + j) * I + k];
+                    }
+                    for (int k = 0; k < H; ++k) {
+                        sum += h[b * H + k] * R[(d * N * H + j) * H + k];
+                    }
+                    gate[j] = sum;
+                }
+                for (int j = 0; j < H; ++j) {
+                    if (isRNN) {
+                        newH[b * H + j] = tanhf(gate[j]);
+                        continue;
+                    }
+                    auto ig = 1.0f / (1.0f + expf(-gate[j]));
+                    auto og = 1.0f / (1.0f + expf(-gate[H + j]));
+                    auto fg = 1.0f / (1.0f + expf(-gate[2 * H + j]));
+                    auto cg = tanhf(gate[3 * H + j]);
+                    c[b * H + j] = ig * cg + fg * c[b * H + j];
+                    newH[b * H + j] = og * tanhf(c[b * H + j]);
+                }
+            }
+            h = newH;
+            ::memcpy(Y + (t * D + d) * B * H, h.data(), B * H * sizeof(float));
+        }
+        ::memcpy(Yh + d * B * H, h.data(), B * H * sizeof(float));
+        if (nullptr != Yc) {
+            ::memcpy(Yc + d * B * H, c.data(), B * H * sizeof(float));
+        }
+    }
+}
+
+class LSTMTest : public MNNTestCase {
+public:
+    virtual ~LSTMTest() = default;
+    virtual bool run(int precision) {
+        // T, B, I, H, D, hasInitState
+        std::vector<std::vector<int>> cases = {
+            {1, 1, 4, 5, 1, 0}, {3, 2, 5, 7, 1, 1}, {4, 3, 6, 9, 2, 1}, {5, 2, 16, 32, 2, 0},
+        };
+        for (int isRNN = 0; isRNN < 2; ++isRNN) {
+            for (auto& c : cases) {
+                if (!_runOneCase(isRNN, c[0], c[1], c[2], c[3], c[4], c[5], precision)) {
+                    MNN_ERROR("%s Test failed for T=%d, B=%d, I=%d, H=%d, D=%d\n", isRNN ? "RNN" : "LSTM", c[0], c[1], c[2], c[3], c[4]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool _runOneCase(bool isRNN, int T, int B, int I, int H, int D, bool hasInitState, int precision) {
+        const int N = isRNN ? 1 : 4;
+        auto fill = [](VARP x, int seed) {
+            auto size = x->getInfo()->size;
+            auto ptr  = x->writeMap<float>();
+            for (int i = 0; i < size; ++i) {
+                ptr[i] = (float)((i * 7 + seed) % 19 - 9) / 30.0f;
+            }
+        };
+        auto X    = _Input({T, B, I}, NCHW, halide_type_of<float>());
+        auto W    = _Input({D, N * H, I}, NCHW, halide_type_of<float>());
+        auto R    = _Input({D, N * H, H}, NCHW, halide_type_of<float>());
+        auto bias = _Input({D, N * H}, NCHW, halide_type_of<float>());
+        fill(X, 1);
+        fill(W, 2);
+        fill(R, 3);
+        fill(bias, 4);
+        std::vector<VARP> inputs = {X, W, R, bias};
+        if (hasInitState) {
+            auto initH = _Input({D, B, H}, NCHW, halide_type_of<float>());
+            fill(initH, 5);
+            inputs.emplace_back(initH);
+            if (!isRNN) {
+                auto initC = _Input({D, B, H}, NCHW, halide_type_of<float>());
+                fill(initC, 6);
+                inputs.emplace_back(initC);
+            }
+        }
+        std::vector<float> Y(T * D * B * H), Yh(D * B * H), Yc(D * B * H);
+        _refLSTM(isRNN, T, B, I, H, D, X->readMap<float>(), W->readMap<float>(), R->readMap<float>(),
+                 bias->readMap<float>(), hasInitState ? inputs[4]->readMap<float>() : nullptr,
+                 (hasInitState && !isRNN) ? inputs[5]->readMap<float>() : nullptr, Y.data(), Yh.data(),
+                 isRNN ? nullptr : Yc.data());
+
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = isRNN ? OpType_RNN : OpType_LSTM;
+        op->main.type  = OpParameter_LSTM;
+        op->main.value = new LSTMT;
+        op->main.AsLSTM()->outputCount = H;
+        int outputNumber = isRNN ? 2 : 3;
+        auto expr = Expr::create(op.get(), inputs, outputNumber);
+        std::vector<std::vector<float>*> expects = {&Y, &Yh, &Yc};
+        float errorScale = precision <= MNN::BackendConfig::Precision_High ? 1 : 20;
+        for (int i = 0; i < outputNumber; ++i) {
+            auto output = Variable::create(expr, i);
+            auto ptr    = output->readMap<float>();
+            if (nullptr == ptr || output->getInfo()->size != expects[i]->size()) {
+                MNN_ERROR("Output %d shape error\n", i);
+                return false;
+            }
+            if (!checkVector<float>(ptr, expects[i]->data(), expects[i]->size(), 0.0005 * errorScale)) {
+                MNN_ERROR("Output %d value error\n", i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(LSTMTest, "op/rnn/LSTM");
@@ -0,0 +1,117 @@
+//
+//  NonMaxSuppressionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/03/02.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+// Plain greedy nms as reference
+static std::vector<int> _referenceNMS(const float* boxes, const float* scores, int numBoxes, int maxDetections,
+                                      float iouThreshold, float scoreThreshold) {
+    std::vector<int> order;
+    for (int i = 0; i < numBoxes; ++i) {
+        if (scores[i] > scoreThreshold) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [scores](int a, int b) { return scores[a] > scores[b]; });
+    auto area = [boxes](int i) {
+        return (std::max(boxes[4 * i + 0], boxes[4 * i + 2]) - std::min(boxes[4 * i + 0], boxes[4 * i + 2])) *
+               (std::max(boxes[4 * i + 1], boxes[4 * i + 3]) - std::min(boxes[4 * i + 1], boxes[4 * i + 3]));
+    };
+    std::vector<int> selected;
+    for (auto i : order) {
+        if (selected.size() >= maxDetections) {
+            break;
+        }
+        bool keep = true;
+        for (auto j : selected) {
+            float areaI = area(i), areaJ = area(j);
+            if (areaI <= 0 || areaJ <= 0) {
+                continue;
+            }
+            float h = std::min(std::max(boxes[4 * i + 0], boxes[4 * i + 2]), std::max(boxes[4 * j + 0], boxes[4 * j + 2])) -
+                      std::max(std::min(boxes[4 * i + 0], boxes[4 * i + 2]), std::min(boxes[4 * j + 0], boxes[4 * j + 2]));
+            float w = std::min(std::max(boxes[4 * i + 1], boxes[4 * i + 3]), std::max(boxes[4 * j + 1], boxes[4 * j + 3])) -
+                      std::max(std::min(boxes[4 * i + 1], boxes[4 * i + 3]), std::min(boxes[4 * j + 1], boxes[4 * j + 3]));
+            float inter = std::max(h, 0.0f) * std::max(w, 0.0f);
+            if (inter / (areaI + areaJ - inter) > iouThreshold) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            selected.push_back(i);
+        }
+    }
+    return selected;
+}
+
+class NonMaxSuppressionTest : public MNNTestCase {
+public:
+    virtual ~NonMaxSuppressionTest() = default;
+    virtual bool run(int precision) {
+        // Small case: second box overlaps the first one, last box is under score threshold
+        {
+            const float boxesData[] = {0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.1f, 1.0f, 1.1f, 0.0f, 2.0f, 1.0f, 3.0f, 0.0f, 4.0f, 1.0f, 5.0f};
+            const float scoresData[] = {0.9f, 0.8f, 0.7f, 0.05f};
+            auto boxes  = _Const(boxesData, {4, 4}, NHWC);
+            auto scores = _Const(scoresData, {4}, NHWC);
+            auto output = _Nms(boxes, scores, 4, 0.5f, 0.1f);
+            const std::vector<int> expected = {0, 2, -1, -1};
+            auto ptr = output->readMap<int>();
+            if (nullptr == ptr || output->getInfo()->size != 4 || !checkVector<int>(ptr, expected.data(), 4, 0)) {
+                MNN_ERROR("NonMaxSuppressionTest small case failed!\n");
+                return false;
+            }
+        }
+        // Large case: several blocks of candidates, compare with reference greedy nms
+        {
+            const int numBoxes = 3000, maxDetections = 500;
+            std::vector<float> boxesData(numBoxes * 4), scoresData(numBoxes);
+            unsigned int seed = 1;
+            auto random = [&seed]() {
+                seed = seed * 1103515245 + 12345;
+                return (float)((seed >> 16) & 0x7fff) / 32768.0f;
+            };
+            for (int i = 0; i < numBoxes; ++i) {
+                float y = random() * 100.0f, x = random() * 100.0f;
+                float h = random() * 20.0f, w = random() * 20.0f;
+                // Some boxes have reversed corners or are empty
+                if (i % 7 == 0) {
+                    boxesData[4 * i + 0] = y + h;
+                    boxesData[4 * i + 2] = y;
+                } else {
+                    boxesData[4 * i + 0] = y;
+                    boxesData[4 * i + 2] = (i % 97 == 0) ? y : y + h;
+                }
+                boxesData[4 * i + 1] = x;
+                boxesData[4 * i + 3] = x + w;
+                // Quantized scores to produce ties
+                scoresData[i] = (float)((int)(random() * 200.0f)) / 200.0f;
+            }
+            const float iouThreshold = 0.4f, scoreThreshold = 0.2f;
+            auto expected = _referenceNMS(boxesData.data(), scoresData.data(), numBoxes, maxDetections, iouThreshold, scoreThreshold);
+            expected.resize(maxDetections, -1);
+            auto boxes  = _Const(boxesData.data(), {numBoxes, 4}, NHWC);
+            auto scores = _Const(scoresData.data(), {numBoxes}, NHWC);
+            auto output = _Nms(boxes, scores, maxDetections, iouThreshold, scoreThreshold);
+            auto ptr = output->readMap<int>();
+            if (nullptr == ptr || output->getInfo()->size != maxDetections || !checkVector<int>(ptr, expected.data(), maxDetections, 0)) {
+                MNN_ERROR("NonMaxSuppressionTest large case failed!\n");
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(NonMaxSuppressionTest, "op/non_max_suppression");
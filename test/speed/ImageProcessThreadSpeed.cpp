@@ -0,0 +1,112 @@
+//
+//  ImageProcessThreadSpeed.cpp
+//  MNNTests
+//
+//  Created by MNN on 2023/04/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/ImageProcess.hpp>
+#include <MNN/Interpreter.hpp>
+#include <MNN/AutoTime.hpp>
+#include <cmath>
+#include <memory>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::CV;
+
+// Convert a 4K RGBA frame to the input of session, the threads of session's backend are used by ImageProcess
+class ImageProcessThreadSpeedTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessThreadSpeedTest() = default;
+    virtual bool run(int precision) {
+        int sw = 3840, sh = 2160;
+        int dw = 1920, dh = 1080;
+        std::vector<uint8_t> pixels(sw * sh * 4);
+        for (int y = 0; y < sh; ++y) {
+            auto pixelY = pixels.data() + 4 * sw * y;
+            for (int x = 0; x < 4 * sw; ++x) {
+                pixelY[x] = (x * 67 + y * 13) % 255;
+            }
+        }
+        ImageProcess::Config config;
+        config.sourceFormat = RGBA;
+        config.destFormat   = BGR;
+        config.filterType   = BILINEAR;
+        config.wrap         = ZERO;
+        for (int i = 0; i < 3; ++i) {
+            config.mean[i]   = 127.5f;
+            config.normal[i] = 1.0f / 127.5f;
+        }
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        Matrix tr;
+        tr.setScale(1.0 / sw, 1.0 / sh);
+        tr.postRotate(5, 0.5f, 0.5f);
+        tr.postScale(dw, dh);
+        tr.invert(&tr);
+        process->setMatrix(tr);
+
+        // Only the session input tensor is used
+        std::unique_ptr<NetT> net(new NetT);
+        std::unique_ptr<OpT> input(new OpT);
+        input->type       = OpType_Input;
+        auto param        = new InputT;
+        param->dims       = {1, 3, dh, dw};
+        param->dformat    = MNN_DATA_FORMAT_NC4HW4;
+        input->main.type  = OpParameter_Input;
+        input->main.value = param;
+        input->outputIndexes.push_back(0);
+        net->oplists.emplace_back(std::move(input));
+        std::unique_ptr<OpT> relu(new OpT);
+        relu->type       = OpType_ReLU;
+        relu->main.type  = OpParameter_Relu;
+        relu->main.value = new ReluT;
+        relu->inputIndexes.push_back(0);
+        relu->outputIndexes.push_back(1);
+        net->oplists.emplace_back(std::move(relu));
+        net->tensorName   = {"input", "output"};
+        net->tensorNumber = 2;
+        net->usage        = Usage_INFERENCE;
+        flatbuffers::FlatBufferBuilder builder(1024);
+        auto offset = Net::Pack(builder, net.get());
+        builder.Finish(offset);
+        std::shared_ptr<Interpreter> interpreter(Interpreter::createFromBuffer(builder.GetBufferPointer(), builder.GetSize()));
+        std::vector<float> expect;
+        for (int thread : {1, 4}) {
+            ScheduleConfig scheduleConfig;
+            scheduleConfig.numThread = thread;
+            auto session = interpreter->createSession(scheduleConfig);
+            auto tensor  = interpreter->getSessionInput(session, nullptr);
+            if (nullptr == tensor || nullptr == tensor->host<float>()) {
+                MNN_ERROR("Can't get session input\n");
+                return false;
+            }
+            process->convert(pixels.data(), sw, sh, 0, tensor);
+            auto ptr  = tensor->host<float>();
+            auto size = tensor->elementSize();
+            if (expect.empty()) {
+                expect.assign(ptr, ptr + size);
+            } else {
+                for (int i = 0; i < size; ++i) {
+                    if (fabsf(ptr[i] - expect[i]) > 1e-6f) {
+                        MNN_ERROR("Error for %d thread at %d: %f, correct=%f\n", thread, i, ptr[i], expect[i]);
+                        return false;
+                    }
+                }
+            }
+            {
+                Timer timer;
+                for (int i = 0; i < 10; ++i) {
+                    process->convert(pixels.data(), sw, sh, 0, tensor);
+                }
+                MNN_PRINT("RGBA %dx%d -> BGR float %dx%d, thread %d: %f ms\n", sw, sh, dw, dh, thread,
+                          (float)timer.durationInUs() / 10000.0f);
+            }
+            interpreter->releaseSession(session);
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessThreadSpeedTest, "speed/cv/image_process/thread");
@@ -40,35 +40,44 @@ public:
             exe->onExecute(inputs, outputs);
         }
     }
-    virtual bool run(int precision) {
-        // prepare CPU backend
-        ScheduleConfig config;
-        config.type = MNN_FORWARD_CPU;
-        BackendConfig backendConfig;
-        backendConfig.precision = BackendConfig::Precision_High;
-        config.backendConfig = &backendConfig;
-        Backend::Info compute;
-        compute.type = config.type;
-        compute.numThread = config.numThread;
-        compute.user = config.backendConfig;
-        const RuntimeCreator* runtimeCreator(MNNGetExtraRuntimeCreator(compute.type));
-        std::unique_ptr<Runtime> runtime(runtimeCreator->onCreate(compute));
-        std::unique_ptr<Backend> backend(runtime->onCreate());
-        // build Op
-        std::unique_ptr<OpT> opt(new OpT);
-        opt->type = OpType_Raster;
-        flatbuffers::FlatBufferBuilder builder(1024);
-        builder.ForceDefaults(true);
-        auto len = Op::Pack(builder, opt.get());
-        builder.Finish(len);
-        auto buffer = builder.GetBufferPointer();
-        const Op* op = flatbuffers::GetMutableRoot<Op>(buffer);
+    // Neither src nor dst is contiguous in the inner dim
+    void RasterStrided(std::unique_ptr<Execution>& exe, std::vector<Tensor*>& inputs, std::vector<Tensor*>& outputs) {
+        AUTOTIME;
+        for (int i = 0; i < TIME; i++) {
+            exe->onExecute(inputs, outputs);
+        }
+    }
+    // Compare with copy element by element
+    bool check(std::unique_ptr<Execution>& exe, std::vector<Tensor*>& inputs, std::vector<Tensor*>& outputs, const char* name) {
+        auto& region = TensorUtils::getDescribe(inputs[0])->regions[0];
+        auto bytes   = outputs[0]->getType().bytes();
+        auto src     = region.origin->host<uint8_t>();
+        auto size    = outputs[0]->elementSize() * bytes;
+        std::vector<uint8_t> expect(size, 0);
+        for (int z = 0; z < region.size[0]; ++z) {
+            for (int y = 0; y < region.size[1]; ++y) {
+                for (int x = 0; x < region.size[2]; ++x) {
+                    auto srcIndex = region.src.offset + z * region.src.stride[0] + y * region.src.stride[1] + x * region.src.stride[2];
+                    auto dstIndex = region.dst.offset + z * region.dst.stride[0] + y * region.dst.stride[1] + x * region.dst.stride[2];
+                    ::memcpy(expect.data() + dstIndex * bytes, src + srcIndex * bytes, bytes);
+                }
+            }
+        }
+        ::memset(outputs[0]->host<void>(), 0, size);
+        exe->onExecute(inputs, outputs);
+        if (0 != ::memcmp(expect.data(), outputs[0]->host<void>(), size)) {
+            MNN_ERROR("Raster %s error for %d bytes\n", name, bytes);
+            return false;
+        }
+        return true;
+    }
+    bool testType(Backend* backend, const Op* op, DataType type) {
         // build Tensors
         std::unique_ptr<Tensor> tensors[3];
         for (int i = 0; i < 3; i++) {
             tensors[i].reset(new Tensor(4, Tensor::CAFFE));
             auto tensor = tensors[i].get();
-            tensor->setType(DataType_DT_FLOAT);
+            tensor->setType(type);
             tensor->setLength(0, 1);
             tensor->setLength(1, CHANNEL);
             tensor->setLength(2, HEIGHT);
@@ -81,13 +90,23 @@ public:
                 des->regions.push_back(region);
             } else {
                 backend->onAcquireBuffer(tensor, Backend::STATIC);
-                TensorUtils::getDescribe(tensor)->backend = backend.get();
+                TensorUtils::getDescribe(tensor)->backend = backend;
             }
         }
+        auto srcPtr = tensors[0]->host<uint8_t>();
+        for (int i = 0; i < tensors[0]->size(); ++i) {
+            srcPtr[i] = (i * 37 + i / 253) % 251;
+        }
+        MNN_PRINT("Raster for %d bytes\n", tensors[0]->getType().bytes());
         auto middle = tensors[1].get();
         auto& region = TensorUtils::getDescribe(middle)->regions[0];
         std::vector<Tensor*> ins = {middle}, outs = {tensors[2].get()};
         std::unique_ptr<Execution> exe(backend->onCreate(ins, outs, op));
+        if (nullptr == exe) {
+            // Some backend only support float and 8 bits int
+            MNN_PRINT("Skip for the type is not supported by backend\n");
+            return true;
+        }
         // transpose(1, 0, 2)
         region.size[0] = HEIGHT;
         region.size[1] = CHANNEL;
@@ -101,6 +120,9 @@ public:
         region.dst.stride[1] = WIDTH;
         region.dst.stride[2] = 1;
         exe->onResize(ins, outs);
+        if (!check(exe, ins, outs, "transpose(1, 0, 2)")) {
+            return false;
+        }
         RasterTranspose_102(exe, ins, outs);
         // transpose(0, 2, 1)
         region.size[0] = CHANNEL;
@@ -115,6 +137,9 @@ public:
         region.dst.stride[1] = HEIGHT;
         region.dst.stride[2] = 1;
         exe->onResize(ins, outs);
+        if (!check(exe, ins, outs, "transpose(0, 2, 1)")) {
+            return false;
+        }
         RasterTranspose_021(exe, ins, outs);
         // transpose(2, 1, 0)
         region.size[0] = WIDTH;
@@ -129,7 +154,57 @@ public:
         region.dst.stride[1] = CHANNEL;
         region.dst.stride[2] = 1;
         exe->onResize(ins, outs);
+        if (!check(exe, ins, outs, "transpose(2, 1, 0)")) {
+            return false;
+        }
         RasterTranspose_210(exe, ins, outs);
+        // Even columns of (c, h, w) -> (h, w / 2, c)
+        region.size[0] = CHANNEL;
+        region.size[1] = HEIGHT;
+        region.size[2] = WIDTH / 2;
+        region.src.offset = 0;
+        region.src.stride[0] = HEIGHT * WIDTH;
+        region.src.stride[1] = WIDTH;
+        region.src.stride[2] = 2;
+        region.dst.offset = 0;
+        region.dst.stride[0] = 1;
+        region.dst.stride[1] = WIDTH / 2 * CHANNEL;
+        region.dst.stride[2] = CHANNEL;
+        exe->onResize(ins, outs);
+        if (!check(exe, ins, outs, "strided")) {
+            return false;
+        }
+        RasterStrided(exe, ins, outs);
+        return true;
+    }
+    virtual bool run(int precision) {
+        // prepare CPU backend
+        ScheduleConfig config;
+        config.type = MNN_FORWARD_CPU;
+        BackendConfig backendConfig;
+        backendConfig.precision = BackendConfig::Precision_High;
+        config.backendConfig = &backendConfig;
+        Backend::Info compute;
+        compute.type = config.type;
+        compute.numThread = config.numThread;
+        compute.user = config.backendConfig;
+        const RuntimeCreator* runtimeCreator(MNNGetExtraRuntimeCreator(compute.type));
+        std::unique_ptr<Runtime> runtime(runtimeCreator->onCreate(compute));
+        std::unique_ptr<Backend> backend(runtime->onCreate());
+        // build Op
+        std::unique_ptr<OpT> opt(new OpT);
+        opt->type = OpType_Raster;
+        flatbuffers::FlatBufferBuilder builder(1024);
+        builder.ForceDefaults(true);
+        auto len = Op::Pack(builder, opt.get());
+        builder.Finish(len);
+        auto buffer = builder.GetBufferPointer();
+        const Op* op = flatbuffers::GetMutableRoot<Op>(buffer);
+        for (auto type : {DataType_DT_FLOAT, DataType_DT_INT16, DataType_DT_INT8}) {
+            if (!testType(backend.get(), op, type)) {
+                return false;
+            }
+        }
         return true;
     }
 };
@@ -17,6 +17,8 @@ using namespace MNN::Express;
 #define WIDTH 501
 #define HEIGHT 243
 #define TIME 100
+#define CHANNEL 32
+#define AREA 112
 class TransposeSpeed : public MNNTestCase {
 public:
     void SpeedTest() {
@@ -30,6 +32,34 @@ public:
             }
         }
     }
+    // NCHW -> NHWC, the region has no contiguous dim on both sides for 1 byte
+    template<typename T>
+    bool PermuteTest(const char* name) {
+        auto x   = _Input({1, CHANNEL, AREA, AREA}, NCHW, halide_type_of<T>());
+        auto ptr = x->template writeMap<T>();
+        for (int i = 0; i < CHANNEL * AREA * AREA; ++i) {
+            ptr[i] = (T)(i % 127);
+        }
+        auto output = _Transpose(x, {0, 2, 3, 1});
+        auto yPtr   = output->template readMap<T>();
+        for (int c = 0; c < CHANNEL; ++c) {
+            for (int i = 0; i < AREA * AREA; ++i) {
+                if (yPtr[i * CHANNEL + c] != (T)((c * AREA * AREA + i) % 127)) {
+                    MNN_ERROR("Permute %s error for %d - %d\n", name, c, i);
+                    return false;
+                }
+            }
+        }
+        MNN_PRINT("Permute %s for %d, %d, %d x %d\n", name, CHANNEL, AREA, AREA, TIME);
+        {
+            AUTOTIME;
+            for (int i = 0; i < TIME; ++i) {
+                x->template writeMap<T>();
+                output->template readMap<T>();
+            }
+        }
+        return true;
+    }
     bool CorrectTest() {
         auto x      = _Input({1, 1, HEIGHT, WIDTH}, NCHW, halide_type_of<int>());
         std::vector<int> input(WIDTH * HEIGHT);
@@ -59,6 +89,9 @@ public:
     virtual bool run(int precision) {
         MNN_PRINT("Test Convert for %d, %d, x %d\n", WIDTH, HEIGHT, TIME);
         SpeedTest();
+        if (!PermuteTest<float>("float") || !PermuteTest<int8_t>("int8")) {
+            return false;
+        }
         return CorrectTest();
     }
 };
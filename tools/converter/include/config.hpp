@@ -58,6 +58,10 @@ public:
     float testThredhold = 0.01;
     bool mnn2json = false;
     bool dumpInfo = false;
+    // Save Conv's weight/bias to MNNModel + ".weight", the model only keeps offsets
+    bool saveExternalData = false;
+    // Merge the pattern of attention into Attention op
+    bool transformerFuse = false;
 };
 
 #endif // CONFIG_HPP
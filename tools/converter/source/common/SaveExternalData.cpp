@@ -0,0 +1,109 @@
+//
+//  SaveExternalData.cpp
+//  MNNConverter
+//
+//  Created by MNN on 2022/06/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "CommonUtils.hpp"
+
+// Write the weight and bias of op to output, the op itself is not modified until all writes succeed
+static bool SaveOpExternalData(const std::unique_ptr<MNN::OpT>& op, std::ofstream& output, int64_t& offset, std::vector<int64_t>& external) {
+    external.clear();
+    const auto opType = op->type;
+    switch (opType) {
+        case MNN::OpType_Convolution:
+        case MNN::OpType_ConvolutionDepthwise: {
+            auto param = op->main.AsConvolution2D();
+            if (nullptr != param->symmetricQuan || param->bias.empty()) {
+                return true;
+            }
+            const char* weightPtr = nullptr;
+            int64_t weightBytes   = 0;
+            if (nullptr != param->quanParameter) {
+                weightPtr   = (const char*)param->quanParameter->buffer.data();
+                weightBytes = param->quanParameter->buffer.size();
+            } else {
+                weightPtr   = (const char*)param->weight.data();
+                weightBytes = param->weight.size() * sizeof(float);
+            }
+            if (0 == weightBytes) {
+                return true;
+            }
+            int64_t biasBytes = param->bias.size() * sizeof(float);
+            output.write(weightPtr, weightBytes);
+            output.write((const char*)param->bias.data(), biasBytes);
+            if (output.fail()) {
+                return false;
+            }
+            external = {offset, weightBytes, biasBytes};
+            offset += weightBytes + biasBytes;
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
+
+static void ClearOpInlineData(std::unique_ptr<MNN::OpT>& op, const std::vector<int64_t>& external) {
+    auto param      = op->main.AsConvolution2D();
+    param->external = external;
+    param->weight.clear();
+    param->bias.clear();
+    if (nullptr != param->quanParameter) {
+        param->quanParameter->buffer.clear();
+    }
+}
+
+bool saveExternalData(std::unique_ptr<MNN::NetT>& netT, const std::string& externalFile) {
+    if (!netT->subgraphs.empty()) {
+        // Control flow subgraphs are executed by express, which don't support external weight
+        MNN_PRINT("The model has subgraphs, don't save external data\n");
+        return true;
+    }
+    // Write to a temp file first, so that a failed write never leaves a truncated weight file or a half external model
+    auto tempFile = externalFile + ".tmp";
+    std::vector<std::vector<int64_t>> externals(netT->oplists.size());
+    int64_t offset = 0;
+    {
+        std::ofstream output(tempFile, std::ofstream::binary);
+        if (!output.is_open()) {
+            MNN_ERROR("Open %s error\n", tempFile.c_str());
+            return false;
+        }
+        bool success = true;
+        for (int i = 0; i < netT->oplists.size(); ++i) {
+            if (!SaveOpExternalData(netT->oplists[i], output, offset, externals[i])) {
+                success = false;
+                break;
+            }
+        }
+        if (success) {
+            output.close();
+            success = !output.fail();
+        }
+        if (!success) {
+            MNN_ERROR("Write %s error\n", tempFile.c_str());
+            output.close();
+            std::remove(tempFile.c_str());
+            return false;
+        }
+    }
+    if (0 != std::rename(tempFile.c_str(), externalFile.c_str())) {
+        MNN_ERROR("Rename %s to %s error\n", tempFile.c_str(), externalFile.c_str());
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    for (int i = 0; i < netT->oplists.size(); ++i) {
+        if (!externals[i].empty()) {
+            ClearOpInlineData(netT->oplists[i], externals[i]);
+        }
+    }
+    MNN_PRINT("Save %lld bytes of weight to %s\n", (long long)offset, externalFile.c_str());
+    return true;
+}
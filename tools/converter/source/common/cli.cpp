@@ -268,6 +268,14 @@ bool Cli::initializeMNNConvertArgs(modelConfig &modelPath, int argc, char **argv
             "detectSparseSpeedUp",
             "if 1 converter would detect weights sparsity and check sparse speedup. default: 1, range : {0, 1}",
             cxxopts::value<int>()
+        )
+        (
+            "saveExternalData",
+            "save Conv's weight/bias to MNNModel.weight file, the graph can then be loaded without weights, only CPU backend supports such model, default: false"
+        )
+        (
+            "transformerFuse",
+            "fuse softmax(q * k^T * scale + mask) * v into Attention op, the model can only run by a runtime including the Attention op, default: false"
         );
 
 
@@ -446,6 +454,12 @@ bool Cli::initializeMNNConvertArgs(modelConfig &modelPath, int argc, char **argv
     if (result.count("detectSparseSpeedUp")) {
         modelPath.detectSparseSpeedUp = result["detectSparseSpeedUp"].as<int>();
     }
+    if (result.count("saveExternalData")) {
+        modelPath.saveExternalData = true;
+    }
+    if (result.count("transformerFuse")) {
+        modelPath.transformerFuse = true;
+    }
 
     if (result.count("testdir")) {
         modelPath.testDir = result["testdir"].as<std::string>();
@@ -64,6 +64,12 @@ int writeFb(std::unique_ptr<MNN::NetT>& netT, const std::string& MNNModelFile, c
 
     weightQuantAndCoding(netT, config);
 
+    if (config.saveExternalData && (!config.saveStaticModel)) {
+        if (!saveExternalData(netT, MNNModelFile + ".weight")) {
+            MNN_ERROR("Save external data failed, abort converting\n");
+            return 1;
+        }
+    }
 
     std::set<std::string> notSupportOps;
     auto CheckIfNotSupported = [&] (const std::unique_ptr<MNN::OpT>& op) {
@@ -0,0 +1,184 @@
+//
+//  FuseAttention.cpp
+//  MNNConverter
+//
+//  Created by MNN on 2023/03/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "../TemplateMerge.hpp"
+#include "MNN/expr/ExprCreator.hpp"
+#include "MNN_generated.h"
+#include "MergeHelpers.hpp"
+
+namespace MNN {
+namespace Express {
+
+// Merge softmax(matmul(q, k^T) * scale + mask) * v into Attention
+class FuseAttention {
+public:
+    FuseAttention();
+private:
+    VARP mQuery;
+    VARP mKey;
+    VARP mValue;
+    VARP mMask;
+    float mScale;
+};
+
+static bool _isMatMul(EXPRP expr, bool& transposeA, bool& transposeB) {
+    const Op* op = expr->get();
+    if (nullptr == op) {
+        return false;
+    }
+    if (op->type() == OpType_MatMul && op->main_type() == OpParameter_MatMul) {
+        transposeA = op->main_as_MatMul()->transposeA();
+        transposeB = op->main_as_MatMul()->transposeB();
+        return expr->inputs().size() == 2;
+    }
+    if (op->type() == OpType_BatchMatMul && op->main_type() == OpParameter_BatchMatMulParam) {
+        transposeA = op->main_as_BatchMatMulParam()->adjX();
+        transposeB = op->main_as_BatchMatMulParam()->adjY();
+        return expr->inputs().size() == 2;
+    }
+    return false;
+}
+
+static bool _readScalar(VARP var, float& value) {
+    if (!helpers::IsConstant(var->expr().first)) {
+        return false;
+    }
+    auto info = var->getInfo();
+    if (nullptr == info || info->size != 1 || info->type.code != halide_type_float) {
+        return false;
+    }
+    value = var->readMap<float>()[0];
+    return true;
+}
+
+// Return the matmul of q * k^T if expr is it, or it multiplied / divided by a scalar
+static EXPRP _matchScore(EXPRP expr, float& scale) {
+    scale = 1.0f;
+    if (helpers::IsBinaryOp(expr) && expr->outputs().size() == 1) {
+        auto binaryType = expr->get()->main_as_BinaryOp()->opType();
+        float value = 0.0f;
+        if (binaryType == BinaryOpOperation_MUL) {
+            if (_readScalar(expr->inputs()[1], value)) {
+                expr = expr->inputs()[0]->expr().first;
+            } else if (_readScalar(expr->inputs()[0], value)) {
+                expr = expr->inputs()[1]->expr().first;
+            } else {
+                return nullptr;
+            }
+            scale = value;
+        } else if (binaryType == BinaryOpOperation_REALDIV || binaryType == BinaryOpOperation_DIV) {
+            if (!_readScalar(expr->inputs()[1], value) || value == 0.0f) {
+                return nullptr;
+            }
+            expr  = expr->inputs()[0]->expr().first;
+            scale = 1.0f / value;
+        } else {
+            return nullptr;
+        }
+    }
+    bool transposeA = false, transposeB = false;
+    if (!_isMatMul(expr, transposeA, transposeB) || transposeA || expr->outputs().size() != 1 || scale == 0.0f) {
+        return nullptr;
+    }
+    return expr;
+}
+
+FuseAttention::FuseAttention() {
+    auto match = [this](EXPRP expr) -> bool {
+        auto config = Global<modelConfig>::Get();
+        if (!config->transformerFuse) {
+            return false;
+        }
+        // p * v
+        bool transposeA = false, transposeB = false;
+        if (!_isMatMul(expr, transposeA, transposeB) || transposeA || transposeB) {
+            return false;
+        }
+        mValue = expr->inputs()[1];
+        auto softmax = expr->inputs()[0]->expr().first;
+        auto op = softmax->get();
+        if (nullptr == op || op->type() != OpType_Softmax || softmax->outputs().size() != 1) {
+            return false;
+        }
+        int axis = -1;
+        if (nullptr != op->main_as_Axis()) {
+            axis = op->main_as_Axis()->axis();
+        }
+        if (axis != -1) {
+            auto info = softmax->inputs()[0]->getInfo();
+            if (nullptr == info || axis != (int)info->dim.size() - 1) {
+                return false;
+            }
+        }
+        // score + mask
+        auto input = softmax->inputs()[0]->expr().first;
+        auto score = _matchScore(input, mScale);
+        mMask      = nullptr;
+        if (nullptr == score) {
+            if (!helpers::IsBinaryAdd(input) || input->outputs().size() != 1) {
+                return false;
+            }
+            score = _matchScore(input->inputs()[0]->expr().first, mScale);
+            mMask = input->inputs()[1];
+            if (nullptr == score) {
+                score = _matchScore(input->inputs()[1]->expr().first, mScale);
+                mMask = input->inputs()[0];
+            }
+            if (nullptr == score) {
+                return false;
+            }
+            auto maskInfo = mMask->getInfo();
+            if (nullptr != maskInfo && maskInfo->type.code != halide_type_float) {
+                return false;
+            }
+        }
+        // q * k^T
+        _isMatMul(score, transposeA, transposeB);
+        mQuery = score->inputs()[0];
+        mKey   = score->inputs()[1];
+        // Attention op don't broadcast, query, key and value must have the same rank and batch dims
+        auto queryInfo = mQuery->getInfo();
+        auto keyInfo   = mKey->getInfo();
+        auto valueInfo = mValue->getInfo();
+        if (nullptr == queryInfo || nullptr == keyInfo || nullptr == valueInfo) {
+            return false;
+        }
+        const int dims = (int)queryInfo->dim.size();
+        if (dims < 2 || keyInfo->dim.size() != dims || valueInfo->dim.size() != dims) {
+            return false;
+        }
+        for (int i = 0; i < dims - 2; ++i) {
+            if (queryInfo->dim[i] <= 0 || queryInfo->dim[i] != keyInfo->dim[i] || queryInfo->dim[i] != valueInfo->dim[i]) {
+                return false;
+            }
+        }
+        if (!transposeB) {
+            // key is given as [..., D, S], transpose it back
+            std::vector<int> perm(dims);
+            for (int i = 0; i < perm.size(); ++i) {
+                perm[i] = i;
+            }
+            std::swap(perm[perm.size() - 1], perm[perm.size() - 2]);
+            mKey = _Transpose(mKey, perm);
+        }
+        return true;
+    };
+
+    auto fold = [this](EXPRP expr) -> bool {
+        auto attention = _Attention(mQuery, mKey, mValue, mMask, mScale);
+        attention->setName(expr->name());
+        Expr::replace(expr, attention->expr().first);
+        return true /*modified*/;
+    };
+    TemplateMerge::getInstance("Merge").insertTemplate("FuseAttention", match, fold);
+}
+
+static FuseAttention g_fuse_attention;
+
+} // namespace Express
+} // namespace MNN
@@ -8,6 +8,8 @@
 
 #include <string.h>
 #include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <string>
 #if defined(_MSC_VER)
 #include <Windows.h>
@@ -16,8 +18,17 @@
 #else
 #include <sys/time.h>
 #endif
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "Profiler.hpp"
 #include "core/Macro.h"
+#ifdef MNN_USE_THREAD_POOL
+#include "backend/cpu/ThreadPool.hpp"
+#endif
 
 #define MFLOPS (1e6)
 
@@ -99,7 +110,36 @@ Profiler::Record& Profiler::getNamedRecord(const OperatorInfo* op) {
     return record;
 }
 
+// The same clock as thread pool's trace
+static inline int64_t getTraceTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::mutex gWorkerMutex;
+
+Profiler::~Profiler() {
+    closeCounters();
+}
+
+void Profiler::closeCounters() {
+#if defined(__linux__)
+    for (auto fd : mCounterFds) {
+        close(fd);
+    }
+#endif
+    mCounterFds.clear();
+    mCounterGroups.clear();
+}
+
 void Profiler::start(const OperatorInfo* info) {
+    if (mTracing) {
+        mCurrentEvent.name  = info->name();
+        mCurrentEvent.type  = info->type();
+        mCurrentEvent.flops = info->flops();
+        mCurrentEvent.bytes = 0;
+        readCounters(mCurrentEvent.counters);
+        mCurrentEvent.begin = getTraceTime();
+    }
     mStartTime = getTime();
     mTotalMFlops += info->flops();
     auto& typed = getTypedRecord(info);
@@ -115,6 +155,199 @@ void Profiler::end(const OperatorInfo* info) {
     mMapByType[info->type()].costTime += cost;
     mMapByName[info->name()].costTime += cost;
     mTotalTime += cost;
+    if (mTracing) {
+        mCurrentEvent.end = getTraceTime();
+        uint64_t counters[COUNTER_NUMBER];
+        if (readCounters(counters)) {
+            for (int i = 0; i < COUNTER_NUMBER; ++i) {
+                mCurrentEvent.counters[i] = counters[i] - mCurrentEvent.counters[i];
+            }
+        }
+        mOpEvents.emplace_back(mCurrentEvent);
+    }
+}
+
+void Profiler::addBytes(const std::vector<Tensor*>& tensors) {
+    if (!mTracing) {
+        return;
+    }
+    for (auto t : tensors) {
+        mCurrentEvent.bytes += t->size();
+    }
+}
+
+void Profiler::traceWorker(int threadIndex, int64_t beginUs, int64_t endUs, int workSize) {
+    std::lock_guard<std::mutex> _l(gWorkerMutex);
+    gInstance->mWorkerEvents.emplace_back(WorkerEvent{threadIndex, beginUs, endUs, workSize});
+}
+
+bool Profiler::readCounters(uint64_t* counters) const {
+    ::memset(counters, 0, COUNTER_NUMBER * sizeof(uint64_t));
+    if (mCounterGroups.empty()) {
+        return false;
+    }
+#if defined(__linux__)
+    // PERF_FORMAT_GROUP: number of counters and then the values
+    uint64_t values[1 + COUNTER_NUMBER];
+    for (auto fd : mCounterGroups) {
+        if (sizeof(values) != read(fd, values, sizeof(values))) {
+            continue;
+        }
+        for (int i = 0; i < COUNTER_NUMBER && i < (int)values[0]; ++i) {
+            counters[i] += values[1 + i];
+        }
+    }
+#endif
+    return true;
+}
+
+#if defined(__linux__)
+static int openCounter(int tid, uint64_t config, int groupFd) {
+    struct perf_event_attr attr;
+    ::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, tid, -1, groupFd, 0);
+}
+#endif
+
+void Profiler::startTrace() {
+    mTracing = true;
+    mOpEvents.clear();
+    {
+        std::lock_guard<std::mutex> _l(gWorkerMutex);
+        mWorkerEvents.clear();
+    }
+#ifdef MNN_USE_THREAD_POOL
+    ThreadPool::setTraceFunction(traceWorker);
+#endif
+#if defined(__linux__)
+    // Reopen counters for the threads existing now, the threads of last trace may be gone
+    closeCounters();
+    // Count all threads of the process, so that the work of thread pool is included in the op
+    auto dir = opendir("/proc/self/task");
+    if (nullptr == dir) {
+        return;
+    }
+    const uint64_t configs[COUNTER_NUMBER] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    while (auto entry = readdir(dir)) {
+        int tid = ::atoi(entry->d_name);
+        if (tid <= 0) {
+            continue;
+        }
+        int leader = openCounter(tid, configs[0], -1);
+        if (leader < 0) {
+            continue;
+        }
+        std::vector<int> fds = {leader};
+        for (int i = 1; i < COUNTER_NUMBER; ++i) {
+            int fd = openCounter(tid, configs[i], leader);
+            if (fd < 0) {
+                break;
+            }
+            fds.emplace_back(fd);
+        }
+        if ((int)fds.size() != COUNTER_NUMBER) {
+            for (auto fd : fds) {
+                close(fd);
+            }
+            continue;
+        }
+        mCounterGroups.emplace_back(leader);
+        mCounterFds.insert(mCounterFds.end(), fds.begin(), fds.end());
+    }
+    closedir(dir);
+    if (mCounterGroups.empty()) {
+        MNN_PRINT("perf_event_open is not available, trace without hardware counters\n");
+    }
+#endif
+}
+
+static std::string escapeJson(const std::string& value) {
+    std::string result;
+    for (auto c : value) {
+        if (c == '"' || c == '\\') {
+            result.push_back('\\');
+            result.push_back(c);
+        } else if ((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            result.append(code);
+        } else {
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+bool Profiler::dumpTrace(const char* path) {
+    mTracing = false;
+#ifdef MNN_USE_THREAD_POOL
+    ThreadPool::setTraceFunction(nullptr);
+#endif
+    FILE* f = fopen(path, "wb");
+    if (nullptr == f) {
+        MNN_ERROR("Can't open %s for trace\n", path);
+        return false;
+    }
+    std::lock_guard<std::mutex> _l(gWorkerMutex);
+    int64_t origin = 0;
+    if (!mOpEvents.empty()) {
+        origin = mOpEvents[0].begin;
+    } else if (!mWorkerEvents.empty()) {
+        origin = mWorkerEvents[0].begin;
+    }
+    for (auto& e : mWorkerEvents) {
+        origin = std::min(origin, e.begin);
+    }
+    bool hasCounter = !mCounterGroups.empty();
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    // tid 0 for ops, tid i + 1 for the i-th thread of thread pool
+    fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, \"args\": {\"name\": \"Op\"}}");
+    int maxThread = -1;
+    for (auto& e : mWorkerEvents) {
+        maxThread = std::max(maxThread, e.threadIndex);
+    }
+    for (int i = 0; i <= maxThread; ++i) {
+        fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, \"args\": {\"name\": \"Thread %d\"}}", i + 1, i);
+    }
+    for (auto& e : mOpEvents) {
+        auto duration = std::max((int64_t)1, e.end - e.begin);
+        // flops is MFlops, duration is us
+        auto gflops = e.flops / (float)duration * 1000.0f;
+        fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": %lld, \"dur\": %lld, \"args\": {\"type\": \"%s\", \"mflops\": %f, \"gflops\": %f, \"bytes\": %lld",
+                escapeJson(e.name).c_str(), escapeJson(e.type).c_str(), (long long)(e.begin - origin), (long long)duration,
+                escapeJson(e.type).c_str(), e.flops, gflops, (long long)e.bytes);
+        if (e.flops > 0.0f) {
+            fprintf(f, ", \"bytes_per_flop\": %f", (float)e.bytes / (e.flops * MFLOPS));
+        }
+        if (hasCounter) {
+            fprintf(f, ", \"cycles\": %llu, \"instructions\": %llu, \"llc_misses\": %llu",
+                    (unsigned long long)e.counters[COUNTER_CYCLES], (unsigned long long)e.counters[COUNTER_INSTRUCTIONS],
+                    (unsigned long long)e.counters[COUNTER_LLC_MISSES]);
+            if (e.counters[COUNTER_CYCLES] > 0) {
+                fprintf(f, ", \"ipc\": %f", (float)e.counters[COUNTER_INSTRUCTIONS] / (float)e.counters[COUNTER_CYCLES]);
+            }
+            if (e.flops > 0.0f) {
+                // Assume 64 bytes cache line for memory traffic
+                fprintf(f, ", \"llc_miss_bytes_per_flop\": %f", (float)e.counters[COUNTER_LLC_MISSES] * 64.0f / (e.flops * MFLOPS));
+            }
+        }
+        fprintf(f, "}}");
+    }
+    for (auto& e : mWorkerEvents) {
+        fprintf(f, ",\n{\"name\": \"work\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %lld, \"dur\": %lld, \"args\": {\"size\": %d}}",
+                e.threadIndex + 1, (long long)(e.begin - origin), (long long)(e.end - e.begin), e.workSize);
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    MNN_PRINT("Write trace of %d ops and %d thread works to %s\n", (int)mOpEvents.size(), (int)mWorkerEvents.size(), path);
+    mWorkerEvents.clear();
+    return true;
 }
 
 static void printTable(const char* title, const std::vector<std::string>& header,
@@ -51,8 +51,25 @@ public:
      * print op that flops / time is slow
      */
     void printSlowOp(const std::string& type, int topk, float limitRate);
+
+    /**
+     * @brief start recording trace events of ops and threads of thread pool, and hardware counters
+     * (cycles, instructions, LLC misses) of ops if perf_event_open is available. The counters are opened for the
+     * threads existing when this is called, so threads created later (e.g. by a new runtime) are not counted.
+     */
+    void startTrace();
+    /**
+     * @brief record the bytes of inputs / outputs for the op in trace, call between start and end.
+     */
+    void addBytes(const std::vector<Tensor*>& tensors);
+    /**
+     * @brief stop recording and write events as Chrome trace json, which can be opened by chrome://tracing or Perfetto.
+     * @param path      output file path.
+     * @return false if the file can't be written.
+     */
+    bool dumpTrace(const char* path);
 private:
-    ~Profiler() = default;
+    ~Profiler();
 
 private:
     struct Record {
@@ -72,6 +89,39 @@ private:
     std::map<std::string, Record> mMapByType;
     std::map<std::string, Record> mMapByName;
 
+    enum {
+        COUNTER_CYCLES = 0,
+        COUNTER_INSTRUCTIONS,
+        COUNTER_LLC_MISSES,
+        COUNTER_NUMBER
+    };
+    struct OpEvent {
+        std::string name;
+        std::string type;
+        int64_t begin;
+        int64_t end;
+        float flops;
+        int64_t bytes;
+        uint64_t counters[COUNTER_NUMBER];
+    };
+    struct WorkerEvent {
+        int threadIndex;
+        int64_t begin;
+        int64_t end;
+        int workSize;
+    };
+    bool mTracing = false;
+    OpEvent mCurrentEvent;
+    std::vector<OpEvent> mOpEvents;
+    std::vector<WorkerEvent> mWorkerEvents;
+    // Group leader fd of counters for each thread of process
+    std::vector<int> mCounterGroups;
+    // All opened counter fds, including the members of groups
+    std::vector<int> mCounterFds;
+    void closeCounters();
+    static void traceWorker(int threadIndex, int64_t beginUs, int64_t endUs, int workSize);
+    bool readCounters(uint64_t* counters) const;
+
 private:
     Record& getTypedRecord(const OperatorInfo* info);
     Record& getNamedRecord(const OperatorInfo* info);
@@ -0,0 +1,112 @@
+//
+//  batchBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2023/03/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/DynamicBatcher.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/AutoTime.hpp>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+using namespace MNN::Express;
+using namespace MNN;
+
+// Send requests of batch 1 from several clients, report throughput and latency for each max batch
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        MNN_PRINT("Usage: ./batchBenchmark.out model.mnn [clients=8] [requestsPerClient=50] [maxDelayUs=1000] [workers=1] [threads=1]\n");
+        return 0;
+    }
+    int clientNumber = 8;
+    int requestNumber = 50;
+    DynamicBatcher::Config config;
+    if (argc > 2) {
+        clientNumber = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        requestNumber = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        config.maxDelayUs = atoi(argv[4]);
+    }
+    if (argc > 5) {
+        config.workerNumber = atoi(argv[5]);
+    }
+    if (argc > 6) {
+        config.numThread = atoi(argv[6]);
+    }
+    std::shared_ptr<Module> module(Module::load({}, {}, argv[1]), Module::destroy);
+    if (nullptr == module) {
+        MNN_ERROR("Can't load module %s\n", argv[1]);
+        return 0;
+    }
+    auto mInfo = module->getInfo();
+    MNN_PRINT("clients: %d, requests per client: %d, max delay: %d us, workers: %d, threads: %d\n", clientNumber,
+              requestNumber, config.maxDelayUs, config.workerNumber, config.numThread);
+    MNN_PRINT("maxBatch\tthroughput(req/s)\tavg(ms)\tp50(ms)\tp99(ms)\n");
+    for (int maxBatch = 1; maxBatch <= clientNumber; maxBatch *= 2) {
+        config.maxBatch = maxBatch;
+        std::shared_ptr<DynamicBatcher> batcher(DynamicBatcher::create(module, config), DynamicBatcher::destroy);
+        if (nullptr == batcher) {
+            return 0;
+        }
+        std::vector<std::vector<float>> latency(clientNumber);
+        std::vector<std::thread> clients;
+        Timer timer;
+        for (int c = 0; c < clientNumber; ++c) {
+            clients.emplace_back([&, c]() {
+                auto exe = Executor::newExecutor(MNN_FORWARD_CPU, BackendConfig(), 1);
+                ExecutorScope scope(exe);
+                std::vector<VARP> inputs(mInfo->inputs.size());
+                for (int i = 0; i < inputs.size(); ++i) {
+                    auto dims = mInfo->inputs[i].dim;
+                    for (auto& d : dims) {
+                        d = d > 0 ? d : 1;
+                    }
+                    if (!dims.empty()) {
+                        dims[0] = 1;
+                    }
+                    inputs[i] = _Input(dims, mInfo->inputs[i].order, mInfo->inputs[i].type);
+                    auto info = inputs[i]->getInfo();
+                    ::memset(inputs[i]->writeMap<void>(), 0, info->size * info->type.bytes());
+                }
+                // Each client is synchronous: send one request after the last one finished
+                for (int n = 0; n < requestNumber; ++n) {
+                    Timer requestTimer;
+                    auto outputs = batcher->forward(inputs).get();
+                    if (outputs.empty()) {
+                        MNN_ERROR("Request failed\n");
+                        return;
+                    }
+                    latency[c].emplace_back((float)requestTimer.durationInUs() / 1000.0f);
+                }
+            });
+        }
+        for (auto& t : clients) {
+            t.join();
+        }
+        auto totalTime = (float)timer.durationInUs() / 1000.0f;
+        std::vector<float> allLatency;
+        for (auto& l : latency) {
+            allLatency.insert(allLatency.end(), l.begin(), l.end());
+        }
+        if (allLatency.empty()) {
+            return 0;
+        }
+        std::sort(allLatency.begin(), allLatency.end());
+        float sum = 0.0f;
+        for (auto l : allLatency) {
+            sum += l;
+        }
+        auto p50 = allLatency[allLatency.size() / 2];
+        auto p99 = allLatency[std::min(allLatency.size() - 1, allLatency.size() * 99 / 100)];
+        MNN_PRINT("%d\t%f\t%f\t%f\t%f\n", maxBatch, allLatency.size() * 1000.0f / totalTime, sum / allLatency.size(), p50, p99);
+    }
+    return 0;
+}
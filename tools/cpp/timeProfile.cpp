@@ -70,6 +70,12 @@ int main(int argc, const char* argv[]) {
         MNN_PRINT("Set ThreadNumber = %d\n", threadNumber);
     }
 
+    // Write chrome trace of ops and threads if set
+    const char* traceFile = nullptr;
+    if (argc > 6 && 0 != ::strcmp(argv[6], "0")) {
+        traceFile = argv[6];
+    }
+
     float sparsity = 0.0f;
     if(argc >= 8) {
         sparsity = atof(argv[7]);
@@ -125,15 +131,20 @@ int main(int argc, const char* argv[]) {
     auto profiler      = MNN::Profiler::getInstance();
     auto beginCallBack = [&](const std::vector<Tensor*>& inputs, const OperatorInfo* info) {
         profiler->start(info);
+        profiler->addBytes(inputs);
         return true;
     };
     auto afterCallBack = [&](const std::vector<Tensor*>& tensors, const OperatorInfo* info) {
         for (auto o : tensors) {
             o->wait(MNN::Tensor::MAP_TENSOR_READ, true);
         }
+        profiler->addBytes(tensors);
         profiler->end(info);
         return true;
     };
+    if (nullptr != traceFile) {
+        profiler->startTrace();
+    }
 
     AUTOTIME;
     // just run
@@ -148,5 +159,8 @@ int main(int argc, const char* argv[]) {
 #endif
     profiler->printSlowOp("Convolution", 20, 0.03f);
     profiler->printTimeByType(runTime);
+    if (nullptr != traceFile) {
+        profiler->dumpTrace(traceFile);
+    }
     return 0;
 }
@@ -128,6 +128,20 @@ void TensorStatistic::updateDistribution() {
     }
 }
 
+void TensorStatistic::mergeRange(const TensorStatistic& other) {
+    mRange.first  = std::min(mRange.first, other.mRange.first);
+    mRange.second = std::max(mRange.second, other.mRange.second);
+}
+
+void TensorStatistic::mergeDistribution(const TensorStatistic& other) {
+    if (!mValid || mDistribution.size() != other.mDistribution.size()) {
+        return;
+    }
+    for (int i = 0; i < mDistribution.size(); ++i) {
+        mDistribution[i] += other.mDistribution[i];
+    }
+}
+
 void TensorStatistic::setThresholdMethod(GET_THRESHOLD_METHOD thresholdMethod) {
     mThresholdMethod = thresholdMethod;
 }
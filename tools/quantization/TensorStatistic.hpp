@@ -32,6 +32,9 @@ public:
     void updateRange();
     void resetDistribution();
     void updateDistribution();
+    // Merge the statistic of the same tensor collected by another session
+    void mergeRange(const TensorStatistic& other);
+    void mergeDistribution(const TensorStatistic& other);
 
     void setThresholdMethod(GET_THRESHOLD_METHOD thresholdMethod);
 
@@ -8,11 +8,17 @@
 
 #include "calibration.hpp"
 #include <cmath>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <set>
+#include <thread>
 #include <algorithm>
 #include <MNN/ImageProcess.hpp>
 #include "flatbuffers/util.h"
@@ -194,6 +200,9 @@ Calibration::Calibration(MNN::NetT* model, const uint8_t* modelBuffer, const int
         if (picObj.HasMember("debug")) {
             _debug = picObj["debug"].GetBool();
         }
+        if (picObj.HasMember("thread_number")) {
+            _threadNumber = std::max(1, picObj["thread_number"].GetInt());
+        }
         _inputType = Helper::InputType::IMAGE;
         if (picObj.HasMember("input_type")) {
             std::string type = picObj["input_type"].GetString();
@@ -229,6 +238,9 @@ Calibration::Calibration(MNN::NetT* model, const uint8_t* modelBuffer, const int
         _initMNNSession(modelBuffer, bufferSize);
         _initMaps();
     }
+    if (_featureQuantizeMethod == "KL") {
+        _initWorkers();
+    }
 }
 
 std::vector<int> Calibration::_getInputShape(std::string filename) {
@@ -344,24 +356,21 @@ void Calibration::_initMNNSession(const uint8_t* modelBuffer, const int bufferSi
     _resizeIfNeeded(_calibrationFiles[0]);
 }
 
-void Calibration::_initMaps() {
-    _featureInfo.clear();
-    _featureInfoOrigin.clear();
-    _opInfo.clear();
-    _tensorMap.clear();
-    // run mnn once, initialize featureMap, opInfo map
+void Calibration::_createFeatureInfo(MNN::Session* session, std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>& featureInfo, bool recordOpInfo) {
     MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
         std::string opName = info->name();
         std::vector<std::string>::iterator iter = std::find(_skip_quant_ops.begin(), _skip_quant_ops.end(), opName);
         if (iter != _skip_quant_ops.end()) {
             return false;
         }
-        _opInfo[opName].first = nTensors;
+        if (recordOpInfo) {
+            _opInfo[opName].first = nTensors;
+        }
         if (Helper::gNotNeedFeatureOp.find(info->type()) == Helper::gNotNeedFeatureOp.end()) {
             int i = 0;
             for (auto t : nTensors) {
-                if (_featureInfo.find(t) == _featureInfo.end() && MNN::TensorUtils::getDescribe(t)->memoryType != MNN::Tensor::InsideDescribe::MEMORY_VIRTUAL) {
-                    _featureInfo[t] = std::shared_ptr<TensorStatistic>(
+                if (featureInfo.find(t) == featureInfo.end() && MNN::TensorUtils::getDescribe(t)->memoryType != MNN::Tensor::InsideDescribe::MEMORY_VIRTUAL) {
+                    featureInfo[t] = std::shared_ptr<TensorStatistic>(
                         new TensorStatistic(t, _featureQuantizeMethod, opName + " input_tensor_" + flatbuffers::NumToString(i), _featureClampValue));
                 }
                 i++;
@@ -369,19 +378,21 @@ void Calibration::_initMaps() {
         }
         return false;
     };
-    MNN::TensorCallBackWithInfo after = [this](const std::vector<MNN::Tensor*>& nTensors,
-                                               const MNN::OperatorInfo* info) {
+    MNN::TensorCallBackWithInfo after = [&](const std::vector<MNN::Tensor*>& nTensors,
+                                            const MNN::OperatorInfo* info) {
         std::string opName = info->name();
         std::vector<std::string>::iterator iter = std::find(_skip_quant_ops.begin(), _skip_quant_ops.end(), opName);
         if (iter != _skip_quant_ops.end()) {
             return true;
         }
-        _opInfo[opName].second = nTensors;
+        if (recordOpInfo) {
+            _opInfo[opName].second = nTensors;
+        }
         if (Helper::gNotNeedFeatureOp.find(info->type()) == Helper::gNotNeedFeatureOp.end()) {
             int i = 0;
             for (auto t : nTensors) {
-                if (_featureInfo.find(t) == _featureInfo.end()) {
-                    _featureInfo[t] =
+                if (featureInfo.find(t) == featureInfo.end()) {
+                    featureInfo[t] =
                         std::shared_ptr<TensorStatistic>(new TensorStatistic(t, _featureQuantizeMethod, opName + " output_tensor_" + flatbuffers::NumToString(i), _featureClampValue));
                 }
                 i++;
@@ -389,7 +400,16 @@ void Calibration::_initMaps() {
         }
         return true;
     };
-    _interpreter->runSessionWithCallBackInfo(_session, before, after);
+    _interpreter->runSessionWithCallBackInfo(session, before, after);
+}
+
+void Calibration::_initMaps() {
+    _featureInfo.clear();
+    _featureInfoOrigin.clear();
+    _opInfo.clear();
+    _tensorMap.clear();
+    // run mnn once, initialize featureMap, opInfo map
+    _createFeatureInfo(_session, _featureInfo, true);
 
 
     MNN::TensorCallBackWithInfo beforeOrigin = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
@@ -454,7 +474,201 @@ void Calibration::_initMaps() {
     }
 }
 
+namespace {
+// Decode and preprocess calibration files by its own threads ahead of inference
+class SamplePrefetcher {
+public:
+    typedef std::function<std::shared_ptr<MNN::Tensor>(int threadIndex, const std::string& file)> LoadFunction;
+    SamplePrefetcher(const std::vector<std::string>& files, int threadNumber, int capacity, LoadFunction&& load)
+        : mFiles(files), mCapacity(capacity), mLoad(std::move(load)) {
+        for (int i = 0; i < threadNumber; ++i) {
+            mThreads.emplace_back([this, i]() {
+                while (true) {
+                    int index = 0;
+                    {
+                        std::unique_lock<std::mutex> _l(mMutex);
+                        mCondition.wait(_l, [this]() {
+                            return mStop || mNext >= mFiles.size() || mQueue.size() + mLoading < mCapacity;
+                        });
+                        if (mStop || mNext >= mFiles.size()) {
+                            return;
+                        }
+                        index = mNext++;
+                        mLoading++;
+                    }
+                    auto sample = mLoad(i, mFiles[index]);
+                    {
+                        std::lock_guard<std::mutex> _l(mMutex);
+                        mQueue.emplace_back(sample);
+                        mLoading--;
+                    }
+                    mCondition.notify_all();
+                }
+            });
+        }
+    }
+    ~SamplePrefetcher() {
+        {
+            std::lock_guard<std::mutex> _l(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        for (auto& t : mThreads) {
+            t.join();
+        }
+    }
+    // Return nullptr if all samples has been taken
+    std::shared_ptr<MNN::Tensor> pop() {
+        std::unique_lock<std::mutex> _l(mMutex);
+        mCondition.wait(_l, [this]() {
+            return !mQueue.empty() || mTaken >= mFiles.size();
+        });
+        if (mQueue.empty()) {
+            return nullptr;
+        }
+        auto sample = mQueue.front();
+        mQueue.pop_front();
+        mTaken++;
+        _l.unlock();
+        mCondition.notify_all();
+        return sample;
+    }
+
+private:
+    const std::vector<std::string>& mFiles;
+    int mCapacity;
+    LoadFunction mLoad;
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::shared_ptr<MNN::Tensor>> mQueue;
+    int mNext    = 0;
+    int mLoading = 0;
+    int mTaken   = 0;
+    bool mStop   = false;
+};
+} // namespace
+
+void Calibration::_initWorkers() {
+    _workers.clear();
+    if (_inputType != Helper::InputType::IMAGE) {
+        // Shape of sequence input is decided by each file, run them one by one
+        return;
+    }
+    Worker mainWorker;
+    mainWorker.session     = _session;
+    mainWorker.inputTensor = _inputTensor;
+    mainWorker.featureInfo = _featureInfo;
+    _workers.emplace_back(std::move(mainWorker));
+    if (_threadNumber <= 1) {
+        return;
+    }
+    // The statistics of a tensor are matched between sessions by their names
+    std::map<std::string, std::shared_ptr<TensorStatistic>> featureByName;
+    for (auto& iter : _featureInfo) {
+        if (!featureByName.insert(std::make_pair(iter.second->name(), iter.second)).second) {
+            MNN_PRINT("Duplicate feature name %s, calibrate by one session\n", iter.second->name().c_str());
+            return;
+        }
+    }
+    MNN::ScheduleConfig config;
+    for (int i = 1; i < _threadNumber; ++i) {
+        Worker worker;
+        worker.session     = _interpreter->createSession(config);
+        worker.inputTensor = _interpreter->getSessionInput(worker.session, NULL);
+        _interpreter->resizeTensor(worker.inputTensor, _inputTensorDims);
+        _interpreter->resizeSession(worker.session);
+        _createFeatureInfo(worker.session, worker.featureInfo, false);
+        bool matched = worker.featureInfo.size() == _featureInfo.size();
+        for (auto& iter : worker.featureInfo) {
+            auto target = featureByName.find(iter.second->name());
+            if (target == featureByName.end()) {
+                matched = false;
+                break;
+            }
+            worker.merges.emplace_back(std::make_pair(iter.second, target->second));
+        }
+        if (!matched) {
+            MNN_PRINT("Features of session %d are not the same as the first one, calibrate by %d sessions\n", i, i);
+            _interpreter->releaseSession(worker.session);
+            return;
+        }
+        _workers.emplace_back(std::move(worker));
+    }
+}
+
+void Calibration::_runWorkers(bool distribution) {
+    const char* title = distribution ? "CollectFeatureDistribution" : "ComputeFeatureRange";
+    const int workerNumber = (int)_workers.size();
+    std::vector<std::shared_ptr<ImageProcess>> processes(workerNumber);
+    for (auto& process : processes) {
+        process.reset(ImageProcess::create(_imageProcessConfig));
+    }
+    SamplePrefetcher prefetcher(_calibrationFiles, workerNumber, workerNumber * 2, [&](int threadIndex, const std::string& file) {
+        std::shared_ptr<MNN::Tensor> sample(new MNN::Tensor(_inputTensor, _inputTensor->getDimensionType()));
+        Helper::preprocessInput(processes[threadIndex].get(), _preprocessConfig, file, sample.get(), _inputType);
+        return sample;
+    });
+    std::atomic_int count(0);
+    std::mutex printMutex;
+    auto run = [&](int index) {
+        auto& worker      = _workers[index];
+        auto& featureInfo = worker.featureInfo;
+        MNN::TensorCallBackWithInfo update = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
+            for (auto t : nTensors) {
+                auto iter = featureInfo.find(t);
+                if (iter != featureInfo.end() && iter->second->visited() == false) {
+                    if (distribution) {
+                        iter->second->updateDistribution();
+                    } else {
+                        iter->second->updateRange();
+                    }
+                }
+            }
+            return true;
+        };
+        while (auto sample = prefetcher.pop()) {
+            for (auto& iter : featureInfo) {
+                iter.second->setVisited(false);
+                if (distribution) {
+                    iter.second->resetUpdatedDistributionFlag();
+                } else {
+                    iter.second->resetUpdatedRangeFlags();
+                }
+            }
+            worker.inputTensor->copyFromHostTensor(sample.get());
+            _interpreter->runSessionWithCallBackInfo(worker.session, update, update);
+            auto current = ++count;
+            std::lock_guard<std::mutex> _l(printMutex);
+            MNN_PRINT("\r%s: %.2lf %%", title, (float)current * 100.0f / (float)_calibrationFileNum);
+            fflush(stdout);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workerNumber; ++i) {
+        threads.emplace_back(run, i);
+    }
+    run(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int i = 1; i < workerNumber; ++i) {
+        for (auto& merge : _workers[i].merges) {
+            if (distribution) {
+                merge.second->mergeDistribution(*merge.first);
+            } else {
+                merge.second->mergeRange(*merge.first);
+            }
+        }
+    }
+    MNN_PRINT("\n");
+}
+
 void Calibration::_computeFeatureMapsRange() {
+    if (!_workers.empty()) {
+        _runWorkers(false);
+        return;
+    }
     // feed input data according to input images
     int count = 0;
     for (const auto& file : _calibrationFiles) {
@@ -503,6 +717,17 @@ void Calibration::_collectFeatureMapsDistribution() {
     for (auto& iter : _featureInfo) {
         iter.second->resetDistribution();
     }
+    if (!_workers.empty()) {
+        // Use the merged range for the statistics of all sessions
+        for (int i = 1; i < _workers.size(); ++i) {
+            for (auto& merge : _workers[i].merges) {
+                merge.first->mergeRange(*merge.second);
+                merge.first->resetDistribution();
+            }
+        }
+        _runWorkers(true);
+        return;
+    }
     // feed input data according to input images
     MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>& nTensors, const MNN::OperatorInfo* info) {
         for (auto t : nTensors) {
@@ -550,9 +775,26 @@ void Calibration::_computeFeatureScaleKL() {
     _collectFeatureMapsDistribution();
 
     _scales.clear();
-    for (auto& iter : _featureInfo) {
-        AUTOTIME;
-        _scales[iter.first] = iter.second->finishAndCompute();
+    // Threshold search of tensors are independent
+    std::vector<std::pair<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>> features(_featureInfo.begin(), _featureInfo.end());
+    std::vector<float> scales(features.size());
+    std::atomic_int next(0);
+    auto compute = [&]() {
+        for (int i = next++; i < (int)features.size(); i = next++) {
+            scales[i] = features[i].second->finishAndCompute();
+        }
+    };
+    int threadNumber = std::min((int)features.size(), std::max(1, (int)std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadNumber; ++i) {
+        threads.emplace_back(compute);
+    }
+    compute();
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int i = 0; i < features.size(); ++i) {
+        _scales[features[i].first] = scales[i];
     }
     //_featureInfo.clear();//No need now
 }
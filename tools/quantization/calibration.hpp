@@ -81,11 +81,26 @@ private:
     float _weightClampValue = 127.0f;
     std::vector<std::string> _skip_quant_ops;
     bool _debug = false;
+    int _threadNumber = 1;
+
+    // Sessions running calibration files in parallel, the first one is _session, the others collect
+    // statistics of their own and merge them into _featureInfo
+    struct Worker {
+        MNN::Session* session;
+        MNN::Tensor* inputTensor;
+        std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>> featureInfo;
+        // <statistic of worker, statistic in _featureInfo>
+        std::vector<std::pair<std::shared_ptr<TensorStatistic>, std::shared_ptr<TensorStatistic>>> merges;
+    };
+    std::vector<Worker> _workers;
 
     std::vector<int> _getInputShape(std::string filename);
     void _resizeIfNeeded(std::string filename, bool force = false);
     void _initMNNSession(const uint8_t* modelBuffer, const int bufferSize);
     void _initMaps();
+    void _createFeatureInfo(MNN::Session* session, std::map<const MNN::Tensor*, std::shared_ptr<TensorStatistic>>& featureInfo, bool recordOpInfo);
+    void _initWorkers();
+    void _runWorkers(bool distribution);
 
     // compute min/max value for every Tensor
     void _computeFeatureMapsRange();
@@ -7,7 +7,7 @@
 //
 
 #include "ADAM.hpp"
-#include "OpGrad.hpp"
+#include <math.h>
 
 using namespace MNN::Express;
 
@@ -16,7 +16,7 @@ namespace Train {
 ADAM::ADAM(std::shared_ptr<Module> module) : SGD(module) {
     auto train = ParameterOptimizer::trainable();
     for (auto p : train) {
-        mHistory2[p] = _Const(0.0f, p->getInfo()->dim, p->getInfo()->order);
+        mHistory2[p].resize(p->getInfo()->size, 0.0f);
     }
 }
 
@@ -36,27 +36,19 @@ float ADAM::getEps() {
     return mEps;
 }
 
-Express::VARP ADAM::onComputeUpdateValue(Express::VARP param, Express::VARP grad) {
-    auto lr    = _Const(mLearningRate, {}, NCHW);
-    auto step  = _Const(currentStep(), {}, NCHW);
-    auto beta1 = _Const(mMomentum, {}, NCHW);
-    auto beta2 = _Const(mMomentum2, {}, NCHW);
-    auto eps   = _Const(mEps, {}, NCHW);
-    // auto m = mHistory[param];
-    // auto v = mHistory2[param];
-
-    auto correction = _Sqrt(_Const(1.0f, {}, NCHW) - _Pow(beta2, step)) / (_Const(1.0f, {}, NCHW) - _Pow(beta1, step));
-
-    mHistory[param] = beta1 * mHistory[param] + (_Const(1.0f, {}, NCHW) - beta1) * grad;
-    mHistory[param].fix(Express::VARP::CONSTANT);
-
-    mHistory2[param] = beta2 * mHistory2[param] + (_Const(1.0f, {}, NCHW) - beta2) * _Square(grad);
-    mHistory2[param].fix(Express::VARP::CONSTANT);
-
-    auto updateValue = lr * correction * (mHistory[param] / (_Sqrt(mHistory2[param]) + eps));
-    updateValue.fix(Express::VARP::CONSTANT);
-
-    return updateValue;
+void ADAM::onUpdate(const ParameterBuffer& buffer, int start, int end) {
+    auto m     = mHistory.find(buffer.variable)->second.data();
+    auto v     = mHistory2.find(buffer.variable)->second.data();
+    auto step  = (float)currentStep();
+    auto beta1 = mMomentum;
+    auto beta2 = mMomentum2;
+    auto lr    = mLearningRate * sqrtf(1.0f - powf(beta2, step)) / (1.0f - powf(beta1, step));
+    for (int i = start; i < end; ++i) {
+        auto grad = regularize(buffer.parameter[i], buffer.grad[i]);
+        m[i]      = beta1 * m[i] + (1.0f - beta1) * grad;
+        v[i]      = beta2 * v[i] + (1.0f - beta2) * grad * grad;
+        buffer.parameter[i] -= lr * (m[i] / (sqrtf(v[i]) + mEps));
+    }
 }
 
 } // namespace Train
@@ -23,7 +23,7 @@ public:
     ADAM(std::shared_ptr<Express::Module> module);
     virtual ~ ADAM() = default;
 
-    virtual Express::VARP onComputeUpdateValue(Express::VARP param, Express::VARP grad) override;
+    virtual void onUpdate(const ParameterBuffer& buffer, int start, int end) override;
 
     float getMomentum2();
 
@@ -36,7 +36,7 @@ public:
 private:
     float mMomentum2 = 0.999; // default 0.999
     float mEps       = 1e-8;
-    std::map<MNN::Express::VARP, MNN::Express::VARP> mHistory2;
+    std::map<MNN::Express::VARP, std::vector<float>> mHistory2;
 };
 
 } // namespace Train
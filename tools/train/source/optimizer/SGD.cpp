@@ -7,7 +7,13 @@
 //
 
 #include "SGD.hpp"
+#include <algorithm>
+#include <MNN/expr/Executor.hpp>
 #include "OpGrad.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#ifdef MNN_USE_THREAD_POOL
+#include "backend/cpu/ThreadPool.hpp"
+#endif
 using namespace MNN::Express;
 
 namespace MNN {
@@ -15,10 +21,27 @@ namespace Train {
 SGD::SGD(std::shared_ptr<Module> module) : ParameterOptimizer(module) {
     auto train = ParameterOptimizer::trainable();
     for (auto p : train) {
-        mHistory[p] = _Const(0.0f, p->getInfo()->dim, p->getInfo()->order);
+        mHistory[p].resize(p->getInfo()->size, 0.0f);
     }
 }
 
+Backend* SGD::_cpuBackend() {
+    auto info = Executor::getRuntime();
+    auto runtime = info.second;
+    auto iter = info.first.find(MNN_FORWARD_CPU);
+    if (iter != info.first.end() && nullptr != iter->second) {
+        runtime = iter->second;
+    }
+    if (nullptr == runtime) {
+        return nullptr;
+    }
+    if (runtime != mRuntime) {
+        mRuntime = runtime;
+        mBackend.reset(runtime->onCreate());
+    }
+    return mBackend.get();
+}
+
 void SGD::setLearningRate(float rate) {
     mLearningRate = rate;
 }
@@ -51,29 +74,13 @@ SGD::RegularizationMethod SGD::getRegularizationMethod() {
     return mRegularizationMethod;
 }
 
-Express::VARP SGD::regularizeParameters(Express::VARP param, Express::VARP grad) {
-    VARP addWeightDecayGrad;
-    if (mRegularizationMethod == L1) {
-        auto temp          = _Sign(param);
-        addWeightDecayGrad = _Const(mWeightDecay, {}, NCHW) * temp + grad;
-    } else if (mRegularizationMethod == L2) {
-        addWeightDecayGrad = _Const(mWeightDecay, {}, NCHW) * param + grad;
-    } else if (mRegularizationMethod == L1L2) {
-        auto temp          = _Sign(param);
-        auto L1 = _Const(mWeightDecay, {}, NCHW) * temp;
-        auto L2 = _Const(mWeightDecay, {}, NCHW) * param;
-        addWeightDecayGrad = L1 + L2 + grad;
+void SGD::onUpdate(const ParameterBuffer& buffer, int start, int end) {
+    auto history = mHistory.find(buffer.variable)->second.data();
+    for (int i = start; i < end; ++i) {
+        auto grad  = regularize(buffer.parameter[i], buffer.grad[i]);
+        history[i] = mLearningRate * grad + mMomentum * history[i];
+        buffer.parameter[i] -= history[i];
     }
-
-    return addWeightDecayGrad;
-}
-
-Express::VARP SGD::onComputeUpdateValue(Express::VARP param, Express::VARP grad) {
-    auto lr         = _Const(mLearningRate, {}, NCHW);
-    mHistory[param] = lr * grad + _Const(mMomentum, {}, NCHW) * mHistory[param];
-    mHistory[param].fix(Express::VARP::CONSTANT);
-    //FUNC_PRINT_ALL(_ReduceMax(grad)->readMap<float>()[0], f);
-    return mHistory[param];
 }
 
 std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP loss) {
@@ -104,15 +111,55 @@ std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP los
         Variable::replace(prepareCompute[i], replaceOp[i]);
     }
 
+    std::vector<ParameterBuffer> buffers;
+    int totalSize = 0;
     for (auto& iter : grad) {
-        // apply regularization
-        auto addWeightDecayGrad = regularizeParameters(iter.first, iter.second);
-        addWeightDecayGrad.fix(Express::VARP::CONSTANT);
-        // apply momentum, etc.
-        auto updateValue = this->onComputeUpdateValue(iter.first, addWeightDecayGrad);
-        // apply update
-        auto newParameter = iter.first - updateValue;
-        iter.second       = newParameter;
+        auto info = iter.first->getInfo();
+        if (nullptr == info || info->type.code != halide_type_float || info->size != iter.second->getInfo()->size) {
+            MNN_ERROR("Only support float parameter in SGD\n");
+            return {};
+        }
+        ParameterBuffer buffer;
+        buffer.variable  = iter.first;
+        buffer.parameter = iter.first->writeMap<float>();
+        buffer.grad      = iter.second->readMap<float>();
+        buffer.size      = info->size;
+        buffers.emplace_back(buffer);
+        totalSize += buffer.size;
+        // Parameter is updated in place
+        iter.second = iter.first;
+    }
+    // Divide all parameters into equal parts for the threads of executor, small models are updated by the calling thread
+    auto backend = static_cast<CPUBackend*>(_cpuBackend());
+    int numberThread = 1;
+    if (nullptr != backend) {
+        numberThread = std::max(1, std::min(backend->threadNumber(), totalSize / 16384));
+    }
+    auto function = [&](int tId) {
+        int sta = (int)((int64_t)totalSize * tId / numberThread);
+        int fin = (int)((int64_t)totalSize * (tId + 1) / numberThread);
+        int offset = 0;
+        for (auto& buffer : buffers) {
+            int start = std::max(sta - offset, 0);
+            int end   = std::min(fin - offset, buffer.size);
+            if (start < end) {
+                this->onUpdate(buffer, start, end);
+            }
+            offset += buffer.size;
+        }
+    };
+#ifdef MNN_USE_THREAD_POOL
+    if (numberThread > 1) {
+        backend->onExecuteBegin();
+        ThreadPool::TASK task = std::make_pair(function, numberThread);
+        ThreadPool::enqueue(std::move(task), backend->taskIndex(), backend->threadNumber());
+        backend->onExecuteEnd();
+    } else
+#endif
+    {
+        for (int i = 0; i < numberThread; ++i) {
+            function(i);
+        }
     }
     return grad;
 }
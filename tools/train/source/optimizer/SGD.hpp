@@ -15,6 +15,8 @@
 #include "ParameterOptimizer.hpp"
 
 namespace MNN {
+class Backend;
+class Runtime;
 namespace Train {
 
 class MNN_PUBLIC SGD : public ParameterOptimizer {
@@ -23,9 +25,16 @@ public:
     virtual ~ SGD() = default;
     virtual std::map<Express::VARP, Express::VARP> onGetNextParameter(Express::VARP loss) override;
 
-    Express::VARP regularizeParameters(Express::VARP param, Express::VARP grad);
+    // Host memory of one trainable parameter and its grad
+    struct ParameterBuffer {
+        Express::VARP variable;
+        float* parameter;
+        const float* grad;
+        int size;
+    };
 
-    virtual Express::VARP onComputeUpdateValue(Express::VARP param, Express::VARP grad);
+    // Regularize, compute the update value and apply it to parameter[start, end) in place
+    virtual void onUpdate(const ParameterBuffer& buffer, int start, int end);
 
     void setLearningRate(float rate);
 
@@ -52,12 +61,34 @@ protected:
     float mMomentum                            = 0;
     float mWeightDecay                         = 0;
     RegularizationMethod mRegularizationMethod = L2;
-    std::map<MNN::Express::VARP, MNN::Express::VARP> mHistory;
+    std::map<MNN::Express::VARP, std::vector<float>> mHistory;
+
+    // Add weight decay of parameter to grad
+    inline float regularize(float parameter, float grad) const {
+        float sign = parameter > 0.0f ? 1.0f : (parameter < 0.0f ? -1.0f : 0.0f);
+        switch (mRegularizationMethod) {
+            case L1:
+                return grad + mWeightDecay * sign;
+            case L2:
+                return grad + mWeightDecay * parameter;
+            case L1L2:
+                return grad + mWeightDecay * (sign + parameter);
+            default:
+                break;
+        }
+        return grad;
+    }
 
     // For Cache
     const Express::Expr* mLoss = nullptr;
     int mLossFromIndex         = 0;
     std::string mGradBlockExprName;
+
+private:
+    // Backend of the executor's CPU runtime, the update kernel is run by its thread pool
+    Backend* _cpuBackend();
+    std::shared_ptr<Runtime> mRuntime;
+    std::shared_ptr<Backend> mBackend;
 };
 
 } // namespace Train